@@ -39,6 +39,7 @@ typedef SOCKET socket_t;
 #include <netdb.h>
 #include <cstring>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <sys/select.h> // fd_set
@@ -46,7 +47,9 @@ typedef SOCKET socket_t;
 typedef int socket_t;
 #endif
 
+#include <chrono>
 #include <fstream>
+#include <functional>
 #include <map>
 #include <string>
 #include <sstream>
@@ -74,9 +77,11 @@ typedef std::multimap<std::string, std::string> MultiMap;
 struct Request {
     std::string method;
     std::string url;
+    std::string version;
     MultiMap    headers;
     std::string body;
     Map         params;
+    std::chrono::steady_clock::time_point received; // the request line became readable
 
     bool has_header(const char* key) const;
     std::string get_header_value(const char* key) const;
@@ -98,7 +103,17 @@ struct Response {
     void set_content(const char* s, size_t n, const char* content_type);
     void set_content(const std::string& s, const char* content_type);
 
-    Response() : status(-1) {}
+    // Chunked streaming of the body while Server::handle_request() runs.
+    // The first chunk sends the status line and headers, body is ignored then.
+    bool is_chunked_allowed() const;
+    bool write_chunk(const char* data, size_t size);
+
+    Response() : status(-1), sock((socket_t)-1), chunked_allowed(false), chunked(false), upgraded(false) {}
+
+    socket_t    sock;            // set by the server for chunked streaming
+    bool        chunked_allowed; // the request was HTTP/1.1
+    bool        chunked;         // headers have been sent, body is chunked
+    bool        upgraded;        // the handler took over the connection for another protocol
 };
 
 class Server {
@@ -110,11 +125,17 @@ public:
     void accept(ProcessFunctor& processor);
     void stop();
     void process_request(socket_t sock);
+    // false once stop() has been called, for handlers that keep a response open
+    bool is_running() const { return keep_accepting; }
 
 protected:
     virtual bool handle_request(const Request&, Response&) = 0;
+    // Called once the response has been sent.
+    virtual void response_written(const Request&, const Response&) {}
 
 private:
+    bool wait_for_request(socket_t sock);
+
     socket_t    svr_sock_;
     volatile bool keep_accepting;
 };
@@ -130,6 +151,14 @@ public:
     Response* post(const char* url, const Map& params);
 
     bool send(const Request& req, Response& res);
+    // sends a request that is already formatted completely, head and body
+    bool send_raw(const std::string& request, Response& res);
+    // sends a GET request and hands the body to on_data while it arrives, chunk by chunk if it is
+    // chunked. on_response is called once the headers have been read. While no data arrives
+    // on_data is called with nullptr every 100 ms. Reading ends when either returns false.
+    bool stream(const char* url, Response& res,
+                const std::function<bool(const Response&)>& on_response,
+                const std::function<bool(const char*, size_t)>& on_data);
 
 private:
     const std::string host_;
@@ -149,7 +178,34 @@ inline int socket_write(socket_t sock, const char* ptr, size_t size = -1)
     if (size == -1) {
         size = strlen(ptr);
     }
-    return send(sock, ptr, size, 0);
+    // send() may accept less than requested for large buffers
+    size_t written = 0;
+    while (written < size) {
+#ifdef MSG_NOSIGNAL
+        // a client that has gone away must not raise SIGPIPE
+        int n = send(sock, ptr + written, size - written, MSG_NOSIGNAL);
+#else
+        int n = send(sock, ptr + written, size - written, 0);
+#endif
+        if (n <= 0) {
+            return n;
+        }
+        written += n;
+    }
+    return (int)written;
+}
+
+inline bool socket_read_all(socket_t sock, char* ptr, size_t size)
+{
+    size_t read = 0;
+    while (read < size) {
+        int n = socket_read(sock, ptr + read, size - read);
+        if (n <= 0) {
+            return false;
+        }
+        read += n;
+    }
+    return true;
 }
 
 inline bool socket_gets(socket_t sock, char* buf, int bufsiz)
@@ -248,6 +304,13 @@ inline bool wait_for_socket_readable(socket_t sock, size_t timeout_us)
     return FD_ISSET(sock, &file_descriptors);
 }
 
+// sends small messages right away instead of waiting for the acknowledgement of the last one
+inline void set_nodelay(socket_t sock)
+{
+    int yes = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&yes, sizeof(yes));
+}
+
 inline int shutdown_socket(socket_t sock)
 {
 #ifdef _MSC_VER    
@@ -339,6 +402,7 @@ inline const char* status_message(int status)
     case 200: return "OK";
     case 400: return "Bad Request";
     case 404: return "Not Found";
+    case 415: return "Unsupported Media Type";
     default:
         case 500: return "Internal Server Error";
     }
@@ -392,13 +456,50 @@ inline bool read_headers(socket_t sock, MultiMap& headers)
     return true;
 }
 
+template <typename T>
+bool read_chunked_content(socket_t sock, T& x)
+{
+    const size_t BUFSIZ_CHUNKLINE = 64;
+    char buf[BUFSIZ_CHUNKLINE];
+    x.body.clear();
+    for (;;) {
+        if (!socket_gets(sock, buf, BUFSIZ_CHUNKLINE)) {
+            return false;
+        }
+        char* end = NULL;
+        unsigned long chunk_size = strtoul(buf, &end, 16);
+        if (end == buf) {
+            return false;
+        }
+        if (chunk_size == 0) {
+            break;
+        }
+        size_t offset = x.body.size();
+        x.body.resize(offset + chunk_size);
+        if (!socket_read_all(sock, &x.body[offset], chunk_size) ||
+            !socket_gets(sock, buf, BUFSIZ_CHUNKLINE)) { // CRLF after the chunk data
+            return false;
+        }
+    }
+    // skip trailers up to the terminating empty line
+    do {
+        if (!socket_gets(sock, buf, BUFSIZ_CHUNKLINE)) {
+            return false;
+        }
+    } while (strcmp(buf, "\r\n") != 0);
+    return true;
+}
+
 template <typename T>
 bool read_content(socket_t sock, T& x)
 {
+    if (get_header_value(x.headers, "Transfer-Encoding", "") == std::string("chunked")) {
+        return read_chunked_content(sock, x);
+    }
     int len = get_header_value_int(x.headers, "Content-Length", 0);
     if (len) {
         x.body.assign(len, 0);
-        if (!socket_read(sock, &x.body[0], x.body.size())) {
+        if (!socket_read_all(sock, &x.body[0], x.body.size())) {
             return false;
         }
     }
@@ -422,6 +523,23 @@ inline void write_headers(socket_t sock, const T& res)
     socket_write(sock, "\r\n");
 }
 
+inline void write_chunked_headers(socket_t sock, const Response& res)
+{
+    socket_printf(sock, "HTTP/1.1 %d %s\r\n", res.status == -1 ? 200 : res.status,
+                  status_message(res.status == -1 ? 200 : res.status));
+    socket_write(sock, "Connection: close\r\n");
+
+    for (MultiMap::const_iterator x = res.headers.begin(); x != res.headers.end(); ++x) {
+        if (x->first != "Content-Type" && x->first != "Content-Length") {
+            socket_printf(sock, "%s: %s\r\n", x->first.c_str(), x->second.c_str());
+        }
+    }
+
+    const char* t = get_header_value(res.headers, "Content-Type", "text/plain");
+    socket_printf(sock, "Content-Type: %s\r\n", t);
+    socket_write(sock, "Transfer-Encoding: chunked\r\n\r\n");
+}
+
 inline void write_response(socket_t sock, const Request& req, const Response& res)
 {
     socket_printf(sock, "HTTP/1.0 %d %s\r\n", res.status, status_message(res.status));
@@ -567,7 +685,7 @@ inline std::string decode_url(const std::string& s)
 inline void write_request(socket_t sock, const Request& req)
 {
     std::string url = encode_url(req.url);
-    socket_printf(sock, "%s %s HTTP/1.0\r\n", req.method.c_str(), url.c_str());
+    socket_printf(sock, "%s %s HTTP/1.1\r\n", req.method.c_str(), url.c_str());
 
     write_headers(sock, req);
 
@@ -661,6 +779,15 @@ inline bool read_request_line(socket_t sock, Request& req)
     {
         req.method = method;
         req.url = url;
+        if (url_end != std::string::npos)
+        {
+            size_t version_start = request_line.find(' ', url_end);
+            if (version_start != std::string::npos)
+            {
+                size_t version_end = request_line.find_first_of("\r\n", version_start + 1);
+                req.version = request_line.substr(version_start + 1, version_end - version_start - 1);
+            }
+        }
         if (request_line.substr(url_end, 1) == "?")
         {
             size_t second_space = request_line.find(' ', url_end);
@@ -764,6 +891,30 @@ inline void Response::set_content(const std::string& s, const char* content_type
     set_header("Content-Type", content_type);
 }
 
+inline bool Response::is_chunked_allowed() const
+{
+    return chunked_allowed && sock != (socket_t)-1;
+}
+
+inline bool Response::write_chunk(const char* data, size_t size)
+{
+    if (!is_chunked_allowed()) {
+        return false;
+    }
+    if (!chunked) {
+        detail::write_chunked_headers(sock, *this);
+        chunked = true;
+    }
+    if (size == 0) {
+        return true; // an empty chunk would terminate the body
+    }
+    char chunk_header[20];
+    int len = snprintf(chunk_header, sizeof(chunk_header), "%lx\r\n", (unsigned long)size);
+    return detail::socket_write(sock, chunk_header, len) > 0 &&
+           detail::socket_write(sock, data, size) > 0 &&
+           detail::socket_write(sock, "\r\n", 2) > 0;
+}
+
 // HTTP server implementation
 inline Server::Server()
     : svr_sock_(-1), keep_accepting(true)
@@ -816,17 +967,34 @@ inline void Server::stop()
     svr_sock_ = -1;
 }
 
+inline bool Server::wait_for_request(socket_t sock)
+{
+    // wait up to 10 seconds for the next request, in slices to notice a stop() in time
+    for (int slice = 0; slice < 100; ++slice) {
+        if (detail::wait_for_socket_readable(sock, 100000)) {
+            return true;
+        }
+        if (!keep_accepting) {
+            break;
+        }
+    }
+    return false;
+}
+
 inline void Server::process_request(socket_t sock)
 {
-    while (detail::wait_for_socket_readable(sock, 10000000))
+    while (wait_for_request(sock))
     {
         Request req;
         Response res;
+        req.received = std::chrono::steady_clock::now();
 
         if (!detail::read_request_line(sock, req) ||
             !detail::read_headers(sock, req.headers)) {
             break;
         }
+        res.sock = sock;
+        res.chunked_allowed = req.version == "HTTP/1.1";
 
         if (req.method == "POST") {
             if (!detail::read_content(sock, req)) {
@@ -839,6 +1007,9 @@ inline void Server::process_request(socket_t sock)
         }
 
         if (handle_request(req, res)) {
+            if (res.upgraded) {
+                break;
+            }
             if (res.status == -1) {
                 res.status = 200;
             }
@@ -848,7 +1019,12 @@ inline void Server::process_request(socket_t sock)
 
         assert(res.status != -1);
 
-        detail::write_response(sock, req, res);
+        if (res.chunked) {
+            detail::socket_write(sock, "0\r\n\r\n");
+        } else {
+            detail::write_response(sock, req, res);
+        }
+        response_written(req, res);
     }
 
     detail::close_socket(sock);
@@ -899,11 +1075,132 @@ inline bool Client::send(const Request& req, Response& res)
     return detail::read_and_close_socket(sock, functor);
 }
 
+struct RawRequestFunctor
+{
+    const std::string& req;
+    Response& res;
+    RawRequestFunctor(const std::string& req, Response& res):
+        req(req), res(res) {
+    }
+
+    bool operator()(socket_t sock) {
+        // Send request with a single write
+        if (detail::socket_write(sock, req.data(), req.size()) != (int)req.size()) {
+            return false;
+        }
+
+        // Receive response
+        return detail::read_response_line(sock, res) &&
+               detail::read_headers(sock, res.headers) &&
+               detail::read_content(sock, res);
+    }
+};
+
+inline bool Client::send_raw(const std::string& request, Response& res)
+{
+    int sock = detail::create_client_socket(host_.c_str(), port_);
+    if (sock == -1) {
+        return false;
+    }
+
+    RawRequestFunctor functor(request, res);
+    return detail::read_and_close_socket(sock, functor);
+}
+
+struct StreamFunctor
+{
+    const Request& req;
+    Response& res;
+    const std::function<bool(const Response&)>& on_response;
+    const std::function<bool(const char*, size_t)>& on_data;
+    StreamFunctor(const Request& req, Response& res,
+                  const std::function<bool(const Response&)>& on_response,
+                  const std::function<bool(const char*, size_t)>& on_data):
+        req(req), res(res), on_response(on_response), on_data(on_data) {
+    }
+
+    // waits until data arrives, false if on_data asks to stop meanwhile
+    bool wait_readable(socket_t sock) {
+        while (!detail::wait_for_socket_readable(sock, 100000)) {
+            if (!on_data(nullptr, 0)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator()(socket_t sock) {
+        detail::write_request(sock, req);
+
+        if (!detail::read_response_line(sock, res) ||
+            !detail::read_headers(sock, res.headers)) {
+            return false;
+        }
+        if (!on_response(res)) {
+            return true;
+        }
+        if (detail::get_header_value(res.headers, "Transfer-Encoding", "") != std::string("chunked")) {
+            if (!detail::read_content(sock, res)) {
+                return false;
+            }
+            on_data(res.body.data(), res.body.size());
+            return true;
+        }
+
+        const size_t BUFSIZ_CHUNKLINE = 64;
+        char buf[BUFSIZ_CHUNKLINE];
+        std::string chunk;
+        for (;;) {
+            if (!wait_readable(sock)) {
+                return true;
+            }
+            if (!detail::socket_gets(sock, buf, BUFSIZ_CHUNKLINE)) {
+                return false;
+            }
+            char* end = NULL;
+            unsigned long chunk_size = strtoul(buf, &end, 16);
+            if (end == buf) {
+                return false;
+            }
+            if (chunk_size == 0) {
+                return true;
+            }
+            chunk.resize(chunk_size);
+            if (!detail::socket_read_all(sock, &chunk[0], chunk_size) ||
+                !detail::socket_gets(sock, buf, BUFSIZ_CHUNKLINE)) {
+                return false;
+            }
+            if (!on_data(chunk.data(), chunk.size())) {
+                return true;
+            }
+        }
+    }
+};
+
+inline bool Client::stream(const char* url, Response& res,
+                           const std::function<bool(const Response&)>& on_response,
+                           const std::function<bool(const char*, size_t)>& on_data)
+{
+    int sock = detail::create_client_socket(host_.c_str(), port_);
+    if (sock == -1) {
+        return false;
+    }
+
+    Request req;
+    req.method = "GET";
+    req.url = url;
+    req.set_header("Host", host_.c_str());
+
+    StreamFunctor functor(req, res, on_response, on_data);
+    return detail::read_and_close_socket(sock, functor);
+}
+
 inline Response* Client::get(const char* url)
 {
     Request req;
     req.method = "GET";
     req.url = url;
+    req.set_header("Host", host_.c_str());
 
     std::auto_ptr<Response> res(new Response);
 
@@ -915,6 +1212,7 @@ inline Response* Client::head(const char* url)
     Request req;
     req.method = "HEAD";
     req.url = url;
+    req.set_header("Host", host_.c_str());
 
     std::auto_ptr<Response> res(new Response);
 
@@ -927,6 +1225,7 @@ inline Response* Client::post(
     Request req;
     req.method = "POST";
     req.url = url;
+    req.set_header("Host", host_.c_str());
     req.set_header("Content-Type", content_type);
     req.body = body;
 
@@ -941,6 +1240,7 @@ inline Response* Client::post(
     Request req;
     req.method = "POST";
     req.url = url;
+    req.set_header("Host", host_.c_str());
     req.set_header("Content-Type", content_type);
     const char* body_ptr = reinterpret_cast<const char*>(body);
     req.body.assign(body_ptr, body_ptr + body_size);
@@ -176,13 +176,24 @@ public:
 
   void omitEndingLineFeed();
 
+  /** \brief Serializes root into sout without materializing the document.
+   *
+   * The output is handed to sout in pieces of about flushSize bytes, so the
+   * writer itself never buffers more than that (plus the largest single
+   * string or number).
+   */
+  void write(const Value& root, JSONCPP_OSTREAM& sout, size_t flushSize = 4096);
+
 public: // overridden from Writer
   JSONCPP_STRING write(const Value& root) JSONCPP_OVERRIDE;
 
 private:
   void writeValue(const Value& value);
+  void flushIfFull();
 
   JSONCPP_STRING document_;
+  JSONCPP_OSTREAM* sout_;
+  size_t flushSize_;
   bool yamlCompatibilityEnabled_;
   bool dropNullPlaceholders_;
   bool omitEndingLineFeed_;
@@ -341,6 +352,8 @@ JSONCPP_STRING JSON_API valueToString(LargestUInt value);
 JSONCPP_STRING JSON_API valueToString(double value);
 JSONCPP_STRING JSON_API valueToString(bool value);
 JSONCPP_STRING JSON_API valueToQuotedString(const char* value);
+/// \brief Quotes value, which may contain embedded zeros.
+JSONCPP_STRING JSON_API valueToQuotedString(const char* value, unsigned length);
 
 /// \brief Output using the StyledStreamWriter.
 /// \see Json::operator>>()
@@ -0,0 +1,655 @@
+// Copyright 2007-2011 Baptiste Lepilleur and The JsonCpp Authors
+// Distributed under MIT license, or public domain if desired and
+// recognized in your jurisdiction.
+// See file LICENSE for detail or copy at http://jsoncpp.sourceforge.net/LICENSE
+
+#if !defined(JSON_IS_AMALGAMATION)
+#include <json/reader.h>
+#include <json/value.h>
+#endif // if !defined(JSON_IS_AMALGAMATION)
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_FAST_READER_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// AVX2 kernels are compiled with a function level target attribute, so the
+// library itself still runs on any SSE2 capable CPU.
+#if defined(JSON_FAST_READER_SSE2) && defined(__GNUC__) &&                     \
+    (defined(__x86_64__) || defined(__i386__)) &&                              \
+    (defined(__clang__) || __GNUC__ >= 5)
+#define JSON_FAST_READER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__) && _MSC_VER < 1900
+#define snprintf _snprintf
+#endif
+
+// Same nesting limit as the classic Reader (see JSONCPP_DEPRECATED_STACK_LIMIT).
+#if !defined(JSONCPP_FAST_READER_STACK_LIMIT)
+#define JSONCPP_FAST_READER_STACK_LIMIT 1000
+#endif
+
+namespace Json {
+
+namespace {
+
+// ////////////////////////////////////////////////////////////////////
+// Character scanning kernels
+// ////////////////////////////////////////////////////////////////////
+
+typedef const char* (*ScanFunction)(const char* current, const char* end);
+
+inline bool isWhitespace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/// Characters that terminate the plain run of a string: the closing quote,
+/// an escape, or an (illegal) unescaped control character.
+inline bool isStringSpecial(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+const char* skipWhitespaceScalar(const char* current, const char* end) {
+  while (current != end && isWhitespace(*current))
+    ++current;
+  return current;
+}
+
+const char* findStringSpecialScalar(const char* current, const char* end) {
+  while (current != end && !isStringSpecial(*current))
+    ++current;
+  return current;
+}
+
+#if defined(JSON_FAST_READER_SSE2)
+inline unsigned int countTrailingZeros(unsigned int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned int>(index);
+#else
+  return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+
+const char* skipWhitespaceSse2(const char* current, const char* end) {
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i carriageReturn = _mm_set1_epi8('\r');
+  const __m128i tab = _mm_set1_epi8('\t');
+  while (end - current >= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+    const __m128i whitespace =
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space),
+                                  _mm_cmpeq_epi8(chunk, newline)),
+                     _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn),
+                                  _mm_cmpeq_epi8(chunk, tab)));
+    const unsigned int mask =
+        ~static_cast<unsigned int>(_mm_movemask_epi8(whitespace)) & 0xFFFFu;
+    if (mask != 0)
+      return current + countTrailingZeros(mask);
+    current += 16;
+  }
+  return skipWhitespaceScalar(current, end);
+}
+
+const char* findStringSpecialSse2(const char* current, const char* end) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i lastControl = _mm_set1_epi8(0x1F);
+  while (end - current >= 16) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+    // max_epu8(c, 0x1F) == 0x1F  <=>  c <= 0x1F (unsigned)
+    const __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmpeq_epi8(_mm_max_epu8(chunk, lastControl), lastControl));
+    const unsigned int mask =
+        static_cast<unsigned int>(_mm_movemask_epi8(special));
+    if (mask != 0)
+      return current + countTrailingZeros(mask);
+    current += 16;
+  }
+  return findStringSpecialScalar(current, end);
+}
+#endif // if defined(JSON_FAST_READER_SSE2)
+
+#if defined(JSON_FAST_READER_AVX2)
+__attribute__((target("avx2"))) const char*
+skipWhitespaceAvx2(const char* current, const char* end) {
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i newline = _mm256_set1_epi8('\n');
+  const __m256i carriageReturn = _mm256_set1_epi8('\r');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  while (end - current >= 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current));
+    const __m256i whitespace =
+        _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space),
+                                        _mm256_cmpeq_epi8(chunk, newline)),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, carriageReturn),
+                                        _mm256_cmpeq_epi8(chunk, tab)));
+    const unsigned int mask =
+        ~static_cast<unsigned int>(_mm256_movemask_epi8(whitespace));
+    if (mask != 0)
+      return current + countTrailingZeros(mask);
+    current += 32;
+  }
+  return skipWhitespaceSse2(current, end);
+}
+
+__attribute__((target("avx2"))) const char*
+findStringSpecialAvx2(const char* current, const char* end) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i lastControl = _mm256_set1_epi8(0x1F);
+  while (end - current >= 32) {
+    const __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(current));
+    const __m256i special = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                        _mm256_cmpeq_epi8(chunk, backslash)),
+        _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, lastControl), lastControl));
+    const unsigned int mask =
+        static_cast<unsigned int>(_mm256_movemask_epi8(special));
+    if (mask != 0)
+      return current + countTrailingZeros(mask);
+    current += 32;
+  }
+  return findStringSpecialSse2(current, end);
+}
+#endif // if defined(JSON_FAST_READER_AVX2)
+
+/// The widest kernels supported by the executing CPU, chosen once.
+struct ScanKernels {
+  ScanFunction skipWhitespace;
+  ScanFunction findStringSpecial;
+
+  ScanKernels() {
+#if defined(JSON_FAST_READER_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      skipWhitespace = &skipWhitespaceAvx2;
+      findStringSpecial = &findStringSpecialAvx2;
+      return;
+    }
+#endif
+#if defined(JSON_FAST_READER_SSE2)
+    skipWhitespace = &skipWhitespaceSse2;
+    findStringSpecial = &findStringSpecialSse2;
+#else
+    skipWhitespace = &skipWhitespaceScalar;
+    findStringSpecial = &findStringSpecialScalar;
+#endif
+  }
+};
+
+const ScanKernels& scanKernels() {
+  static const ScanKernels kernels;
+  return kernels;
+}
+
+/// Compact RPC payloads rarely contain more than a single blank between
+/// tokens, so only runs of whitespace are handed to the vector kernel.
+inline const char*
+skipWhitespace(const ScanKernels& kernels, const char* current, const char* end) {
+  if (current == end || !isWhitespace(*current))
+    return current;
+  ++current;
+  if (current == end || !isWhitespace(*current))
+    return current;
+  return kernels.skipWhitespace(current, end);
+}
+
+// ////////////////////////////////////////////////////////////////////
+// Number decoding helpers
+// ////////////////////////////////////////////////////////////////////
+
+/// Powers of ten which are exactly representable as double.
+const double exactPowersOfTen[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                   1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                   1e18, 1e19, 1e20, 1e21, 1e22};
+
+const Value::LargestUInt maxExactMantissa = Value::LargestUInt(1) << 53;
+
+/// Same conversion as Reader::decodeDouble(), used whenever the exact fast
+/// path does not apply. strtod() rounds correctly as well, but honours the C
+/// locale, so it is only used while that matches the stream's "C" locale.
+bool decodeDoubleSlow(const char* begin, const char* end, double& value) {
+  char buffer[64];
+  const size_t length = static_cast<size_t>(end - begin);
+  const struct lconv* locale = std::localeconv();
+  if (length < sizeof(buffer) && locale && locale->decimal_point &&
+      locale->decimal_point[0] == '.' && locale->decimal_point[1] == '\0') {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    value = std::strtod(buffer, 0);
+    // like std::num_get, reject overflow but accept underflow
+    return value != HUGE_VAL && value != -HUGE_VAL;
+  }
+  JSONCPP_STRING string(begin, end);
+  JSONCPP_ISTRINGSTREAM is(string);
+  return static_cast<bool>(is >> value);
+}
+
+void appendUTF8(JSONCPP_STRING& decoded, unsigned int cp) {
+  if (cp <= 0x7f) {
+    decoded += static_cast<char>(cp);
+  } else if (cp <= 0x7FF) {
+    decoded += static_cast<char>(0xC0 | (0x1f & (cp >> 6)));
+    decoded += static_cast<char>(0x80 | (0x3f & cp));
+  } else if (cp <= 0xFFFF) {
+    decoded += static_cast<char>(0xE0 | (0xf & (cp >> 12)));
+    decoded += static_cast<char>(0x80 | (0x3f & (cp >> 6)));
+    decoded += static_cast<char>(0x80 | (0x3f & cp));
+  } else {
+    decoded += static_cast<char>(0xF0 | (0x7 & (cp >> 18)));
+    decoded += static_cast<char>(0x80 | (0x3f & (cp >> 12)));
+    decoded += static_cast<char>(0x80 | (0x3f & (cp >> 6)));
+    decoded += static_cast<char>(0x80 | (0x3f & cp));
+  }
+}
+
+bool decodeHexQuad(const char* current, unsigned int& unicode) {
+  unicode = 0;
+  for (int index = 0; index < 4; ++index) {
+    const char c = current[index];
+    unicode <<= 4;
+    if (c >= '0' && c <= '9')
+      unicode += static_cast<unsigned int>(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      unicode += static_cast<unsigned int>(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      unicode += static_cast<unsigned int>(c - 'A' + 10);
+    else
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+// Implementation of class FastReader
+// ////////////////////////////////////////////////////////////////////
+
+FastReader::FastReader()
+    : begin_(), end_(), current_(), errorLocation_(), errorMessage_(), key_(),
+      buffer_() {}
+
+bool FastReader::parse(const JSONCPP_STRING& document, Value& root) {
+  const char* begin = document.data();
+  return parse(begin, begin + document.size(), root);
+}
+
+bool FastReader::parse(const char* beginDoc, const char* endDoc, Value& root) {
+  begin_ = beginDoc;
+  end_ = endDoc;
+  current_ = begin_;
+  errorLocation_ = 0;
+  errorMessage_.clear();
+
+  const ScanKernels& kernels = scanKernels();
+  current_ = skipWhitespace(kernels, current_, end_);
+  if (!readValue(root, 0))
+    return false;
+  current_ = skipWhitespace(kernels, current_, end_);
+  if (current_ != end_)
+    return addError("Extra non-whitespace after JSON value.", current_);
+  return true;
+}
+
+JSONCPP_STRING FastReader::getFormattedErrorMessages() const {
+  if (errorMessage_.empty())
+    return JSONCPP_STRING();
+  int line = 1;
+  Location lastLineStart = begin_;
+  for (Location current = begin_; current < errorLocation_ && current != end_;
+       ++current) {
+    if (*current == '\r' && current + 1 != end_ && current[1] == '\n')
+      ++current;
+    if (*current == '\r' || *current == '\n') {
+      lastLineStart = current + 1;
+      ++line;
+    }
+  }
+  char location[18 + 16 + 16 + 1];
+  snprintf(location, sizeof(location), "Line %d, Column %d", line,
+           int(errorLocation_ - lastLineStart) + 1);
+  return "* " + JSONCPP_STRING(location) + "\n  " + errorMessage_ + "\n";
+}
+
+bool FastReader::readValue(Value& value, unsigned int depth) {
+  if (current_ == end_)
+    return addError("Syntax error: value, object or array expected.",
+                    current_);
+  switch (*current_) {
+  case '{':
+    if (depth >= JSONCPP_FAST_READER_STACK_LIMIT)
+      return addError("Exceeded stack limit.", current_);
+    return readObject(value, depth + 1);
+  case '[':
+    if (depth >= JSONCPP_FAST_READER_STACK_LIMIT)
+      return addError("Exceeded stack limit.", current_);
+    return readArray(value, depth + 1);
+  case '"': {
+    Location begin;
+    Location end;
+    if (!readString(begin, end))
+      return false;
+    Value decoded(begin, end);
+    value.swapPayload(decoded);
+    return true;
+  }
+  case 't':
+    if (!readLiteral("true", 4))
+      return false;
+    value = true;
+    return true;
+  case 'f':
+    if (!readLiteral("false", 5))
+      return false;
+    value = false;
+    return true;
+  case 'n':
+    if (!readLiteral("null", 4))
+      return false;
+    value = Value();
+    return true;
+  default:
+    return readNumber(value);
+  }
+}
+
+bool FastReader::readObject(Value& value, unsigned int depth) {
+  const ScanKernels& kernels = scanKernels();
+  Value init(objectValue);
+  value.swapPayload(init);
+  current_ = skipWhitespace(kernels, current_ + 1, end_);
+  if (current_ != end_ && *current_ == '}') {
+    ++current_;
+    return true;
+  }
+  for (;;) {
+    if (current_ == end_ || *current_ != '"')
+      return addError("Missing '}' or object member name", current_);
+    Location begin;
+    Location end;
+    if (!readString(begin, end))
+      return false;
+    key_.assign(begin, end);
+    current_ = skipWhitespace(kernels, current_, end_);
+    if (current_ == end_ || *current_ != ':')
+      return addError("Missing ':' after object member name", current_);
+    current_ = skipWhitespace(kernels, current_ + 1, end_);
+    if (!readValue(value[key_], depth))
+      return false;
+    current_ = skipWhitespace(kernels, current_, end_);
+    if (current_ == end_)
+      return addError("Missing ',' or '}' in object declaration", current_);
+    if (*current_ == '}') {
+      ++current_;
+      return true;
+    }
+    if (*current_ != ',')
+      return addError("Missing ',' or '}' in object declaration", current_);
+    current_ = skipWhitespace(kernels, current_ + 1, end_);
+  }
+}
+
+bool FastReader::readArray(Value& value, unsigned int depth) {
+  const ScanKernels& kernels = scanKernels();
+  Value init(arrayValue);
+  value.swapPayload(init);
+  current_ = skipWhitespace(kernels, current_ + 1, end_);
+  if (current_ != end_ && *current_ == ']') {
+    ++current_;
+    return true;
+  }
+  for (ArrayIndex index = 0;; ++index) {
+    if (!readValue(value[index], depth))
+      return false;
+    current_ = skipWhitespace(kernels, current_, end_);
+    if (current_ == end_)
+      return addError("Missing ',' or ']' in array declaration", current_);
+    if (*current_ == ']') {
+      ++current_;
+      return true;
+    }
+    if (*current_ != ',')
+      return addError("Missing ',' or ']' in array declaration", current_);
+    current_ = skipWhitespace(kernels, current_ + 1, end_);
+  }
+}
+
+bool FastReader::readString(Location& begin, Location& end) {
+  const ScanKernels& kernels = scanKernels();
+  const Location start = current_;
+  Location current = kernels.findStringSpecial(start + 1, end_);
+  if (current != end_ && *current == '"') {
+    // Fast path: no escapes, the value is a slice of the document.
+    begin = start + 1;
+    end = current;
+    current_ = current + 1;
+    return true;
+  }
+
+  buffer_.assign(start + 1, current);
+  for (;;) {
+    if (current == end_)
+      return addError("Missing '\"' at end of string", start);
+    if (*current == '"')
+      break;
+    if (*current != '\\')
+      return addError("Unescaped control character in string", current);
+    if (!decodeEscape(current))
+      return false;
+    const Location plain = current;
+    current = kernels.findStringSpecial(plain, end_);
+    buffer_.append(plain, current);
+  }
+  begin = buffer_.data();
+  end = begin + buffer_.size();
+  current_ = current + 1;
+  return true;
+}
+
+bool FastReader::decodeEscape(Location& current) {
+  const Location escape = current;
+  if (end_ - current < 2)
+    return addError("Empty escape sequence in string", escape);
+  current += 2;
+  switch (escape[1]) {
+  case '"':
+    buffer_ += '"';
+    return true;
+  case '/':
+    buffer_ += '/';
+    return true;
+  case '\\':
+    buffer_ += '\\';
+    return true;
+  case 'b':
+    buffer_ += '\b';
+    return true;
+  case 'f':
+    buffer_ += '\f';
+    return true;
+  case 'n':
+    buffer_ += '\n';
+    return true;
+  case 'r':
+    buffer_ += '\r';
+    return true;
+  case 't':
+    buffer_ += '\t';
+    return true;
+  case 'u':
+    break;
+  default:
+    return addError("Bad escape sequence in string", escape);
+  }
+
+  unsigned int unicode;
+  if (end_ - current < 4 || !decodeHexQuad(current, unicode))
+    return addError("Bad unicode escape sequence in string: four digits "
+                    "expected.",
+                    escape);
+  current += 4;
+  if (unicode >= 0xD800 && unicode <= 0xDBFF) {
+    // surrogate pairs
+    unsigned int surrogatePair;
+    if (end_ - current < 6 || current[0] != '\\' || current[1] != 'u' ||
+        !decodeHexQuad(current + 2, surrogatePair))
+      return addError("additional six characters expected to parse unicode "
+                      "surrogate pair.",
+                      escape);
+    unicode = 0x10000 + ((unicode & 0x3FF) << 10) + (surrogatePair & 0x3FF);
+    current += 6;
+  }
+  appendUTF8(buffer_, unicode);
+  return true;
+}
+
+bool FastReader::readLiteral(const char* literal, size_t length) {
+  if (static_cast<size_t>(end_ - current_) < length ||
+      std::memcmp(current_, literal, length) != 0)
+    return addError("Syntax error: value, object or array expected.",
+                    current_);
+  current_ += length;
+  return true;
+}
+
+bool FastReader::readNumber(Value& value) {
+  const Location start = current_;
+  Location current = current_;
+  const bool isNegative = current != end_ && *current == '-';
+  if (isNegative)
+    ++current;
+  if (current == end_ || !isDigit(*current))
+    return addError("Syntax error: value, object or array expected.", start);
+
+  // Up to 19 decimal digits always fit the 64 bit mantissa, a 20th integer
+  // digit only if it does not overflow. Further digits are only counted, such
+  // numbers are left to the slow path.
+  Value::LargestUInt mantissa = 0;
+  int digits = 0;
+  int droppedDigits = 0;
+  if (*current == '0') {
+    ++current;
+    if (current != end_ && isDigit(*current))
+      return addError("Leading zeros are not allowed in numbers", start);
+  } else {
+    for (; current != end_ && isDigit(*current); ++current) {
+      const unsigned int digit = static_cast<unsigned int>(*current - '0');
+      if (digits < 19 ||
+          (digits == 19 && droppedDigits == 0 &&
+           mantissa <= (Value::maxLargestUInt - digit) / 10)) {
+        mantissa = mantissa * 10 + digit;
+        ++digits;
+      } else {
+        ++droppedDigits;
+      }
+    }
+  }
+
+  bool isInteger = true;
+  int exponent = droppedDigits;
+  if (current != end_ && *current == '.') {
+    isInteger = false;
+    ++current;
+    if (current == end_ || !isDigit(*current))
+      return addError("'" + JSONCPP_STRING(start, current) +
+                          "' is not a number.",
+                      start);
+    for (; current != end_ && isDigit(*current); ++current) {
+      if (digits < 19) {
+        mantissa = mantissa * 10 + static_cast<unsigned int>(*current - '0');
+        if (mantissa != 0)
+          ++digits;
+        --exponent;
+      } else {
+        ++droppedDigits;
+      }
+    }
+  }
+  if (current != end_ && (*current == 'e' || *current == 'E')) {
+    isInteger = false;
+    ++current;
+    bool isNegativeExponent = false;
+    if (current != end_ && (*current == '+' || *current == '-'))
+      isNegativeExponent = *current++ == '-';
+    if (current == end_ || !isDigit(*current))
+      return addError("'" + JSONCPP_STRING(start, current) +
+                          "' is not a number.",
+                      start);
+    int explicitExponent = 0;
+    for (; current != end_ && isDigit(*current); ++current) {
+      if (explicitExponent < 100000)
+        explicitExponent = explicitExponent * 10 + (*current - '0');
+    }
+    exponent += isNegativeExponent ? -explicitExponent : explicitExponent;
+  }
+  current_ = current;
+
+  if (isInteger && droppedDigits == 0) {
+    // Same value types as Reader::decodeNumber().
+    if (isNegative) {
+      if (mantissa <= Value::LargestUInt(Value::maxLargestInt)) {
+        value = -Value::LargestInt(mantissa);
+        return true;
+      }
+      if (mantissa == Value::LargestUInt(Value::maxLargestInt) + 1) {
+        value = Value::minLargestInt;
+        return true;
+      }
+    } else {
+      if (mantissa <= Value::LargestUInt(Value::maxInt))
+        value = Value::LargestInt(mantissa);
+      else
+        value = mantissa;
+      return true;
+    }
+  } else if (droppedDigits == 0 && mantissa <= maxExactMantissa &&
+             exponent >= -22 && exponent <= 22) {
+    // Both operands are exact, so a single IEEE operation rounds correctly.
+    double decoded = static_cast<double>(mantissa);
+    if (exponent < 0)
+      decoded /= exactPowersOfTen[-exponent];
+    else
+      decoded *= exactPowersOfTen[exponent];
+    value = isNegative ? -decoded : decoded;
+    return true;
+  }
+
+  double decoded = 0;
+  if (!decodeDoubleSlow(start, current, decoded))
+    return addError("'" + JSONCPP_STRING(start, current) + "' is not a number.",
+                    start);
+  value = decoded;
+  return true;
+}
+
+bool FastReader::addError(const JSONCPP_STRING& message, Location location) {
+  errorMessage_ = message;
+  errorLocation_ = location;
+  return false;
+}
+
+} // namespace Json
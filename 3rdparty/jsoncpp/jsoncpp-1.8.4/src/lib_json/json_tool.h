@@ -70,6 +70,18 @@ enum {
 // Defines a char buffer for use with uintToString().
 typedef char UIntToStringBuffer[uintToStringBufferSize];
 
+/// "00" to "99", used to emit two digits per division.
+static const char digitPairs[] = "00010203040506070809"
+                                 "10111213141516171819"
+                                 "20212223242526272829"
+                                 "30313233343536373839"
+                                 "40414243444546474849"
+                                 "50515253545556575859"
+                                 "60616263646566676869"
+                                 "70717273747576777879"
+                                 "80818283848586878889"
+                                 "90919293949596979899";
+
 /** Converts an unsigned integer to string.
  * @param value Unsigned integer to convert to string
  * @param current Input/Output string buffer.
@@ -77,10 +89,21 @@ typedef char UIntToStringBuffer[uintToStringBufferSize];
  */
 static inline void uintToString(LargestUInt value, char*& current) {
   *--current = 0;
-  do {
-    *--current = static_cast<char>(value % 10U + static_cast<unsigned>('0'));
-    value /= 10;
-  } while (value != 0);
+  while (value >= 100) {
+    const unsigned int pair = static_cast<unsigned int>(value % 100U) * 2U;
+    value /= 100U;
+    current -= 2;
+    current[0] = digitPairs[pair];
+    current[1] = digitPairs[pair + 1];
+  }
+  if (value >= 10) {
+    const unsigned int pair = static_cast<unsigned int>(value) * 2U;
+    current -= 2;
+    current[0] = digitPairs[pair];
+    current[1] = digitPairs[pair + 1];
+  } else {
+    *--current = static_cast<char>(value + static_cast<unsigned>('0'));
+  }
 }
 
 /** Change ',' to '.' everywhere in buffer.
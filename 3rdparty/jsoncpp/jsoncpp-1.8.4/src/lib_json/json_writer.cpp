@@ -5,6 +5,7 @@
 
 #if !defined(JSON_IS_AMALGAMATION)
 #include <json/writer.h>
+#include "json_ryu_tables.h"
 #include "json_tool.h"
 #endif // if !defined(JSON_IS_AMALGAMATION)
 #include <iomanip>
@@ -118,43 +119,346 @@ JSONCPP_STRING valueToString(UInt value) {
 #endif // # if defined(JSON_HAS_INT64)
 
 namespace {
-JSONCPP_STRING valueToString(double value, bool useSpecialFloats, unsigned int precision) {
-  // Allocate a buffer that is more than large enough to store the 16 digits of
-  // precision requested below.
-  char buffer[36];
-  int len = -1;
 
-  char formatString[15];
-  snprintf(formatString, sizeof(formatString), "%%.%ug", precision);
+// ////////////////////////////////////////////////////////////////////
+// Shortest round-trip double formatting (Ryu)
+// ////////////////////////////////////////////////////////////////////
+
+/// Precision at which doubles round-trip and the shortest representation is
+/// used instead of snprintf().
+const unsigned int roundTripPrecision = 17;
+
+inline UInt64 multiplyHigh(UInt64 a, UInt64 b, UInt64& low) {
+#if defined(__SIZEOF_INT128__)
+  const unsigned __int128 product =
+      static_cast<unsigned __int128>(a) * static_cast<unsigned __int128>(b);
+  low = static_cast<UInt64>(product);
+  return static_cast<UInt64>(product >> 64);
+#else
+  const UInt64 aLow = a & 0xFFFFFFFFu;
+  const UInt64 aHigh = a >> 32;
+  const UInt64 bLow = b & 0xFFFFFFFFu;
+  const UInt64 bHigh = b >> 32;
+  const UInt64 lowLow = aLow * bLow;
+  const UInt64 lowHigh = aLow * bHigh;
+  const UInt64 highLow = aHigh * bLow;
+  const UInt64 highHigh = aHigh * bHigh;
+  const UInt64 middle = (lowLow >> 32) + (highLow & 0xFFFFFFFFu) + lowHigh;
+  low = (middle << 32) | (lowLow & 0xFFFFFFFFu);
+  return highHigh + (highLow >> 32) + (middle >> 32);
+#endif
+}
+
+/// (m * mul) >> shift for a 125 bit multiplier and 64 <= shift < 128.
+inline UInt64 mulShift(UInt64 m, const unsigned long long* mul, int shift) {
+  UInt64 low0;
+  const UInt64 high0 = multiplyHigh(m, mul[0], low0);
+  UInt64 low1;
+  const UInt64 high1 = multiplyHigh(m, mul[1], low1);
+  const UInt64 sumLow = high0 + low1;
+  const UInt64 sumHigh = high1 + (sumLow < high0 ? 1 : 0);
+  const int bits = shift - 64;
+  return bits == 0 ? sumLow : (sumHigh << (64 - bits)) | (sumLow >> bits);
+}
+
+/// floor(log10(2^e)) for 0 <= e <= 1650
+inline int log10Pow2(int e) {
+  return static_cast<int>((static_cast<unsigned int>(e) * 78913U) >> 18);
+}
+
+/// floor(log10(5^e)) for 0 <= e <= 2620
+inline int log10Pow5(int e) {
+  return static_cast<int>((static_cast<unsigned int>(e) * 732923U) >> 20);
+}
+
+/// ceil(log2(5^e)), 1 for e == 0
+inline int pow5Bits(int e) {
+  return static_cast<int>(((static_cast<unsigned int>(e) * 1217359U) >> 19) +
+                          1);
+}
+
+inline bool multipleOfPowerOf5(UInt64 value, int p) {
+  int count = 0;
+  while (value % 5 == 0) {
+    value /= 5;
+    ++count;
+  }
+  return count >= p;
+}
+
+inline bool multipleOfPowerOf2(UInt64 value, int p) {
+  return (value & ((UInt64(1) << p) - 1)) == 0;
+}
+
+/** Computes the shortest decimal digits that round-trip to a finite, non-zero
+ * double: value = digits * 10^exponent. Ties between equally short
+ * candidates resolve to the one closest to the exact binary value.
+ */
+void shortestDecimal(UInt64 ieeeMantissa, unsigned int ieeeExponent,
+                     UInt64& digits, int& exponent) {
+  const int mantissaBits = 52;
+  const int exponentBias = 1023;
+  int e2;
+  UInt64 m2;
+  if (ieeeExponent == 0) {
+    e2 = 1 - exponentBias - mantissaBits - 2;
+    m2 = ieeeMantissa;
+  } else {
+    e2 = static_cast<int>(ieeeExponent) - exponentBias - mantissaBits - 2;
+    m2 = (UInt64(1) << mantissaBits) | ieeeMantissa;
+  }
+  const bool acceptBounds = (m2 & 1) == 0;
+
+  // Interval of decimal values that round to the input: [mm, mp] around mv.
+  const UInt64 mv = 4 * m2;
+  const unsigned int mmShift = (ieeeMantissa != 0 || ieeeExponent <= 1) ? 1 : 0;
+
+  UInt64 vr, vp, vm;
+  int e10;
+  bool vmIsTrailingZeros = false;
+  bool vrIsTrailingZeros = false;
+  if (e2 >= 0) {
+    const int q = log10Pow2(e2) - (e2 > 3 ? 1 : 0);
+    e10 = q;
+    const int k = ryuPow5InvBitCount + pow5Bits(q) - 1;
+    const int i = -e2 + q + k;
+    vr = mulShift(4 * m2, ryuPow5InvSplit[q], i);
+    vp = mulShift(4 * m2 + 2, ryuPow5InvSplit[q], i);
+    vm = mulShift(4 * m2 - 1 - mmShift, ryuPow5InvSplit[q], i);
+    if (q <= 21) {
+      // Only one of mp, mv and mm can be a multiple of 5, if any.
+      if (mv % 5 == 0)
+        vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+      else if (acceptBounds)
+        vmIsTrailingZeros = multipleOfPowerOf5(mv - 1 - mmShift, q);
+      else
+        vp -= multipleOfPowerOf5(mv + 2, q) ? 1 : 0;
+    }
+  } else {
+    const int q = log10Pow5(-e2) - (-e2 > 1 ? 1 : 0);
+    e10 = q + e2;
+    const int i = -e2 - q;
+    const int k = pow5Bits(i) - ryuPow5BitCount;
+    const int j = q - k;
+    vr = mulShift(4 * m2, ryuPow5Split[i], j);
+    vp = mulShift(4 * m2 + 2, ryuPow5Split[i], j);
+    vm = mulShift(4 * m2 - 1 - mmShift, ryuPow5Split[i], j);
+    if (q <= 1) {
+      // mv = 4 * m2 always has at least two trailing zero bits.
+      vrIsTrailingZeros = true;
+      if (acceptBounds)
+        vmIsTrailingZeros = mmShift == 1;
+      else
+        --vp;
+    } else if (q < 63) {
+      vrIsTrailingZeros = multipleOfPowerOf2(mv, q);
+    }
+  }
+
+  // Remove digits as long as the interval still contains a shorter number.
+  int removed = 0;
+  unsigned int lastRemovedDigit = 0;
+  UInt64 output;
+  if (vmIsTrailingZeros || vrIsTrailingZeros) {
+    while (vp / 10 > vm / 10) {
+      vmIsTrailingZeros &= vm % 10 == 0;
+      vrIsTrailingZeros &= lastRemovedDigit == 0;
+      lastRemovedDigit = static_cast<unsigned int>(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if (vmIsTrailingZeros) {
+      while (vm % 10 == 0) {
+        vrIsTrailingZeros &= lastRemovedDigit == 0;
+        lastRemovedDigit = static_cast<unsigned int>(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr % 2 == 0) {
+      // Round even if the exact number is .....50..0.
+      lastRemovedDigit = 4;
+    }
+    output = vr + (((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) ||
+                    lastRemovedDigit >= 5)
+                       ? 1
+                       : 0);
+  } else {
+    // Common case: no trailing zero bookkeeping needed.
+    bool roundUp = false;
+    while (vp / 10 > vm / 10) {
+      roundUp = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    output = vr + ((vr == vm || roundUp) ? 1 : 0);
+  }
+  digits = output;
+  exponent = e10 + removed;
+}
+
+/** Writes a finite double the way snprintf("%.17g") plus the ".0" suffix of
+ * valueToString() does, but with the shortest round-tripping digits.
+ * \return number of chars written to buffer (at most 25, not terminated)
+ */
+unsigned int writeShortestDouble(double value, char* buffer) {
+  UInt64 bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const bool sign = (bits >> 63) != 0;
+  const UInt64 ieeeMantissa = bits & ((UInt64(1) << 52) - 1);
+  const unsigned int ieeeExponent =
+      static_cast<unsigned int>((bits >> 52) & 0x7FFu);
+
+  char* current = buffer;
+  if (sign)
+    *current++ = '-';
+  if (ieeeExponent == 0 && ieeeMantissa == 0) {
+    std::memcpy(current, "0.0", 3);
+    return static_cast<unsigned int>(current + 3 - buffer);
+  }
+
+  UInt64 digits;
+  int exponent;
+  shortestDecimal(ieeeMantissa, ieeeExponent, digits, exponent);
+  while (digits % 10 == 0) {
+    digits /= 10;
+    ++exponent;
+  }
+
+  UIntToStringBuffer digitBuffer;
+  char* digitsEnd = digitBuffer + sizeof(digitBuffer);
+  char* digitsBegin = digitsEnd;
+  uintToString(digits, digitsBegin);
+  --digitsEnd; // terminating zero
+  const int length = static_cast<int>(digitsEnd - digitsBegin);
+  // decimal exponent of the leading digit, as %g uses it
+  const int scientificExponent = exponent + length - 1;
+
+  if (scientificExponent < -4 ||
+      scientificExponent >= static_cast<int>(roundTripPrecision)) {
+    *current++ = *digitsBegin;
+    if (length > 1) {
+      *current++ = '.';
+      std::memcpy(current, digitsBegin + 1, static_cast<size_t>(length - 1));
+      current += length - 1;
+    }
+    *current++ = 'e';
+    int absExponent = scientificExponent;
+    if (absExponent < 0) {
+      *current++ = '-';
+      absExponent = -absExponent;
+    } else {
+      *current++ = '+';
+    }
+    if (absExponent >= 100) {
+      *current++ = static_cast<char>('0' + absExponent / 100);
+      absExponent %= 100;
+    }
+    *current++ = digitPairs[absExponent * 2];
+    *current++ = digitPairs[absExponent * 2 + 1];
+  } else if (scientificExponent < 0) {
+    *current++ = '0';
+    *current++ = '.';
+    for (int zero = -1; zero > scientificExponent; --zero)
+      *current++ = '0';
+    std::memcpy(current, digitsBegin, static_cast<size_t>(length));
+    current += length;
+  } else if (scientificExponent >= length - 1) {
+    std::memcpy(current, digitsBegin, static_cast<size_t>(length));
+    current += length;
+    for (int zero = length - 1; zero < scientificExponent; ++zero)
+      *current++ = '0';
+    *current++ = '.';
+    *current++ = '0';
+  } else {
+    const int integerDigits = scientificExponent + 1;
+    std::memcpy(current, digitsBegin, static_cast<size_t>(integerDigits));
+    current += integerDigits;
+    *current++ = '.';
+    std::memcpy(current, digitsBegin + integerDigits,
+                static_cast<size_t>(length - integerDigits));
+    current += length - integerDigits;
+  }
+  return static_cast<unsigned int>(current - buffer);
+}
 
-  // Print into the buffer. We need not request the alternative representation
-  // that always has a decimal point because JSON doesn't distinguish the
-  // concepts of reals and integers.
+/** Formats a double into buffer (at least 36 chars), terminated.
+ * \return number of chars written, without the terminating zero
+ */
+unsigned int writeDouble(double value, bool useSpecialFloats,
+                         unsigned int precision, char* buffer) {
+  int len = -1;
   if (isfinite(value)) {
-    len = snprintf(buffer, sizeof(buffer), formatString, value);
+    if (precision == roundTripPrecision) {
+      len = static_cast<int>(writeShortestDouble(value, buffer));
+      buffer[len] = 0;
+      return static_cast<unsigned int>(len);
+    }
+
+    char formatString[15];
+    snprintf(formatString, sizeof(formatString), "%%.%ug", precision);
+
+    // Print into the buffer. We need not request the alternative representation
+    // that always has a decimal point because JSON doesn't distinguish the
+    // concepts of reals and integers.
+    len = snprintf(buffer, 36, formatString, value);
     fixNumericLocale(buffer, buffer + len);
 
     // try to ensure we preserve the fact that this was given to us as a double on input
     if (!strchr(buffer, '.') && !strchr(buffer, 'e')) {
       strcat(buffer, ".0");
+      len += 2;
     }
 
   } else {
     // IEEE standard states that NaN values will not compare to themselves
     if (value != value) {
-      len = snprintf(buffer, sizeof(buffer), useSpecialFloats ? "NaN" : "null");
+      len = snprintf(buffer, 36, useSpecialFloats ? "NaN" : "null");
     } else if (value < 0) {
-      len = snprintf(buffer, sizeof(buffer), useSpecialFloats ? "-Infinity" : "-1e+9999");
+      len = snprintf(buffer, 36, useSpecialFloats ? "-Infinity" : "-1e+9999");
     } else {
-      len = snprintf(buffer, sizeof(buffer), useSpecialFloats ? "Infinity" : "1e+9999");
+      len = snprintf(buffer, 36, useSpecialFloats ? "Infinity" : "1e+9999");
     }
   }
   assert(len >= 0);
-  return buffer;
+  return static_cast<unsigned int>(len);
+}
+
+void appendLargestUInt(JSONCPP_STRING& document, LargestUInt value) {
+  UIntToStringBuffer buffer;
+  char* const end = buffer + sizeof(buffer) - 1; // terminating zero
+  char* current = end + 1;
+  uintToString(value, current);
+  document.append(current, end);
+}
+
+void appendLargestInt(JSONCPP_STRING& document, LargestInt value) {
+  if (value < 0) {
+    document += '-';
+    appendLargestUInt(document, LargestUInt(0) - LargestUInt(value));
+  } else {
+    appendLargestUInt(document, LargestUInt(value));
+  }
+}
+
+JSONCPP_STRING valueToString(double value, bool useSpecialFloats, unsigned int precision) {
+  // Allocate a buffer that is more than large enough to store the 17 digits of
+  // precision plus sign, decimal point and exponent.
+  char buffer[36];
+  const unsigned int len = writeDouble(value, useSpecialFloats, precision, buffer);
+  return JSONCPP_STRING(buffer, len);
 }
 }
 
-JSONCPP_STRING valueToString(double value) { return valueToString(value, false, 17); }
+JSONCPP_STRING valueToString(double value) {
+  return valueToString(value, false, roundTripPrecision);
+}
 
 JSONCPP_STRING valueToString(bool value) { return value ? "true" : "false"; }
 
@@ -326,6 +630,10 @@ JSONCPP_STRING valueToQuotedString(const char* value) {
   return valueToQuotedStringN(value, static_cast<unsigned int>(strlen(value)));
 }
 
+JSONCPP_STRING valueToQuotedString(const char* value, unsigned length) {
+  return valueToQuotedStringN(value, length);
+}
+
 // Class Writer
 // //////////////////////////////////////////////////////////////////
 Writer::~Writer() {}
@@ -334,8 +642,8 @@ Writer::~Writer() {}
 // //////////////////////////////////////////////////////////////////
 
 FastWriter::FastWriter()
-    : yamlCompatibilityEnabled_(false), dropNullPlaceholders_(false),
-      omitEndingLineFeed_(false) {}
+    : sout_(0), flushSize_(0), yamlCompatibilityEnabled_(false),
+      dropNullPlaceholders_(false), omitEndingLineFeed_(false) {}
 
 void FastWriter::enableYAMLCompatibility() { yamlCompatibilityEnabled_ = true; }
 
@@ -351,6 +659,27 @@ JSONCPP_STRING FastWriter::write(const Value& root) {
   return document_;
 }
 
+void FastWriter::write(const Value& root, JSONCPP_OSTREAM& sout,
+                       size_t flushSize) {
+  document_.clear();
+  sout_ = &sout;
+  flushSize_ = flushSize;
+  writeValue(root);
+  if (!omitEndingLineFeed_)
+    document_ += "\n";
+  sout.write(document_.data(), static_cast<std::streamsize>(document_.size()));
+  document_.clear();
+  sout_ = 0;
+}
+
+void FastWriter::flushIfFull() {
+  if (sout_ && document_.size() >= flushSize_) {
+    sout_->write(document_.data(),
+                 static_cast<std::streamsize>(document_.size()));
+    document_.clear();
+  }
+}
+
 void FastWriter::writeValue(const Value& value) {
   switch (value.type()) {
   case nullValue:
@@ -358,14 +687,17 @@ void FastWriter::writeValue(const Value& value) {
       document_ += "null";
     break;
   case intValue:
-    document_ += valueToString(value.asLargestInt());
+    appendLargestInt(document_, value.asLargestInt());
     break;
   case uintValue:
-    document_ += valueToString(value.asLargestUInt());
+    appendLargestUInt(document_, value.asLargestUInt());
     break;
-  case realValue:
-    document_ += valueToString(value.asDouble());
+  case realValue: {
+    char buffer[36];
+    document_.append(buffer, writeDouble(value.asDouble(), false,
+                                         roundTripPrecision, buffer));
     break;
+  }
   case stringValue:
   {
     // Is NULL possible for value.string_? No.
@@ -385,6 +717,7 @@ void FastWriter::writeValue(const Value& value) {
       if (index > 0)
         document_ += ',';
       writeValue(value[index]);
+      flushIfFull();
     }
     document_ += ']';
   } break;
@@ -399,6 +732,7 @@ void FastWriter::writeValue(const Value& value) {
       document_ += valueToQuotedStringN(name.data(), static_cast<unsigned>(name.length()));
       document_ += yamlCompatibilityEnabled_ ? ": " : ":";
       writeValue(value[name]);
+      flushIfFull();
     }
     document_ += '}';
   } break;
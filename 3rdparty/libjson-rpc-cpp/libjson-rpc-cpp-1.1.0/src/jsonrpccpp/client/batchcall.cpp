@@ -31,6 +31,10 @@ int BatchCall::addCall(const string &methodname, const Json::Value &params,
   return call[RpcProtocolClient::KEY_ID].asInt();
 }
 
+void BatchCall::encode(encoding_t encoding, string &target) const {
+  EncodeValue(encoding, this->result, target);
+}
+
 string BatchCall::toString(bool fast) const {
   string result;
   if (fast) {
@@ -11,6 +11,7 @@
 #define JSONRPC_CPP_BATCHCALL_H
 
 #include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/binarycodec.h>
 
 namespace jsonrpc
 {
@@ -28,6 +29,10 @@ namespace jsonrpc
              */
             int         addCall     (const std::string &methodname, const Json::Value &params, bool isNotification = false);
             std::string toString    (bool fast = true) const;
+            /**
+             * @brief Serializes the batch in the given wire encoding.
+             */
+            void        encode      (encoding_t encoding, std::string& target) const;
 
         private:
             Json::Value result;
@@ -9,32 +9,111 @@
 
 #include "client.h"
 #include "rpcprotocolclient.h"
+#include "singleflight.h"
 
 using namespace jsonrpc;
 
 Client::Client(IClientConnector &connector, clientVersion_t version)
-    : connector(connector) {
+    : connector(connector), compactRequests(false), singleFlight(NULL) {
   this->protocol = new RpcProtocolClient(version);
 }
 
-Client::~Client() { delete this->protocol; }
+Client::~Client() {
+  delete this->protocol;
+  delete this->singleFlight;
+}
+
+void Client::SetJsonReader(jsonreader_t reader) {
+  this->protocol->SetJsonReader(reader);
+}
+
+void Client::SetEncoding(encoding_t encoding) {
+  this->protocol->SetEncoding(encoding);
+}
+
+void Client::SetCompactRequests(bool compact) {
+  this->compactRequests = compact;
+}
+
+bool Client::UsesCompactRequests() const { return this->compactRequests; }
+
+void Client::SetCoalescing(const std::string &name, bool coalesce) {
+  if (!coalesce) {
+    this->coalescedMethods.erase(name);
+    return;
+  }
+  this->coalescedMethods.insert(name);
+  if (this->singleFlight == NULL)
+    this->singleFlight = new SingleFlight();
+}
+
+bool Client::IsCoalescing(const std::string &name) const {
+  return this->coalescedMethods.find(name) != this->coalescedMethods.end();
+}
+
+void Client::Send(const std::string &name, const std::string &request,
+                  std::string &response) {
+  // requests always carry the id 1, so equal calls are equal bytes
+  if (!this->coalescedMethods.empty() && this->IsCoalescing(name))
+    this->singleFlight->Send(this->connector, request, response);
+  else
+    connector.SendRPCMessage(request, response);
+}
+
+Json::Value Client::EncodeBinary(const std::vector<uint8_t> &value) const {
+  if (this->protocol->GetEncoding() == ENCODING_JSON)
+    return EncodeBase64(value);
+  return value.empty()
+             ? std::string()
+             : std::string(reinterpret_cast<const char *>(&value[0]),
+                           value.size());
+}
+
+bool Client::DecodeBinary(const Json::Value &result,
+                          std::vector<uint8_t> &value) const {
+  if (!result.isString())
+    return false;
+  if (this->protocol->GetEncoding() == ENCODING_JSON)
+    return DecodeBase64(result.asString(), value);
+  std::string bytes = result.asString();
+  value.assign(bytes.begin(), bytes.end());
+  return true;
+}
+
+bool Client::IsDirectCallable() const {
+  return this->protocol->SupportsDirectCalls();
+}
+
+void Client::CallDirect(const std::string &request, std::string &response) {
+  connector.SendRPCMessage(request, response);
+}
+
+void Client::CallDirect(const std::string &name, const std::string &request,
+                        std::string &response) {
+  this->Send(name, request, response);
+}
+
+void Client::HandleDirectResponse(const std::string &response,
+                                  Json::Value &result) {
+  protocol->HandleResponse(response, result);
+}
 
 void Client::CallMethod(const std::string &name, const Json::Value &parameter,
                         Json::Value &result) {
   std::string request, response;
   protocol->BuildRequest(name, parameter, request, false);
-  connector.SendRPCMessage(request, response);
+  this->Send(name, request, response);
   protocol->HandleResponse(response, result);
 }
 
 void Client::CallProcedures(const BatchCall &calls, BatchResponse &result) {
   std::string request, response;
-  request = calls.toString();
+  calls.encode(this->protocol->GetEncoding(), request);
   connector.SendRPCMessage(request, response);
-  Json::Reader reader;
   Json::Value tmpresult;
 
-  if (!reader.parse(response, tmpresult) || !tmpresult.isArray()) {
+  if (!this->protocol->DecodeResponse(response, tmpresult) ||
+      !tmpresult.isArray()) {
     throw JsonRpcException(Errors::ERROR_CLIENT_INVALID_RESPONSE,
                            "Array expected.");
   }
@@ -77,3 +156,28 @@ void Client::CallNotification(const std::string &name,
   protocol->BuildRequest(name, parameter, request, true);
   connector.SendRPCMessage(request, response);
 }
+
+Json::Value Client::CallMethod(int methodId, const std::string &name,
+                               const Json::Value &parameter) {
+  if (!this->compactRequests)
+    return this->CallMethod(name, parameter);
+
+  std::string request, response;
+  Json::Value result;
+  protocol->BuildCompactRequest(methodId, name, parameter, request, false);
+  this->Send(name, request, response);
+  protocol->HandleResponse(response, result);
+  return result;
+}
+
+void Client::CallNotification(int methodId, const std::string &name,
+                              const Json::Value &parameter) {
+  if (!this->compactRequests) {
+    this->CallNotification(name, parameter);
+    return;
+  }
+
+  std::string request, response;
+  protocol->BuildCompactRequest(methodId, name, parameter, request, true);
+  connector.SendRPCMessage(request, response);
+}
@@ -14,13 +14,16 @@
 #include "batchcall.h"
 #include "batchresponse.h"
 #include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/binarycodec.h>
 
 #include <vector>
 #include <map>
+#include <set>
 
 namespace jsonrpc
 {
     class RpcProtocolClient;
+    class SingleFlight;
 
     typedef enum {JSONRPC_CLIENT_V1, JSONRPC_CLIENT_V2} clientVersion_t;
 
@@ -38,9 +41,81 @@ namespace jsonrpc
 
             void        CallNotification    (const std::string& name, const Json::Value& parameter) ;
 
+            /**
+             * @brief Calls a method by its id if compact requests are enabled, by its name otherwise.
+             * @param methodId - Procedure::GetMethodId() of name, generated stubs pass their method_ids.
+             */
+            Json::Value CallMethod          (int methodId, const std::string &name, const Json::Value &parameter) ;
+            void        CallNotification    (int methodId, const std::string& name, const Json::Value& parameter) ;
+
+            /**
+             * @brief Sends the numeric method id instead of the method name, off by default.
+             * Only JSON-RPC 2.0 servers of this library understand the compact form.
+             */
+            void        SetCompactRequests  (bool compact);
+            bool        UsesCompactRequests () const;
+
+            /**
+             * @brief Selects the reader used to parse responses, JSONREADER_CLASSIC by default.
+             */
+            void        SetJsonReader       (jsonreader_t reader);
+
+            /**
+             * @brief Selects the wire encoding, ENCODING_JSON by default. The connector has to
+             * announce the matching content type, batch calls included.
+             */
+            void        SetEncoding         (encoding_t encoding);
+
+            /**
+             * @brief true if stubs generated with --cpp-direct may use CallDirect.
+             */
+            bool        IsDirectCallable    () const;
+
+            /**
+             * @brief Sends a request written by jsonrpc::DirectRequest.
+             */
+            void        CallDirect          (const std::string& request, std::string& response);
+            /**
+             * @brief Sends a request of the method written by jsonrpc::DirectRequest, see SetCoalescing.
+             */
+            void        CallDirect          (const std::string& name, const std::string& request, std::string& response);
+
+            /**
+             * @brief Handles a response jsonrpc::DirectResponse could not read, i.e. errors.
+             */
+            void        HandleDirectResponse(const std::string& response, Json::Value& result);
+
+            /**
+             * @brief Converts a JSON_BINARY parameter for the selected encoding: a base64 string
+             * in JSON, the raw bytes in the binary encodings.
+             */
+            Json::Value EncodeBinary        (const std::vector<uint8_t>& value) const;
+
+            /**
+             * @brief Reads a JSON_BINARY result in the form EncodeBinary creates.
+             * @return false if result is no string or no valid base64.
+             */
+            bool        DecodeBinary        (const Json::Value& result, std::vector<uint8_t>& value) const;
+
+            /**
+             * @brief Lets concurrent calls of a method with equal parameters share one request,
+             * off by default. Only enable it for methods without side effects, i.e. the ones a
+             * specification marks "cacheable". Must not be changed while calls are made.
+             */
+            void        SetCoalescing       (const std::string& name, bool coalesce);
+            bool        IsCoalescing        (const std::string& name) const;
+
         private:
            IClientConnector  &connector;
            RpcProtocolClient *protocol;
+           bool               compactRequests;
+           std::set<std::string> coalescedMethods;
+           SingleFlight      *singleFlight;
+
+           /**
+            * @brief Sends a request, via the single flight if the method is coalesced.
+            */
+           void Send(const std::string& name, const std::string& request, std::string& response);
 
     };
 
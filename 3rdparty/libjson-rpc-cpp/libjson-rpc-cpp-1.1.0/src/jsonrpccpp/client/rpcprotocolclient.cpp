@@ -24,28 +24,61 @@ const std::string RpcProtocolClient::KEY_ERROR_MESSAGE = "message";
 const std::string RpcProtocolClient::KEY_ERROR_DATA = "data";
 
 RpcProtocolClient::RpcProtocolClient(clientVersion_t version)
-    : version(version) {}
+    : version(version), jsonReader(JSONREADER_CLASSIC),
+      encoding(ENCODING_JSON) {}
+
+void RpcProtocolClient::SetJsonReader(jsonreader_t reader) {
+  this->jsonReader = reader;
+}
+
+void RpcProtocolClient::SetEncoding(encoding_t encoding) {
+  this->encoding = encoding;
+}
+
+encoding_t RpcProtocolClient::GetEncoding() const { return this->encoding; }
+
+bool RpcProtocolClient::SupportsDirectCalls() const {
+  return this->version == JSONRPC_CLIENT_V2 && this->encoding == ENCODING_JSON;
+}
 
 void RpcProtocolClient::BuildRequest(const std::string &method,
                                      const Json::Value &parameter,
                                      std::string &result, bool isNotification) {
   Json::Value request;
-  Json::FastWriter writer;
   this->BuildRequest(1, method, parameter, request, isNotification);
-  result = writer.write(request);
+  EncodeValue(this->encoding, request, result);
+}
+
+void RpcProtocolClient::BuildCompactRequest(int methodId,
+                                            const std::string &method,
+                                            const Json::Value &parameter,
+                                            std::string &result,
+                                            bool isNotification) {
+  Json::Value request;
+  if (this->version == JSONRPC_CLIENT_V2)
+    this->BuildRequest(1, methodId, parameter, request, isNotification);
+  else
+    this->BuildRequest(1, method, parameter, request, isNotification);
+  EncodeValue(this->encoding, request, result);
 }
 
 void RpcProtocolClient::HandleResponse(const std::string &response,
                                        Json::Value &result) {
-  Json::Reader reader;
   Json::Value value;
-  if (reader.parse(response, value)) {
+  if (this->DecodeResponse(response, value)) {
     this->HandleResponse(value, result);
   } else {
     throw JsonRpcException(Errors::ERROR_RPC_JSON_PARSE_ERROR, " " + response);
   }
 }
 
+bool RpcProtocolClient::DecodeResponse(const std::string &response,
+                                       Json::Value &value) const {
+  return this->encoding == ENCODING_JSON
+             ? ParseJson(this->jsonReader, response, value, true)
+             : DecodeValue(this->encoding, response, value);
+}
+
 Json::Value RpcProtocolClient::HandleResponse(const Json::Value &value,
                                               Json::Value &result) {
   if (this->ValidateResponse(value)) {
@@ -61,7 +94,7 @@ Json::Value RpcProtocolClient::HandleResponse(const Json::Value &value,
   return value[KEY_ID];
 }
 
-void RpcProtocolClient::BuildRequest(int id, const std::string &method,
+void RpcProtocolClient::BuildRequest(int id, const Json::Value &method,
                                      const Json::Value &parameter,
                                      Json::Value &result, bool isNotification) {
   if (this->version == JSONRPC_CLIENT_V2)
@@ -12,6 +12,7 @@
 
 #include <jsonrpccpp/common/exception.h>
 #include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/binarycodec.h>
 #include <string>
 #include "client.h"
 
@@ -45,6 +46,14 @@ namespace jsonrpc {
              */
             void BuildRequest(const std::string& method, const Json::Value& parameter, std::string& result, bool isNotification);
 
+            /**
+             * @brief Builds a JSON-RPC 2.0 request that names the method by its numeric id.
+             * JSON-RPC 1.0 has no such form, the method name is used there.
+             * @param methodId - Procedure::GetMethodId() of the method
+             * @param method - name of method or notification to be called
+             */
+            void BuildCompactRequest(int methodId, const std::string& method, const Json::Value& parameter, std::string& result, bool isNotification);
+
 
             /**
              * @brief Does the same as Json::Value RpcProtocolClient::HandleResponse(const std::string& response) throw(Exception)
@@ -60,6 +69,28 @@ namespace jsonrpc {
              */
             Json::Value HandleResponse(const Json::Value &response, Json::Value &result) ;
 
+            /**
+             * @brief Parses a response string of the selected encoding with the selected reader.
+             * @return false if response is not a single, complete value.
+             */
+            bool DecodeResponse(const std::string &response, Json::Value &value) const;
+
+            /**
+             * @brief Selects the reader used to parse response strings, JSONREADER_CLASSIC by default.
+             */
+            void SetJsonReader(jsonreader_t reader);
+
+            /**
+             * @brief Selects the wire encoding of requests and responses, ENCODING_JSON by default.
+             */
+            void SetEncoding(encoding_t encoding);
+            encoding_t GetEncoding() const;
+
+            /**
+             * @brief true if requests are JSON-RPC 2.0 in JSON, the only form jsonrpc::DirectRequest writes.
+             */
+            bool SupportsDirectCalls() const;
+
             static const std::string KEY_PROTOCOL_VERSION;
             static const std::string KEY_PROCEDURE_NAME;
             static const std::string KEY_ID;
@@ -73,8 +104,10 @@ namespace jsonrpc {
 
         private:
             clientVersion_t version;
+            jsonreader_t jsonReader;
+            encoding_t encoding;
 
-            void BuildRequest(int id, const std::string& method, const Json::Value& parameter, Json::Value& result, bool isNotification);
+            void BuildRequest(int id, const Json::Value& method, const Json::Value& parameter, Json::Value& result, bool isNotification);
             bool ValidateResponse(const Json::Value &response);
             bool HasError(const Json::Value &response);
             void throwErrorException(const Json::Value &response);
@@ -0,0 +1,59 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    singleflight.cpp
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "singleflight.h"
+
+using namespace jsonrpc;
+using namespace std;
+
+SingleFlight::Call::Call() : done(false), waiting(0) {}
+
+SingleFlight::SingleFlight() {}
+
+void SingleFlight::Send(IClientConnector &connector, const string &request,
+                        string &response) {
+  shared_ptr<Call> call;
+  {
+    unique_lock<mutex> guard(this->lock);
+    map<string, shared_ptr<Call> >::iterator it = this->calls.find(request);
+    if (it != this->calls.end()) {
+      call = it->second;
+      ++call->waiting;
+      while (!call->done)
+        call->finished.wait(guard);
+      guard.unlock();
+      // the call is done, nothing writes to it anymore
+      if (call->error)
+        rethrow_exception(call->error);
+      response = call->response;
+      return;
+    }
+    call = make_shared<Call>();
+    this->calls.insert(make_pair(request, call));
+  }
+
+  exception_ptr error;
+  try {
+    connector.SendRPCMessage(request, response);
+  } catch (...) {
+    error = current_exception();
+  }
+
+  {
+    lock_guard<mutex> guard(this->lock);
+    // later requests are sent again, they may see a newer state
+    this->calls.erase(request);
+    if (call->waiting > 0) {
+      call->response = response;
+      call->error = error;
+    }
+    call->done = true;
+  }
+  call->finished.notify_all();
+  if (error)
+    rethrow_exception(error);
+}
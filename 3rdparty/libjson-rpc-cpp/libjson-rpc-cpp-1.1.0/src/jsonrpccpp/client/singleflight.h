@@ -0,0 +1,58 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    singleflight.h
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_SINGLEFLIGHT_H
+#define JSONRPC_CPP_SINGLEFLIGHT_H
+
+#include "iclientconnector.h"
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace jsonrpc {
+
+    /**
+     * @brief Lets concurrent callers of equal requests share one of them: the first one is
+     * sent, the others wait for and get a copy of its response, or the exception it threw.
+     * Requests sent after the response has arrived are sent again. Thread safe.
+     */
+    class SingleFlight
+    {
+        public:
+            SingleFlight();
+
+            /**
+             * @brief Sends a request via the connector unless an equal one is in flight.
+             */
+            void Send(IClientConnector& connector, const std::string& request,
+                      std::string& response);
+
+        private:
+            struct Call
+            {
+                Call();
+
+                std::condition_variable finished;
+                bool done;
+                /**
+                 * @brief The number of callers waiting, the response is only kept for them.
+                 */
+                unsigned int waiting;
+                std::string response;
+                std::exception_ptr error;
+            };
+
+            std::mutex lock;
+            std::map<std::string, std::shared_ptr<Call> > calls;
+    };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_SINGLEFLIGHT_H
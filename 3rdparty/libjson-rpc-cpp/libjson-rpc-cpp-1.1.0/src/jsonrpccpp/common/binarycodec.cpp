@@ -0,0 +1,877 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    binarycodec.cpp
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "binarycodec.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdint.h>
+
+using namespace jsonrpc;
+using namespace std;
+
+namespace {
+
+// same nesting limit as Json::FastReader
+const unsigned maxDepth = 1000;
+
+bool isValidUtf8(const char *begin, const char *end) {
+  const unsigned char *p = reinterpret_cast<const unsigned char *>(begin);
+  const unsigned char *e = reinterpret_cast<const unsigned char *>(end);
+  while (p < e) {
+    if (e - p >= 8) {
+      uint64_t word;
+      memcpy(&word, p, sizeof(word));
+      if ((word & 0x8080808080808080ULL) == 0) {
+        p += 8;
+        continue;
+      }
+    }
+    if (*p < 0x80) {
+      ++p;
+      continue;
+    }
+    size_t trailing;
+    uint32_t codepoint;
+    if ((*p & 0xe0) == 0xc0) {
+      trailing = 1;
+      codepoint = *p & 0x1f;
+    } else if ((*p & 0xf0) == 0xe0) {
+      trailing = 2;
+      codepoint = *p & 0x0f;
+    } else if ((*p & 0xf8) == 0xf0) {
+      trailing = 3;
+      codepoint = *p & 0x07;
+    } else {
+      return false;
+    }
+    if (static_cast<size_t>(e - p) <= trailing)
+      return false;
+    for (size_t i = 1; i <= trailing; ++i) {
+      if ((p[i] & 0xc0) != 0x80)
+        return false;
+      codepoint = (codepoint << 6) | (p[i] & 0x3f);
+    }
+    // reject overlong forms, surrogates and values beyond U+10FFFF
+    if ((trailing == 1 && codepoint < 0x80) ||
+        (trailing == 2 &&
+         (codepoint < 0x800 || (codepoint >= 0xd800 && codepoint <= 0xdfff))) ||
+        (trailing == 3 && (codepoint < 0x10000 || codepoint > 0x10ffff)))
+      return false;
+    p += trailing + 1;
+  }
+  return true;
+}
+
+void appendBigEndian(string &target, uint64_t value, unsigned bytes) {
+  for (unsigned shift = bytes * 8; shift > 0; shift -= 8)
+    target.push_back(static_cast<char>(value >> (shift - 8)));
+}
+
+// Decoded integers get the same Json::Value type the text readers produce.
+Json::Value unsignedValue(uint64_t value) {
+  if (value <= static_cast<uint64_t>(Json::Value::maxInt))
+    return Json::Value(static_cast<Json::Value::LargestInt>(value));
+  return Json::Value(static_cast<Json::Value::LargestUInt>(value));
+}
+
+Json::Value signedValue(int64_t value) {
+  if (value >= 0)
+    return unsignedValue(static_cast<uint64_t>(value));
+  return Json::Value(static_cast<Json::Value::LargestInt>(value));
+}
+
+bool isSinglePrecision(double value) {
+  return static_cast<double>(static_cast<float>(value)) == value ||
+         value != value;
+}
+
+uint32_t floatBits(double value) {
+  float single = static_cast<float>(value);
+  uint32_t bits;
+  memcpy(&bits, &single, sizeof(bits));
+  return bits;
+}
+
+uint64_t doubleBits(double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+double floatFromBits(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+double doubleFromBits(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+const char base64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int base64Digit(char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+')
+    return 62;
+  if (c == '/')
+    return 63;
+  return -1;
+}
+
+string encodeBase64(const unsigned char *data, size_t size) {
+  string text;
+  text.reserve((size + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < size; i += 3) {
+    uint32_t group = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) |
+                     data[i + 2];
+    text += base64Alphabet[group >> 18];
+    text += base64Alphabet[(group >> 12) & 0x3f];
+    text += base64Alphabet[(group >> 6) & 0x3f];
+    text += base64Alphabet[group & 0x3f];
+  }
+  if (i < size) {
+    uint32_t group = uint32_t(data[i]) << 16;
+    if (i + 1 < size)
+      group |= uint32_t(data[i + 1]) << 8;
+    text += base64Alphabet[group >> 18];
+    text += base64Alphabet[(group >> 12) & 0x3f];
+    text += i + 1 < size ? base64Alphabet[(group >> 6) & 0x3f] : '=';
+    text += '=';
+  }
+  return text;
+}
+
+template <typename Bytes>
+bool decodeBase64(const string &text, Bytes &bytes) {
+  bytes.clear();
+  if (text.size() % 4 != 0)
+    return false;
+  bytes.reserve(text.size() / 4 * 3);
+  for (size_t i = 0; i < text.size(); i += 4) {
+    // padding is only allowed at the end of the last group
+    bool last = i + 4 == text.size();
+    size_t padding = 0;
+    if (last && text[i + 3] == '=')
+      padding = text[i + 2] == '=' ? 2 : 1;
+    uint32_t group = 0;
+    for (size_t j = 0; j < 4 - padding; ++j) {
+      int digit = base64Digit(text[i + j]);
+      if (digit < 0)
+        return false;
+      group = (group << 6) | uint32_t(digit);
+    }
+    group <<= 6 * padding;
+    bytes.push_back(static_cast<unsigned char>(group >> 16));
+    if (padding < 2)
+      bytes.push_back(static_cast<unsigned char>(group >> 8));
+    if (padding < 1)
+      bytes.push_back(static_cast<unsigned char>(group));
+  }
+  return true;
+}
+
+double halfFromBits(uint16_t bits) {
+  int exponent = (bits >> 10) & 0x1f;
+  int mantissa = bits & 0x3ff;
+  double value;
+  if (exponent == 0)
+    value = ldexp(mantissa, -24);
+  else if (exponent != 31)
+    value = ldexp(mantissa + 1024, exponent - 25);
+  else
+    value = mantissa == 0 ? numeric_limits<double>::infinity()
+                          : numeric_limits<double>::quiet_NaN();
+  return (bits & 0x8000) ? -value : value;
+}
+
+class Cursor {
+public:
+  Cursor(const string &source)
+      : current(source.data()), end(source.data() + source.size()) {}
+
+  bool atEnd() const { return current == end; }
+
+  bool readByte(unsigned char &byte) {
+    if (current == end)
+      return false;
+    byte = static_cast<unsigned char>(*current++);
+    return true;
+  }
+
+  bool peekByte(unsigned char &byte) const {
+    if (current == end)
+      return false;
+    byte = static_cast<unsigned char>(*current);
+    return true;
+  }
+
+  bool readBigEndian(unsigned bytes, uint64_t &value) {
+    if (static_cast<size_t>(end - current) < bytes)
+      return false;
+    value = 0;
+    for (unsigned i = 0; i < bytes; ++i)
+      value = (value << 8) | static_cast<unsigned char>(*current++);
+    return true;
+  }
+
+  bool readBytes(uint64_t length, const char *&data) {
+    if (length > static_cast<uint64_t>(end - current))
+      return false;
+    data = current;
+    current += length;
+    return true;
+  }
+
+  // every element takes at least one byte, reject counts the input can't hold
+  bool canHold(uint64_t elements) const {
+    return elements <= static_cast<uint64_t>(end - current);
+  }
+
+private:
+  const char *current;
+  const char *end;
+};
+
+// CBOR, RFC 7049
+
+class CborEncoder {
+public:
+  CborEncoder(string &target) : target(target) {}
+
+  void encode(const Json::Value &value) {
+    switch (value.type()) {
+    case Json::nullValue:
+      target.push_back(static_cast<char>(0xf6));
+      break;
+    case Json::booleanValue:
+      target.push_back(static_cast<char>(value.asBool() ? 0xf5 : 0xf4));
+      break;
+    case Json::intValue: {
+      Json::Value::LargestInt number = value.asLargestInt();
+      if (number >= 0)
+        writeHead(0, static_cast<uint64_t>(number));
+      else
+        writeHead(1, ~static_cast<uint64_t>(number)); // -1 - number
+      break;
+    }
+    case Json::uintValue:
+      writeHead(0, value.asLargestUInt());
+      break;
+    case Json::realValue: {
+      double number = value.asDouble();
+      if (isSinglePrecision(number)) {
+        target.push_back(static_cast<char>(0xfa));
+        appendBigEndian(target, floatBits(number), 4);
+      } else {
+        target.push_back(static_cast<char>(0xfb));
+        appendBigEndian(target, doubleBits(number), 8);
+      }
+      break;
+    }
+    case Json::stringValue: {
+      const char *begin;
+      const char *end;
+      value.getString(&begin, &end);
+      writeString(begin, end);
+      break;
+    }
+    case Json::arrayValue: {
+      Json::ArrayIndex size = value.size();
+      writeHead(4, size);
+      for (Json::ArrayIndex index = 0; index < size; ++index)
+        encode(value[index]);
+      break;
+    }
+    case Json::objectValue: {
+      writeHead(5, value.size());
+      for (Json::Value::const_iterator it = value.begin(); it != value.end();
+           ++it) {
+        const char *end;
+        const char *begin = it.memberName(&end);
+        writeString(begin, end);
+        encode(*it);
+      }
+      break;
+    }
+    }
+  }
+
+private:
+  void writeHead(unsigned char major, uint64_t argument) {
+    major = static_cast<unsigned char>(major << 5);
+    if (argument < 24) {
+      target.push_back(static_cast<char>(major | argument));
+    } else if (argument <= 0xff) {
+      target.push_back(static_cast<char>(major | 24));
+      appendBigEndian(target, argument, 1);
+    } else if (argument <= 0xffff) {
+      target.push_back(static_cast<char>(major | 25));
+      appendBigEndian(target, argument, 2);
+    } else if (argument <= 0xffffffffULL) {
+      target.push_back(static_cast<char>(major | 26));
+      appendBigEndian(target, argument, 4);
+    } else {
+      target.push_back(static_cast<char>(major | 27));
+      appendBigEndian(target, argument, 8);
+    }
+  }
+
+  void writeString(const char *begin, const char *end) {
+    writeHead(isValidUtf8(begin, end) ? 3 : 2, end - begin);
+    target.append(begin, end);
+  }
+
+  string &target;
+};
+
+class CborDecoder {
+public:
+  CborDecoder(const string &source) : cursor(source) {}
+
+  bool decode(Json::Value &value) {
+    return decodeItem(value, 0) && cursor.atEnd();
+  }
+
+private:
+  static const unsigned char indefinite = 31;
+
+  bool readHead(unsigned char &major, unsigned char &info, uint64_t &argument) {
+    unsigned char initial;
+    if (!cursor.readByte(initial))
+      return false;
+    major = initial >> 5;
+    info = initial & 0x1f;
+    if (info < 24) {
+      argument = info;
+      return true;
+    }
+    if (info <= 27)
+      return cursor.readBigEndian(1u << (info - 24), argument);
+    argument = 0;
+    return info == indefinite && major >= 2 && major != 6;
+  }
+
+  // consumes the "break" stop code of indefinite length items
+  bool atBreak() {
+    unsigned char byte;
+    if (cursor.peekByte(byte) && byte == 0xff) {
+      cursor.readByte(byte);
+      return true;
+    }
+    return false;
+  }
+
+  bool readString(unsigned char major, unsigned char info, uint64_t argument,
+                  string &target) {
+    const char *data;
+    if (info != indefinite) {
+      if (!cursor.readBytes(argument, data))
+        return false;
+      target.assign(data, static_cast<size_t>(argument));
+      return true;
+    }
+    target.clear();
+    while (!atBreak()) {
+      unsigned char chunkMajor, chunkInfo;
+      uint64_t length;
+      if (!readHead(chunkMajor, chunkInfo, length) || chunkMajor != major ||
+          chunkInfo == indefinite || !cursor.readBytes(length, data))
+        return false;
+      target.append(data, static_cast<size_t>(length));
+    }
+    return true;
+  }
+
+  bool decodeItem(Json::Value &value, unsigned depth) {
+    unsigned char major, info;
+    uint64_t argument;
+    if (depth > maxDepth || !readHead(major, info, argument))
+      return false;
+
+    switch (major) {
+    case 0:
+      value = unsignedValue(argument);
+      return true;
+    case 1:
+      if (argument > static_cast<uint64_t>(numeric_limits<int64_t>::max()))
+        value = -1.0 - static_cast<double>(argument);
+      else
+        value = Json::Value(
+            static_cast<Json::Value::LargestInt>(~argument)); // -1 - argument
+      return true;
+    case 2:
+    case 3:
+      if (info != indefinite) {
+        const char *data;
+        if (!cursor.readBytes(argument, data))
+          return false;
+        value = Json::Value(data, data + argument);
+        return true;
+      } else {
+        string text;
+        if (!readString(major, info, argument, text))
+          return false;
+        value = Json::Value(text);
+        return true;
+      }
+    case 4:
+      value = Json::Value(Json::arrayValue);
+      if (info == indefinite) {
+        while (!atBreak()) {
+          if (!decodeItem(value.append(Json::Value()), depth + 1))
+            return false;
+        }
+        return true;
+      }
+      if (!cursor.canHold(argument))
+        return false;
+      for (uint64_t index = 0; index < argument; ++index) {
+        if (!decodeItem(value.append(Json::Value()), depth + 1))
+          return false;
+      }
+      return true;
+    case 5:
+      value = Json::Value(Json::objectValue);
+      if (info == indefinite) {
+        while (!atBreak()) {
+          if (!decodeMember(value, depth))
+            return false;
+        }
+        return true;
+      }
+      if (!cursor.canHold(argument))
+        return false;
+      for (uint64_t index = 0; index < argument; ++index) {
+        if (!decodeMember(value, depth))
+          return false;
+      }
+      return true;
+    case 6: // tags carry no information for the Json::Value model
+      return decodeItem(value, depth + 1);
+    default:
+      switch (info) {
+      case 20:
+        value = false;
+        return true;
+      case 21:
+        value = true;
+        return true;
+      case 22: // null
+      case 23: // undefined
+        value = Json::Value();
+        return true;
+      case 25:
+        value = halfFromBits(static_cast<uint16_t>(argument));
+        return true;
+      case 26:
+        value = floatFromBits(static_cast<uint32_t>(argument));
+        return true;
+      case 27:
+        value = doubleFromBits(argument);
+        return true;
+      default:
+        return false;
+      }
+    }
+  }
+
+  bool decodeMember(Json::Value &object, unsigned depth) {
+    unsigned char major, info;
+    uint64_t argument;
+    if (!readHead(major, info, argument) || (major != 2 && major != 3) ||
+        !readString(major, info, argument, key))
+      return false;
+    return decodeItem(object[key], depth + 1);
+  }
+
+  Cursor cursor;
+  string key;
+};
+
+// MessagePack
+
+class MsgpackEncoder {
+public:
+  MsgpackEncoder(string &target) : target(target) {}
+
+  void encode(const Json::Value &value) {
+    switch (value.type()) {
+    case Json::nullValue:
+      target.push_back(static_cast<char>(0xc0));
+      break;
+    case Json::booleanValue:
+      target.push_back(static_cast<char>(value.asBool() ? 0xc3 : 0xc2));
+      break;
+    case Json::intValue: {
+      Json::Value::LargestInt number = value.asLargestInt();
+      if (number >= 0)
+        writeUnsigned(static_cast<uint64_t>(number));
+      else
+        writeNegative(number);
+      break;
+    }
+    case Json::uintValue:
+      writeUnsigned(value.asLargestUInt());
+      break;
+    case Json::realValue: {
+      double number = value.asDouble();
+      if (isSinglePrecision(number)) {
+        target.push_back(static_cast<char>(0xca));
+        appendBigEndian(target, floatBits(number), 4);
+      } else {
+        target.push_back(static_cast<char>(0xcb));
+        appendBigEndian(target, doubleBits(number), 8);
+      }
+      break;
+    }
+    case Json::stringValue: {
+      const char *begin;
+      const char *end;
+      value.getString(&begin, &end);
+      writeString(begin, end);
+      break;
+    }
+    case Json::arrayValue: {
+      Json::ArrayIndex size = value.size();
+      writeContainerHead(size, 0x90, 0xdc);
+      for (Json::ArrayIndex index = 0; index < size; ++index)
+        encode(value[index]);
+      break;
+    }
+    case Json::objectValue: {
+      writeContainerHead(value.size(), 0x80, 0xde);
+      for (Json::Value::const_iterator it = value.begin(); it != value.end();
+           ++it) {
+        const char *end;
+        const char *begin = it.memberName(&end);
+        writeString(begin, end);
+        encode(*it);
+      }
+      break;
+    }
+    }
+  }
+
+private:
+  void writeTyped(unsigned char type, uint64_t value, unsigned bytes) {
+    target.push_back(static_cast<char>(type));
+    appendBigEndian(target, value, bytes);
+  }
+
+  void writeUnsigned(uint64_t number) {
+    if (number < 0x80)
+      target.push_back(static_cast<char>(number));
+    else if (number <= 0xff)
+      writeTyped(0xcc, number, 1);
+    else if (number <= 0xffff)
+      writeTyped(0xcd, number, 2);
+    else if (number <= 0xffffffffULL)
+      writeTyped(0xce, number, 4);
+    else
+      writeTyped(0xcf, number, 8);
+  }
+
+  void writeNegative(int64_t number) {
+    if (number >= -32)
+      target.push_back(static_cast<char>(number));
+    else if (number >= numeric_limits<int8_t>::min())
+      writeTyped(0xd0, static_cast<uint64_t>(number), 1);
+    else if (number >= numeric_limits<int16_t>::min())
+      writeTyped(0xd1, static_cast<uint64_t>(number), 2);
+    else if (number >= numeric_limits<int32_t>::min())
+      writeTyped(0xd2, static_cast<uint64_t>(number), 4);
+    else
+      writeTyped(0xd3, static_cast<uint64_t>(number), 8);
+  }
+
+  void writeString(const char *begin, const char *end) {
+    uint64_t length = static_cast<uint64_t>(end - begin);
+    if (isValidUtf8(begin, end)) {
+      if (length < 32)
+        target.push_back(static_cast<char>(0xa0 | length));
+      else if (length <= 0xff)
+        writeTyped(0xd9, length, 1);
+      else if (length <= 0xffff)
+        writeTyped(0xda, length, 2);
+      else
+        writeTyped(0xdb, length, 4);
+    } else {
+      if (length <= 0xff)
+        writeTyped(0xc4, length, 1);
+      else if (length <= 0xffff)
+        writeTyped(0xc5, length, 2);
+      else
+        writeTyped(0xc6, length, 4);
+    }
+    target.append(begin, end);
+  }
+
+  void writeContainerHead(uint64_t size, unsigned char fixType,
+                          unsigned char type16) {
+    if (size < 16)
+      target.push_back(static_cast<char>(fixType | size));
+    else if (size <= 0xffff)
+      writeTyped(type16, size, 2);
+    else
+      writeTyped(type16 + 1, size, 4);
+  }
+
+  string &target;
+};
+
+class MsgpackDecoder {
+public:
+  MsgpackDecoder(const string &source) : cursor(source) {}
+
+  bool decode(Json::Value &value) {
+    return decodeItem(value, 0) && cursor.atEnd();
+  }
+
+private:
+  bool readSigned(unsigned bytes, Json::Value &value) {
+    uint64_t bits;
+    if (!cursor.readBigEndian(bytes, bits))
+      return false;
+    unsigned shift = 64 - bytes * 8;
+    // sign extend
+    value = signedValue(static_cast<int64_t>(bits << shift) >> shift);
+    return true;
+  }
+
+  bool readUnsigned(unsigned bytes, Json::Value &value) {
+    uint64_t number;
+    if (!cursor.readBigEndian(bytes, number))
+      return false;
+    value = unsignedValue(number);
+    return true;
+  }
+
+  // str/bin length, false for any other type
+  bool readStringLength(unsigned char type, uint64_t &length) {
+    if ((type & 0xe0) == 0xa0) {
+      length = type & 0x1f;
+      return true;
+    }
+    switch (type) {
+    case 0xc4:
+    case 0xd9:
+      return cursor.readBigEndian(1, length);
+    case 0xc5:
+    case 0xda:
+      return cursor.readBigEndian(2, length);
+    case 0xc6:
+    case 0xdb:
+      return cursor.readBigEndian(4, length);
+    default:
+      return false;
+    }
+  }
+
+  bool decodeArray(uint64_t size, Json::Value &value, unsigned depth) {
+    if (!cursor.canHold(size))
+      return false;
+    value = Json::Value(Json::arrayValue);
+    for (uint64_t index = 0; index < size; ++index) {
+      if (!decodeItem(value.append(Json::Value()), depth + 1))
+        return false;
+    }
+    return true;
+  }
+
+  bool decodeMap(uint64_t size, Json::Value &value, unsigned depth) {
+    if (!cursor.canHold(size))
+      return false;
+    value = Json::Value(Json::objectValue);
+    for (uint64_t index = 0; index < size; ++index) {
+      unsigned char type;
+      uint64_t length;
+      const char *data;
+      if (!cursor.readByte(type) || !readStringLength(type, length) ||
+          !cursor.readBytes(length, data))
+        return false;
+      key.assign(data, static_cast<size_t>(length));
+      if (!decodeItem(value[key], depth + 1))
+        return false;
+    }
+    return true;
+  }
+
+  bool decodeItem(Json::Value &value, unsigned depth) {
+    unsigned char type;
+    if (depth > maxDepth || !cursor.readByte(type))
+      return false;
+
+    if (type < 0x80) {
+      value = Json::Value(static_cast<Json::Value::LargestInt>(type));
+      return true;
+    }
+    if (type >= 0xe0) {
+      value = Json::Value(
+          static_cast<Json::Value::LargestInt>(static_cast<int8_t>(type)));
+      return true;
+    }
+    if (type <= 0x8f)
+      return decodeMap(type & 0x0f, value, depth);
+    if (type <= 0x9f)
+      return decodeArray(type & 0x0f, value, depth);
+
+    uint64_t size;
+    switch (type) {
+    case 0xc0:
+      value = Json::Value();
+      return true;
+    case 0xc2:
+      value = false;
+      return true;
+    case 0xc3:
+      value = true;
+      return true;
+    case 0xca:
+      if (!cursor.readBigEndian(4, size))
+        return false;
+      value = floatFromBits(static_cast<uint32_t>(size));
+      return true;
+    case 0xcb:
+      if (!cursor.readBigEndian(8, size))
+        return false;
+      value = doubleFromBits(size);
+      return true;
+    case 0xcc:
+      return readUnsigned(1, value);
+    case 0xcd:
+      return readUnsigned(2, value);
+    case 0xce:
+      return readUnsigned(4, value);
+    case 0xcf:
+      return readUnsigned(8, value);
+    case 0xd0:
+      return readSigned(1, value);
+    case 0xd1:
+      return readSigned(2, value);
+    case 0xd2:
+      return readSigned(4, value);
+    case 0xd3:
+      return readSigned(8, value);
+    case 0xdc:
+      return cursor.readBigEndian(2, size) && decodeArray(size, value, depth);
+    case 0xdd:
+      return cursor.readBigEndian(4, size) && decodeArray(size, value, depth);
+    case 0xde:
+      return cursor.readBigEndian(2, size) && decodeMap(size, value, depth);
+    case 0xdf:
+      return cursor.readBigEndian(4, size) && decodeMap(size, value, depth);
+    default: {
+      // str and bin, the ext types have no Json::Value equivalent
+      const char *data;
+      if (!readStringLength(type, size) || !cursor.readBytes(size, data))
+        return false;
+      value = Json::Value(data, data + size);
+      return true;
+    }
+    }
+  }
+
+  Cursor cursor;
+  string key;
+};
+
+} // namespace
+
+const char *jsonrpc::GetContentType(encoding_t encoding) {
+  switch (encoding) {
+  case ENCODING_CBOR:
+    return "application/cbor";
+  case ENCODING_MSGPACK:
+    return "application/msgpack";
+  default:
+    return "application/json";
+  }
+}
+
+bool jsonrpc::GetEncoding(const string &contentType, encoding_t &encoding) {
+  string mimeType = contentType.substr(0, contentType.find(';'));
+  mimeType.erase(mimeType.find_last_not_of(" \t") + 1);
+  if (mimeType == "application/json") {
+    encoding = ENCODING_JSON;
+  } else if (mimeType == "application/cbor") {
+    encoding = ENCODING_CBOR;
+  } else if (mimeType == "application/msgpack" ||
+             mimeType == "application/x-msgpack" ||
+             mimeType == "application/vnd.msgpack") {
+    encoding = ENCODING_MSGPACK;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool jsonrpc::ParseJson(jsonreader_t reader, const string &document,
+                        Json::Value &root, bool collectComments) {
+  if (reader == JSONREADER_FAST) {
+    Json::FastReader fastReader;
+    return fastReader.parse(document, root);
+  }
+  Json::Reader classicReader;
+  return classicReader.parse(document, root, collectComments);
+}
+
+void jsonrpc::EncodeValue(encoding_t encoding, const Json::Value &value,
+                          string &target) {
+  switch (encoding) {
+  case ENCODING_CBOR:
+    target.clear();
+    CborEncoder(target).encode(value);
+    break;
+  case ENCODING_MSGPACK:
+    target.clear();
+    MsgpackEncoder(target).encode(value);
+    break;
+  default:
+    target = Json::FastWriter().write(value);
+    break;
+  }
+}
+
+bool jsonrpc::DecodeValue(encoding_t encoding, const string &source,
+                          Json::Value &value, jsonreader_t reader) {
+  switch (encoding) {
+  case ENCODING_CBOR:
+    return CborDecoder(source).decode(value);
+  case ENCODING_MSGPACK:
+    return MsgpackDecoder(source).decode(value);
+  default:
+    return ParseJson(reader, source, value);
+  }
+}
+
+string jsonrpc::EncodeBase64(const string &bytes) {
+  return encodeBase64(reinterpret_cast<const unsigned char *>(bytes.data()),
+                      bytes.size());
+}
+
+string jsonrpc::EncodeBase64(const vector<uint8_t> &bytes) {
+  return encodeBase64(bytes.empty() ? NULL : &bytes[0], bytes.size());
+}
+
+bool jsonrpc::DecodeBase64(const string &text, string &bytes) {
+  return decodeBase64(text, bytes);
+}
+
+bool jsonrpc::DecodeBase64(const string &text, vector<uint8_t> &bytes) {
+  return decodeBase64(text, bytes);
+}
@@ -0,0 +1,63 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    binarycodec.h
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_BINARYCODEC_H
+#define JSONRPC_CPP_BINARYCODEC_H
+
+#include <jsonrpccpp/common/jsonparser.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace jsonrpc {
+
+    /**
+     * @brief Wire encodings of JSON-RPC messages. All of them map to the same
+     * Json::Value model: CBOR (RFC 7049) and MessagePack keep the integer type
+     * (int64/uint64) and carry strings that are not valid UTF-8 as byte strings.
+     */
+    typedef enum {ENCODING_JSON, ENCODING_CBOR, ENCODING_MSGPACK} encoding_t;
+
+    /**
+     * @brief Returns the MIME type of the encoding, i.e. "application/cbor".
+     */
+    const char* GetContentType(encoding_t encoding);
+
+    /**
+     * @brief Looks up the encoding for a MIME type, parameters like "; charset=utf-8" are ignored.
+     * @return false if the content type is not known, encoding is left untouched then.
+     */
+    bool GetEncoding(const std::string& contentType, encoding_t& encoding);
+
+    /**
+     * @brief Serializes value, JSON is written with Json::FastWriter.
+     */
+    void EncodeValue(encoding_t encoding, const Json::Value& value, std::string& target);
+
+    /**
+     * @brief Deserializes source, JSON is parsed with the given reader.
+     * @return false if source is not a single, complete value of the encoding.
+     */
+    bool DecodeValue(encoding_t encoding, const std::string& source, Json::Value& value,
+                     jsonreader_t reader = JSONREADER_CLASSIC);
+
+    /**
+     * @brief Base64 (RFC 4648, with padding), the form binary parameters and
+     * results (JSON_BINARY) take in the Json::Value model and in JSON.
+     */
+    std::string EncodeBase64(const std::string& bytes);
+    std::string EncodeBase64(const std::vector<uint8_t>& bytes);
+
+    /**
+     * @return false if text is not valid base64, bytes are undefined then.
+     */
+    bool DecodeBase64(const std::string& text, std::string& bytes);
+    bool DecodeBase64(const std::string& text, std::vector<uint8_t>& bytes);
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_BINARYCODEC_H
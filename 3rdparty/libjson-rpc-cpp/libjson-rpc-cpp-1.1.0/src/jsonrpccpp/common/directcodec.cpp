@@ -0,0 +1,735 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    directcodec.cpp
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "directcodec.h"
+#include "binarycodec.h"
+#include "procedure.h"
+
+#include <cerrno>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
+
+using namespace jsonrpc;
+using namespace std;
+
+namespace {
+
+const unsigned maxDepth = 1000;
+const char *const keyId = "id";
+const char *const keyVersion = "jsonrpc";
+const char *const keyMethod = "method";
+const char *const keyParams = "params";
+const char *const keyResult = "result";
+
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+bool equals(const char *begin, const char *end, const char *text) {
+  size_t length = strlen(text);
+  return size_t(end - begin) == length && memcmp(begin, text, length) == 0;
+}
+
+bool readHexQuad(const char *&current, const char *end, unsigned &value) {
+  if (end - current < 4)
+    return false;
+  value = 0;
+  for (int i = 0; i < 4; i++) {
+    char c = *current++;
+    value <<= 4;
+    if (c >= '0' && c <= '9')
+      value += c - '0';
+    else if (c >= 'a' && c <= 'f')
+      value += c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      value += c - 'A' + 10;
+    else
+      return false;
+  }
+  return true;
+}
+
+void appendUtf8(string &target, unsigned codePoint) {
+  if (codePoint < 0x80) {
+    target += static_cast<char>(codePoint);
+  } else if (codePoint < 0x800) {
+    target += static_cast<char>(0xC0 | (codePoint >> 6));
+    target += static_cast<char>(0x80 | (codePoint & 0x3F));
+  } else if (codePoint < 0x10000) {
+    target += static_cast<char>(0xE0 | (codePoint >> 12));
+    target += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    target += static_cast<char>(0x80 | (codePoint & 0x3F));
+  } else {
+    target += static_cast<char>(0xF0 | (codePoint >> 18));
+    target += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    target += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    target += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+}
+
+void appendJson(string &target, const Json::Value &value) {
+  Json::FastWriter writer;
+  writer.omitEndingLineFeed();
+  target += writer.write(value);
+}
+
+} // namespace
+
+DirectScanner::DirectScanner(const char *begin, const char *end)
+    : current(begin), end(end) {}
+
+void DirectScanner::SkipWhitespace() {
+  while (current < end && (*current == ' ' || *current == '\n' ||
+                           *current == '\r' || *current == '\t'))
+    ++current;
+}
+
+bool DirectScanner::Consume(char c) {
+  SkipWhitespace();
+  if (current < end && *current == c) {
+    ++current;
+    return true;
+  }
+  return false;
+}
+
+bool DirectScanner::ReadPlainString(const char *&begin, const char *&stop) {
+  if (!Consume('"'))
+    return false;
+  begin = current;
+  while (current < end) {
+    char c = *current;
+    if (c == '"') {
+      stop = current++;
+      return true;
+    }
+    // escapes are left to the full parsers
+    if (c == '\\' || static_cast<unsigned char>(c) < 0x20)
+      return false;
+    ++current;
+  }
+  return false;
+}
+
+bool DirectScanner::ReadNumber(const char *&begin, bool &isInteger) {
+  SkipWhitespace();
+  begin = current;
+  isInteger = true;
+  if (current < end && *current == '-')
+    ++current;
+  if (current < end && *current == '0') {
+    ++current;
+  } else if (current < end && isDigit(*current)) {
+    while (current < end && isDigit(*current))
+      ++current;
+  } else {
+    return false;
+  }
+  if (current < end && *current == '.') {
+    isInteger = false;
+    if (++current == end || !isDigit(*current))
+      return false;
+    while (current < end && isDigit(*current))
+      ++current;
+  }
+  if (current < end && (*current == 'e' || *current == 'E')) {
+    isInteger = false;
+    if (++current < end && (*current == '+' || *current == '-'))
+      ++current;
+    if (current == end || !isDigit(*current))
+      return false;
+    while (current < end && isDigit(*current))
+      ++current;
+  }
+  return true;
+}
+
+bool DirectScanner::SkipValue(unsigned depth) {
+  SkipWhitespace();
+  if (current == end || depth > maxDepth)
+    return false;
+  switch (*current) {
+  case '"':
+    for (++current; current < end; ++current) {
+      if (*current == '"') {
+        ++current;
+        return true;
+      }
+      if (*current == '\\' && ++current == end)
+        return false;
+    }
+    return false;
+  case '{':
+    ++current;
+    if (Consume('}'))
+      return true;
+    do {
+      SkipWhitespace();
+      if (current == end || *current != '"' || !SkipValue(depth + 1) ||
+          !Consume(':') || !SkipValue(depth + 1))
+        return false;
+    } while (Consume(','));
+    return Consume('}');
+  case '[':
+    ++current;
+    if (Consume(']'))
+      return true;
+    do {
+      if (!SkipValue(depth + 1))
+        return false;
+    } while (Consume(','));
+    return Consume(']');
+  case 't':
+  case 'f':
+  case 'n': {
+    const char *literal =
+        *current == 't' ? "true" : (*current == 'f' ? "false" : "null");
+    size_t length = strlen(literal);
+    if (size_t(end - current) < length ||
+        memcmp(current, literal, length) != 0)
+      return false;
+    current += length;
+    return true;
+  }
+  default: {
+    const char *begin;
+    bool isInteger;
+    return ReadNumber(begin, isInteger);
+  }
+  }
+}
+
+bool DirectScanner::Read(bool &value) {
+  SkipWhitespace();
+  if (end - current >= 4 && memcmp(current, "true", 4) == 0) {
+    current += 4;
+    value = true;
+    return true;
+  }
+  if (end - current >= 5 && memcmp(current, "false", 5) == 0) {
+    current += 5;
+    value = false;
+    return true;
+  }
+  return false;
+}
+
+bool DirectScanner::Read(int &value) {
+  const char *begin;
+  bool isInteger;
+  if (!ReadNumber(begin, isInteger) || !isInteger)
+    return false;
+  bool negative = *begin == '-';
+  const char *digits = negative ? begin + 1 : begin;
+  if (current - digits > 10)
+    return false;
+  long long number = 0;
+  for (const char *c = digits; c < current; ++c)
+    number = number * 10 + (*c - '0');
+  if (negative)
+    number = -number;
+  if (number < -2147483647LL - 1 || number > 2147483647LL)
+    return false;
+  value = static_cast<int>(number);
+  return true;
+}
+
+bool DirectScanner::ReadInteger(uint64_t &magnitude, bool &negative) {
+  const char *begin;
+  bool isInteger;
+  if (!ReadNumber(begin, isInteger) || !isInteger)
+    return false;
+  negative = *begin == '-';
+  magnitude = 0;
+  for (const char *c = negative ? begin + 1 : begin; c < current; ++c) {
+    uint64_t digit = static_cast<uint64_t>(*c - '0');
+    if (magnitude > (UINT64_MAX - digit) / 10)
+      return false;
+    magnitude = magnitude * 10 + digit;
+  }
+  return true;
+}
+
+bool DirectScanner::Read(int64_t &value) {
+  uint64_t magnitude;
+  bool negative;
+  if (!ReadInteger(magnitude, negative))
+    return false;
+  if (negative) {
+    if (magnitude > uint64_t(INT64_MAX) + 1u)
+      return false;
+    value = magnitude == uint64_t(INT64_MAX) + 1u
+                ? INT64_MIN
+                : -static_cast<int64_t>(magnitude);
+  } else {
+    if (magnitude > uint64_t(INT64_MAX))
+      return false;
+    value = static_cast<int64_t>(magnitude);
+  }
+  return true;
+}
+
+bool DirectScanner::Read(uint64_t &value) {
+  uint64_t magnitude;
+  bool negative;
+  // the readers decode "-0" as the integer 0
+  if (!ReadInteger(magnitude, negative) || (negative && magnitude != 0))
+    return false;
+  value = magnitude;
+  return true;
+}
+
+bool DirectScanner::Read(double &value) {
+  // strtod follows LC_NUMERIC, the readers do not
+  const char *point = localeconv()->decimal_point;
+  if (point[0] != '.' || point[1] != '\0')
+    return false;
+  const char *begin;
+  bool isInteger;
+  if (!ReadNumber(begin, isInteger))
+    return false;
+  char buffer[64];
+  size_t length = current - begin;
+  if (length >= sizeof(buffer))
+    return false;
+  memcpy(buffer, begin, length);
+  buffer[length] = '\0';
+  errno = 0;
+  value = strtod(buffer, NULL);
+  if (errno == ERANGE)
+    return false;
+  // the readers decode "-0" as the integer 0
+  if (isInteger && value == 0)
+    value = 0.0;
+  return true;
+}
+
+bool DirectScanner::Read(string &value) {
+  if (!Consume('"'))
+    return false;
+  value.clear();
+  while (current < end) {
+    const char *run = current;
+    while (current < end && *current != '"' && *current != '\\' &&
+           static_cast<unsigned char>(*current) >= 0x20)
+      ++current;
+    value.append(run, current - run);
+    if (current == end || static_cast<unsigned char>(*current) < 0x20)
+      return false;
+    if (*current++ == '"')
+      return true;
+    if (current == end)
+      return false;
+    switch (*current++) {
+    case '"':
+      value += '"';
+      break;
+    case '\\':
+      value += '\\';
+      break;
+    case '/':
+      value += '/';
+      break;
+    case 'b':
+      value += '\b';
+      break;
+    case 'f':
+      value += '\f';
+      break;
+    case 'n':
+      value += '\n';
+      break;
+    case 'r':
+      value += '\r';
+      break;
+    case 't':
+      value += '\t';
+      break;
+    case 'u': {
+      unsigned codePoint;
+      if (!readHexQuad(current, end, codePoint))
+        return false;
+      if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+        return false;
+      if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+        unsigned low;
+        if (end - current < 2 || current[0] != '\\' || current[1] != 'u')
+          return false;
+        current += 2;
+        if (!readHexQuad(current, end, low) || low < 0xDC00 || low > 0xDFFF)
+          return false;
+        codePoint = 0x10000 + ((codePoint & 0x3FF) << 10) + (low & 0x3FF);
+      }
+      appendUtf8(value, codePoint);
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+bool DirectScanner::Read(vector<uint8_t> &value) {
+  string text;
+  return Read(text) && DecodeBase64(text, value);
+}
+
+bool DirectScanner::Read(Json::Value &value, Json::ValueType type) {
+  SkipWhitespace();
+  const char *begin = current;
+  if (!SkipValue())
+    return false;
+  Json::FastReader reader;
+  return reader.parse(begin, current, value) && value.type() == type;
+}
+
+DirectObjectReader::DirectObjectReader(DirectScanner &scanner)
+    : scanner(scanner), nameBegin(NULL), nameEnd(NULL), started(false),
+      firstMember(true), finished(false) {}
+
+bool DirectObjectReader::Next() {
+  if (!started) {
+    started = true;
+    if (!scanner.Consume('{'))
+      return false;
+  }
+  if (scanner.Consume('}')) {
+    finished = true;
+    return false;
+  }
+  if (!firstMember && !scanner.Consume(','))
+    return false;
+  firstMember = false;
+  return scanner.ReadPlainString(nameBegin, nameEnd) && scanner.Consume(':');
+}
+
+bool DirectObjectReader::IsMember(const char *name) const {
+  return equals(nameBegin, nameEnd, name);
+}
+
+bool DirectObjectReader::Finished() const { return finished; }
+
+void DirectWriter::Write(string &json, bool value) {
+  json += Json::valueToString(value);
+}
+
+void DirectWriter::Write(string &json, int value) {
+  json += Json::valueToString(Json::Int(value));
+}
+
+void DirectWriter::Write(string &json, int64_t value) {
+  json += Json::valueToString(Json::Int64(value));
+}
+
+void DirectWriter::Write(string &json, uint64_t value) {
+  json += Json::valueToString(Json::UInt64(value));
+}
+
+void DirectWriter::Write(string &json, double value) {
+  json += Json::valueToString(value);
+}
+
+void DirectWriter::Write(string &json, const string &value) {
+  json += Json::valueToQuotedString(value.data(),
+                                    static_cast<unsigned>(value.size()));
+}
+
+void DirectWriter::Write(string &json, const vector<uint8_t> &value) {
+  // base64 needs no escaping
+  json += '"';
+  json += EncodeBase64(value);
+  json += '"';
+}
+
+void DirectWriter::Write(string &json, const Json::Value &value) {
+  appendJson(json, value);
+}
+
+DirectCall::DirectCall(const string &request)
+    : DirectScanner(request.data(), request.data() + request.size()),
+      methodBegin(NULL), methodEnd(NULL), methodId(0), compactMethod(false),
+      idBegin(NULL), idEnd(NULL), paramBegin(NULL), paramEnd(NULL),
+      hasParams(false), firstParam(true), finished(false), failed(false) {}
+
+bool DirectCall::ReadMethod() {
+  SkipWhitespace();
+  if (current < end && *current == '"') {
+    if (!ReadPlainString(methodBegin, methodEnd))
+      return false;
+    methodId = Procedure::CalculateMethodId(
+        string(methodBegin, methodEnd - methodBegin));
+    return true;
+  }
+  // the compact form, ids are positive ints
+  bool isInteger;
+  if (!ReadNumber(methodBegin, isInteger) || !isInteger)
+    return false;
+  methodEnd = current;
+  if (*methodBegin == '-' || *methodBegin == '0' || methodEnd - methodBegin > 10)
+    return false;
+  long long value = 0;
+  for (const char *digit = methodBegin; digit < methodEnd; ++digit)
+    value = value * 10 + (*digit - '0');
+  if (value > 0x7FFFFFFF)
+    return false;
+  methodId = static_cast<int>(value);
+  compactMethod = true;
+  return true;
+}
+
+bool DirectCall::ReadId() {
+  SkipWhitespace();
+  idBegin = current;
+  if (current == end)
+    return false;
+  if (*current == '"') {
+    // only ids the writer echoes unchanged
+    for (++current; current < end; ++current) {
+      if (*current == '"') {
+        idEnd = ++current;
+        return true;
+      }
+      if (*current == '\\' || static_cast<unsigned char>(*current) < 0x20 ||
+          static_cast<unsigned char>(*current) > 0x7E)
+        return false;
+    }
+    return false;
+  }
+  if (end - current >= 4 && memcmp(current, "null", 4) == 0) {
+    current += 4;
+    idEnd = current;
+    return true;
+  }
+  bool isInteger;
+  const char *begin;
+  if (!ReadNumber(begin, isInteger) || !isInteger)
+    return false;
+  idEnd = current;
+  size_t digits = idEnd - idBegin - (*idBegin == '-' ? 1 : 0);
+  return digits <= 18 && !equals(idBegin, idEnd, "-0");
+}
+
+bool DirectCall::ReadEnvelope() {
+  if (!Consume('{'))
+    return false;
+  const char *paramsBegin = NULL;
+  const char *paramsEnd = NULL;
+  bool hasVersion = false;
+  do {
+    const char *key, *keyEnd;
+    if (!ReadPlainString(key, keyEnd) || !Consume(':'))
+      return false;
+    if (equals(key, keyEnd, keyVersion) && !hasVersion) {
+      const char *version, *versionEnd;
+      if (!ReadPlainString(version, versionEnd) ||
+          !equals(version, versionEnd, "2.0"))
+        return false;
+      hasVersion = true;
+    } else if (equals(key, keyEnd, keyMethod) && methodBegin == NULL) {
+      if (!ReadMethod())
+        return false;
+    } else if (equals(key, keyEnd, keyId) && idBegin == NULL) {
+      if (!ReadId())
+        return false;
+    } else if (equals(key, keyEnd, keyParams) && !hasParams) {
+      SkipWhitespace();
+      paramsBegin = current;
+      if (current == end || *current != '{' || !SkipValue())
+        return false;
+      paramsEnd = current;
+      hasParams = true;
+    } else {
+      return false;
+    }
+  } while (Consume(','));
+  if (!Consume('}'))
+    return false;
+  SkipWhitespace();
+  if (current != end || !hasVersion || methodBegin == NULL || idBegin == NULL)
+    return false;
+  if (hasParams) {
+    current = paramsBegin + 1;
+    end = paramsEnd;
+  }
+  return true;
+}
+
+bool DirectCall::IsMethod(const char *name) const {
+  return !compactMethod && equals(methodBegin, methodEnd, name);
+}
+
+bool DirectCall::IsMethod(int id, const char *name) const {
+  return compactMethod ? methodId == id : equals(methodBegin, methodEnd, name);
+}
+
+int DirectCall::GetMethodId() const { return methodId; }
+
+bool DirectCall::NextParam() {
+  if (!hasParams || Consume('}')) {
+    finished = true;
+    return false;
+  }
+  if (!firstParam && !Consume(','))
+    return false;
+  firstParam = false;
+  return ReadPlainString(paramBegin, paramEnd) && Consume(':');
+}
+
+bool DirectCall::IsParam(const char *name) const {
+  return equals(paramBegin, paramEnd, name);
+}
+
+bool DirectCall::Finished() const { return finished; }
+
+void DirectCall::WriteHead(string &response) const {
+  response.assign("{\"id\":");
+  response.append(idBegin, idEnd - idBegin);
+  response.append(",\"jsonrpc\":\"2.0\",\"result\":");
+}
+
+void DirectCall::WriteResult(string &response, bool result) const {
+  WriteHead(response);
+  DirectWriter::Write(response, result);
+  response += "}\n";
+}
+
+void DirectCall::WriteResult(string &response, int result) const {
+  WriteHead(response);
+  DirectWriter::Write(response, result);
+  response += "}\n";
+}
+
+void DirectCall::WriteResult(string &response, double result) const {
+  WriteHead(response);
+  DirectWriter::Write(response, result);
+  response += "}\n";
+}
+
+void DirectCall::WriteResult(string &response, const string &result) const {
+  WriteHead(response);
+  DirectWriter::Write(response, result);
+  response += "}\n";
+}
+
+void DirectCall::WriteResult(string &response,
+                             const Json::Value &result) const {
+  WriteHead(response);
+  DirectWriter::Write(response, result);
+  response += "}\n";
+}
+
+void DirectCall::WriteException(string &response,
+                                const JsonRpcException &exception) const {
+  this->failed = true;
+  Json::Value error;
+  Json::Value id;
+  Json::FastReader reader;
+  reader.parse(idBegin, idEnd, id);
+  error["jsonrpc"] = "2.0";
+  error["error"]["code"] = exception.GetCode();
+  error["error"]["message"] = exception.GetMessage();
+  error["error"]["data"] = exception.GetData();
+  error["id"] = id;
+  Json::FastWriter writer;
+  response = writer.write(error);
+}
+
+bool DirectCall::HasFailed() const { return this->failed; }
+
+DirectRequest::DirectRequest(const char *method, int methodId)
+    : request("{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":"), hasParams(false) {
+  if (methodId != 0)
+    request += Json::valueToString(Json::Int(methodId));
+  else
+    request += Json::valueToQuotedString(method);
+}
+
+void DirectRequest::ParamName(const char *name) {
+  request += hasParams ? "," : ",\"params\":{";
+  hasParams = true;
+  request += Json::valueToQuotedString(name);
+  request += ':';
+}
+
+void DirectRequest::Param(const char *name, bool value) {
+  ParamName(name);
+  DirectWriter::Write(request, value);
+}
+
+void DirectRequest::Param(const char *name, int value) {
+  ParamName(name);
+  DirectWriter::Write(request, value);
+}
+
+void DirectRequest::Param(const char *name, double value) {
+  ParamName(name);
+  DirectWriter::Write(request, value);
+}
+
+void DirectRequest::Param(const char *name, const string &value) {
+  ParamName(name);
+  DirectWriter::Write(request, value);
+}
+
+void DirectRequest::Param(const char *name, const Json::Value &value) {
+  ParamName(name);
+  DirectWriter::Write(request, value);
+}
+
+const string &DirectRequest::Finish() {
+  request += hasParams ? "}}\n" : "}\n";
+  return request;
+}
+
+DirectResponse::DirectResponse(const string &response)
+    : DirectScanner(response.data(), response.data() + response.size()),
+      hasId(false), hasVersion(false) {}
+
+bool DirectResponse::ReadMember(bool &isResult) {
+  const char *key, *keyEnd;
+  if (!ReadPlainString(key, keyEnd) || !Consume(':'))
+    return false;
+  isResult = false;
+  if (equals(key, keyEnd, keyId) && !hasId) {
+    hasId = true;
+    return SkipValue();
+  }
+  if (equals(key, keyEnd, keyVersion) && !hasVersion) {
+    const char *version, *versionEnd;
+    hasVersion = true;
+    return ReadPlainString(version, versionEnd) &&
+           equals(version, versionEnd, "2.0");
+  }
+  // errors and anything unknown take the regular path
+  isResult = equals(key, keyEnd, keyResult);
+  return isResult;
+}
+
+bool DirectResponse::ReadEnvelope() {
+  if (!Consume('{'))
+    return false;
+  do {
+    bool isResult;
+    if (!ReadMember(isResult))
+      return false;
+    if (isResult)
+      return true;
+  } while (Consume(','));
+  return false;
+}
+
+bool DirectResponse::ReadRest() {
+  while (Consume(',')) {
+    bool isResult;
+    if (!ReadMember(isResult) || isResult)
+      return false;
+  }
+  if (!Consume('}'))
+    return false;
+  SkipWhitespace();
+  return current == end && hasId && hasVersion;
+}
@@ -0,0 +1,259 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    directcodec.h
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_DIRECTCODEC_H
+#define JSONRPC_CPP_DIRECTCODEC_H
+
+#include <jsonrpccpp/common/jsonparser.h>
+#include <jsonrpccpp/common/exception.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace jsonrpc {
+
+    /**
+     * @brief Strict JSON scanner behind the stubs generated with --cpp-direct.
+     * Every read returns false on input it does not expect, the caller then
+     * falls back to the Json::Value based path, which handles it exactly as before.
+     */
+    class DirectScanner
+    {
+        public:
+            DirectScanner(const char* begin, const char* end);
+
+            bool Read(bool& value);
+            bool Read(int& value);
+            bool Read(int64_t& value);
+            bool Read(uint64_t& value);
+            bool Read(double& value);
+            bool Read(std::string& value);
+            /**
+             * @brief Reads the base64 string of a JSON_BINARY value.
+             */
+            bool Read(std::vector<uint8_t>& value);
+            /**
+             * @brief Reads any value of the given type via the DOM.
+             */
+            bool Read(Json::Value& value, Json::ValueType type);
+            /**
+             * @brief Reads a struct generated with --cpp-structs.
+             */
+            template <typename T>
+            bool Read(T& value)
+            {
+                return value.ReadDirect(*this);
+            }
+
+        protected:
+            friend class DirectObjectReader;
+
+            const char* current;
+            const char* end;
+
+            void SkipWhitespace();
+            bool Consume(char c);
+            bool ReadPlainString(const char*& begin, const char*& stop);
+            bool ReadNumber(const char*& begin, bool& isInteger);
+            bool ReadInteger(uint64_t& magnitude, bool& negative);
+            bool SkipValue(unsigned depth = 0);
+    };
+
+    /**
+     * @brief Walks the members of an object, used by the structs generated with --cpp-structs.
+     */
+    class DirectObjectReader
+    {
+        public:
+            DirectObjectReader(DirectScanner& scanner);
+
+            /**
+             * @brief Advances to the next member name.
+             * @return false at the end of the object or on unexpected input, see Finished().
+             */
+            bool Next();
+            bool IsMember(const char* name) const;
+
+            /**
+             * @brief true if all members have been read without errors.
+             */
+            bool Finished() const;
+
+        private:
+            DirectScanner& scanner;
+            const char* nameBegin;
+            const char* nameEnd;
+            bool started;
+            bool firstMember;
+            bool finished;
+    };
+
+    /**
+     * @brief Appends values in the form the Json::FastWriter writes them.
+     */
+    class DirectWriter
+    {
+        public:
+            static void Write(std::string& json, bool value);
+            static void Write(std::string& json, int value);
+            static void Write(std::string& json, int64_t value);
+            static void Write(std::string& json, uint64_t value);
+            static void Write(std::string& json, double value);
+            static void Write(std::string& json, const std::string& value);
+            /**
+             * @brief Writes a JSON_BINARY value as base64 string.
+             */
+            static void Write(std::string& json, const std::vector<uint8_t>& value);
+            static void Write(std::string& json, const Json::Value& value);
+            /**
+             * @brief Writes a struct generated with --cpp-structs.
+             */
+            template <typename T>
+            static void Write(std::string& json, const T& value)
+            {
+                value.WriteDirect(json);
+            }
+    };
+
+    /**
+     * @brief A JSON-RPC 2.0 method call as seen by a server stub generated with --cpp-direct.
+     * Only requests with a plain method name or a method id, an integer, string or null id
+     * and named parameters are accepted, everything else is left to the protocol handler.
+     */
+    class DirectCall : public DirectScanner
+    {
+        public:
+            DirectCall(const std::string& request);
+
+            /**
+             * @brief Parses the request envelope, members may appear in any order.
+             */
+            bool ReadEnvelope();
+
+            bool IsMethod(const char* name) const;
+            /**
+             * @brief true if the request calls the method by the given id or by its name.
+             */
+            bool IsMethod(int id, const char* name) const;
+            /**
+             * @brief The method id of the request, see Procedure::CalculateMethodId.
+             */
+            int GetMethodId() const;
+
+            /**
+             * @brief Advances to the next parameter name.
+             * @return false at the end of the parameters or on unexpected input, see Finished().
+             */
+            bool NextParam();
+            bool IsParam(const char* name) const;
+
+            /**
+             * @brief true if all parameters have been read without errors.
+             */
+            bool Finished() const;
+
+            void WriteResult(std::string& response, bool result) const;
+            void WriteResult(std::string& response, int result) const;
+            void WriteResult(std::string& response, double result) const;
+            void WriteResult(std::string& response, const std::string& result) const;
+            void WriteResult(std::string& response, const Json::Value& result) const;
+            template <typename T>
+            void WriteResult(std::string& response, const T& result) const
+            {
+                WriteHead(response);
+                DirectWriter::Write(response, result);
+                response += "}\n";
+            }
+            /**
+             * @brief Writes the same error response the protocol handler would.
+             */
+            void WriteException(std::string& response, const JsonRpcException& exception) const;
+            /**
+             * @brief true if WriteException has been called.
+             */
+            bool HasFailed() const;
+
+        private:
+            const char* methodBegin;
+            const char* methodEnd;
+            int methodId;
+            bool compactMethod;
+            const char* idBegin;
+            const char* idEnd;
+            const char* paramBegin;
+            const char* paramEnd;
+            bool hasParams;
+            bool firstParam;
+            bool finished;
+            mutable bool failed;
+
+            bool ReadMethod();
+            bool ReadId();
+            void WriteHead(std::string& response) const;
+    };
+
+    /**
+     * @brief Writes the same request text as the Json::Value based jsonrpc::Client.
+     * Parameters have to be passed in the order of their names.
+     */
+    class DirectRequest
+    {
+        public:
+            /**
+             * @param methodId - if not 0 the method is called by this id, see Client::SetCompactRequests.
+             */
+            DirectRequest(const char* method, int methodId = 0);
+
+            void Param(const char* name, bool value);
+            void Param(const char* name, int value);
+            void Param(const char* name, double value);
+            void Param(const char* name, const std::string& value);
+            void Param(const char* name, const Json::Value& value);
+            template <typename T>
+            void Param(const char* name, const T& value)
+            {
+                ParamName(name);
+                DirectWriter::Write(request, value);
+            }
+
+            const std::string& Finish();
+
+        private:
+            std::string request;
+            bool hasParams;
+
+            void ParamName(const char* name);
+    };
+
+    /**
+     * @brief Reads the result of a successful JSON-RPC 2.0 response.
+     * Error responses and any other unexpected input make ReadResult() return false,
+     * the stub then hands the response to jsonrpc::Client::HandleDirectResponse.
+     */
+    class DirectResponse : public DirectScanner
+    {
+        public:
+            DirectResponse(const std::string& response);
+
+            template <typename T>
+            bool ReadResult(T& result)
+            {
+                return ReadEnvelope() && this->Read(result) && ReadRest();
+            }
+
+        private:
+            bool hasId;
+            bool hasVersion;
+
+            bool ReadEnvelope();
+            bool ReadRest();
+            bool ReadMember(bool& isResult);
+    };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_DIRECTCODEC_H
@@ -8,17 +8,36 @@
  ************************************************************************/
 
 #include "procedure.h"
+#include "binarycodec.h"
 #include "errors.h"
 #include "exception.h"
+#include <algorithm>
 #include <cstdarg>
+#include <cstring>
+#include <stdint.h>
 #include <vector>
 
 using namespace std;
 using namespace jsonrpc;
 
+ParameterValues::ParameterValues() : values(inlineValues), count(0) {}
+
+void ParameterValues::Resize(unsigned int size) {
+  if (size > sizeof(this->inlineValues) / sizeof(this->inlineValues[0])) {
+    this->moreValues.resize(size);
+    this->values = &this->moreValues[0];
+  } else {
+    this->values = this->inlineValues;
+  }
+  this->count = size;
+}
+
+const int Procedure::CACHE_UNTIL_INVALIDATED;
+
 Procedure::Procedure()
     : procedureName(""), procedureType(RPC_METHOD), returntype(JSON_BOOLEAN),
-      paramDeclaration(PARAMS_BY_NAME) {}
+      paramDeclaration(PARAMS_BY_NAME), methodId(CalculateMethodId("")),
+      cacheTtl(0) {}
 
 Procedure::Procedure(const string &name, parameterDeclaration_t paramType,
                      jsontype_t returntype, ...) {
@@ -36,6 +55,8 @@ Procedure::Procedure(const string &name, parameterDeclaration_t paramType,
   this->returntype = returntype;
   this->procedureType = RPC_METHOD;
   this->paramDeclaration = paramType;
+  this->methodId = CalculateMethodId(name);
+  this->cacheTtl = 0;
 }
 Procedure::Procedure(const string &name, parameterDeclaration_t paramType,
                      ...) {
@@ -53,17 +74,25 @@ Procedure::Procedure(const string &name, parameterDeclaration_t paramType,
   this->procedureType = RPC_NOTIFICATION;
   this->paramDeclaration = paramType;
   this->returntype = JSON_BOOLEAN;
+  this->methodId = CalculateMethodId(name);
+  this->cacheTtl = 0;
 }
 
 bool Procedure::ValdiateParameters(const Json::Value &parameters) const {
+  ParameterValues values;
+  return this->ValidateParameters(parameters, values);
+}
+bool Procedure::ValidateParameters(const Json::Value &parameters,
+                                   ParameterValues &values) const {
   if (this->parametersName.empty()) {
+    values.Resize(0);
     return true;
   }
   if (parameters.isArray() && this->paramDeclaration == PARAMS_BY_POSITION) {
-    return this->ValidatePositionalParameters(parameters);
+    return this->ValidatePositionalParameters(parameters, values);
   } else if (parameters.isObject() &&
              this->paramDeclaration == PARAMS_BY_NAME) {
-    return this->ValidateNamedParameters(parameters);
+    return this->ValidateNamedParameters(parameters, values);
   } else {
     return false;
   }
@@ -79,9 +108,12 @@ parameterDeclaration_t Procedure::GetParameterDeclarationType() const {
   return this->paramDeclaration;
 }
 jsontype_t Procedure::GetReturnType() const { return this->returntype; }
+int Procedure::GetMethodId() const { return this->methodId; }
+int Procedure::GetCacheTtl() const { return this->cacheTtl; }
 
 void Procedure::SetProcedureName(const string &name) {
   this->procedureName = name;
+  this->methodId = CalculateMethodId(name);
 }
 void Procedure::SetProcedureType(procedure_t type) {
   this->procedureType = type;
@@ -90,37 +122,109 @@ void Procedure::SetReturnType(jsontype_t type) { this->returntype = type; }
 void Procedure::SetParameterDeclarationType(parameterDeclaration_t type) {
   this->paramDeclaration = type;
 }
+void Procedure::SetMethodId(int id) { this->methodId = id; }
+void Procedure::SetCacheTtl(int ttl) { this->cacheTtl = ttl; }
+
+Procedure &Procedure::Cached(int ttl) {
+  this->SetCacheTtl(ttl);
+  return *this;
+}
 
+int Procedure::CalculateMethodId(const string &name) {
+  // FNV-1a, folded to the positive range of an int so that ids fit into any
+  // JSON number representation. Ids must never change for a given name.
+  uint32_t hash = 2166136261u;
+  for (string::const_iterator it = name.begin(); it != name.end(); ++it) {
+    hash ^= static_cast<unsigned char>(*it);
+    hash *= 16777619u;
+  }
+  hash &= 0x7FFFFFFFu;
+  return hash == 0 ? 1 : static_cast<int>(hash);
+}
+
+void Procedure::EncodeBinaryParameters(Json::Value &parameters) const {
+  if (parameters.isObject()) {
+    for (parameterNameList_t::const_iterator it = this->parametersName.begin();
+         it != this->parametersName.end(); ++it) {
+      if (it->second == JSON_BINARY && parameters.isMember(it->first) &&
+          parameters[it->first].isString())
+        parameters[it->first] = EncodeBase64(parameters[it->first].asString());
+    }
+  } else if (parameters.isArray()) {
+    for (Json::ArrayIndex i = 0;
+         i < parameters.size() && i < this->parametersPosition.size(); i++) {
+      if (this->parametersPosition[i] == JSON_BINARY && parameters[i].isString())
+        parameters[i] = EncodeBase64(parameters[i].asString());
+    }
+  }
+}
+bool Procedure::HasBinaryValues() const {
+  if (this->procedureType == RPC_METHOD && this->returntype == JSON_BINARY)
+    return true;
+  for (unsigned int i = 0; i < this->parametersPosition.size(); i++) {
+    if (this->parametersPosition[i] == JSON_BINARY)
+      return true;
+  }
+  return false;
+}
 void Procedure::AddParameter(const string &name, jsontype_t type) {
   this->parametersName[name] = type;
   this->parametersPosition.push_back(type);
 }
 bool Procedure::ValidateNamedParameters(const Json::Value &parameters) const {
-  bool ok = parameters.isObject() || parameters.isNull();
-  for (map<string, jsontype_t>::const_iterator it =
-           this->parametersName.begin();
-       ok == true && it != this->parametersName.end(); ++it) {
-    if (!parameters.isMember(it->first)) {
-      ok = false;
-    } else {
-      ok = this->ValidateSingleParameter(it->second, parameters[it->first]);
-    }
-  }
-  return ok;
+  ParameterValues values;
+  return this->ValidateNamedParameters(parameters, values);
 }
 bool Procedure::ValidatePositionalParameters(
     const Json::Value &parameters) const {
-  bool ok = true;
+  ParameterValues values;
+  return this->ValidatePositionalParameters(parameters, values);
+}
+bool Procedure::ValidateNamedParameters(const Json::Value &parameters,
+                                        ParameterValues &values) const {
+  if (!parameters.isObject())
+    return parameters.isNull() && this->parametersName.empty();
 
+  // the members of a Json::Value and the declared names are both sorted
+  // bytewise, so one merge pass finds all of them
+  values.Resize(static_cast<unsigned int>(this->parametersName.size()));
+  Json::ValueConstIterator member = parameters.begin();
+  unsigned int i = 0;
+  for (parameterNameList_t::const_iterator it = this->parametersName.begin();
+       it != this->parametersName.end(); ++it, ++i) {
+    int comparison = -1;
+    for (; member != parameters.end(); ++member) {
+      const char *end;
+      const char *name = member.memberName(&end);
+      size_t length = static_cast<size_t>(end - name);
+      comparison = memcmp(name, it->first.data(), min(length, it->first.size()));
+      if (comparison == 0)
+        comparison = length < it->first.size() ? -1
+                                               : (length > it->first.size() ? 1 : 0);
+      if (comparison >= 0)
+        break;
+    }
+    if (comparison != 0 || !this->ValidateSingleParameter(it->second, *member))
+      return false;
+    values.values[i] = &*member;
+    ++member;
+  }
+  return true;
+}
+bool Procedure::ValidatePositionalParameters(const Json::Value &parameters,
+                                             ParameterValues &values) const {
   if (parameters.size() != this->parametersPosition.size()) {
     return false;
   }
 
-  for (unsigned int i = 0; ok && i < this->parametersPosition.size(); i++) {
-    ok = this->ValidateSingleParameter(this->parametersPosition.at(i),
-                                       parameters[i]);
+  values.Resize(static_cast<unsigned int>(this->parametersPosition.size()));
+  for (unsigned int i = 0; i < this->parametersPosition.size(); i++) {
+    const Json::Value &value = parameters[i];
+    if (!this->ValidateSingleParameter(this->parametersPosition[i], value))
+      return false;
+    values.values[i] = &value;
   }
-  return ok;
+  return true;
 }
 bool Procedure::ValidateSingleParameter(jsontype_t expectedType,
                                         const Json::Value &value) const {
@@ -150,6 +254,19 @@ bool Procedure::ValidateSingleParameter(jsontype_t expectedType,
     if (!value.isArray())
       ok = false;
     break;
+  case JSON_INTEGER64:
+    if (!value.isInt64())
+      ok = false;
+    break;
+  case JSON_UINTEGER64:
+    if (!value.isUInt64())
+      ok = false;
+    break;
+  case JSON_BINARY:
+    // the stubs reject strings which are no valid base64
+    if (!value.isString())
+      ok = false;
+    break;
   }
   return ok;
 }
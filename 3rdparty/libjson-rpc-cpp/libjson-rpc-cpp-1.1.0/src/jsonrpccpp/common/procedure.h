@@ -12,6 +12,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "jsonparser.h"
 #include "specification.h"
@@ -23,9 +24,40 @@ namespace jsonrpc
 
     typedef enum {PARAMS_BY_NAME, PARAMS_BY_POSITION} parameterDeclaration_t;
 
+    /**
+     * @brief The parameters of a call in the order of Procedure::GetParameters(), collected while
+     * they are validated so that the stubs do not look them up again.
+     * The values point into the validated parameters, which have to outlive them.
+     */
+    class ParameterValues
+    {
+        public:
+            ParameterValues();
+
+            const Json::Value& operator[](unsigned int index) const { return *this->values[index]; }
+            unsigned int size() const { return this->count; }
+
+        private:
+            friend class Procedure;
+
+            ParameterValues(const ParameterValues&);
+            ParameterValues& operator=(const ParameterValues&);
+
+            const Json::Value* inlineValues[32];
+            std::vector<const Json::Value*> moreValues;
+            const Json::Value** values;
+            unsigned int count;
+
+            void Resize(unsigned int size);
+    };
+
     class Procedure
     {
         public:
+            /**
+             * @brief The cache ttl of methods cached until they are invalidated, see Cached().
+             */
+            static const int CACHE_UNTIL_INVALIDATED = -1;
 
             Procedure();
 
@@ -55,6 +87,23 @@ namespace jsonrpc
              */
             bool ValdiateParameters(const Json::Value &parameters) const;
 
+            /**
+             * @brief Validates the parameters like ValdiateParameters and collects them on the way,
+             * named ones with a single pass over the parameter object.
+             * @param values - the parameters in the order of GetParameters(), undefined if validation fails.
+             */
+            bool ValidateParameters(const Json::Value &parameters, ParameterValues &values) const;
+
+            /**
+             * @brief Replaces the raw bytes of JSON_BINARY parameters by their base64 form.
+             * Binary encodings carry them as byte strings, the stubs always expect base64.
+             */
+            void EncodeBinaryParameters(Json::Value &parameters) const;
+
+            /**
+             * @return true if a parameter or the return value is of type JSON_BINARY.
+             */
+            bool HasBinaryValues() const;
 
             //Various get methods.
             const parameterNameList_t&      GetParameters               () const;
@@ -62,12 +111,30 @@ namespace jsonrpc
             const std::string&              GetProcedureName            () const;
             jsontype_t                      GetReturnType               () const;
             parameterDeclaration_t          GetParameterDeclarationType () const;
+            int                             GetMethodId                 () const;
+            int                             GetCacheTtl                 () const;
 
             //Various set methods.
             void                            SetProcedureName            (const std::string &name);
             void                            SetProcedureType            (procedure_t type);
             void                            SetReturnType               (jsontype_t type);
             void                            SetParameterDeclarationType (parameterDeclaration_t type);
+            void                            SetMethodId                 (int id);
+            void                            SetCacheTtl                 (int ttl);
+
+            /**
+             * @brief Marks a side effect free method, its responses are cached by the server.
+             * @param ttl - milliseconds a response is reused, CACHE_UNTIL_INVALIDATED to keep it
+             * until AbstractProtocolHandler::InvalidateCache is called.
+             * @return this procedure, so that stubs can mark it where they bind it.
+             */
+            Procedure&                      Cached                      (int ttl);
+
+            /**
+             * @brief Calculates the numeric id jsonrpcstub assigns to a procedure name.
+             * The id is a 31 bit FNV-1a hash of the name, it is never 0.
+             */
+            static int CalculateMethodId(const std::string& name);
 
 
             /**
@@ -79,6 +146,8 @@ namespace jsonrpc
 
             bool ValidateNamedParameters        (const Json::Value &parameters) const;
             bool ValidatePositionalParameters   (const Json::Value &parameters) const;
+            bool ValidateNamedParameters        (const Json::Value &parameters, ParameterValues &values) const;
+            bool ValidatePositionalParameters   (const Json::Value &parameters, ParameterValues &values) const;
 
         private:
 
@@ -113,6 +182,16 @@ namespace jsonrpc
              */
             parameterDeclaration_t      paramDeclaration;
 
+            /**
+             * @brief methodId the id of the compact request form, 0 if it must not be used.
+             */
+            int                         methodId;
+
+            /**
+             * @brief cacheTtl milliseconds the response of a call is reused, 0 if it is not cached.
+             */
+            int                         cacheTtl;
+
             bool ValidateSingleParameter        (jsontype_t expectedType, const Json::Value &value) const;
     };
 } /* namespace jsonrpc */
@@ -15,6 +15,11 @@
 #define KEY_SPEC_PROCEDURE_NOTIFICATION  "notification" //legacy format -> use name now
 #define KEY_SPEC_PROCEDURE_PARAMETERS    "params"
 #define KEY_SPEC_RETURN_TYPE             "returns"
+#define KEY_SPEC_CACHEABLE               "cacheable"    //true or the time to live in milliseconds
+
+#define KEY_SPEC_TYPE_INT64              "$int64"
+#define KEY_SPEC_TYPE_UINT64             "$uint64"
+#define KEY_SPEC_TYPE_BINARY             "$binary"
 
 namespace jsonrpc
 {
@@ -29,6 +34,10 @@ namespace jsonrpc
 
     /**
      * This enum represents all processable json Types of this framework.
+     * JSON_INTEGER64, JSON_UINTEGER64 and JSON_BINARY are declared in a specification with the
+     * strings "$int64", "$uint64" and "$binary", integers out of the int range infer the 64 bit
+     * types as well. Binary values are base64 strings in JSON and byte strings in CBOR and
+     * MessagePack.
      */
     enum jsontype_t
     {
@@ -37,7 +46,10 @@ namespace jsonrpc
         JSON_INTEGER = 3,
         JSON_REAL = 4,
         JSON_OBJECT = 5,
-        JSON_ARRAY = 6
+        JSON_ARRAY = 6,
+        JSON_INTEGER64 = 7,
+        JSON_UINTEGER64 = 8,
+        JSON_BINARY = 9
     } ;
 }
 
@@ -77,6 +77,8 @@ void SpecificationParser::GetProcedure(Json::Value &signature,
             "Invalid signature types in fileds: " + signature.toStyledString());
       }
     }
+    if (signature.isMember(KEY_SPEC_CACHEABLE))
+      GetCacheTtl(signature, result);
   } else {
     throw JsonRpcException(
         Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX,
@@ -84,6 +86,22 @@ void SpecificationParser::GetProcedure(Json::Value &signature,
             signature.toStyledString());
   }
 }
+void SpecificationParser::GetCacheTtl(Json::Value &signature,
+                                      Procedure &result) {
+  const Json::Value &cacheable = signature[KEY_SPEC_CACHEABLE];
+  // only the results of methods can be reused
+  if (result.GetProcedureType() == RPC_METHOD && cacheable.isBool()) {
+    result.SetCacheTtl(cacheable.asBool() ? Procedure::CACHE_UNTIL_INVALIDATED
+                                          : 0);
+  } else if (result.GetProcedureType() == RPC_METHOD && cacheable.isInt() &&
+             cacheable.asInt() >= 0) {
+    result.SetCacheTtl(cacheable.asInt());
+  } else {
+    throw JsonRpcException(
+        Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX,
+        "Invalid cacheable field: " + signature.toStyledString());
+  }
+}
 void SpecificationParser::GetFileContent(const std::string &filename,
                                          std::string &target) {
   ifstream config(filename.c_str());
@@ -102,13 +120,25 @@ jsontype_t SpecificationParser::toJsonType(Json::Value &val) {
   switch (val.type()) {
   case Json::uintValue:
   case Json::intValue:
-    result = JSON_INTEGER;
+    if (val.isInt())
+      result = JSON_INTEGER;
+    else if (val.isInt64())
+      result = JSON_INTEGER64;
+    else
+      result = JSON_UINTEGER64;
     break;
   case Json::realValue:
     result = JSON_REAL;
     break;
   case Json::stringValue:
-    result = JSON_STRING;
+    if (val.asString() == KEY_SPEC_TYPE_INT64)
+      result = JSON_INTEGER64;
+    else if (val.asString() == KEY_SPEC_TYPE_UINT64)
+      result = JSON_UINTEGER64;
+    else if (val.asString() == KEY_SPEC_TYPE_BINARY)
+      result = JSON_BINARY;
+    else
+      result = JSON_STRING;
     break;
   case Json::booleanValue:
     result = JSON_BOOLEAN;
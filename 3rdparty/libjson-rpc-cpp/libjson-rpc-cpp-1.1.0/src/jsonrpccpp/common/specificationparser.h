@@ -31,6 +31,7 @@ namespace jsonrpc {
 
             static void         GetPositionalParameters (Json::Value &val, Procedure &target);
             static void         GetNamedParameters      (Json::Value &val, Procedure &target);
+            static void         GetCacheTtl             (Json::Value &val, Procedure &target);
             static std::string  GetProcedureName        (Json::Value &signature);
 
     };
@@ -62,6 +62,15 @@ Json::Value SpecificationWriter::toJsonLiteral(jsontype_t type) {
   case JSON_INTEGER:
     literal = 1;
     break;
+  case JSON_INTEGER64:
+    literal = KEY_SPEC_TYPE_INT64;
+    break;
+  case JSON_UINTEGER64:
+    literal = KEY_SPEC_TYPE_UINT64;
+    break;
+  case JSON_BINARY:
+    literal = KEY_SPEC_TYPE_BINARY;
+    break;
   }
   return literal;
 }
@@ -70,6 +79,10 @@ void SpecificationWriter::procedureToJsonValue(const Procedure &procedure,
   target[KEY_SPEC_PROCEDURE_NAME] = procedure.GetProcedureName();
   if (procedure.GetProcedureType() == RPC_METHOD) {
     target[KEY_SPEC_RETURN_TYPE] = toJsonLiteral(procedure.GetReturnType());
+    if (procedure.GetCacheTtl() == Procedure::CACHE_UNTIL_INVALIDATED)
+      target[KEY_SPEC_CACHEABLE] = true;
+    else if (procedure.GetCacheTtl() > 0)
+      target[KEY_SPEC_CACHEABLE] = procedure.GetCacheTtl();
   }
   for (parameterNameList_t::const_iterator it =
            procedure.GetParameters().begin();
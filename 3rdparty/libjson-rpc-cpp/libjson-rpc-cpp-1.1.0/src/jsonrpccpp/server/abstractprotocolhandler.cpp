@@ -8,6 +8,7 @@
  ************************************************************************/
 
 #include "abstractprotocolhandler.h"
+#include "responsecache.h"
 #include <jsonrpccpp/common/errors.h>
 #include <jsonrpccpp/common/jsonparser.h>
 
@@ -16,67 +17,332 @@
 using namespace jsonrpc;
 using namespace std;
 
+namespace {
+thread_local IProcedureObserver *procedureObserver = NULL;
+}
+
 AbstractProtocolHandler::AbstractProtocolHandler(
     IProcedureInvokationHandler &handler)
-    : handler(handler) {}
+    : handler(handler), jsonReader(JSONREADER_CLASSIC), binaryValues(false),
+      responseCache(NULL) {}
 
-AbstractProtocolHandler::~AbstractProtocolHandler() {}
+AbstractProtocolHandler::~AbstractProtocolHandler() {
+  delete this->responseCache;
+}
 
 void AbstractProtocolHandler::AddProcedure(const Procedure &procedure) {
-  this->procedures[procedure.GetProcedureName()] = procedure;
+  Procedure &added = this->procedures[procedure.GetProcedureName()];
+  added = procedure;
+  if (added.HasBinaryValues())
+    this->binaryValues = true;
+  if (added.GetCacheTtl() != 0 && this->responseCache == NULL)
+    this->responseCache = new ResponseCache();
+  if (added.GetMethodId() == 0)
+    return;
+
+  map<int, Procedure *>::iterator it =
+      this->procedureIds.find(added.GetMethodId());
+  if (it == this->procedureIds.end() || it->second == &added) {
+    this->procedureIds[added.GetMethodId()] = &added;
+  } else {
+    // an id shared by two names neither dispatches nor resolves
+    if (it->second != NULL)
+      it->second->SetMethodId(0);
+    it->second = NULL;
+    added.SetMethodId(0);
+  }
+}
+
+Procedure *AbstractProtocolHandler::FindProcedure(const Json::Value &method) {
+  if (method.isString()) {
+    map<string, Procedure>::iterator it =
+        this->procedures.find(method.asString());
+    if (it != this->procedures.end())
+      return &it->second;
+  } else if (method.isInt()) {
+    map<int, Procedure *>::iterator it =
+        this->procedureIds.find(method.asInt());
+    if (it != this->procedureIds.end())
+      return it->second;
+  }
+  return NULL;
+}
+
+IProcedureObserver *
+AbstractProtocolHandler::SetProcedureObserver(IProcedureObserver *observer) {
+  IProcedureObserver *previous = procedureObserver;
+  procedureObserver = observer;
+  return previous;
+}
+
+void AbstractProtocolHandler::NotifyProcedureCall(const Json::Value &request,
+                                                  bool error) {
+  if (procedureObserver == NULL || !request.isObject())
+    return;
+  Procedure *procedure = this->FindProcedure(request[KEY_REQUEST_METHODNAME]);
+  if (procedure != NULL)
+    procedureObserver->OnProcedureCall(*procedure, error);
+}
+
+void AbstractProtocolHandler::NotifyProcedureCall(const Procedure &procedure,
+                                                  bool error) {
+  if (procedureObserver != NULL)
+    procedureObserver->OnProcedureCall(procedure, error);
+}
+
+void AbstractProtocolHandler::NotifyPhase(phase_t phase) {
+  if (procedureObserver != NULL)
+    procedureObserver->OnPhase(phase);
+}
+
+void AbstractProtocolHandler::SetJsonReader(jsonreader_t reader) {
+  this->jsonReader = reader;
+}
+
+void AbstractProtocolHandler::InvalidateCache() {
+  if (this->responseCache != NULL)
+    this->responseCache->Invalidate();
+}
+
+void AbstractProtocolHandler::InvalidateCache(const std::string &method) {
+  if (this->responseCache != NULL)
+    this->responseCache->Invalidate(method);
 }
 
 void AbstractProtocolHandler::HandleRequest(const std::string &request,
-                                            std::string &retValue) {
-  Json::Reader reader;
+                                            Json::Value &resp,
+                                            encoding_t encoding) {
   Json::Value req;
-  Json::Value resp;
-  Json::FastWriter w;
 
-  if (reader.parse(request, req, false)) {
-    this->HandleJsonRequest(req, resp);
+  if (DecodeValue(encoding, request, req, this->jsonReader)) {
+    NotifyPhase(PHASE_PARSED);
+    if (encoding == ENCODING_JSON || !this->binaryValues)
+      this->HandleJsonRequest(req, resp);
+    else
+      this->HandleBinaryRequest(req, resp);
   } else {
+    NotifyPhase(PHASE_PARSED);
     this->WrapError(Json::nullValue, Errors::ERROR_RPC_JSON_PARSE_ERROR,
                     Errors::GetErrorMessage(Errors::ERROR_RPC_JSON_PARSE_ERROR),
                     resp);
   }
+  NotifyPhase(PHASE_DISPATCHED);
+}
+
+void AbstractProtocolHandler::HandleBinaryRequest(Json::Value &request,
+                                                  Json::Value &response) {
+  if (request.isArray()) {
+    for (Json::ArrayIndex i = 0; i < request.size(); i++)
+      this->EncodeBinaryParameters(request[i]);
+  } else {
+    this->EncodeBinaryParameters(request);
+  }
+  this->HandleJsonRequest(request, response);
+  if (request.isArray() && response.isArray()) {
+    for (Json::ArrayIndex i = 0; i < response.size(); i++)
+      this->DecodeBinaryResult(request, response[i]);
+  } else {
+    this->DecodeBinaryResult(request, response);
+  }
+}
+
+void AbstractProtocolHandler::EncodeBinaryParameters(Json::Value &request) {
+  if (!request.isObject() || !request.isMember(KEY_REQUEST_PARAMETERS))
+    return;
+  const Json::Value &constRequest = request;
+  Procedure *proc = this->FindProcedure(constRequest[KEY_REQUEST_METHODNAME]);
+  if (proc != NULL)
+    proc->EncodeBinaryParameters(request[KEY_REQUEST_PARAMETERS]);
+}
+
+void AbstractProtocolHandler::DecodeBinaryResult(const Json::Value &request,
+                                                 Json::Value &response) {
+  const Json::Value &constResponse = response;
+  if (!response.isObject() || !constResponse[KEY_RESPONSE_RESULT].isString())
+    return;
+  // the responses of a batch are matched by id, the first request wins
+  const Json::Value *call = &request;
+  if (request.isArray()) {
+    call = NULL;
+    for (Json::ArrayIndex i = 0; call == NULL && i < request.size(); i++) {
+      if (request[i].isObject() &&
+          request[i][KEY_REQUEST_ID] == constResponse[KEY_REQUEST_ID])
+        call = &request[i];
+    }
+  }
+  if (call == NULL || !call->isObject())
+    return;
+  Procedure *proc = this->FindProcedure((*call)[KEY_REQUEST_METHODNAME]);
+  string bytes;
+  if (proc != NULL && proc->GetProcedureType() == RPC_METHOD &&
+      proc->GetReturnType() == JSON_BINARY &&
+      DecodeBase64(constResponse[KEY_RESPONSE_RESULT].asString(), bytes))
+    response[KEY_RESPONSE_RESULT] = bytes;
+}
+
+bool AbstractProtocolHandler::HandleDirectRequest(const std::string &request,
+                                                  std::string &retValue) {
+  (void)request;
+  (void)retValue;
+  return false;
+}
 
+void AbstractProtocolHandler::HandleRequest(const std::string &request,
+                                            std::string &retValue) {
+  Json::Value resp;
+  Json::FastWriter w;
+
+  if (this->HandleDirectRequest(request, retValue)) {
+    NotifyDirectRequest();
+    return;
+  }
+  if (this->responseCache == NULL)
+    this->HandleRequest(request, resp);
+  else if (this->HandleCachedRequest(request, resp, retValue))
+    return;
   if (resp != Json::nullValue)
     retValue = w.write(resp);
+  NotifyPhase(PHASE_SERIALIZED);
+}
+
+void AbstractProtocolHandler::HandleRequest(const std::string &request,
+                                            std::string &retValue,
+                                            encoding_t encoding) {
+  Json::Value resp;
+
+  this->HandleRequest(request, resp, encoding);
+  if (resp != Json::nullValue)
+    EncodeValue(encoding, resp, retValue);
+  NotifyPhase(PHASE_SERIALIZED);
+}
+
+void AbstractProtocolHandler::HandleRequest(const std::string &request,
+                                            std::ostream &response) {
+  Json::Value resp;
+  Json::FastWriter w;
+  std::string direct;
+
+  if (this->HandleDirectRequest(request, direct)) {
+    NotifyDirectRequest();
+    response.write(direct.data(), direct.size());
+    return;
+  }
+  if (this->responseCache == NULL) {
+    this->HandleRequest(request, resp);
+  } else if (this->HandleCachedRequest(request, resp, direct)) {
+    response.write(direct.data(), direct.size());
+    return;
+  }
+  if (resp != Json::nullValue)
+    w.write(resp, response);
+  NotifyPhase(PHASE_SERIALIZED);
+}
+
+bool AbstractProtocolHandler::HandleCachedRequest(const std::string &request,
+                                                  Json::Value &response,
+                                                  std::string &retValue) {
+  Json::Value req;
+  if (!DecodeValue(ENCODING_JSON, request, req, this->jsonReader)) {
+    this->HandleRequest(request, response);
+    return false;
+  }
+  NotifyPhase(PHASE_PARSED);
+
+  // batches, notifications and invalid calls take the regular path
+  const Json::Value &call = req;
+  Procedure *procedure = NULL;
+  if (call.isObject() && this->ValidateRequestFields(call) &&
+      this->GetRequestType(call) == RPC_METHOD)
+    procedure = this->FindProcedure(call[KEY_REQUEST_METHODNAME]);
+  if (procedure == NULL || procedure->GetCacheTtl() == 0 ||
+      procedure->GetProcedureType() != RPC_METHOD) {
+    this->HandleJsonRequest(req, response);
+    NotifyPhase(PHASE_DISPATCHED);
+    return false;
+  }
+
+  // the writer sorts the members of objects, equal parameters share the key
+  Json::FastWriter writer;
+  writer.omitEndingLineFeed();
+  const std::string params = writer.write(call[KEY_REQUEST_PARAMETERS]);
+  const std::string id = writer.write(call[KEY_REQUEST_ID]);
+  if (this->responseCache->Lookup(*procedure, params, id, retValue)) {
+    this->NotifyProcedureCall(*procedure, false);
+    NotifyPhase(PHASE_DISPATCHED);
+    NotifyPhase(PHASE_SERIALIZED);
+    return true;
+  }
+
+  const uint64_t generation = this->responseCache->GetGeneration();
+  this->HandleJsonRequest(req, response);
+  NotifyPhase(PHASE_DISPATCHED);
+  Json::FastWriter w;
+  retValue = w.write(response);
+  const Json::Value &constResponse = response;
+  if (constResponse.isObject() && constResponse[KEY_RESPONSE_ERROR].isNull())
+    this->responseCache->Store(*procedure, params, id, retValue, generation);
+  NotifyPhase(PHASE_SERIALIZED);
+  return true;
+}
+
+void AbstractProtocolHandler::NotifyDirectRequest() {
+  // parsing, dispatching and writing the response are one step
+  if (procedureObserver != NULL) {
+    procedureObserver->OnPhase(PHASE_DISPATCHED);
+    procedureObserver->OnPhase(PHASE_SERIALIZED);
+  }
+}
+
+void AbstractProtocolHandler::ProcessRequest(const Json::Value &request,
+                                             Json::Value &response) {
+  Procedure &method = *this->FindProcedure(request[KEY_REQUEST_METHODNAME]);
+  ParameterValues values;
+  method.ValidateParameters(request[KEY_REQUEST_PARAMETERS], values);
+  this->ProcessRequest(request, values, response);
 }
 
 void AbstractProtocolHandler::ProcessRequest(const Json::Value &request,
+                                             const ParameterValues &values,
                                              Json::Value &response) {
-  Procedure &method =
-      this->procedures[request[KEY_REQUEST_METHODNAME].asString()];
+  Procedure &method = *this->FindProcedure(request[KEY_REQUEST_METHODNAME]);
+  const Json::Value &params = request[KEY_REQUEST_PARAMETERS];
   Json::Value result;
 
   if (method.GetProcedureType() == RPC_METHOD) {
-    handler.HandleMethodCall(method, request[KEY_REQUEST_PARAMETERS], result);
+    if (method.GetMethodId() == 0 ||
+        !handler.HandleMethodCallById(method.GetMethodId(), values, result))
+      handler.HandleMethodCall(method, params, result);
     this->WrapResult(request, response, result);
   } else {
-    handler.HandleNotificationCall(method, request[KEY_REQUEST_PARAMETERS]);
+    if (method.GetMethodId() == 0 ||
+        !handler.HandleNotificationCallById(method.GetMethodId(), values))
+      handler.HandleNotificationCall(method, params);
     response = Json::nullValue;
   }
 }
 
 int AbstractProtocolHandler::ValidateRequest(const Json::Value &request) {
+  ParameterValues values;
+  return this->ValidateRequest(request, values);
+}
+
+int AbstractProtocolHandler::ValidateRequest(const Json::Value &request,
+                                             ParameterValues &values) {
   int error = 0;
-  Procedure proc;
   if (!this->ValidateRequestFields(request)) {
     error = Errors::ERROR_RPC_INVALID_REQUEST;
   } else {
-    map<string, Procedure>::iterator it =
-        this->procedures.find(request[KEY_REQUEST_METHODNAME].asString());
-    if (it != this->procedures.end()) {
-      proc = it->second;
+    Procedure *found = this->FindProcedure(request[KEY_REQUEST_METHODNAME]);
+    if (found != NULL) {
+      const Procedure &proc = *found;
       if (this->GetRequestType(request) == RPC_METHOD &&
           proc.GetProcedureType() == RPC_NOTIFICATION) {
         error = Errors::ERROR_SERVER_PROCEDURE_IS_NOTIFICATION;
       } else if (this->GetRequestType(request) == RPC_NOTIFICATION &&
                  proc.GetProcedureType() == RPC_METHOD) {
         error = Errors::ERROR_SERVER_PROCEDURE_IS_METHOD;
-      } else if (!proc.ValdiateParameters(request[KEY_REQUEST_PARAMETERS])) {
+      } else if (!proc.ValidateParameters(request[KEY_REQUEST_PARAMETERS],
+                                          values)) {
         error = Errors::ERROR_RPC_INVALID_PARAMS;
       }
     } else {
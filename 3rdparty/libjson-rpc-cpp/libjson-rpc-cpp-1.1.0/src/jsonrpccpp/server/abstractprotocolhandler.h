@@ -12,9 +12,11 @@
 
 #include "iprocedureinvokationhandler.h"
 #include "iclientconnectionhandler.h"
+#include "iprocedureobserver.h"
 #include <map>
 #include <string>
 #include <jsonrpccpp/common/procedure.h>
+#include <jsonrpccpp/common/binarycodec.h>
 
 #define KEY_REQUEST_METHODNAME  "method"
 #define KEY_REQUEST_ID          "id"
@@ -24,6 +26,8 @@
 
 namespace jsonrpc {
 
+    class ResponseCache;
+
     class AbstractProtocolHandler : public IProtocolHandler
     {
         public:
@@ -32,6 +36,23 @@ namespace jsonrpc {
 
             void HandleRequest(const std::string& request, std::string& retValue);
 
+            /**
+             * @brief Streams the serialized response in pieces of at most the
+             * writer's flush size instead of building the response string.
+             */
+            void HandleRequest(const std::string& request, std::ostream& response);
+
+            /**
+             * @brief Handles a request in the given wire encoding, the response
+             * is returned in the same encoding.
+             */
+            void HandleRequest(const std::string& request, std::string& retValue, encoding_t encoding);
+
+            /**
+             * @brief Selects the reader used by HandleRequest, JSONREADER_CLASSIC by default.
+             */
+            void SetJsonReader(jsonreader_t reader);
+
             virtual void AddProcedure(const Procedure& procedure);
 
             virtual void HandleJsonRequest(const Json::Value& request, Json::Value& response) = 0;
@@ -40,12 +61,92 @@ namespace jsonrpc {
             virtual void WrapError(const Json::Value& request, int code, const std::string &message, Json::Value& result) = 0;
             virtual procedure_t GetRequestType(const Json::Value& request) = 0;
 
+            /**
+             * @brief Handles a JSON request via IProcedureInvokationHandler::HandleDirectCall.
+             * @return false if the request has to be parsed into a Json::Value.
+             */
+            virtual bool HandleDirectRequest(const std::string& request, std::string& retValue);
+
+            /**
+             * @brief Sets the observer of the procedures called on the calling thread, NULL
+             * removes it. Without an observer the calls are not looked at.
+             * @return the previous observer.
+             */
+            static IProcedureObserver* SetProcedureObserver(IProcedureObserver* observer);
+
+            /**
+             * @brief Drops the cached responses of all methods, see Procedure::Cached.
+             * Responses of calls still running are not cached.
+             */
+            void InvalidateCache();
+            /**
+             * @brief Drops the cached responses of one method.
+             */
+            void InvalidateCache(const std::string& method);
+
         protected:
             IProcedureInvokationHandler &handler;
             std::map<std::string, Procedure> procedures;
+            /**
+             * @brief Procedures by Procedure::GetMethodId() for the compact request form,
+             * NULL for ids shared by several names.
+             */
+            std::map<int, Procedure*> procedureIds;
+            jsonreader_t jsonReader;
+            /**
+             * @brief true if a procedure has JSON_BINARY parameters or results.
+             */
+            bool binaryValues;
+            /**
+             * @brief The responses of the procedures marked with Procedure::Cached, NULL if
+             * there are none.
+             */
+            ResponseCache* responseCache;
 
+            /**
+             * @brief Looks up the procedure of a method name or a method id.
+             * @return NULL if there is none.
+             */
+            Procedure* FindProcedure(const Json::Value& method);
             void ProcessRequest(const Json::Value &request, Json::Value &retValue);
+            /**
+             * @brief Processes a request validated by ValidateRequest(request, values).
+             */
+            void ProcessRequest(const Json::Value &request, const ParameterValues &values, Json::Value &retValue);
+            void HandleRequest(const std::string& request, Json::Value& response,
+                               encoding_t encoding = ENCODING_JSON);
             int ValidateRequest(const Json::Value &val);
+            /**
+             * @brief Validates the request and collects its parameters for ProcessRequest.
+             */
+            int ValidateRequest(const Json::Value &val, ParameterValues &values);
+            /**
+             * @brief Passes a handled request on to the observer of the thread, if any.
+             */
+            void NotifyProcedureCall(const Json::Value &request, bool error);
+            void NotifyProcedureCall(const Procedure &procedure, bool error);
+            /**
+             * @brief Passes the end of a phase on to the observer of the thread, if any.
+             */
+            static void NotifyPhase(phase_t phase);
+            static void NotifyDirectRequest();
+
+        private:
+            /**
+             * @brief Handles a JSON request, answers calls of cached procedures from
+             * the response cache and caches the responses of the others.
+             * @return true if the serialized response is in retValue, false if it is in
+             * response and still has to be serialized.
+             */
+            bool HandleCachedRequest(const std::string& request, Json::Value& response,
+                                     std::string& retValue);
+            /**
+             * @brief Handles a request of a binary encoding, its byte strings have to be
+             * converted from and to the base64 form of JSON_BINARY values in the model.
+             */
+            void HandleBinaryRequest(Json::Value& request, Json::Value& response);
+            void EncodeBinaryParameters(Json::Value& request);
+            void DecodeBinaryResult(const Json::Value& request, Json::Value& response);
 
     };
 
@@ -28,6 +28,11 @@ namespace jsonrpc
         public:
             typedef void(S::*methodPointer_t)       (const Json::Value &parameter, Json::Value &result);
             typedef void(S::*notificationPointer_t) (const Json::Value &parameter);
+            /**
+             * @brief Methods which take the parameters collected by Procedure::ValidateParameters.
+             */
+            typedef void(S::*valuesMethodPointer_t)       (const ParameterValues &parameter, Json::Value &result);
+            typedef void(S::*valuesNotificationPointer_t) (const ParameterValues &parameter);
 
             AbstractServer(AbstractServerConnector &connector, serverVersion_t type = JSONRPC_SERVER_V2) :
                 connection(connector)
@@ -53,13 +58,29 @@ namespace jsonrpc
 
             virtual void HandleMethodCall(Procedure &proc, const Json::Value& input, Json::Value& output)
             {
-                S* instance = dynamic_cast<S*>(this);
+                S* instance = static_cast<S*>(this);
+                typename std::map<std::string, valuesMethodPointer_t>::const_iterator it = valuesMethods.find(proc.GetProcedureName());
+                if (it != valuesMethods.end())
+                {
+                    ParameterValues values;
+                    proc.ValidateParameters(input, values);
+                    (instance->*it->second)(values, output);
+                    return;
+                }
                 (instance->*methods[proc.GetProcedureName()])(input, output);
             }
 
             virtual void HandleNotificationCall(Procedure &proc, const Json::Value& input)
             {
-                S* instance = dynamic_cast<S*>(this);
+                S* instance = static_cast<S*>(this);
+                typename std::map<std::string, valuesNotificationPointer_t>::const_iterator it = valuesNotifications.find(proc.GetProcedureName());
+                if (it != valuesNotifications.end())
+                {
+                    ParameterValues values;
+                    proc.ValidateParameters(input, values);
+                    (instance->*it->second)(values);
+                    return;
+                }
                 (instance->*notifications[proc.GetProcedureName()])(input);
             }
 
@@ -86,11 +107,35 @@ namespace jsonrpc
                 return false;
             }
 
+            bool bindAndAddMethod(const Procedure& proc, valuesMethodPointer_t pointer)
+            {
+                if(proc.GetProcedureType() == RPC_METHOD && !this->symbolExists(proc.GetProcedureName()))
+                {
+                    this->handler->AddProcedure(proc);
+                    this->valuesMethods[proc.GetProcedureName()] = pointer;
+                    return true;
+                }
+                return false;
+            }
+
+            bool bindAndAddNotification(const Procedure& proc, valuesNotificationPointer_t pointer)
+            {
+                if(proc.GetProcedureType() == RPC_NOTIFICATION && !this->symbolExists(proc.GetProcedureName()))
+                {
+                    this->handler->AddProcedure(proc);
+                    this->valuesNotifications[proc.GetProcedureName()] = pointer;
+                    return true;
+                }
+                return false;
+            }
+
         private:
             AbstractServerConnector                         &connection;
             IProtocolHandler                                *handler;
             std::map<std::string, methodPointer_t>          methods;
             std::map<std::string, notificationPointer_t>    notifications;
+            std::map<std::string, valuesMethodPointer_t>        valuesMethods;
+            std::map<std::string, valuesNotificationPointer_t>  valuesNotifications;
 
             bool symbolExists(const std::string &name)
             {
@@ -98,6 +143,10 @@ namespace jsonrpc
                     return true;
                 if (notifications.find(name) != notifications.end())
                     return true;
+                if (valuesMethods.find(name) != valuesMethods.end())
+                    return true;
+                if (valuesNotifications.find(name) != valuesNotifications.end())
+                    return true;
                 return false;
             }
     };
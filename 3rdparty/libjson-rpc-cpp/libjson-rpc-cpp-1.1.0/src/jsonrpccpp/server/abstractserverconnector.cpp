@@ -25,6 +25,13 @@ void AbstractServerConnector::ProcessRequest(const string &request,
   }
 }
 
+void AbstractServerConnector::ProcessRequest(const string &request,
+                                             std::ostream &response) {
+  if (this->handler != NULL) {
+    this->handler->HandleRequest(request, response);
+  }
+}
+
 void AbstractServerConnector::SetHandler(IClientConnectionHandler *handler) {
   this->handler = handler;
 }
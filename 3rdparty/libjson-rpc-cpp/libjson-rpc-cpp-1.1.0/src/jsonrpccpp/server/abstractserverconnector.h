@@ -35,6 +35,12 @@ public:
 
   void ProcessRequest(const std::string &request, std::string &response);
 
+  /**
+   * Same as ProcessRequest(const std::string&, std::string&), but the response
+   * is serialized into the stream piece by piece.
+   */
+  void ProcessRequest(const std::string &request, std::ostream &response);
+
   void SetHandler(IClientConnectionHandler *handler);
   IClientConnectionHandler *GetHandler();
 
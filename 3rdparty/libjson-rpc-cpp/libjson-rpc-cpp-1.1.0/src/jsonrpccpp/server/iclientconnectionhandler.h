@@ -10,6 +10,7 @@
 #ifndef JSONRPC_CPP_ICLIENTCONNECTIONHANDLER_H
 #define JSONRPC_CPP_ICLIENTCONNECTIONHANDLER_H
 
+#include <ostream>
 #include <string>
 
 namespace jsonrpc
@@ -20,6 +21,18 @@ namespace jsonrpc
             virtual ~IClientConnectionHandler() {}
 
             virtual void HandleRequest(const std::string& request, std::string& retValue) = 0;
+
+            /**
+             * @brief Handles request and writes the response to the given stream.
+             * Handlers that can serialize incrementally override this to avoid
+             * materializing the whole response.
+             */
+            virtual void HandleRequest(const std::string& request, std::ostream& response)
+            {
+                std::string retValue;
+                this->HandleRequest(request, retValue);
+                response.write(retValue.data(), static_cast<std::streamsize>(retValue.size()));
+            }
     };
 
     class IProtocolHandler : public IClientConnectionHandler
@@ -10,6 +10,8 @@
 #ifndef JSONRPC_CPP_IPROCEDUREINVOKATIONHANDLER_H
 #define JSONRPC_CPP_IPROCEDUREINVOKATIONHANDLER_H
 
+#include <string>
+
 namespace Json {
     class Value;
 }
@@ -17,12 +19,33 @@ namespace Json {
 namespace jsonrpc {
 
     class Procedure;
+    class ParameterValues;
+    class DirectCall;
 
     class IProcedureInvokationHandler {
         public:
             virtual ~IProcedureInvokationHandler() {}
             virtual void HandleMethodCall(Procedure& proc, const Json::Value& input, Json::Value& output) = 0;
             virtual void HandleNotificationCall(Procedure& proc, const Json::Value& input) = 0;
+
+            /**
+             * @brief Dispatches a call by Procedure::GetMethodId(), generated stubs switch on their method_ids.
+             * @param input - the parameters collected by Procedure::ValidateParameters.
+             * @return false if the id is unknown, the call is then passed to HandleMethodCall.
+             */
+            virtual bool HandleMethodCallById(int methodId, const ParameterValues& input, Json::Value& output) { (void)methodId; (void)input; (void)output; return false; }
+            virtual bool HandleNotificationCallById(int methodId, const ParameterValues& input) { (void)methodId; (void)input; return false; }
+
+            /**
+             * @brief true if HandleDirectCall is implemented, see jsonrpcstub --cpp-direct.
+             */
+            virtual bool SupportsDirectCalls() const { return false; }
+
+            /**
+             * @brief Handles a method call without building a Json::Value of the request.
+             * @return false if the request has to take the regular path, response is undefined then.
+             */
+            virtual bool HandleDirectCall(DirectCall& call, std::string& response) { (void)call; (void)response; return false; }
     };
 }
 
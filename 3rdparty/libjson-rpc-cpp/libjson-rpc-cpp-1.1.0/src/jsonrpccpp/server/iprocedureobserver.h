@@ -0,0 +1,42 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    iprocedureobserver.h
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_IPROCEDUREOBSERVER_H
+#define JSONRPC_CPP_IPROCEDUREOBSERVER_H
+
+namespace jsonrpc {
+
+    class Procedure;
+
+    /**
+     * @brief The steps of handling a request, requests handled by IProcedureInvokationHandler::HandleDirectCall
+     * are dispatched right after they arrive.
+     */
+    typedef enum {PHASE_PARSED, PHASE_DISPATCHED, PHASE_SERIALIZED} phase_t;
+
+    /**
+     * @brief Notified about every procedure the protocol handlers call on the thread it is
+     * registered for with AbstractProtocolHandler::SetProcedureObserver.
+     */
+    class IProcedureObserver {
+        public:
+            virtual ~IProcedureObserver() {}
+
+            /**
+             * @param error - true if the call was answered with an error, i.e. invalid parameters
+             * or an exception.
+             */
+            virtual void OnProcedureCall(const Procedure& procedure, bool error) = 0;
+
+            /**
+             * @brief Called when the handler of a request has finished a phase.
+             */
+            virtual void OnPhase(phase_t phase) { (void)phase; }
+    };
+}
+
+#endif //JSONRPC_CPP_IPROCEDUREOBSERVER_H
@@ -0,0 +1,86 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    responsecache.cpp
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "responsecache.h"
+
+using namespace jsonrpc;
+using namespace std;
+
+const size_t ResponseCache::MAX_ENTRIES;
+
+ResponseCache::ResponseCache() : generation(0) {}
+
+uint64_t ResponseCache::GetGeneration() const {
+  lock_guard<mutex> guard(this->lock);
+  return this->generation;
+}
+
+bool ResponseCache::Lookup(const Procedure &procedure, const string &params,
+                           const string &id, string &response) const {
+  shared_ptr<const string> cached;
+  size_t idOffset = 0;
+  {
+    lock_guard<mutex> guard(this->lock);
+    map<string, entries_t>::const_iterator method =
+        this->methods.find(procedure.GetProcedureName());
+    if (method == this->methods.end())
+      return false;
+    entries_t::const_iterator entry = method->second.find(params);
+    if (entry == method->second.end() ||
+        (procedure.GetCacheTtl() > 0 &&
+         chrono::steady_clock::now() >= entry->second.expiry))
+      return false;
+    cached = entry->second.response;
+    idOffset = entry->second.idOffset;
+  }
+  response.reserve(cached->size() + id.size());
+  response.assign(*cached, 0, idOffset);
+  response += id;
+  response.append(*cached, idOffset, string::npos);
+  return true;
+}
+
+void ResponseCache::Store(const Procedure &procedure, const string &params,
+                          const string &id, const string &response,
+                          uint64_t generation) {
+  // the responses of both protocol versions start with the id or a null
+  // error, nothing before the id can look like it
+  const string idMember = "\"id\":" + id;
+  size_t idOffset = response.find(idMember);
+  if (idOffset == string::npos)
+    return;
+  idOffset += idMember.size() - id.size();
+
+  Entry entry;
+  entry.response = make_shared<const string>(
+      response.substr(0, idOffset) + response.substr(idOffset + id.size()));
+  entry.idOffset = idOffset;
+  entry.expiry = procedure.GetCacheTtl() > 0
+                     ? chrono::steady_clock::now() +
+                           chrono::milliseconds(procedure.GetCacheTtl())
+                     : chrono::steady_clock::time_point::max();
+
+  lock_guard<mutex> guard(this->lock);
+  if (generation != this->generation)
+    return;
+  entries_t &entries = this->methods[procedure.GetProcedureName()];
+  if (entries.size() >= MAX_ENTRIES && entries.find(params) == entries.end())
+    entries.clear();
+  entries[params] = entry;
+}
+
+void ResponseCache::Invalidate() {
+  lock_guard<mutex> guard(this->lock);
+  this->methods.clear();
+  ++this->generation;
+}
+
+void ResponseCache::Invalidate(const string &method) {
+  lock_guard<mutex> guard(this->lock);
+  this->methods.erase(method);
+  ++this->generation;
+}
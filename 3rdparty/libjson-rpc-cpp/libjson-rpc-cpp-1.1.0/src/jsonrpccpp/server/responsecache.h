@@ -0,0 +1,81 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    responsecache.h
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_RESPONSECACHE_H
+#define JSONRPC_CPP_RESPONSECACHE_H
+
+#include <jsonrpccpp/common/procedure.h>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+namespace jsonrpc {
+
+    /**
+     * @brief The serialized responses of the methods marked with Procedure::Cached by the
+     * parameters of their calls. Responses are stored without their id, a cached response
+     * gets the id of the call it answers. Thread safe.
+     */
+    class ResponseCache
+    {
+        public:
+            /**
+             * @brief The most responses kept per method, storing one more drops the others.
+             */
+            static const size_t MAX_ENTRIES = 1024;
+
+            ResponseCache();
+
+            /**
+             * @brief Changes with every invalidation, see Store.
+             */
+            uint64_t GetGeneration() const;
+
+            /**
+             * @brief Writes the cached response of a call.
+             * @param params - the parameters of the call as written by Json::FastWriter.
+             * @param id - the id of the call as written by Json::FastWriter.
+             * @return false if there is none or it has expired.
+             */
+            bool Lookup(const Procedure& procedure, const std::string& params,
+                        const std::string& id, std::string& response) const;
+
+            /**
+             * @brief Stores the response of a call.
+             * @param generation - GetGeneration() before the call has been processed, the
+             * response is dropped if the cache has been invalidated since.
+             */
+            void Store(const Procedure& procedure, const std::string& params,
+                       const std::string& id, const std::string& response, uint64_t generation);
+
+            void Invalidate();
+            void Invalidate(const std::string& method);
+
+        private:
+            struct Entry
+            {
+                /**
+                 * @brief The response without its id, shared to copy it outside of the lock.
+                 */
+                std::shared_ptr<const std::string> response;
+                size_t idOffset;
+                std::chrono::steady_clock::time_point expiry;
+            };
+            typedef std::unordered_map<std::string, Entry> entries_t;
+
+            mutable std::mutex lock;
+            std::map<std::string, entries_t> methods;
+            uint64_t generation;
+    };
+
+} // namespace jsonrpc
+
+#endif // JSONRPC_CPP_RESPONSECACHE_H
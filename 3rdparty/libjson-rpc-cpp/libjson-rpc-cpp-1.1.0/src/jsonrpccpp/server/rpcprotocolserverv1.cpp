@@ -19,15 +19,19 @@ RpcProtocolServerV1::RpcProtocolServerV1(IProcedureInvokationHandler &handler)
 void RpcProtocolServerV1::HandleJsonRequest(const Json::Value &req,
                                             Json::Value &response) {
   if (req.isObject()) {
-    int error = this->ValidateRequest(req);
+    ParameterValues values;
+    int error = this->ValidateRequest(req, values);
     if (error == 0) {
       try {
-        this->ProcessRequest(req, response);
+        this->ProcessRequest(req, values, response);
+        this->NotifyProcedureCall(req, false);
       } catch (const JsonRpcException &exc) {
         this->WrapException(req, exc, response);
+        this->NotifyProcedureCall(req, true);
       }
     } else {
       this->WrapError(req, error, Errors::GetErrorMessage(error), response);
+      this->NotifyProcedureCall(req, true);
     }
   } else {
     this->WrapError(Json::nullValue, Errors::ERROR_RPC_INVALID_REQUEST,
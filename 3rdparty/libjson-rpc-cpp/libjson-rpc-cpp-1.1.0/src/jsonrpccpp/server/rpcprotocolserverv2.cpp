@@ -9,6 +9,7 @@
 
 #include "rpcprotocolserverv2.h"
 #include <iostream>
+#include <jsonrpccpp/common/directcodec.h>
 #include <jsonrpccpp/common/errors.h>
 
 using namespace std;
@@ -31,17 +32,38 @@ void RpcProtocolServerV2::HandleJsonRequest(const Json::Value &req,
                     response);
   }
 }
+bool RpcProtocolServerV2::HandleDirectRequest(const std::string &request,
+                                              std::string &retValue) {
+  // stubs dispatch direct calls by method id, which is ambiguous once two
+  // registered names share one, see AddProcedure
+  if (!handler.SupportsDirectCalls() ||
+      this->procedureIds.size() != this->procedures.size())
+    return false;
+  DirectCall call(request);
+  if (!call.ReadEnvelope() || !handler.HandleDirectCall(call, retValue))
+    return false;
+  map<int, Procedure *>::const_iterator it =
+      this->procedureIds.find(call.GetMethodId());
+  if (it != this->procedureIds.end() && it->second != NULL)
+    this->NotifyProcedureCall(*it->second, call.HasFailed());
+  return true;
+}
+
 void RpcProtocolServerV2::HandleSingleRequest(const Json::Value &req,
                                               Json::Value &response) {
-  int error = this->ValidateRequest(req);
+  ParameterValues values;
+  int error = this->ValidateRequest(req, values);
   if (error == 0) {
     try {
-      this->ProcessRequest(req, response);
+      this->ProcessRequest(req, values, response);
+      this->NotifyProcedureCall(req, false);
     } catch (const JsonRpcException &exc) {
       this->WrapException(req, exc, response);
+      this->NotifyProcedureCall(req, true);
     }
   } else {
     this->WrapError(req, error, Errors::GetErrorMessage(error), response);
+    this->NotifyProcedureCall(req, true);
   }
 }
 void RpcProtocolServerV2::HandleBatchRequest(const Json::Value &req,
@@ -62,8 +84,10 @@ void RpcProtocolServerV2::HandleBatchRequest(const Json::Value &req,
 bool RpcProtocolServerV2::ValidateRequestFields(const Json::Value &request) {
   if (!request.isObject())
     return false;
+  // besides its name a method may be called by its id, see Procedure::GetMethodId
   if (!(request.isMember(KEY_REQUEST_METHODNAME) &&
-        request[KEY_REQUEST_METHODNAME].isString()))
+        (request[KEY_REQUEST_METHODNAME].isString() ||
+         request[KEY_REQUEST_METHODNAME].isInt())))
     return false;
   if (!(request.isMember(KEY_REQUEST_VERSION) &&
         request[KEY_REQUEST_VERSION].isString() &&
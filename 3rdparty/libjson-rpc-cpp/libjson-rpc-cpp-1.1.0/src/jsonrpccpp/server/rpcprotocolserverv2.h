@@ -34,6 +34,7 @@ namespace jsonrpc
             void WrapError(const Json::Value& request, int code, const std::string &message, Json::Value& result);
             void WrapException(const Json::Value& request, const JsonRpcException &exception, Json::Value& result);
             procedure_t GetRequestType(const Json::Value& request);
+            bool HandleDirectRequest(const std::string& request, std::string& retValue);
 
         private:
             void HandleSingleRequest(const Json::Value& request, Json::Value& response);
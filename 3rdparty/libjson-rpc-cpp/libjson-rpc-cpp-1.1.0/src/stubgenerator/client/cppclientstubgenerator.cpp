@@ -18,12 +18,15 @@
 
 #define TEMPLATE_CPPCLIENT_SIGMETHOD "<returntype> <methodname>(<parameters>) "
 
-#define TEMPLATE_NAMED_ASSIGNMENT "p[\"<paramname>\"] = <paramname>;"
-#define TEMPLATE_POSITION_ASSIGNMENT "p.append(<paramname>);"
+#define TEMPLATE_NAMED_ASSIGNMENT "p[\"<paramname>\"] = <paramvalue>;"
+#define TEMPLATE_POSITION_ASSIGNMENT "p.append(<paramvalue>);"
 
 #define TEMPLATE_METHODCALL                                                    \
-  "Json::Value result = this->CallMethod(\"<name>\",p);"
-#define TEMPLATE_NOTIFICATIONCALL "this->CallNotification(\"<name>\",p);"
+  "Json::Value result = this->CallMethod(method_ids::<id>, \"<name>\",p);"
+#define TEMPLATE_METHODCALL_ASSIGNMENT                                         \
+  "result = this->CallMethod(method_ids::<id>, \"<name>\",p);"
+#define TEMPLATE_NOTIFICATIONCALL                                              \
+  "this->CallNotification(method_ids::<id>, \"<name>\",p);"
 
 #define TEMPLATE_RETURNCHECK "if (result<cast>)"
 #define TEMPLATE_RETURN "return result<cast>;"
@@ -33,13 +36,15 @@ using namespace jsonrpc;
 
 CPPClientStubGenerator::CPPClientStubGenerator(
     const string &stubname, std::vector<Procedure> &procedures,
-    std::ostream &outputstream)
-    : StubGenerator(stubname, procedures, outputstream) {}
+    std::ostream &outputstream, bool direct, const CPPStructs &structs)
+    : StubGenerator(stubname, procedures, outputstream), direct(direct),
+      structs(structs) {}
 
 CPPClientStubGenerator::CPPClientStubGenerator(
     const string &stubname, std::vector<Procedure> &procedures,
-    const string filename)
-    : StubGenerator(stubname, procedures, filename) {}
+    const string filename, bool direct, const CPPStructs &structs)
+    : StubGenerator(stubname, procedures, filename), direct(direct),
+      structs(structs) {}
 
 void CPPClientStubGenerator::generateStub() {
   vector<string> classname = CPPHelper::splitPackages(this->stubname);
@@ -60,6 +65,10 @@ void CPPClientStubGenerator::generateStub() {
                              classname.at(classname.size() - 1)));
   this->writeNewLine();
 
+  this->structs.generateDefinitions(*this, this->direct);
+  CPPHelper::methodIds(*this, this->procedures);
+  this->generateCoalescing();
+
   for (unsigned int i = 0; i < procedures.size(); i++) {
     this->generateMethod(procedures[i]);
   }
@@ -73,9 +82,33 @@ void CPPClientStubGenerator::generateStub() {
   CPPHelper::epilog(*this, this->stubname);
 }
 
+void CPPClientStubGenerator::generateCoalescing() {
+  vector<string> names;
+  for (unsigned int i = 0; i < procedures.size(); i++) {
+    if (procedures[i].GetCacheTtl() != 0)
+      names.push_back(procedures[i].GetProcedureName());
+  }
+  if (names.empty())
+    return;
+
+  this->writeLine("/**");
+  this->writeLine(" * Lets concurrent calls of the methods the specification "
+                  "marks cacheable share one request.");
+  this->writeLine(" */");
+  this->writeLine("void CoalesceCacheableMethods(bool coalesce = true)");
+  this->writeLine("{");
+  this->increaseIndentation();
+  for (unsigned int i = 0; i < names.size(); i++) {
+    this->writeLine("this->SetCoalescing(\"" + names[i] + "\", coalesce);");
+  }
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->writeNewLine();
+}
+
 void CPPClientStubGenerator::generateMethod(Procedure &proc) {
   string procsignature = TEMPLATE_CPPCLIENT_SIGMETHOD;
-  string returntype = CPPHelper::toCppReturntype(proc.GetReturnType());
+  string returntype = this->structs.toCppReturntype(proc);
   if (proc.GetProcedureType() == RPC_NOTIFICATION)
     returntype = "void";
 
@@ -83,19 +116,109 @@ void CPPClientStubGenerator::generateMethod(Procedure &proc) {
   replaceAll2(procsignature, "<methodname>",
               CPPHelper::normalizeString(proc.GetProcedureName()));
   replaceAll2(procsignature, "<parameters>",
-              CPPHelper::generateParameterDeclarationList(proc));
+              this->structs.generateParameterDeclarationList(proc));
 
   this->writeLine(procsignature);
   this->writeLine("{");
   this->increaseIndentation();
 
-  this->writeLine("Json::Value p;");
+  if (this->direct && proc.GetProcedureType() == RPC_METHOD &&
+      proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
+    generateDirectCall(proc);
+  } else {
+    this->writeLine("Json::Value p;");
 
-  generateAssignments(proc);
-  generateProcCall(proc);
+    generateAssignments(proc);
+    generateProcCall(proc);
+  }
+
+  this->decreaseIndentation();
+  this->writeLine("}");
+}
 
+void CPPClientStubGenerator::generateDirectCall(Procedure &proc) {
+  string call;
+  parameterNameList_t list = proc.GetParameters();
+
+  this->writeLine("Json::Value result;");
+  this->writeLine("if (this->IsDirectCallable())");
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("jsonrpc::DirectRequest directRequest(\"" +
+                  proc.GetProcedureName() +
+                  "\", this->UsesCompactRequests() ? method_ids::" +
+                  CPPHelper::normalizeString(proc.GetProcedureName()) +
+                  " : 0);");
+  for (parameterNameList_t::iterator it = list.begin(); it != list.end();
+       ++it) {
+    this->writeLine("directRequest.Param(\"" + it->first + "\", " +
+                    it->first + ");");
+  }
+  this->writeLine("std::string directResponse;");
+  this->writeLine("this->CallDirect(\"" + proc.GetProcedureName() +
+                  "\", directRequest.Finish(), directResponse);");
+  if (CPPHelper::isScalarType(proc.GetReturnType()) ||
+      !this->structs.returnStruct(proc).empty()) {
+    this->writeLine(this->structs.toCppReturntype(proc) + " directResult" +
+                    (this->structs.returnStruct(proc).empty()
+                         ? CPPHelper::toCppInitializer(proc.GetReturnType())
+                         : "") +
+                    ";");
+    this->writeLine("if (jsonrpc::DirectResponse(directResponse)."
+                    "ReadResult(directResult))");
+    this->increaseIndentation();
+    this->writeLine("return directResult;");
+    this->decreaseIndentation();
+  }
+  this->writeLine("this->HandleDirectResponse(directResponse, result);");
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->writeLine("else");
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("Json::Value p;");
+  generateAssignments(proc);
+  call = TEMPLATE_METHODCALL_ASSIGNMENT;
+  replaceAll2(call, "<id>", CPPHelper::normalizeString(proc.GetProcedureName()));
+  this->writeLine(replaceAll(call, "<name>", proc.GetProcedureName()));
   this->decreaseIndentation();
   this->writeLine("}");
+  generateReturn(proc);
+}
+
+void CPPClientStubGenerator::generateReturn(Procedure &proc) {
+  string call;
+  string structname = this->structs.returnStruct(proc);
+  if (proc.GetReturnType() == JSON_BINARY) {
+    this->writeLine("std::vector<uint8_t> binaryResult;");
+    this->writeLine("if (this->DecodeBinary(result, binaryResult))");
+    this->increaseIndentation();
+    this->writeLine("return binaryResult;");
+    this->decreaseIndentation();
+  } else if (structname.empty()) {
+    call = TEMPLATE_RETURNCHECK;
+    replaceAll2(call, "<cast>",
+                CPPHelper::isCppConversion(proc.GetReturnType()));
+    this->writeLine(call);
+    this->increaseIndentation();
+    call = TEMPLATE_RETURN;
+    replaceAll2(call, "<cast>",
+                CPPHelper::toCppConversion(proc.GetReturnType()));
+    this->writeLine(call);
+    this->decreaseIndentation();
+  } else {
+    this->writeLine(structname + " structResult;");
+    this->writeLine("if (structResult.FromJson(result))");
+    this->increaseIndentation();
+    this->writeLine("return structResult;");
+    this->decreaseIndentation();
+  }
+  this->writeLine("else");
+  this->increaseIndentation();
+  this->writeLine("throw "
+                  "jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_"
+                  "INVALID_RESPONSE, result.toStyledString());");
+  this->decreaseIndentation();
 }
 
 void CPPClientStubGenerator::generateAssignments(Procedure &proc) {
@@ -111,6 +234,13 @@ void CPPClientStubGenerator::generateAssignments(Procedure &proc) {
         assignment = TEMPLATE_POSITION_ASSIGNMENT;
       }
       replaceAll2(assignment, "<paramname>", it->first);
+      if (!this->structs.paramStruct(proc, it->first).empty())
+        replaceAll2(assignment, "<paramvalue>", it->first + ".ToJson()");
+      else if (it->second == JSON_BINARY)
+        replaceAll2(assignment, "<paramvalue>",
+                    "this->EncodeBinary(" + it->first + ")");
+      else
+        replaceAll2(assignment, "<paramvalue>", it->first);
       this->writeLine(assignment);
     }
   } else {
@@ -122,25 +252,14 @@ void CPPClientStubGenerator::generateProcCall(Procedure &proc) {
   string call;
   if (proc.GetProcedureType() == RPC_METHOD) {
     call = TEMPLATE_METHODCALL;
+    replaceAll2(call, "<id>",
+                CPPHelper::normalizeString(proc.GetProcedureName()));
     this->writeLine(replaceAll(call, "<name>", proc.GetProcedureName()));
-    call = TEMPLATE_RETURNCHECK;
-    replaceAll2(call, "<cast>",
-                CPPHelper::isCppConversion(proc.GetReturnType()));
-    this->writeLine(call);
-    this->increaseIndentation();
-    call = TEMPLATE_RETURN;
-    replaceAll2(call, "<cast>",
-                CPPHelper::toCppConversion(proc.GetReturnType()));
-    this->writeLine(call);
-    this->decreaseIndentation();
-    this->writeLine("else");
-    this->increaseIndentation();
-    this->writeLine("throw "
-                    "jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_"
-                    "INVALID_RESPONSE, result.toStyledString());");
-    this->decreaseIndentation();
+    generateReturn(proc);
   } else {
     call = TEMPLATE_NOTIFICATIONCALL;
+    replaceAll2(call, "<id>",
+                CPPHelper::normalizeString(proc.GetProcedureName()));
     replaceAll2(call, "<name>", proc.GetProcedureName());
     this->writeLine(call);
   }
@@ -12,6 +12,7 @@
 
 #include "../stubgenerator.h"
 #include "../codegenerator.h"
+#include "../helper/cppstructs.h"
 
 namespace jsonrpc
 {
@@ -20,14 +21,33 @@ namespace jsonrpc
         public:
 
 
-            CPPClientStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, std::ostream& outputstream);
-            CPPClientStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, const std::string filename);
+            CPPClientStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, std::ostream& outputstream, bool direct = false, const CPPStructs& structs = CPPStructs());
+            CPPClientStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, const std::string filename, bool direct = false, const CPPStructs& structs = CPPStructs());
 
             virtual void generateStub();
 
             void generateMethod(Procedure& proc);
             void generateAssignments(Procedure& proc);
             void generateProcCall(Procedure &proc);
+
+            /**
+             * @brief Generates the call via jsonrpc::DirectRequest, taken whenever
+             * jsonrpc::Client::IsDirectCallable() allows it.
+             */
+            void generateDirectCall(Procedure &proc);
+            /**
+             * @brief Generates CoalesceCacheableMethods() if the specification marks methods
+             * cacheable, see jsonrpc::Client::SetCoalescing().
+             */
+            void generateCoalescing();
+            /**
+             * @brief Generates the check and conversion of the Json::Value result.
+             */
+            void generateReturn(Procedure &proc);
+
+        private:
+            bool direct;
+            CPPStructs structs;
     };
 }
 #endif // JSONRPC_CPP_CLIENTSTUBGENERATOR_H
@@ -9,25 +9,54 @@
 
 #include "codegenerator.h"
 
+#include <cstdio>
+
 using namespace jsonrpc;
 using namespace std;
 
 CodeGenerator::CodeGenerator(const ::string &filename)
-    : indentation(0), atBeginning(true) {
-  this->file.open(filename.c_str());
-  this->output = &this->file;
-  this->indentSymbol = "    ";
-}
+    : output(&this->buffer), filename(filename), indentSymbol("    "),
+      indentation(0), atBeginning(true) {}
 
 CodeGenerator::CodeGenerator(::ostream &outputstream)
     : output(&outputstream), indentSymbol("    "), indentation(0),
       atBeginning(true) {}
 
-CodeGenerator::~CodeGenerator() {
-  this->output->flush();
-  if (this->file.is_open()) {
-    this->file.close();
+CodeGenerator::~CodeGenerator() { this->output->flush(); }
+
+const string &CodeGenerator::getFilename() const { return this->filename; }
+
+bool CodeGenerator::writeFile() {
+  if (this->filename.empty())
+    return true;
+  // an unchanged file keeps its timestamp, so nothing including it is rebuilt
+  string content = this->buffer.str();
+  ifstream existing(this->filename.c_str());
+  if (existing) {
+    stringstream current;
+    current << existing.rdbuf();
+    if (current.str() == content)
+      return true;
+    existing.close();
+  }
+
+  string temporary = this->filename + ".tmp";
+  ofstream file(temporary.c_str());
+  file << content;
+  file.close();
+  if (!file) {
+    remove(temporary.c_str());
+    return false;
+  }
+#ifdef _WIN32
+  // rename does not replace existing files on Windows
+  remove(this->filename.c_str());
+#endif
+  if (rename(temporary.c_str(), this->filename.c_str()) != 0) {
+    remove(temporary.c_str());
+    return false;
   }
+  return true;
 }
 
 void CodeGenerator::write(const ::string &line) {
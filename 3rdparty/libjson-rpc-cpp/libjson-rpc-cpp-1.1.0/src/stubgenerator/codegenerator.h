@@ -20,10 +20,20 @@ namespace jsonrpc
     class CodeGenerator
     {
         public:
+            /**
+             * @brief Collects the code in memory until writeFile() is called.
+             */
             CodeGenerator(const std::string &filename);
             CodeGenerator(std::ostream &outputstream);
             virtual ~CodeGenerator();
 
+            /**
+             * @brief Replaces the file with the collected code, only if its content changed.
+             * @return false if the file could not be written, true for generators of streams.
+             */
+            bool writeFile();
+            const std::string& getFilename() const;
+
             void write (const std::string &line);
             void writeLine(const std::string &line);
             void writeNewLine();
@@ -34,7 +44,8 @@ namespace jsonrpc
 
         private:
             std::ostream *output;
-            std::ofstream file;
+            std::ostringstream buffer;
+            std::string filename;
             std::string indentSymbol;
             int indentation;
             bool atBeginning;
@@ -35,6 +35,15 @@ string CPPHelper::toCppType(jsontype_t type, bool isConst, bool isReference) {
   case JSON_STRING:
     result = "std::string";
     break;
+  case JSON_INTEGER64:
+    result = "int64_t";
+    break;
+  case JSON_UINTEGER64:
+    result = "uint64_t";
+    break;
+  case JSON_BINARY:
+    result = "std::vector<uint8_t>";
+    break;
   default:
     result = "Json::Value";
     break;
@@ -62,6 +71,12 @@ string CPPHelper::toCppConversion(jsontype_t type) {
   case JSON_STRING:
     result = ".asString()";
     break;
+  case JSON_INTEGER64:
+    result = ".asInt64()";
+    break;
+  case JSON_UINTEGER64:
+    result = ".asUInt64()";
+    break;
   default:
     result = "";
     break;
@@ -89,6 +104,15 @@ string CPPHelper::toString(jsontype_t type) {
   case JSON_ARRAY:
     result = "jsonrpc::JSON_ARRAY";
     break;
+  case JSON_INTEGER64:
+    result = "jsonrpc::JSON_INTEGER64";
+    break;
+  case JSON_UINTEGER64:
+    result = "jsonrpc::JSON_UINTEGER64";
+    break;
+  case JSON_BINARY:
+    result = "jsonrpc::JSON_BINARY";
+    break;
   }
   return result;
 }
@@ -109,12 +133,32 @@ string CPPHelper::toCppReturntype(jsontype_t type) {
 }
 
 string CPPHelper::toCppParamType(jsontype_t type) {
-  if (type == JSON_ARRAY || type == JSON_OBJECT || type == JSON_STRING)
+  if (type == JSON_ARRAY || type == JSON_OBJECT || type == JSON_STRING ||
+      type == JSON_BINARY)
     return toCppType(type, true, true);
   else
     return toCppType(type, false, false);
 }
 
+bool CPPHelper::isScalarType(jsontype_t type) {
+  return type != JSON_ARRAY && type != JSON_OBJECT;
+}
+
+string CPPHelper::toCppInitializer(jsontype_t type) {
+  switch (type) {
+  case JSON_BOOLEAN:
+    return " = false";
+  case JSON_INTEGER:
+  case JSON_INTEGER64:
+  case JSON_UINTEGER64:
+    return " = 0";
+  case JSON_REAL:
+    return " = 0.0";
+  default:
+    return "";
+  }
+}
+
 string CPPHelper::class2Filename(const string &classname) {
   vector<string> packages = splitPackages(classname);
   string data = packages.at(packages.size() - 1);
@@ -154,6 +198,23 @@ void CPPHelper::prolog(CodeGenerator &cg, const string &stubname) {
   cg.writeNewLine();
 }
 
+void CPPHelper::methodIds(CodeGenerator &cg,
+                          const vector<Procedure> &procedures) {
+  cg.writeLine("struct method_ids");
+  cg.writeLine("{");
+  cg.increaseIndentation();
+  for (vector<Procedure>::const_iterator it = procedures.begin();
+       it != procedures.end(); ++it) {
+    stringstream id;
+    id << it->GetMethodId();
+    cg.writeLine("static constexpr int " + normalizeString(it->GetProcedureName()) +
+                 " = " + id.str() + ";");
+  }
+  cg.decreaseIndentation();
+  cg.writeLine("};");
+  cg.writeNewLine();
+}
+
 void CPPHelper::epilog(CodeGenerator &cg, const string &stubname) {
   string stub_upper = stubname;
   std::transform(stub_upper.begin(), stub_upper.end(), stub_upper.begin(),
@@ -214,6 +275,15 @@ string CPPHelper::isCppConversion(jsontype_t type) {
   case JSON_ARRAY:
     result = ".isArray()";
     break;
+  case JSON_INTEGER64:
+    result = ".isInt64()";
+    break;
+  case JSON_UINTEGER64:
+    result = ".isUInt64()";
+    break;
+  case JSON_BINARY:
+    result = ".isString()";
+    break;
   }
   return result;
 }
@@ -29,6 +29,8 @@ namespace jsonrpc
 
             static std::string toCppReturntype  (jsontype_t type);
             static std::string toCppParamType   (jsontype_t type);
+            static bool        isScalarType     (jsontype_t type);
+            static std::string toCppInitializer (jsontype_t type);
 
             static std::string class2Filename(const std::string &classname);
             static std::vector<std::string> splitPackages(const std::string &classname);
@@ -36,6 +38,11 @@ namespace jsonrpc
             static void prolog(CodeGenerator &cg, const std::string &stubname);
             static void epilog(CodeGenerator &cg, const std::string &stubname);
 
+            /**
+             * @brief Writes the struct method_ids with one constant per procedure, see Procedure::GetMethodId.
+             */
+            static void methodIds(CodeGenerator &cg, const std::vector<Procedure> &procedures);
+
             static int namespaceOpen(CodeGenerator &cg, const std::string &classname);
             static void namespaceClose(CodeGenerator &cg, int depth);
 
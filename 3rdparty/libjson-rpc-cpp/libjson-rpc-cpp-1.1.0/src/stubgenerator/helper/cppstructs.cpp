@@ -0,0 +1,427 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    cppstructs.cpp
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#include "cppstructs.h"
+#include "cpphelper.h"
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <jsonrpccpp/common/exception.h>
+
+using namespace std;
+using namespace jsonrpc;
+
+namespace {
+
+const char *const reservedNames[] = {
+    "ToJson",    "FromJson", "WriteDirect", "ReadDirect", "alignas",
+    "alignof",   "and",      "asm",         "auto",       "bool",
+    "break",     "case",     "catch",       "char",       "class",
+    "const",     "constexpr", "continue",   "decltype",   "default",
+    "delete",    "do",       "double",      "else",       "enum",
+    "explicit",  "export",   "extern",      "false",      "float",
+    "for",       "friend",   "goto",        "if",         "inline",
+    "int",       "long",     "mutable",     "namespace",  "new",
+    "noexcept",  "not",      "nullptr",     "operator",   "or",
+    "private",   "protected", "public",     "register",   "return",
+    "short",     "signed",   "sizeof",      "static",     "struct",
+    "switch",    "template", "this",        "throw",      "true",
+    "try",       "typedef",  "typeid",      "typename",   "union",
+    "unsigned",  "using",    "virtual",     "void",       "volatile",
+    "while",     "xor"};
+
+string returnKey(const string &procedure) { return "r\n" + procedure; }
+
+string paramKey(const string &procedure, const string &param) {
+  return "p\n" + procedure + "\n" + param;
+}
+
+string procedureName(const Json::Value &signature) {
+  if (signature[KEY_SPEC_PROCEDURE_NAME].isString())
+    return signature[KEY_SPEC_PROCEDURE_NAME].asString();
+  if (signature[KEY_SPEC_PROCEDURE_METHOD].isString())
+    return signature[KEY_SPEC_PROCEDURE_METHOD].asString();
+  if (signature[KEY_SPEC_PROCEDURE_NOTIFICATION].isString())
+    return signature[KEY_SPEC_PROCEDURE_NOTIFICATION].asString();
+  return "";
+}
+
+string mask(unsigned bits) {
+  stringstream result;
+  result << "0x" << std::hex << (bits == 32 ? 0xFFFFFFFFu : (1u << bits) - 1u)
+         << "u";
+  return result.str();
+}
+
+} // namespace
+
+void CPPStructs::parse(const string &specification) {
+  Json::Reader reader;
+  Json::Value procedures;
+  if (!reader.parse(specification, procedures) || !procedures.isArray()) {
+    throw JsonRpcException(Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX,
+                           " specification file contains syntax errors");
+  }
+
+  for (Json::ArrayIndex i = 0; i < procedures.size(); ++i) {
+    const Json::Value &signature = procedures[i];
+    if (!signature.isObject())
+      continue;
+    string name = procedureName(signature);
+    string prefix = CPPHelper::normalizeString(name);
+    string shape;
+
+    if (signature.isMember(KEY_SPEC_RETURN_TYPE)) {
+      string structname = inferStruct(signature[KEY_SPEC_RETURN_TYPE],
+                                      prefix + "_result", shape);
+      if (!structname.empty())
+        usages[returnKey(name)] = structname;
+    }
+
+    const Json::Value &params = signature[KEY_SPEC_PROCEDURE_PARAMETERS];
+    // the names SpecificationParser gives to positional parameters
+    for (Json::ArrayIndex j = 0; params.isArray() && j < params.size(); ++j) {
+      stringstream param;
+      param << "param" << std::setfill('0') << std::setw(2) << (j + 1);
+      string structname =
+          inferStruct(params[j], prefix + "_" + param.str(), shape);
+      if (!structname.empty())
+        usages[paramKey(name, param.str())] = structname;
+    }
+    if (params.isObject()) {
+      vector<string> names = params.getMemberNames();
+      for (size_t j = 0; j < names.size(); ++j) {
+        string structname =
+            inferStruct(params[names[j]],
+                        prefix + "_" + CPPHelper::normalizeString(names[j]),
+                        shape);
+        if (!structname.empty())
+          usages[paramKey(name, names[j])] = structname;
+      }
+    }
+  }
+}
+
+string CPPStructs::inferStruct(const Json::Value &value, const string &name,
+                               string &signature) {
+  signature.clear();
+  // one bit per member keeps track of the ones read by ReadDirect
+  if (!value.isObject() || value.empty() || value.size() > 32)
+    return "";
+
+  set<string> identifiers;
+  vector<string> names = value.getMemberNames();
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (names[i].find('\0') != string::npos ||
+        !isIdentifier(CPPHelper::normalizeString(names[i])) ||
+        !identifiers.insert(CPPHelper::normalizeString(names[i])).second ||
+        value[names[i]].isNull() ||
+        value[names[i]] == KEY_SPEC_TYPE_BINARY)
+      return "";
+  }
+  for (vector<struct_t>::const_iterator it = structs.begin();
+       it != structs.end(); ++it) {
+    if (it->name == name)
+      return "";
+  }
+
+  struct_t definition;
+  definition.name = name;
+  string shape = "{";
+  for (size_t i = 0; i < names.size(); ++i) {
+    string identifier = CPPHelper::normalizeString(names[i]);
+    member_t member;
+    member.name = names[i];
+    string type;
+    const Json::Value &example = value[names[i]];
+    switch (example.type()) {
+    case Json::intValue:
+    case Json::uintValue:
+      if (example.isInt()) {
+        member.type = JSON_INTEGER;
+        type = "i";
+      } else if (example.isInt64()) {
+        member.type = JSON_INTEGER64;
+        type = "l";
+      } else {
+        member.type = JSON_UINTEGER64;
+        type = "L";
+      }
+      break;
+    case Json::realValue:
+      member.type = JSON_REAL;
+      type = "d";
+      break;
+    case Json::stringValue:
+      if (example == KEY_SPEC_TYPE_INT64) {
+        member.type = JSON_INTEGER64;
+        type = "l";
+      } else if (example == KEY_SPEC_TYPE_UINT64) {
+        member.type = JSON_UINTEGER64;
+        type = "L";
+      } else {
+        member.type = JSON_STRING;
+        type = "s";
+      }
+      break;
+    case Json::booleanValue:
+      member.type = JSON_BOOLEAN;
+      type = "b";
+      break;
+    case Json::arrayValue:
+      member.type = JSON_ARRAY;
+      type = "a";
+      break;
+    case Json::objectValue:
+      member.type = JSON_OBJECT;
+      member.structname = inferStruct(example, name + "_" + identifier, type);
+      if (member.structname.empty())
+        type = "o";
+      break;
+    default:
+      break;
+    }
+    shape += Json::valueToQuotedString(names[i].c_str()) + ":" + type + ",";
+    definition.members.push_back(member);
+  }
+  shape += "}";
+  signature = shape;
+
+  map<string, string>::const_iterator known = signatures.find(shape);
+  if (known != signatures.end()) {
+    // each use keeps the name derived from it
+    if (known->second != name) {
+      struct_t alias;
+      alias.name = name;
+      alias.alias = known->second;
+      structs.push_back(alias);
+    }
+    return name;
+  }
+  signatures[shape] = name;
+  structs.push_back(definition);
+  return name;
+}
+
+bool CPPStructs::empty() const { return structs.empty(); }
+
+string CPPStructs::returnStruct(const Procedure &proc) const {
+  map<string, string>::const_iterator it =
+      usages.find(returnKey(proc.GetProcedureName()));
+  return it == usages.end() ? "" : it->second;
+}
+
+string CPPStructs::paramStruct(const Procedure &proc,
+                               const string &param) const {
+  map<string, string>::const_iterator it =
+      usages.find(paramKey(proc.GetProcedureName(), param));
+  return it == usages.end() ? "" : it->second;
+}
+
+string CPPStructs::toCppReturntype(const Procedure &proc) const {
+  string structname = returnStruct(proc);
+  return structname.empty() ? CPPHelper::toCppReturntype(proc.GetReturnType())
+                            : structname;
+}
+
+string CPPStructs::toCppParamType(const Procedure &proc,
+                                  const string &param) const {
+  string structname = paramStruct(proc, param);
+  return structname.empty()
+             ? CPPHelper::toCppParamType(proc.GetParameters().at(param))
+             : "const " + structname + "&";
+}
+
+string CPPStructs::toCppType(const Procedure &proc, const string &param) const {
+  string structname = paramStruct(proc, param);
+  return structname.empty()
+             ? CPPHelper::toCppType(proc.GetParameters().at(param))
+             : structname;
+}
+
+string CPPStructs::generateParameterDeclarationList(
+    const Procedure &proc) const {
+  stringstream param_string;
+  const parameterNameList_t &list = proc.GetParameters();
+  for (parameterNameList_t::const_iterator it = list.begin();
+       it != list.end();) {
+    param_string << toCppParamType(proc, it->first) << " " << it->first;
+    if (++it != list.end()) {
+      param_string << ", ";
+    }
+  }
+  return param_string.str();
+}
+
+void CPPStructs::generateDefinitions(CodeGenerator &cg, bool direct) const {
+  for (vector<struct_t>::const_iterator it = structs.begin();
+       it != structs.end(); ++it) {
+    if (it->alias.empty())
+      generateDefinition(cg, *it, direct);
+    else
+      cg.writeLine("typedef " + it->alias + " " + it->name + ";");
+  }
+  if (!structs.empty())
+    cg.writeNewLine();
+}
+
+void CPPStructs::generateDefinition(CodeGenerator &cg,
+                                    const struct_t &definition,
+                                    bool direct) const {
+  const vector<member_t> &members = definition.members;
+  vector<string> identifiers;
+  for (size_t i = 0; i < members.size(); ++i)
+    identifiers.push_back(CPPHelper::normalizeString(members[i].name));
+
+  cg.writeLine("struct " + definition.name);
+  cg.writeLine("{");
+  cg.increaseIndentation();
+  for (size_t i = 0; i < members.size(); ++i) {
+    if (members[i].structname.empty())
+      cg.writeLine(CPPHelper::toCppType(members[i].type) + " " +
+                   identifiers[i] +
+                   CPPHelper::toCppInitializer(members[i].type) + ";");
+    else
+      cg.writeLine(members[i].structname + " " + identifiers[i] + ";");
+  }
+  cg.writeNewLine();
+
+  // members are accessed through this, they may shadow any local name
+  cg.writeLine("Json::Value ToJson() const");
+  cg.writeLine("{");
+  cg.increaseIndentation();
+  cg.writeLine("Json::Value value(Json::objectValue);");
+  for (size_t i = 0; i < members.size(); ++i) {
+    cg.writeLine("value[" + toCppLiteral(members[i].name) + "] = this->" +
+                 identifiers[i] +
+                 (members[i].structname.empty() ? "" : ".ToJson()") + ";");
+  }
+  cg.writeLine("return value;");
+  cg.decreaseIndentation();
+  cg.writeLine("}");
+
+  cg.writeLine("bool FromJson(const Json::Value &value)");
+  cg.writeLine("{");
+  cg.increaseIndentation();
+  cg.writeLine("if (!value.isObject())");
+  cg.increaseIndentation();
+  cg.writeLine("return false;");
+  cg.decreaseIndentation();
+  for (size_t i = 0; i < members.size(); ++i) {
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    cg.writeLine("const Json::Value &member = value[" +
+                 toCppLiteral(members[i].name) + "];");
+    if (!members[i].structname.empty()) {
+      cg.writeLine("if (!this->" + identifiers[i] + ".FromJson(member))");
+      cg.increaseIndentation();
+      cg.writeLine("return false;");
+      cg.decreaseIndentation();
+    } else {
+      // ints have to fit, the readers keep larger values as uint or double
+      string check = members[i].type == JSON_INTEGER
+                         ? ".isInt()"
+                         : CPPHelper::isCppConversion(members[i].type);
+      cg.writeLine("if (!member" + check + ")");
+      cg.increaseIndentation();
+      cg.writeLine("return false;");
+      cg.decreaseIndentation();
+      cg.writeLine("this->" + identifiers[i] + " = member" +
+                   CPPHelper::toCppConversion(members[i].type) + ";");
+    }
+    cg.decreaseIndentation();
+    cg.writeLine("}");
+  }
+  cg.writeLine("return true;");
+  cg.decreaseIndentation();
+  cg.writeLine("}");
+
+  if (direct) {
+    cg.writeLine("void WriteDirect(std::string &json) const");
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    // the members in the order of the Json::Value based writers
+    for (size_t i = 0; i < members.size(); ++i) {
+      cg.writeLine("json += " +
+                   toCppLiteral((i == 0 ? "{" : ",") +
+                                Json::valueToQuotedString(
+                                    members[i].name.c_str()) +
+                                ":") +
+                   ";");
+      cg.writeLine("jsonrpc::DirectWriter::Write(json, this->" +
+                   identifiers[i] + ");");
+    }
+    cg.writeLine("json += '}';");
+    cg.decreaseIndentation();
+    cg.writeLine("}");
+
+    cg.writeLine("bool ReadDirect(jsonrpc::DirectScanner &scanner)");
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    cg.writeLine("jsonrpc::DirectObjectReader object(scanner);");
+    cg.writeLine("unsigned found = 0;");
+    cg.writeLine("while (object.Next())");
+    cg.writeLine("{");
+    cg.increaseIndentation();
+    for (size_t i = 0; i < members.size(); ++i) {
+      stringstream bit;
+      bit << "0x" << std::hex << (1u << i) << "u";
+      string read = "this->" + identifiers[i];
+      if (members[i].structname.empty() && members[i].type == JSON_OBJECT)
+        read += ", Json::objectValue";
+      else if (members[i].type == JSON_ARRAY)
+        read += ", Json::arrayValue";
+      cg.writeLine(string(i == 0 ? "if" : "else if") + " (object.IsMember(" +
+                   toCppLiteral(members[i].name) + ") && !(found & " +
+                   bit.str() + ") && scanner.Read(" + read + "))");
+      cg.increaseIndentation();
+      cg.writeLine("found |= " + bit.str() + ";");
+      cg.decreaseIndentation();
+    }
+    cg.writeLine("else");
+    cg.increaseIndentation();
+    cg.writeLine("return false;");
+    cg.decreaseIndentation();
+    cg.decreaseIndentation();
+    cg.writeLine("}");
+    cg.writeLine("return object.Finished() && found == " +
+                 mask(static_cast<unsigned>(members.size())) + ";");
+    cg.decreaseIndentation();
+    cg.writeLine("}");
+  }
+
+  cg.decreaseIndentation();
+  cg.writeLine("};");
+}
+
+bool CPPStructs::isIdentifier(const string &name) {
+  if (name.empty() || (name[0] >= '0' && name[0] <= '9'))
+    return false;
+  for (size_t i = 0; i < sizeof(reservedNames) / sizeof(reservedNames[0]); ++i) {
+    if (name == reservedNames[i])
+      return false;
+  }
+  return true;
+}
+
+string CPPStructs::toCppLiteral(const string &text) {
+  stringstream literal;
+  literal << '"';
+  for (size_t i = 0; i < text.size(); ++i) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c == '"' || c == '\\')
+      literal << '\\' << text[i];
+    else if (c < 0x20 || c >= 0x7F)
+      // octal escapes end after three digits, hex ones would not
+      literal << '\\' << std::oct << std::setw(3) << std::setfill('0')
+              << static_cast<unsigned>(c) << std::dec;
+    else
+      literal << text[i];
+  }
+  literal << '"';
+  return literal.str();
+}
@@ -0,0 +1,83 @@
+/*************************************************************************
+ * libjson-rpc-cpp
+ *************************************************************************
+ * @file    cppstructs.h
+ * @license See attached LICENSE.txt
+ ************************************************************************/
+
+#ifndef JSONRPC_CPP_CPPSTRUCTS_H
+#define JSONRPC_CPP_CPPSTRUCTS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <jsonrpccpp/common/procedure.h>
+#include "../codegenerator.h"
+
+namespace jsonrpc
+{
+    /**
+     * @brief Plain C++ structs inferred from the object shaped parameters and return values of a
+     * specification, enabled with --cpp-structs.
+     * A struct is named after its first use, e.g. GetResult_result or SetResult_oResult, later uses
+     * of the same shape become typedefs of it. Objects which are empty, contain null values or
+     * "$binary" members, more than 32 members or member names which are no valid C++ identifiers
+     * stay Json::Value.
+     */
+    class CPPStructs
+    {
+        public:
+            /**
+             * @brief Infers the structs of all procedures of the specification.
+             */
+            void parse(const std::string& specification);
+
+            bool empty() const;
+
+            /**
+             * @return the struct returned by the procedure, empty if it returns none.
+             */
+            std::string returnStruct(const Procedure& proc) const;
+            /**
+             * @return the struct type of the parameter, empty if it is none.
+             */
+            std::string paramStruct(const Procedure& proc, const std::string& param) const;
+
+            std::string toCppReturntype(const Procedure& proc) const;
+            std::string toCppParamType(const Procedure& proc, const std::string& param) const;
+            std::string toCppType(const Procedure& proc, const std::string& param) const;
+            std::string generateParameterDeclarationList(const Procedure& proc) const;
+
+            /**
+             * @brief Writes the struct definitions, with ReadDirect and WriteDirect for stubs
+             * generated with --cpp-direct.
+             */
+            void generateDefinitions(CodeGenerator& cg, bool direct) const;
+
+        private:
+            struct member_t
+            {
+                std::string name;
+                jsontype_t type;
+                std::string structname;
+            };
+
+            struct struct_t
+            {
+                std::string name;
+                std::string alias;
+                std::vector<member_t> members;
+            };
+
+            std::vector<struct_t> structs;
+            std::map<std::string, std::string> signatures;
+            std::map<std::string, std::string> usages;
+
+            std::string inferStruct(const Json::Value& value, const std::string& name, std::string& signature);
+            void generateDefinition(CodeGenerator& cg, const struct_t& definition, bool direct) const;
+            static bool isIdentifier(const std::string& name);
+            static std::string toCppLiteral(const std::string& text);
+    };
+}
+
+#endif // JSONRPC_CPP_CPPSTRUCTS_H
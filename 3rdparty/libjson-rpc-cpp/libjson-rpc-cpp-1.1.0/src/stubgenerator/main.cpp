@@ -16,15 +16,5 @@ using namespace std;
 using namespace jsonrpc;
 
 int main(int argc, char **argv) {
-  vector<StubGenerator *> stubgens;
-  vector<Procedure> procedures;
-
-  bool result = StubGeneratorFactory::createStubGenerators(
-      argc, argv, procedures, stubgens, stdout, stderr);
-
-  for (unsigned int i = 0; i < stubgens.size(); ++i) {
-    stubgens[i]->generateStub();
-  }
-  StubGeneratorFactory::deleteStubGenerators(stubgens);
-  return !result;
+  return !StubGeneratorFactory::generateStubs(argc, argv, stdout, stderr);
 }
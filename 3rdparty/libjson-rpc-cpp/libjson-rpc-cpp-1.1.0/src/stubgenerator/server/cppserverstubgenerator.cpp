@@ -16,24 +16,40 @@
 
 #define TEMPLATE_CPPSERVER_METHODBINDING                                       \
   "this->bindAndAddMethod(jsonrpc::Procedure(\"<rawprocedurename>\", "         \
-  "<paramtype>, <returntype>, <parameterlist> NULL), "                         \
+  "<paramtype>, <returntype>, <parameterlist> NULL)<cached>, "                 \
   "&<stubname>::<procedurename>I);"
 #define TEMPLATE_CPPSERVER_NOTIFICATIONBINDING                                 \
   "this->bindAndAddNotification(jsonrpc::Procedure(\"<rawprocedurename>\", "   \
   "<paramtype>, <parameterlist> NULL), &<stubname>::<procedurename>I);"
 
 #define TEMPLATE_CPPSERVER_SIGCLASS                                            \
-  "class <stubname> : public jsonrpc::AbstractServer<<stubname>>"
+  "class <stubname> : public jsonrpc::AbstractServer<<stubtype>>"
 #define TEMPLATE_CPPSERVER_SIGCONSTRUCTOR                                      \
   "<stubname>(jsonrpc::AbstractServerConnector &conn, "                        \
   "jsonrpc::serverVersion_t type = jsonrpc::JSONRPC_SERVER_V2) : "             \
-  "jsonrpc::AbstractServer<<stubname>>(conn, type)"
+  "jsonrpc::AbstractServer<<stubtype>>(conn, type)"
+#define TEMPLATE_CPPSERVER_SIGTEMPLATE "template <class Implementation>"
+#define TEMPLATE_CPPSERVER_STATICTYPE "<stubname><Implementation>"
+#define TEMPLATE_CPPSERVER_STATICINSTANCE                                      \
+  "static_cast<Implementation *>(this)->"
 
 #define TEMPLATE_CPPSERVER_SIGMETHOD                                           \
-  "inline virtual void <procedurename>I(const Json::Value &request, "          \
-  "Json::Value &response)"
+  "inline virtual void <procedurename>I("                                      \
+  "const jsonrpc::ParameterValues &request, Json::Value &response)"
 #define TEMPLATE_CPPSERVER_SIGNOTIFICATION                                     \
-  "inline virtual void <procedurename>I(const Json::Value &request)"
+  "inline virtual void <procedurename>I("                                      \
+  "const jsonrpc::ParameterValues &request)"
+
+#define TEMPLATE_CPPSERVER_SIGMETHODBYID                                       \
+  "inline virtual bool HandleMethodCallById(int methodId, "                    \
+  "const jsonrpc::ParameterValues &request, Json::Value &response)"
+#define TEMPLATE_CPPSERVER_SIGNOTIFICATIONBYID                                 \
+  "inline virtual bool HandleNotificationCallById(int methodId, "              \
+  "const jsonrpc::ParameterValues &request)"
+
+#define TEMPLATE_CPPSERVER_SIGDIRECTCALL                                       \
+  "inline virtual bool <procedurename>D(jsonrpc::DirectCall &call, "           \
+  "std::string &response)"
 
 #define TEMPLATE_SERVER_ABSTRACTDEFINITION                                     \
   "virtual <returntype> <procedurename>(<parameterlist>) = 0;"
@@ -43,16 +59,23 @@ using namespace jsonrpc;
 
 CPPServerStubGenerator::CPPServerStubGenerator(const std::string &stubname,
                                                vector<Procedure> &procedures,
-                                               ostream &outputstream)
-    : StubGenerator(stubname, procedures, outputstream) {}
+                                               ostream &outputstream,
+                                               bool direct, bool staticDispatch,
+                                               const CPPStructs &structs)
+    : StubGenerator(stubname, procedures, outputstream), direct(direct),
+      staticDispatch(staticDispatch), structs(structs) {}
 
 CPPServerStubGenerator::CPPServerStubGenerator(
     const string &stubname, std::vector<Procedure> &procedures,
     const string &filename, 
-    const string &definition
+    const string &definition,
+    bool direct,
+    bool staticDispatch,
+    const CPPStructs &structs
     )
     : StubGenerator(stubname, procedures, filename),
-    definition(definition) {}
+    definition(definition), direct(direct), staticDispatch(staticDispatch),
+    structs(structs) {}
 
 void CPPServerStubGenerator::generateStub() {
   vector<string> classname = CPPHelper::splitPackages(this->stubname);
@@ -63,14 +86,24 @@ void CPPServerStubGenerator::generateStub() {
 
   int depth = CPPHelper::namespaceOpen(*this, stubname);
 
-  this->writeLine(replaceAll(TEMPLATE_CPPSERVER_SIGCLASS, "<stubname>",
+  string stubtype = classname.at(classname.size() - 1);
+  if (this->staticDispatch) {
+    this->writeLine(TEMPLATE_CPPSERVER_SIGTEMPLATE);
+    stubtype = replaceAll(TEMPLATE_CPPSERVER_STATICTYPE, "<stubname>", stubtype);
+  }
+  string tmp = replaceAll(TEMPLATE_CPPSERVER_SIGCLASS, "<stubtype>", stubtype);
+  this->writeLine(replaceAll(tmp, "<stubname>",
                              classname.at(classname.size() - 1)));
   this->writeLine("{");
   this->increaseIndentation();
   this->writeLine("public:");
   this->increaseIndentation();
 
-  this->writeLine(replaceAll(TEMPLATE_CPPSERVER_SIGCONSTRUCTOR, "<stubname>",
+  this->structs.generateDefinitions(*this, this->direct);
+  CPPHelper::methodIds(*this, this->procedures);
+
+  tmp = replaceAll(TEMPLATE_CPPSERVER_SIGCONSTRUCTOR, "<stubtype>", stubtype);
+  this->writeLine(replaceAll(tmp, "<stubname>",
                              classname.at(classname.size() - 1)));
   this->writeLine("{");
   this->generateBindings();
@@ -79,6 +112,11 @@ void CPPServerStubGenerator::generateStub() {
   this->writeNewLine();
 
   this->generateProcedureDefinitions();
+  this->generateIdDispatch(RPC_METHOD);
+  this->generateIdDispatch(RPC_NOTIFICATION);
+
+  if (this->direct)
+    this->generateDirectCalls();
 
   this->generateAbstractDefinitions();
 
@@ -114,7 +152,23 @@ void CPPServerStubGenerator::generateBindings() {
                 CPPHelper::normalizeString(proc.GetProcedureName()));
     replaceAll2(tmp, "<returntype>", CPPHelper::toString(proc.GetReturnType()));
     replaceAll2(tmp, "<parameterlist>", generateBindingParameterlist(proc));
-    replaceAll2(tmp, "<stubname>", this->stubname);
+    if (proc.GetCacheTtl() == Procedure::CACHE_UNTIL_INVALIDATED) {
+      replaceAll2(tmp, "<cached>",
+                  ".Cached(jsonrpc::Procedure::CACHE_UNTIL_INVALIDATED)");
+    } else if (proc.GetCacheTtl() > 0) {
+      stringstream cached;
+      cached << ".Cached(" << proc.GetCacheTtl() << ")";
+      replaceAll2(tmp, "<cached>", cached.str());
+    } else {
+      replaceAll2(tmp, "<cached>", "");
+    }
+    if (this->staticDispatch) {
+      // the injected class name, the qualified one names the template
+      vector<string> classname = CPPHelper::splitPackages(this->stubname);
+      replaceAll2(tmp, "<stubname>", classname.at(classname.size() - 1));
+    } else {
+      replaceAll2(tmp, "<stubname>", this->stubname);
+    }
 
     if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
       replaceAll2(tmp, "<paramtype>", "jsonrpc::PARAMS_BY_NAME");
@@ -132,31 +186,82 @@ void CPPServerStubGenerator::generateProcedureDefinitions() {
        it != this->procedures.end(); ++it) {
     Procedure &proc = *it;
     if (proc.GetProcedureType() == RPC_METHOD)
-      this->writeLine(
+      this->writeLine(wrapperSignature(
           replaceAll(TEMPLATE_CPPSERVER_SIGMETHOD, "<procedurename>",
-                     CPPHelper::normalizeString(proc.GetProcedureName())));
+                     CPPHelper::normalizeString(proc.GetProcedureName()))));
     else
-      this->writeLine(
+      this->writeLine(wrapperSignature(
           replaceAll(TEMPLATE_CPPSERVER_SIGNOTIFICATION, "<procedurename>",
-                     CPPHelper::normalizeString(proc.GetProcedureName())));
+                     CPPHelper::normalizeString(proc.GetProcedureName()))));
 
     this->writeLine("{");
     this->increaseIndentation();
     if (proc.GetParameters().empty())
       this->writeLine("(void)request;");
+    this->generateConvertedParameters(proc);
 
+    bool binaryResult = proc.GetProcedureType() == RPC_METHOD &&
+                        proc.GetReturnType() == JSON_BINARY;
     if (proc.GetProcedureType() == RPC_METHOD)
-      this->write("response = ");
-    this->write("this->");
+      this->write(binaryResult ? "response = jsonrpc::EncodeBase64("
+                               : "response = ");
+    this->write(this->instance());
     this->write(CPPHelper::normalizeString(proc.GetProcedureName()) + "(");
     this->generateParameterMapping(proc);
-    this->writeLine(");");
+    if (proc.GetProcedureType() == RPC_METHOD &&
+        !this->structs.returnStruct(proc).empty())
+      this->writeLine(").ToJson();");
+    else if (binaryResult)
+      this->writeLine("));");
+    else
+      this->writeLine(");");
 
     this->decreaseIndentation();
     this->writeLine("}");
   }
 }
 
+void CPPServerStubGenerator::generateIdDispatch(procedure_t type) {
+  vector<Procedure *> dispatched;
+  for (vector<Procedure>::iterator it = this->procedures.begin();
+       it != this->procedures.end(); ++it) {
+    if (it->GetProcedureType() == type)
+      dispatched.push_back(&*it);
+  }
+  if (dispatched.empty())
+    return;
+
+  if (type == RPC_METHOD)
+    this->writeLine(TEMPLATE_CPPSERVER_SIGMETHODBYID);
+  else
+    this->writeLine(TEMPLATE_CPPSERVER_SIGNOTIFICATIONBYID);
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("switch (methodId)");
+  this->writeLine("{");
+  this->increaseIndentation();
+  for (vector<Procedure *>::iterator it = dispatched.begin();
+       it != dispatched.end(); ++it) {
+    string procedurename =
+        CPPHelper::normalizeString((*it)->GetProcedureName());
+    this->writeLine("case method_ids::" + procedurename + ":");
+    this->increaseIndentation();
+    this->writeLine("this->" + procedurename +
+                    (type == RPC_METHOD ? "I(request, response);"
+                                        : "I(request);"));
+    this->writeLine("return true;");
+    this->decreaseIndentation();
+  }
+  this->writeLine("default:");
+  this->increaseIndentation();
+  this->writeLine("return false;");
+  this->decreaseIndentation();
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->decreaseIndentation();
+  this->writeLine("}");
+}
+
 void CPPServerStubGenerator::generateAbstractDefinitions() {
   string tmp;
   for (vector<Procedure>::iterator it = this->procedures.begin();
@@ -165,13 +270,13 @@ void CPPServerStubGenerator::generateAbstractDefinitions() {
     tmp = TEMPLATE_SERVER_ABSTRACTDEFINITION;
     string returntype = "void";
     if (proc.GetProcedureType() == RPC_METHOD) {
-      returntype = CPPHelper::toCppReturntype(proc.GetReturnType());
+      returntype = this->structs.toCppReturntype(proc);
     }
     replaceAll2(tmp, "<returntype>", returntype);
     replaceAll2(tmp, "<procedurename>",
                 CPPHelper::normalizeString(proc.GetProcedureName()));
     replaceAll2(tmp, "<parameterlist>",
-                CPPHelper::generateParameterDeclarationList(proc));
+                this->structs.generateParameterDeclarationList(proc));
     this->writeLine(tmp);
   }
 }
@@ -194,10 +299,12 @@ void CPPServerStubGenerator::generateParameterMapping(Procedure &proc) {
   int i = 0;
   for (parameterNameList_t::const_iterator it2 = params.begin();
        it2 != params.end(); ++it2) {
-    if (proc.GetParameterDeclarationType() == PARAMS_BY_NAME) {
-      tmp = "request[\"" + it2->first + "\"]" +
-            CPPHelper::toCppConversion(it2->second);
+    if (!this->structs.paramStruct(proc, it2->first).empty()) {
+      tmp = it2->first + "Struct";
+    } else if (it2->second == JSON_BINARY) {
+      tmp = it2->first + "Binary";
     } else {
+      // named and positional parameters alike in the order of GetParameters()
       stringstream tmp2;
       tmp2 << "request[" << i << "u]"
            << CPPHelper::toCppConversion(it2->second);
@@ -211,9 +318,187 @@ void CPPServerStubGenerator::generateParameterMapping(Procedure &proc) {
   }
 }
 
+void CPPServerStubGenerator::generateConvertedParameters(Procedure &proc) {
+  const parameterNameList_t &params = proc.GetParameters();
+  int i = 0;
+  for (parameterNameList_t::const_iterator it = params.begin();
+       it != params.end(); ++it, ++i) {
+    string structname = this->structs.paramStruct(proc, it->first);
+    if (structname.empty() && it->second != JSON_BINARY)
+      continue;
+    stringstream value;
+    value << "request[" << i << "u]";
+    if (structname.empty()) {
+      // the protocol handler passes binary values as base64 in any encoding
+      this->writeLine("std::vector<uint8_t> " + it->first + "Binary;");
+      this->writeLine("if (!jsonrpc::DecodeBase64(" + value.str() +
+                      ".asString(), " + it->first + "Binary))");
+    } else {
+      this->writeLine(structname + " " + it->first + "Struct;");
+      this->writeLine("if (!" + it->first + "Struct.FromJson(" + value.str() +
+                      "))");
+    }
+    this->increaseIndentation();
+    this->writeLine("throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_"
+                    "RPC_INVALID_PARAMS);");
+    this->decreaseIndentation();
+  }
+}
+
 void CPPServerStubGenerator::generateInterfaceDefinition()
 {
     this->write("static constexpr const char* interface_definition =\nR\"(");
     this->write(definition);
     this->writeLine(")\";");
 }
+
+bool CPPServerStubGenerator::isDirectCallable(Procedure &proc) {
+  // one bit per parameter keeps track of the ones already read, cached
+  // methods are left to the response cache of the protocol handler
+  return proc.GetProcedureType() == RPC_METHOD &&
+         proc.GetParameterDeclarationType() == PARAMS_BY_NAME &&
+         proc.GetCacheTtl() == 0 &&
+         proc.GetParameters().size() <= 32;
+}
+
+void CPPServerStubGenerator::generateDirectCalls() {
+  this->writeLine("inline virtual bool SupportsDirectCalls() const");
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("return true;");
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->writeLine("inline virtual bool HandleDirectCall(jsonrpc::DirectCall "
+                  "&call, std::string &response)");
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("switch (call.GetMethodId())");
+  this->writeLine("{");
+  this->increaseIndentation();
+  for (vector<Procedure>::iterator it = this->procedures.begin();
+       it != this->procedures.end(); ++it) {
+    if (!isDirectCallable(*it))
+      continue;
+    string procedurename = CPPHelper::normalizeString(it->GetProcedureName());
+    this->writeLine("case method_ids::" + procedurename + ":");
+    this->increaseIndentation();
+    // the id of a name is a hash, the name itself still has to match
+    this->writeLine("return call.IsMethod(method_ids::" + procedurename +
+                    ", \"" + it->GetProcedureName() + "\") && this->" +
+                    procedurename + "D(call, response);");
+    this->decreaseIndentation();
+  }
+  this->writeLine("default:");
+  this->increaseIndentation();
+  this->writeLine("return false;");
+  this->decreaseIndentation();
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->decreaseIndentation();
+  this->writeLine("}");
+
+  for (vector<Procedure>::iterator it = this->procedures.begin();
+       it != this->procedures.end(); ++it) {
+    if (isDirectCallable(*it))
+      this->generateDirectCall(*it);
+  }
+}
+
+void CPPServerStubGenerator::generateDirectCall(Procedure &proc) {
+  const parameterNameList_t &params = proc.GetParameters();
+  string procedurename = CPPHelper::normalizeString(proc.GetProcedureName());
+
+  this->writeLine(wrapperSignature(replaceAll(
+      TEMPLATE_CPPSERVER_SIGDIRECTCALL, "<procedurename>", procedurename)));
+  this->writeLine("{");
+  this->increaseIndentation();
+
+  for (parameterNameList_t::const_iterator it = params.begin();
+       it != params.end(); ++it) {
+    this->writeLine(
+        this->structs.toCppType(proc, it->first) + " " + it->first +
+        (this->structs.paramStruct(proc, it->first).empty()
+             ? CPPHelper::toCppInitializer(it->second)
+             : "") +
+        ";");
+  }
+
+  stringstream all;
+  all << "0x" << std::hex
+      << (params.size() == 32 ? 0xFFFFFFFFu
+                              : (1u << params.size()) - 1u) << "u";
+  this->writeLine("unsigned found = 0;");
+  this->writeLine("while (call.NextParam())");
+  this->writeLine("{");
+  this->increaseIndentation();
+  unsigned bit = 0;
+  for (parameterNameList_t::const_iterator it = params.begin();
+       it != params.end(); ++it, ++bit) {
+    stringstream mask;
+    mask << "0x" << std::hex << (1u << bit) << "u";
+    string read = it->first;
+    // structs read themselves, other objects and arrays via the DOM
+    bool isStruct = !this->structs.paramStruct(proc, it->first).empty();
+    if (!isStruct && it->second == JSON_OBJECT)
+      read += ", Json::objectValue";
+    else if (!isStruct && it->second == JSON_ARRAY)
+      read += ", Json::arrayValue";
+    this->writeLine((it == params.begin() ? "if" : "else if") +
+                    string(" (call.IsParam(\"") + it->first + "\") && !(found & " +
+                    mask.str() + ") && call.Read(" + read + "))");
+    this->increaseIndentation();
+    this->writeLine("found |= " + mask.str() + ";");
+    this->decreaseIndentation();
+  }
+  if (params.empty()) {
+    this->writeLine("return false;");
+  } else {
+    this->writeLine("else");
+    this->increaseIndentation();
+    this->writeLine("return false;");
+    this->decreaseIndentation();
+  }
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->writeLine("if (!call.Finished() || found != " +
+                  (params.empty() ? string("0") : all.str()) + ")");
+  this->increaseIndentation();
+  this->writeLine("return false;");
+  this->decreaseIndentation();
+
+  this->writeLine("try");
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->write("call.WriteResult(response, " + this->instance() +
+              procedurename + "(");
+  for (parameterNameList_t::const_iterator it = params.begin();
+       it != params.end(); ++it) {
+    if (it != params.begin())
+      this->write(", ");
+    this->write(it->first);
+  }
+  this->writeLine("));");
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->writeLine("catch (const jsonrpc::JsonRpcException &exception)");
+  this->writeLine("{");
+  this->increaseIndentation();
+  this->writeLine("call.WriteException(response, exception);");
+  this->decreaseIndentation();
+  this->writeLine("}");
+  this->writeLine("return true;");
+
+  this->decreaseIndentation();
+  this->writeLine("}");
+}
+
+string CPPServerStubGenerator::instance() const {
+  return this->staticDispatch ? TEMPLATE_CPPSERVER_STATICINSTANCE : "this->";
+}
+
+string CPPServerStubGenerator::wrapperSignature(const string &signature) const {
+  // the wrappers are only called from within the stub and may be inlined
+  return this->staticDispatch
+             ? replaceAll(signature, "inline virtual ", "inline ")
+             : signature;
+}
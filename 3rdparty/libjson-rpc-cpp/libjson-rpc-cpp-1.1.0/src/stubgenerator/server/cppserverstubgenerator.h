@@ -12,25 +12,53 @@
 
 #include "../stubgenerator.h"
 #include "../codegenerator.h"
+#include "../helper/cppstructs.h"
 
 namespace jsonrpc
 {
     class CPPServerStubGenerator : public StubGenerator
     {
         public:
-            CPPServerStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, std::ostream &outputstream);
-            CPPServerStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, const std::string &filename, const std::string &definition);
+            CPPServerStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, std::ostream &outputstream, bool direct = false, bool staticDispatch = false, const CPPStructs& structs = CPPStructs());
+            CPPServerStubGenerator(const std::string& stubname, std::vector<Procedure> &procedures, const std::string &filename, const std::string &definition, bool direct = false, bool staticDispatch = false, const CPPStructs& structs = CPPStructs());
 
             virtual void generateStub();
 
             void generateBindings();
             void generateProcedureDefinitions();
+            /**
+             * @brief Generates HandleMethodCallById or HandleNotificationCallById, a switch on method_ids.
+             */
+            void generateIdDispatch(procedure_t type);
             void generateAbstractDefinitions();
             void generateInterfaceDefinition();
             std::string generateBindingParameterlist(Procedure &proc);
             void generateParameterMapping(Procedure &proc);
+            /**
+             * @brief Generates the conversion of the parameters inferred as struct, see CPPStructs,
+             * and of binary parameters.
+             */
+            void generateConvertedParameters(Procedure &proc);
+
+            /**
+             * @brief Generates HandleDirectCall, which reads the parameters of methods with
+             * named parameters straight from the request text.
+             */
+            void generateDirectCalls();
+            void generateDirectCall(Procedure &proc);
+            static bool isDirectCallable(Procedure &proc);
+
+            /**
+             * @brief The expression calling the user implementation, with staticDispatch the stub is a
+             * template on the implementing class and calls it without virtual dispatch.
+             */
+            std::string instance() const;
+            std::string wrapperSignature(const std::string& signature) const;
 
             std::string definition;
+            bool direct;
+            bool staticDispatch;
+            CPPStructs structs;
     };
 }
 
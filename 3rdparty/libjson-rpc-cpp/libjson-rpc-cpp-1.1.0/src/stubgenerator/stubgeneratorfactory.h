@@ -20,6 +20,12 @@ namespace jsonrpc {
         public:
             static bool createStubGenerators(int argc, char** argv, std::vector<Procedure> &procedures, std::vector<StubGenerator*> &stubgenerators, FILE* _stdout, FILE* _stderr);
             static void deleteStubGenerators(std::vector<StubGenerator*> &stubgenerators);
+
+            /**
+             * @brief Generates the stubs of the command line. With --batch=<file> every line of the
+             * file holds the arguments of one invocation, these are generated in parallel.
+             */
+            static bool generateStubs(int argc, char** argv, FILE* _stdout, FILE* _stderr);
     };
 
 } // namespace jsonrpc
@@ -12,5 +12,6 @@
 # You may add additional accurate notices of copyright ownership.
 #
 find_package(a_util 5.6.1 COMPONENTS result regex REQUIRED)
+find_package(ZLIB REQUIRED)
 include(${CMAKE_CURRENT_LIST_DIR}/stub_generation.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/pkg_rpcTargets.cmake)
@@ -24,11 +24,12 @@ if(NOT TARGET jsonrpcstub)
     )
 endif(NOT TARGET jsonrpcstub)
 
+# Additional arguments are passed to jsonrpcstub, e.g. --cpp-direct
 macro(jsonrpc_generate_client_stub JSON_RPC_DEFINITION_FILE CLIENT_CLASS_NAME CLIENT_FILE_NAME)
     message(STATUS "will generate clientstub to ${CLIENT_FILE_NAME}")
     add_custom_command(OUTPUT ${CLIENT_FILE_NAME}
-                       COMMAND jsonrpcstub ${JSON_RPC_DEFINITION_FILE} --cpp-client=${CLIENT_CLASS_NAME} --cpp-client-file=${CLIENT_FILE_NAME}
-                       DEPENDS ${JSON_RPC_DEFINITION_FILE}
+                       COMMAND jsonrpcstub ${JSON_RPC_DEFINITION_FILE} --cpp-client=${CLIENT_CLASS_NAME} --cpp-client-file=${CLIENT_FILE_NAME} ${ARGN}
+                       DEPENDS ${JSON_RPC_DEFINITION_FILE} jsonrpcstub
                        WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
                        COMMENT "generating json rpc client stub ${CLIENT_FILE_NAME}")
 endmacro(jsonrpc_generate_client_stub)
@@ -36,8 +37,29 @@ endmacro(jsonrpc_generate_client_stub)
 macro(jsonrpc_generate_server_stub JSON_RPC_DEFINITION_FILE SERVER_CLASS_NAME SERVER_FILE_NAME)
     message(STATUS "will generate serverstub to ${SERVER_FILE_NAME}")
     add_custom_command(OUTPUT ${SERVER_FILE_NAME}
-                       COMMAND jsonrpcstub ${JSON_RPC_DEFINITION_FILE} --cpp-server=${SERVER_CLASS_NAME} --cpp-server-file=${SERVER_FILE_NAME}
-                       DEPENDS ${JSON_RPC_DEFINITION_FILE}
+                       COMMAND jsonrpcstub ${JSON_RPC_DEFINITION_FILE} --cpp-server=${SERVER_CLASS_NAME} --cpp-server-file=${SERVER_FILE_NAME} ${ARGN}
+                       DEPENDS ${JSON_RPC_DEFINITION_FILE} jsonrpcstub
                        WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
                        COMMENT "generating json rpc server stub ${SERVER_FILE_NAME}")
 endmacro(jsonrpc_generate_server_stub)
+
+# Generates several stubs with a single jsonrpcstub call, which processes them in parallel.
+# Every entry of STUBS holds the jsonrpcstub arguments of one stub, OUTPUTS lists the generated
+# files and DEPENDS the specification files, e.g.
+#   jsonrpc_generate_stubs(calculator_stubs
+#       STUBS "calculator.json --cpp-client=rpc_stubs::cCalculatorClientStub --cpp-client-file=${CMAKE_CURRENT_BINARY_DIR}/calculatorclientstub.h"
+#             "calculator.json --cpp-server=rpc_stubs::cCalculatorServerStub --cpp-server-file=${CMAKE_CURRENT_BINARY_DIR}/calculatorserverstub.h"
+#       OUTPUTS ${CMAKE_CURRENT_BINARY_DIR}/calculatorclientstub.h ${CMAKE_CURRENT_BINARY_DIR}/calculatorserverstub.h
+#       DEPENDS calculator.json)
+function(jsonrpc_generate_stubs BATCH_NAME)
+    cmake_parse_arguments(JSONRPC_STUBS "" "" "STUBS;OUTPUTS;DEPENDS" ${ARGN})
+    set(BATCH_FILE_NAME ${CMAKE_CURRENT_BINARY_DIR}/${BATCH_NAME}.jsonrpcstub)
+    string(REPLACE ";" "\n" BATCH_CONTENT "${JSONRPC_STUBS_STUBS}")
+    file(GENERATE OUTPUT ${BATCH_FILE_NAME} CONTENT "${BATCH_CONTENT}\n")
+    message(STATUS "will generate stubs of ${BATCH_FILE_NAME}")
+    add_custom_command(OUTPUT ${JSONRPC_STUBS_OUTPUTS}
+                       COMMAND jsonrpcstub --batch=${BATCH_FILE_NAME}
+                       DEPENDS ${BATCH_FILE_NAME} ${JSONRPC_STUBS_DEPENDS} jsonrpcstub
+                       WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+                       COMMENT "generating json rpc stubs of ${BATCH_FILE_NAME}")
+endfunction(jsonrpc_generate_stubs)
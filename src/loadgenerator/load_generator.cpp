@@ -0,0 +1,415 @@
+/**
+ * @file
+ * Load generator implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/jsonparser.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "httplib.h"
+#include "rpc_pkg/impl/url.h"
+#include "load_generator.h"
+
+namespace rpc
+{
+namespace load
+{
+
+tLoadOptions::tLoadOptions()
+    : eMode(eClosedLoop), nClients(1), fRate(1000), fDuration(10), nBatchSize(1), bKeepAlive(false)
+{
+}
+
+tLoadResult::tLoadResult() : nRequests(0), nCalls(0), nErrors(0), fSeconds(0)
+{
+}
+
+namespace
+{
+typedef std::chrono::steady_clock tClock;
+
+uint64_t GetNanoseconds(tClock::duration oDuration)
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(oDuration).count());
+}
+
+/**
+ * Replaces the type placeholders of a specification with values of that type.
+ */
+Json::Value ToExampleValue(const Json::Value& oValue)
+{
+    if (oValue.isString())
+    {
+        const std::string strValue = oValue.asString();
+        if (strValue == "$int64")
+        {
+            return Json::Value(Json::Int64(1));
+        }
+        if (strValue == "$uint64")
+        {
+            return Json::Value(Json::UInt64(1));
+        }
+        if (strValue == "$binary")
+        {
+            return Json::Value("");
+        }
+        return oValue;
+    }
+    if (oValue.isObject())
+    {
+        Json::Value oResult(Json::objectValue);
+        for (Json::ValueConstIterator it = oValue.begin(); it != oValue.end(); ++it)
+        {
+            oResult[it.name()] = ToExampleValue(*it);
+        }
+        return oResult;
+    }
+    if (oValue.isArray())
+    {
+        Json::Value oResult(Json::arrayValue);
+        for (Json::ArrayIndex nIndex = 0; nIndex < oValue.size(); ++nIndex)
+        {
+            oResult.append(ToExampleValue(oValue[nIndex]));
+        }
+        return oResult;
+    }
+    return oValue;
+}
+
+/**
+ * A client of the load generator, with a connection per request or one kept alive.
+ */
+class cConnection
+{
+public:
+    cConnection(const cUrl& oUrl, bool bKeepAlive)
+        : m_strHost(oUrl.GetAuthority().GetHost()),
+          m_nPort(oUrl.GetAuthority().GetPort()),
+          m_bKeepAlive(bKeepAlive),
+          m_nSocket(-1),
+          m_oClient(m_strHost.c_str(), m_nPort)
+    {
+        m_oRequest.method = "POST";
+        m_oRequest.url = "/" + oUrl.GetPath();
+        m_oRequest.set_header("Host", m_strHost.c_str());
+        m_oRequest.set_header("Content-Type", "application/json");
+    }
+
+    ~cConnection()
+    {
+        Close();
+    }
+
+    /**
+     * Sends a request and waits for its response.
+     * @return false if there was no valid response.
+     */
+    bool Send(const std::string& strRequest, std::string& strResponse)
+    {
+        m_oRequest.body = strRequest;
+        httplib::Response oResponse;
+        if (m_bKeepAlive)
+        {
+            // the server closes idle connections, so try once more on a new one
+            if (!SendKeptAlive(oResponse) && !SendKeptAlive(oResponse))
+            {
+                return false;
+            }
+        }
+        else if (!m_oClient.send(m_oRequest, oResponse))
+        {
+            return false;
+        }
+        strResponse.swap(oResponse.body);
+        return oResponse.status == 200;
+    }
+
+private:
+    bool SendKeptAlive(httplib::Response& oResponse)
+    {
+        if (m_nSocket == -1)
+        {
+            m_nSocket = httplib::detail::create_client_socket(m_strHost.c_str(), m_nPort);
+            if (m_nSocket == -1)
+            {
+                return false;
+            }
+        }
+        oResponse = httplib::Response();
+        httplib::detail::write_request(m_nSocket, m_oRequest);
+        if (httplib::detail::read_response_line(m_nSocket, oResponse) &&
+            httplib::detail::read_headers(m_nSocket, oResponse.headers) &&
+            httplib::detail::read_content(m_nSocket, oResponse))
+        {
+            return true;
+        }
+        Close();
+        return false;
+    }
+
+    void Close()
+    {
+        if (m_nSocket != -1)
+        {
+            httplib::detail::close_socket(m_nSocket);
+            m_nSocket = -1;
+        }
+    }
+
+    std::string m_strHost;
+    int m_nPort;
+    bool m_bKeepAlive;
+    socket_t m_nSocket;
+    httplib::Client m_oClient;
+    httplib::Request m_oRequest;
+};
+
+/**
+ * The counters of one client, summed up at the end of the run.
+ */
+struct tClientResult
+{
+    uint64_t nRequests;
+    uint64_t nErrors;
+    cLatencyHistogram oServiceTime;
+    cLatencyHistogram oLatency;
+
+    tClientResult() : nRequests(0), nErrors(0)
+    {
+    }
+};
+
+void RunClient(const tLoadOptions& oOptions,
+               const cUrl& oUrl,
+               const std::vector<std::string>& oRequests,
+               size_t nFirstRequest,
+               tClock::time_point oStart,
+               std::atomic<uint64_t>& nNextTicket,
+               tClientResult& oResult)
+{
+    cConnection oConnection(oUrl, oOptions.bKeepAlive);
+    const tClock::time_point oEnd =
+        oStart + std::chrono::nanoseconds(static_cast<int64_t>(oOptions.fDuration * 1e9));
+    const double fInterval = 1e9 / oOptions.fRate;
+    std::string strResponse;
+    size_t nRequest = nFirstRequest;
+    for (;;)
+    {
+        tClock::time_point oScheduled = tClock::now();
+        if (oOptions.eMode == eOpenLoop)
+        {
+            const uint64_t nTicket = nNextTicket.fetch_add(1, std::memory_order_relaxed);
+            oScheduled =
+                oStart + std::chrono::nanoseconds(static_cast<int64_t>(nTicket * fInterval));
+            if (oScheduled >= oEnd)
+            {
+                break;
+            }
+            std::this_thread::sleep_until(oScheduled);
+            nRequest = static_cast<size_t>(nTicket % oRequests.size());
+        }
+        else if (oScheduled >= oEnd)
+        {
+            break;
+        }
+
+        const tClock::time_point oSent = tClock::now();
+        const bool bValid = oConnection.Send(oRequests[nRequest], strResponse);
+        const tClock::time_point oReceived = tClock::now();
+
+        ++oResult.nRequests;
+        oResult.nErrors += bValid ? CountErrors(strResponse) : 1;
+        oResult.oServiceTime.m_aBuckets[cLatencyHistogram::GetBucket(
+            GetNanoseconds(oReceived - oSent))]++;
+        oResult.oLatency.m_aBuckets[cLatencyHistogram::GetBucket(
+            GetNanoseconds(oReceived - oScheduled))]++;
+        nRequest = (nRequest + 1) % oRequests.size();
+    }
+}
+
+} // namespace
+
+std::vector<std::string> CreateRequests(const std::string& strSpecification,
+                                        const std::vector<std::string>& oMethods,
+                                        size_t nBatchSize)
+{
+    Json::Value oSpecification;
+    if (!jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, strSpecification, oSpecification) ||
+        !oSpecification.isArray())
+    {
+        throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX,
+                                        "specification must be an array of procedures");
+    }
+
+    std::vector<Json::Value> oCalls;
+    for (const Json::Value& oProcedure: oSpecification)
+    {
+        const std::string strName = oProcedure["name"].asString();
+        if (!oMethods.empty() &&
+            std::find(oMethods.begin(), oMethods.end(), strName) == oMethods.end())
+        {
+            continue;
+        }
+        Json::Value oCall(Json::objectValue);
+        oCall["jsonrpc"] = "2.0";
+        oCall["method"] = strName;
+        if (oProcedure.isMember("params"))
+        {
+            oCall["params"] = ToExampleValue(oProcedure["params"]);
+        }
+        // procedures without return value are notifications
+        if (oProcedure.isMember("returns"))
+        {
+            oCall["id"] = 1;
+        }
+        oCalls.push_back(oCall);
+    }
+    if (oCalls.empty())
+    {
+        throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_SERVER_PROCEDURE_SPECIFICATION_SYNTAX,
+                                        "specification contains none of the methods to call");
+    }
+
+    Json::FastWriter oWriter;
+    std::vector<std::string> oRequests;
+    for (size_t nFirstCall = 0; nFirstCall < oCalls.size(); ++nFirstCall)
+    {
+        if (nBatchSize <= 1)
+        {
+            oRequests.push_back(oWriter.write(oCalls[nFirstCall]));
+            continue;
+        }
+        Json::Value oBatch(Json::arrayValue);
+        for (size_t nCall = 0; nCall < nBatchSize; ++nCall)
+        {
+            Json::Value& oCall = oBatch.append(oCalls[(nFirstCall + nCall) % oCalls.size()]);
+            if (oCall.isMember("id"))
+            {
+                oCall["id"] = static_cast<Json::UInt>(nCall + 1);
+            }
+        }
+        oRequests.push_back(oWriter.write(oBatch));
+    }
+    return oRequests;
+}
+
+uint64_t CountErrors(const std::string& strResponse)
+{
+    // requests of notifications only are answered without content
+    if (strResponse.empty())
+    {
+        return 0;
+    }
+    Json::Value oResponse;
+    if (!jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, strResponse, oResponse))
+    {
+        return 1;
+    }
+    if (!oResponse.isArray())
+    {
+        return oResponse.isObject() && !oResponse["error"].isNull() ? 1 : 0;
+    }
+    uint64_t nErrors = 0;
+    for (const Json::Value& oCall: oResponse)
+    {
+        // JSON-RPC 1.0 answers successful calls with "error": null
+        if (!oCall.isObject() || !oCall["error"].isNull())
+        {
+            ++nErrors;
+        }
+    }
+    return nErrors;
+}
+
+cLatencyHistogram CorrectCoordinatedOmission(const cLatencyHistogram& oHistogram,
+                                             uint64_t nExpectedInterval)
+{
+    cLatencyHistogram oCorrected = oHistogram;
+    if (nExpectedInterval == 0)
+    {
+        return oCorrected;
+    }
+    for (size_t nBucket = 0; nBucket < cLatencyHistogram::nBucketCount; ++nBucket)
+    {
+        const uint64_t nCount = oHistogram.m_aBuckets[nBucket];
+        const uint64_t nLatency = cLatencyHistogram::GetBucketLimit(nBucket);
+        if (nCount == 0 || nLatency <= nExpectedInterval)
+        {
+            continue;
+        }
+        // the requests that would have been sent while waiting, each one interval less late
+        for (uint64_t nMissing = nLatency - nExpectedInterval; nMissing >= nExpectedInterval;
+             nMissing -= nExpectedInterval)
+        {
+            oCorrected.m_aBuckets[cLatencyHistogram::GetBucket(nMissing)] += nCount;
+        }
+    }
+    return oCorrected;
+}
+
+tLoadResult GenerateLoad(const tLoadOptions& oOptions, const std::vector<std::string>& oRequests)
+{
+    const cUrl oUrl(oOptions.strUrl);
+    std::vector<tClientResult> oClientResults(std::max<size_t>(oOptions.nClients, 1));
+    std::vector<std::thread> oClients;
+    std::atomic<uint64_t> nNextTicket(0);
+    const tClock::time_point oStart = tClock::now();
+    for (size_t nClient = 0; nClient < oClientResults.size(); ++nClient)
+    {
+        oClients.push_back(std::thread(RunClient,
+                                       std::cref(oOptions),
+                                       std::cref(oUrl),
+                                       std::cref(oRequests),
+                                       nClient % oRequests.size(),
+                                       oStart,
+                                       std::ref(nNextTicket),
+                                       std::ref(oClientResults[nClient])));
+    }
+    for (std::thread& oClient: oClients)
+    {
+        oClient.join();
+    }
+
+    tLoadResult oResult;
+    oResult.fSeconds = std::chrono::duration<double>(tClock::now() - oStart).count();
+    for (const tClientResult& oClientResult: oClientResults)
+    {
+        oResult.nRequests += oClientResult.nRequests;
+        oResult.nErrors += oClientResult.nErrors;
+        oResult.oServiceTime.Add(oClientResult.oServiceTime);
+        oResult.oLatency.Add(oClientResult.oLatency);
+    }
+    oResult.nCalls = oResult.nRequests * std::max<size_t>(oOptions.nBatchSize, 1);
+
+    if (oOptions.eMode == eClosedLoop && oResult.nRequests > 0)
+    {
+        // every client would have sent at its average pace without the stalls
+        const uint64_t nExpectedInterval = static_cast<uint64_t>(
+            oResult.fSeconds * 1e9 * static_cast<double>(oClientResults.size()) /
+            static_cast<double>(oResult.nRequests));
+        oResult.oLatency = CorrectCoordinatedOmission(oResult.oServiceTime, nExpectedInterval);
+    }
+    return oResult;
+}
+
+} // namespace load
+} // namespace rpc
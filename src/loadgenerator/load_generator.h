@@ -0,0 +1,132 @@
+/**
+ * @file
+ * Load generator declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_LOAD_GENERATOR_H_INCLUDED
+#define PKG_RPC_LOAD_GENERATOR_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <rpc_pkg/rpc_metrics.h>
+
+namespace rpc
+{
+namespace load
+{
+
+/**
+ * How requests are sent.
+ */
+enum eLoadMode
+{
+    /// every client sends its next request as soon as it got the response to the last one
+    eClosedLoop,
+    /// requests are scheduled at a constant rate, independent of how fast they are answered
+    eOpenLoop
+};
+
+/**
+ * The parameters of a run.
+ */
+struct tLoadOptions
+{
+    /// the URL of the RPC object, i.e. http://127.0.0.1:1234/calculator
+    std::string strUrl;
+    /// closed or open loop
+    eLoadMode eMode;
+    /// the number of concurrent connections
+    size_t nClients;
+    /// requests per second of all clients together, only used in open loop
+    double fRate;
+    /// the length of the run in seconds
+    double fDuration;
+    /// the number of calls per request, 1 sends no batches
+    size_t nBatchSize;
+    /// whether a client sends all its requests on one connection
+    bool bKeepAlive;
+
+    tLoadOptions();
+};
+
+/**
+ * The outcome of a run.
+ */
+struct tLoadResult
+{
+    /// the number of requests answered
+    uint64_t nRequests;
+    /// the number of calls in these requests
+    uint64_t nCalls;
+    /// the number of requests that failed and of calls answered with an error
+    uint64_t nErrors;
+    /// the time the run took
+    double fSeconds;
+    /// from sending a request until its response has been received
+    cLatencyHistogram oServiceTime;
+    /// corrected for coordinated omission: in open loop from the time a request was scheduled,
+    /// in closed loop with the requests added that a stalled client did not send
+    cLatencyHistogram oLatency;
+
+    tLoadResult();
+};
+
+/**
+ * Synthesizes requests from the example parameters of an interface specification, the same
+ * format jsonrpcstub reads. "$int64", "$uint64" and "$binary" become 1, 1 and empty data.
+ * @param[in] strSpecification The content of the specification.
+ * @param[in] oMethods The methods to call, all if empty.
+ * @param[in] nBatchSize The number of calls per request, 1 sends no batches.
+ * @return The requests, to be sent round robin.
+ * @throw jsonrpc::JsonRpcException If the specification is invalid or names none of the methods.
+ */
+std::vector<std::string> CreateRequests(const std::string& strSpecification,
+                                        const std::vector<std::string>& oMethods,
+                                        size_t nBatchSize);
+
+/**
+ * Counts the calls of a response that were answered with an error.
+ * @param[in] strResponse The body of the response, a single response or the one of a batch.
+ * @return The number of responses with a non-null error, 1 if the body is no valid JSON.
+ */
+uint64_t CountErrors(const std::string& strResponse);
+
+/**
+ * Adds the requests a client in a closed loop would have sent while it was waiting for slow
+ * responses, assuming it sends one every nExpectedInterval nanoseconds.
+ * @param[in] oHistogram The measured latencies.
+ * @param[in] nExpectedInterval The usual time between two requests of a client.
+ * @return The corrected latencies.
+ */
+cLatencyHistogram CorrectCoordinatedOmission(const cLatencyHistogram& oHistogram,
+                                             uint64_t nExpectedInterval);
+
+/**
+ * Sends the requests to the URL until the duration is over.
+ * @param[in] oOptions The parameters of the run.
+ * @param[in] oRequests The requests, sent round robin.
+ * @return The outcome.
+ */
+tLoadResult GenerateLoad(const tLoadOptions& oOptions, const std::vector<std::string>& oRequests);
+
+} // namespace load
+} // namespace rpc
+
+#endif // PKG_RPC_LOAD_GENERATOR_H_INCLUDED
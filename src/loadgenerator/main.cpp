@@ -0,0 +1,143 @@
+/**
+ * @file
+ * jsonrpcload, replays calls synthesized from an interface specification against a server.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <jsonrpccpp/common/exception.h>
+#include <jsonrpccpp/common/specificationparser.h>
+#include <cstdio>
+#include <cstdlib>
+#include "commandline.h"
+#include "load_generator.h"
+
+namespace
+{
+const char* const strUsage =
+    "Usage: %s <specfile> --url=<http://host:port/object> [options]\n"
+    "  --mode=closed|open  closed: every client sends after the last response (default),\n"
+    "                      open: requests are sent at a constant rate\n"
+    "  --clients=<n>       concurrent connections (default 1)\n"
+    "  --rate=<n>          requests per second of all clients in open loop (default 1000)\n"
+    "  --duration=<s>      length of the run in seconds (default 10)\n"
+    "  --batch=<n>         calls per request (default 1)\n"
+    "  --methods=<a,b>     the methods to call (default all of the specification)\n"
+    "  --keep-alive        send all requests of a client on one connection\n";
+
+std::vector<std::string> SplitList(const std::string& strList)
+{
+    std::vector<std::string> oItems;
+    size_t nStart = 0;
+    while (nStart < strList.size())
+    {
+        size_t nEnd = strList.find(',', nStart);
+        if (nEnd == std::string::npos)
+        {
+            nEnd = strList.size();
+        }
+        if (nEnd > nStart)
+        {
+            oItems.push_back(strList.substr(nStart, nEnd - nStart));
+        }
+        nStart = nEnd + 1;
+    }
+    return oItems;
+}
+
+void PrintHistogram(const char* strName, const rpc::cLatencyHistogram& oHistogram)
+{
+    fprintf(stdout, "%-22s", strName);
+    const double aShares[] = {0.5, 0.9, 0.99, 0.999, 1.0};
+    const char* const aNames[] = {"p50", "p90", "p99", "p99.9", "max"};
+    for (size_t nShare = 0; nShare < sizeof(aShares) / sizeof(aShares[0]); ++nShare)
+    {
+        fprintf(stdout,
+                " %s %9.1f us",
+                aNames[nShare],
+                static_cast<double>(oHistogram.GetPercentile(aShares[nShare])) / 1e3);
+    }
+    fprintf(stdout, "\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    rpc::cCommandLine oCmd(argc, const_cast<const char**>(argv));
+    if (oCmd.GetFlag("help") || oCmd.GetFlag("h") || oCmd.GetValues().size() < 2 ||
+        oCmd.GetProperty("url").empty())
+    {
+        fprintf(stderr, strUsage, argv[0]);
+        return oCmd.GetFlag("help") || oCmd.GetFlag("h") ? 0 : 1;
+    }
+
+    rpc::load::tLoadOptions oOptions;
+    oOptions.strUrl = oCmd.GetProperty("url");
+    const std::string strMode = oCmd.GetProperty("mode", "closed");
+    if (strMode != "closed" && strMode != "open")
+    {
+        fprintf(stderr, "Invalid mode %s, use closed or open.\n", strMode.c_str());
+        return 1;
+    }
+    oOptions.eMode = strMode == "open" ? rpc::load::eOpenLoop : rpc::load::eClosedLoop;
+    oOptions.nClients = static_cast<size_t>(atoi(oCmd.GetProperty("clients", "1").c_str()));
+    oOptions.fRate = atof(oCmd.GetProperty("rate", "1000").c_str());
+    oOptions.fDuration = atof(oCmd.GetProperty("duration", "10").c_str());
+    oOptions.nBatchSize = static_cast<size_t>(atoi(oCmd.GetProperty("batch", "1").c_str()));
+    oOptions.bKeepAlive = oCmd.GetFlag("keep-alive");
+    if (oOptions.nClients == 0 || oOptions.fRate <= 0 || oOptions.fDuration <= 0 ||
+        oOptions.nBatchSize == 0)
+    {
+        fprintf(stderr, "clients, rate, duration and batch have to be positive.\n");
+        return 1;
+    }
+
+    std::vector<std::string> oRequests;
+    try
+    {
+        std::string strSpecification;
+        jsonrpc::SpecificationParser::GetFileContent(oCmd.GetValue(1), strSpecification);
+        oRequests = rpc::load::CreateRequests(
+            strSpecification, SplitList(oCmd.GetProperty("methods")), oOptions.nBatchSize);
+    }
+    catch (const jsonrpc::JsonRpcException& ex)
+    {
+        fprintf(stderr, "%s\n", ex.what());
+        return 1;
+    }
+
+    fprintf(stdout,
+            "%s loop, %zu clients, %s, batch %zu, %zu distinct requests, %.1f s\n",
+            strMode.c_str(),
+            oOptions.nClients,
+            oOptions.bKeepAlive ? "keep-alive" : "connection per request",
+            oOptions.nBatchSize,
+            oRequests.size(),
+            oOptions.fDuration);
+    const rpc::load::tLoadResult oResult = rpc::load::GenerateLoad(oOptions, oRequests);
+
+    fprintf(stdout,
+            "requests %llu (%.1f/s), calls %llu (%.1f/s), errors %llu\n",
+            static_cast<unsigned long long>(oResult.nRequests),
+            static_cast<double>(oResult.nRequests) / oResult.fSeconds,
+            static_cast<unsigned long long>(oResult.nCalls),
+            static_cast<double>(oResult.nCalls) / oResult.fSeconds,
+            static_cast<unsigned long long>(oResult.nErrors));
+    PrintHistogram("latency (corrected)", oResult.oLatency);
+    PrintHistogram("service time", oResult.oServiceTime);
+    return oResult.nRequests > 0 ? 0 : 1;
+}
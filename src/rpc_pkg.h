@@ -27,6 +27,10 @@
 
 #include "rpc_pkg/rpc_server.h"
 #include "rpc_pkg/rpc_object_registry.h"
+#include "rpc_pkg/rpc_router.h"
+#include "rpc_pkg/rpc_metrics.h"
+#include "rpc_pkg/rpc_flight_recorder.h"
+#include "rpc_pkg/rpc_notifications.h"
 
 // http
 #include "rpc_pkg/http/threaded_http_server.h"
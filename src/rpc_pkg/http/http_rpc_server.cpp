@@ -18,6 +18,10 @@
    @endverbatim
  */
 
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <jsonrpccpp/server/abstractprotocolhandler.h>
 #include "rpc_pkg/http/http_rpc_server.h"
 
 namespace rpc
@@ -27,13 +31,183 @@ namespace http
 namespace detail
 {
 
+namespace
+{
+const char* const strSubscribePath = "/__subscribe/";
+/// the idle time after which an empty line is sent to subscribers to notice closed connections
+const uint32_t nHeartbeatMilliseconds = 1000;
+const uint32_t nSubscriptionPollMilliseconds = 100;
+
+uint64_t GetNanoseconds()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/**
+ * A call whose response is being sent, to add the time it takes once it is.
+ */
+struct tPendingWrite
+{
+    const cRPCMetrics* pMetrics;
+    std::string strObject;
+    std::string strMethod;
+    uint64_t nHandled;
+};
+
+thread_local tPendingWrite oPendingWrite = {nullptr, std::string(), std::string(), 0};
+
+/**
+ * Collects the methods a request calls, the calls of batches are recorded right away.
+ */
+class cCallObserver : public jsonrpc::IProcedureObserver
+{
+public:
+    cCallObserver(cRPCMetrics& oMetrics, const std::string& strObject, bool bPhaseTiming)
+        : m_oMetrics(oMetrics),
+          m_strObject(strObject),
+          m_pProcedure(nullptr),
+          m_bError(false),
+          m_bAnyError(false),
+          m_nCalls(0),
+          m_bPhaseTiming(bPhaseTiming),
+          m_aPhaseEnds()
+    {
+    }
+
+    void OnProcedureCall(const jsonrpc::Procedure& oProcedure, bool bError) override
+    {
+        if (++m_nCalls == 1)
+        {
+            m_pProcedure = &oProcedure;
+            m_bError = bError;
+        }
+        else
+        {
+            if (m_nCalls == 2)
+            {
+                m_oMetrics.RecordBatchedCall(m_strObject, m_pProcedure->GetProcedureName(), m_bError);
+            }
+            m_oMetrics.RecordBatchedCall(m_strObject, oProcedure.GetProcedureName(), bError);
+        }
+        m_bAnyError = m_bAnyError || bError;
+    }
+
+    void OnPhase(jsonrpc::phase_t ePhase) override
+    {
+        if (m_bPhaseTiming)
+        {
+            m_aPhaseEnds[ePhase] = GetNanoseconds();
+        }
+    }
+
+    /**
+     * Splits the time of a call into its phases, everything the protocol handler did not report
+     * counts as dispatch.
+     * @param[in] nLocked When the RPC object was locked.
+     * @param[in] nEnd When the response was complete.
+     * @param[out] aPhaseNanoseconds The phases @ref ePhaseParse to @ref ePhaseSerialize.
+     */
+    void GetPhases(uint64_t nLocked, uint64_t nEnd, uint64_t* aPhaseNanoseconds) const
+    {
+        const uint64_t nParsed = m_aPhaseEnds[jsonrpc::PHASE_PARSED]
+                                     ? m_aPhaseEnds[jsonrpc::PHASE_PARSED]
+                                     : nLocked;
+        const uint64_t nDispatched = m_aPhaseEnds[jsonrpc::PHASE_DISPATCHED]
+                                         ? m_aPhaseEnds[jsonrpc::PHASE_DISPATCHED]
+                                         : nEnd;
+        aPhaseNanoseconds[ePhaseParse] = nParsed - nLocked;
+        aPhaseNanoseconds[ePhaseDispatch] = nDispatched > nParsed ? nDispatched - nParsed : 0;
+        aPhaseNanoseconds[ePhaseSerialize] = nEnd > nDispatched ? nEnd - nDispatched : 0;
+    }
+
+    /**
+     * @return The method of a request that was no batch, nullptr otherwise.
+     */
+    const jsonrpc::Procedure* GetSingleCall() const
+    {
+        return m_nCalls == 1 ? m_pProcedure : nullptr;
+    }
+
+    bool HasError() const
+    {
+        return m_bAnyError;
+    }
+
+    bool IsSingleCallError() const
+    {
+        return m_bError;
+    }
+
+private:
+    cRPCMetrics& m_oMetrics;
+    const std::string& m_strObject;
+    const jsonrpc::Procedure* m_pProcedure;
+    bool m_bError;
+    bool m_bAnyError;
+    size_t m_nCalls;
+    bool m_bPhaseTiming;
+    uint64_t m_aPhaseEnds[jsonrpc::PHASE_SERIALIZED + 1];
+};
+
+/**
+ * Writes the phases as value of a Server-Timing header, i.e. "read;dur=0.012, lock;dur=0.001".
+ */
+void FormatServerTiming(const uint64_t* aPhaseNanoseconds, char* strBuffer, size_t nSize)
+{
+    size_t nLength = 0;
+    for (size_t nPhase = 0; nPhase < ePhaseWrite && nLength < nSize; ++nPhase)
+    {
+        const int nWritten = std::snprintf(strBuffer + nLength,
+                                           nSize - nLength,
+                                           "%s%s;dur=%.3f",
+                                           nPhase ? ", " : "",
+                                           GetPhaseName(static_cast<ePhase>(nPhase)),
+                                           static_cast<double>(aPhaseNanoseconds[nPhase]) / 1e6);
+        if (nWritten < 0)
+        {
+            break;
+        }
+        nLength += static_cast<size_t>(nWritten);
+    }
+}
+/**
+ * Makes the route of a call available to the object via GetCurrentRoute() while it handles it.
+ */
+class cCurrentRouteGuard
+{
+public:
+    explicit cCurrentRouteGuard(const tRouteMatch& oRoute) : m_pPrevious(SetCurrentRoute(&oRoute))
+    {
+    }
+
+    ~cCurrentRouteGuard()
+    {
+        SetCurrentRoute(m_pPrevious);
+    }
+
+private:
+    const tRouteMatch* m_pPrevious;
+};
+
+} // namespace
+
 cRPCServer::cRPCServer(const char* strContentType)
-    : m_strContentType(strContentType), cRPCObjectsRegistry(), cThreadedHttpServer()
+    : m_strContentType(strContentType),
+      cRPCObjectsRegistry(),
+      cThreadedHttpServer(),
+      m_bMetricsEndpoint(false),
+      m_bPhaseTiming(false),
+      m_bServerTimingHeader(false),
+      m_bFlightRecorderEndpoint(false)
 {
 }
 
 cRPCServer::~cRPCServer()
 {
+    // the request threads call back into this object until they have ended
+    StopListening();
 }
 
 Result cRPCServer::RegisterRPCObject(const char* strName, IRPCObject* pObject)
@@ -48,33 +222,318 @@ a_util::result::Result cRPCServer::UnregisterRPCObject(const char* strName)
     return cRPCObjectsRegistry::UnregisterRPCObject(strURL.c_str());
 }
 
-class cResponse : public IResponse
+Result cRPCServer::RegisterRPCObjects(const tRPCObjectList& oObjects)
 {
-private:
-    std::string& m_strResponse;
+    tRPCObjectList oURLs;
+    oURLs.reserve(oObjects.size());
+    for (const tRPCObjectList::value_type& oObject: oObjects)
+    {
+        oURLs.push_back(std::make_pair("/" + oObject.first, oObject.second));
+    }
+    return cRPCObjectsRegistry::RegisterRPCObjects(oURLs);
+}
 
-public:
-    cResponse(std::string& oResponse) : m_strResponse(oResponse)
+a_util::result::Result cRPCServer::UnregisterRPCObjects(const std::vector<std::string>& oNames)
+{
+    std::vector<std::string> oURLs;
+    oURLs.reserve(oNames.size());
+    for (const std::string& strName: oNames)
     {
+        oURLs.push_back("/" + strName);
     }
+    return cRPCObjectsRegistry::UnregisterRPCObjects(oURLs);
+}
 
-    virtual void Set(const char* strResponse, size_t nResponseSize)
+void cRPCServer::AddContentType(const char* strContentType)
+{
+    m_oContentTypes.push_back(strContentType);
+}
+
+void cRPCServer::EnableMetrics(bool bEndpoint)
+{
+    if (!m_pMetrics)
     {
-        m_strResponse.assign(reinterpret_cast<const char*>(strResponse), nResponseSize);
+        m_pMetrics.reset(new cRPCMetrics);
     }
-};
+    m_bMetricsEndpoint = bEndpoint;
+}
+
+void cRPCServer::EnablePhaseTiming(bool bServerTimingHeader)
+{
+    if (!m_pMetrics)
+    {
+        m_pMetrics.reset(new cRPCMetrics);
+    }
+    m_bPhaseTiming = true;
+    m_bServerTimingHeader = bServerTimingHeader;
+}
+
+void cRPCServer::EnableFlightRecorder(uint64_t nThresholdNanoseconds,
+                                      size_t nCapacity,
+                                      bool bEndpoint)
+{
+    if (!m_bPhaseTiming)
+    {
+        EnablePhaseTiming(false);
+    }
+    m_pFlightRecorder.reset(new cFlightRecorder(nThresholdNanoseconds, nCapacity));
+    m_bFlightRecorderEndpoint = bEndpoint;
+}
+
+std::vector<tSlowCall> cRPCServer::GetSlowCalls() const
+{
+    if (!m_pFlightRecorder)
+    {
+        return std::vector<tSlowCall>();
+    }
+    // recorded with the URL path of the object
+    std::vector<tSlowCall> oCalls = m_pFlightRecorder->GetCalls();
+    for (tSlowCall& oCall: oCalls)
+    {
+        oCall.strObject.erase(0, 1);
+    }
+    return oCalls;
+}
+
+tMetricsSnapshot cRPCServer::GetMetrics() const
+{
+    if (!m_pMetrics)
+    {
+        return tMetricsSnapshot();
+    }
+    // recorded with the URL path of the object
+    tMetricsSnapshot oMetrics = m_pMetrics->GetSnapshot();
+    for (tCallMetrics& oEntry: oMetrics)
+    {
+        oEntry.strObject.erase(0, 1);
+    }
+    return oMetrics;
+}
+
+void cRPCServer::WriteMetrics(IHttpResponse& oResponse) const
+{
+    Json::Value oMetrics(Json::arrayValue);
+    for (const tCallMetrics& oEntry: GetMetrics())
+    {
+        Json::Value& oJsonEntry = oMetrics.append(Json::Value(Json::objectValue));
+        oJsonEntry["object"] = oEntry.strObject;
+        if (!oEntry.strMethod.empty())
+        {
+            oJsonEntry["method"] = oEntry.strMethod;
+        }
+        oJsonEntry["calls"] = Json::UInt64(oEntry.nCalls);
+        oJsonEntry["errors"] = Json::UInt64(oEntry.nErrors);
+        oJsonEntry["bytes_in"] = Json::UInt64(oEntry.nBytesIn);
+        oJsonEntry["bytes_out"] = Json::UInt64(oEntry.nBytesOut);
+        Json::Value& oLatency = oJsonEntry["latency_ns"];
+        oLatency["p50"] = Json::UInt64(oEntry.oLatency.GetPercentile(0.5));
+        oLatency["p99"] = Json::UInt64(oEntry.oLatency.GetPercentile(0.99));
+        oLatency["p999"] = Json::UInt64(oEntry.oLatency.GetPercentile(0.999));
+        if (oEntry.nTimedCalls)
+        {
+            oJsonEntry["timed_calls"] = Json::UInt64(oEntry.nTimedCalls);
+            Json::Value& oPhases = oJsonEntry["phases_ns"];
+            for (size_t nPhase = 0; nPhase < ePhaseCount; ++nPhase)
+            {
+                oPhases[GetPhaseName(static_cast<ePhase>(nPhase))] =
+                    Json::UInt64(oEntry.aPhaseNanoseconds[nPhase]);
+            }
+        }
+    }
+    const std::string strMetrics = Json::FastWriter().write(oMetrics);
+    oResponse.SetContentType("application/json");
+    oResponse.Set(strMetrics.data(), strMetrics.size());
+}
+
+void cRPCServer::WriteSlowCalls(IHttpResponse& oResponse) const
+{
+    Json::Value oCalls(Json::arrayValue);
+    for (const tSlowCall& oCall: GetSlowCalls())
+    {
+        Json::Value& oJsonCall = oCalls.append(Json::Value(Json::objectValue));
+        oJsonCall["object"] = oCall.strObject;
+        if (!oCall.strMethod.empty())
+        {
+            oJsonCall["method"] = oCall.strMethod;
+        }
+        oJsonCall["bytes_in"] = Json::UInt64(oCall.nRequestBytes);
+        oJsonCall["latency_ns"] = Json::UInt64(oCall.nNanoseconds);
+        Json::Value& oPhases = oJsonCall["phases_ns"];
+        for (size_t nPhase = 0; nPhase < ePhaseWrite; ++nPhase)
+        {
+            oPhases[GetPhaseName(static_cast<ePhase>(nPhase))] =
+                Json::UInt64(oCall.aPhaseNanoseconds[nPhase]);
+        }
+        oJsonCall["thread"] = Json::UInt64(oCall.nThreadId);
+        // requests in binary encodings may contain zero bytes
+        oJsonCall["request"] = Json::Value(oCall.strRequest.data(),
+                                           oCall.strRequest.data() + oCall.strRequest.size());
+    }
+    const std::string strCalls = Json::FastWriter().write(oCalls);
+    oResponse.SetContentType("application/json");
+    oResponse.Set(strCalls.data(), strCalls.size());
+}
+
+void cRPCServer::EnableNotifications(size_t nQueueCapacity, eOverflowPolicy eOverflow)
+{
+    m_pNotifications.reset(new cNotificationHub(nQueueCapacity, eOverflow));
+}
+
+size_t cRPCServer::Publish(const char* strTopic, const char* strMethod, const Json::Value& oParams)
+{
+    if (!m_pNotifications || m_pNotifications->GetSubscriberCount(strTopic) == 0)
+    {
+        return 0;
+    }
+    Json::Value oNotification(Json::objectValue);
+    oNotification["jsonrpc"] = "2.0";
+    oNotification["method"] = strMethod;
+    oNotification["params"] = oParams;
+    std::shared_ptr<tNotification> pNotification(new tNotification);
+    pNotification->strKey = strMethod;
+    // ends with a line feed, which separates the notifications in the stream
+    pNotification->strData = Json::FastWriter().write(oNotification);
+    return m_pNotifications->Publish(strTopic, pNotification);
+}
+
+size_t cRPCServer::GetSubscriberCount(const char* strTopic) const
+{
+    return m_pNotifications ? m_pNotifications->GetSubscriberCount(strTopic) : 0;
+}
+
+bool cRPCServer::ServeSubscription(const std::string& strTopic, IHttpResponse& oResponse)
+{
+    cNotificationHub::cSubscription oSubscription(*m_pNotifications, strTopic);
+    oResponse.SetContentType("application/x-ndjson");
+    // the headers tell the client it is subscribed
+    if (!oResponse.Flush())
+    {
+        return false;
+    }
+
+    std::vector<tNotificationPtr> oNotifications;
+    uint32_t nIdleMilliseconds = 0;
+    while (IsListening())
+    {
+        if (oSubscription.Take(oNotifications, nSubscriptionPollMilliseconds))
+        {
+            // all notifications queued meanwhile go into one chunk
+            for (const tNotificationPtr& pNotification: oNotifications)
+            {
+                oResponse.GetStream().write(pNotification->strData.data(),
+                                            pNotification->strData.size());
+            }
+            nIdleMilliseconds = 0;
+        }
+        else if ((nIdleMilliseconds += nSubscriptionPollMilliseconds) >= nHeartbeatMilliseconds)
+        {
+            oResponse.GetStream().put('\n');
+            nIdleMilliseconds = 0;
+        }
+        else
+        {
+            continue;
+        }
+        if (!oResponse.Flush())
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+void cRPCServer::ServeSubscription(const std::string& strTopic, IWebSocket& oSocket)
+{
+    cNotificationHub::cSubscription oSubscription(*m_pNotifications, strTopic);
+    std::vector<tNotificationPtr> oNotifications;
+    std::string strMessage;
+    for (;;)
+    {
+        // messages of the client are ignored, but a close has to be noticed
+        const IWebSocket::eReceiveResult eResult = oSocket.Receive(strMessage, 0);
+        if (eResult == IWebSocket::eClosed)
+        {
+            return;
+        }
+        if (eResult == IWebSocket::eMessage ||
+            !oSubscription.Take(oNotifications, nSubscriptionPollMilliseconds))
+        {
+            continue;
+        }
+        for (const tNotificationPtr& pNotification: oNotifications)
+        {
+            // without the line feed, the messages are separated by the frames
+            if (!oSocket.Send(pNotification->strData.data(), pNotification->strData.size() - 1))
+            {
+                return;
+            }
+        }
+    }
+}
+
+void cRPCServer::HandleWebSocket(const std::string& strUrl, IWebSocket& oSocket)
+{
+    if (m_pNotifications && strUrl.compare(0, std::strlen(strSubscribePath), strSubscribePath) == 0)
+    {
+        ServeSubscription(strUrl.substr(std::strlen(strSubscribePath)), oSocket);
+    }
+    else
+    {
+        cThreadedHttpServer::HandleWebSocket(strUrl, oSocket);
+    }
+}
 
 bool cRPCServer::HandleRequest(const std::string& strName,
+                               const std::string& strContentType,
                                const std::string& strRequest,
-                               std::string& strResponse,
-                               std::string& strContentType)
+                               IHttpResponse& oResponse)
 {
+    if (m_pNotifications && strName.compare(0, std::strlen(strSubscribePath), strSubscribePath) == 0)
+    {
+        return ServeSubscription(strName.substr(std::strlen(strSubscribePath)), oResponse);
+    }
+
+    uint64_t nStart = 0;
+    if (m_pMetrics)
+    {
+        if (m_bMetricsEndpoint && strName == "/__metrics")
+        {
+            WriteMetrics(oResponse);
+            return true;
+        }
+        if (m_bFlightRecorderEndpoint && strName == "/__slow_calls")
+        {
+            WriteSlowCalls(oResponse);
+            return true;
+        }
+        nStart = GetNanoseconds();
+    }
+
+    tRouteMatch oRoute;
+    // calls are measured per route, not per path, so parameters do not multiply the entries
+    std::string strRoute;
     cRPCObjectsRegistry::cLockedRPCObject m_oLockedObject =
-        cRPCObjectsRegistry::GetRPCObject(strName.c_str());
+        m_pMetrics ? cRPCObjectsRegistry::GetRPCObject(strName.c_str(), oRoute, strRoute)
+                   : cRPCObjectsRegistry::GetRPCObject(strName.c_str(), oRoute);
     if (m_oLockedObject)
     {
-        strContentType = m_strContentType;
-        cResponse oResponse(strResponse);
+        const cCurrentRouteGuard oRouteGuard(oRoute);
+        // ignore parameters like "; charset=utf-8"
+        const std::string strMimeType = strContentType.substr(0, strContentType.find(';'));
+        const char* strResponseContentType = m_strContentType.c_str();
+        for (const std::string& strAccepted: m_oContentTypes)
+        {
+            if (strMimeType == strAccepted)
+            {
+                strResponseContentType = strAccepted.c_str();
+            }
+        }
+        oResponse.SetContentType(strResponseContentType);
+        if (m_pMetrics)
+        {
+            return HandleMeasuredCall(
+                m_oLockedObject, strName, strRoute, strRequest, oResponse, nStart);
+        }
         Result oRes =
             m_oLockedObject->HandleCall(strRequest.c_str(), strRequest.length(), oResponse);
         if (a_util::result::isOk(oRes))
@@ -85,6 +544,103 @@ bool cRPCServer::HandleRequest(const std::string& strName,
     return false;
 }
 
+bool cRPCServer::HandleMeasuredCall(cLockedRPCObject& oObject,
+                                    const std::string& strName,
+                                    const std::string& strRoute,
+                                    const std::string& strRequest,
+                                    IHttpResponse& oResponse,
+                                    uint64_t nStart)
+{
+    const uint64_t nLocked = m_bPhaseTiming ? GetNanoseconds() : 0;
+    cCallObserver oObserver(*m_pMetrics, strRoute, m_bPhaseTiming);
+    jsonrpc::IProcedureObserver* pPreviousObserver =
+        jsonrpc::AbstractProtocolHandler::SetProcedureObserver(&oObserver);
+    const bool bResult =
+        a_util::result::isOk(oObject->HandleCall(strRequest.c_str(), strRequest.length(), oResponse));
+    jsonrpc::AbstractProtocolHandler::SetProcedureObserver(pPreviousObserver);
+    const uint64_t nEnd = GetNanoseconds();
+    const uint64_t nNanoseconds = nEnd - nStart;
+
+    uint64_t aPhaseNanoseconds[ePhaseCount] = {};
+    const uint64_t* pPhaseNanoseconds = nullptr;
+    if (m_bPhaseTiming)
+    {
+        const uint64_t nReceived = oResponse.GetReceivedTime();
+        aPhaseNanoseconds[ePhaseRead] = nReceived && nReceived < nStart ? nStart - nReceived : 0;
+        aPhaseNanoseconds[ePhaseLock] = nLocked - nStart;
+        oObserver.GetPhases(nLocked, nEnd, aPhaseNanoseconds);
+        pPhaseNanoseconds = aPhaseNanoseconds;
+        if (m_bServerTimingHeader)
+        {
+            char strServerTiming[256];
+            FormatServerTiming(aPhaseNanoseconds, strServerTiming, sizeof(strServerTiming));
+            oResponse.SetHeader("Server-Timing", strServerTiming);
+        }
+    }
+
+    const size_t nBytesOut = oResponse.GetBytesWritten();
+    m_pMetrics->RecordCall(strRoute,
+                           std::string(),
+                           !bResult || oObserver.HasError(),
+                           strRequest.size(),
+                           nBytesOut,
+                           nNanoseconds,
+                           pPhaseNanoseconds);
+    const jsonrpc::Procedure* pProcedure = oObserver.GetSingleCall();
+    if (pProcedure)
+    {
+        m_pMetrics->RecordCall(strRoute,
+                               pProcedure->GetProcedureName(),
+                               !bResult || oObserver.IsSingleCallError(),
+                               strRequest.size(),
+                               nBytesOut,
+                               nNanoseconds,
+                               pPhaseNanoseconds);
+    }
+
+    if (m_pFlightRecorder)
+    {
+        m_pFlightRecorder->Record(strName.c_str(),
+                                  pProcedure ? pProcedure->GetProcedureName().c_str() : "",
+                                  strRequest.data(),
+                                  strRequest.size(),
+                                  nNanoseconds,
+                                  pPhaseNanoseconds);
+    }
+
+    if (m_bPhaseTiming)
+    {
+        oPendingWrite.pMetrics = m_pMetrics.get();
+        oPendingWrite.strObject = strRoute;
+        if (pProcedure)
+        {
+            oPendingWrite.strMethod = pProcedure->GetProcedureName();
+        }
+        else
+        {
+            oPendingWrite.strMethod.clear();
+        }
+        oPendingWrite.nHandled = nEnd;
+    }
+    return bResult;
+}
+
+void cRPCServer::OnResponseWritten()
+{
+    if (!m_pMetrics || oPendingWrite.pMetrics != m_pMetrics.get())
+    {
+        return;
+    }
+    const uint64_t nNanoseconds = GetNanoseconds() - oPendingWrite.nHandled;
+    m_pMetrics->RecordPhase(oPendingWrite.strObject, std::string(), ePhaseWrite, nNanoseconds);
+    if (!oPendingWrite.strMethod.empty())
+    {
+        m_pMetrics->RecordPhase(
+            oPendingWrite.strObject, oPendingWrite.strMethod, ePhaseWrite, nNanoseconds);
+    }
+    oPendingWrite.pMetrics = nullptr;
+}
+
 } // namespace detail
 } // namespace http
 } // namespace rpc
@@ -23,7 +23,11 @@
 
 #include <a_util/result.h>
 #include <json/json.h>
+#include <vector>
 #include "rpc_pkg/rpc_object_registry.h"
+#include "rpc_pkg/rpc_metrics.h"
+#include "rpc_pkg/rpc_flight_recorder.h"
+#include "rpc_pkg/rpc_notifications.h"
 #include "rpc_pkg/http/threaded_http_server.h"
 
 namespace rpc
@@ -62,14 +66,131 @@ public:
      */
     virtual Result UnregisterRPCObject(const char* strName);
 
+    using cRPCObjectsRegistry::tRPCObjectList;
+
+    /**
+     * @copydoc cRPCObjectsRegistry::RegisterRPCObjects
+     */
+    Result RegisterRPCObjects(const tRPCObjectList& oObjects);
+
+    /**
+     * @copydoc cRPCObjectsRegistry::UnregisterRPCObjects
+     */
+    Result UnregisterRPCObjects(const std::vector<std::string>& oNames);
+
+    /**
+     * Starts to record the number, errors, sizes and latencies of the calls per object and method.
+     * Objects are named by the route they are registered with, whatever path a call uses.
+     * Must not be called while the server is listening.
+     * @param[in] bEndpoint Whether requests to the URL path /__metrics are answered with the
+     *                      metrics as JSON.
+     */
+    void EnableMetrics(bool bEndpoint = false);
+
+    /**
+     * Returns the metrics recorded since @ref EnableMetrics.
+     * @return The metrics, empty if they are not enabled.
+     */
+    tMetricsSnapshot GetMetrics() const;
+
+    /**
+     * Additionally records the time each request spends in the phases of @ref ePhase, enables the
+     * metrics if they are not yet. Must not be called while the server is listening.
+     * @param[in] bServerTimingHeader Whether responses carry the phases up to @ref ePhaseSerialize
+     *                                in a Server-Timing header. Responses sent in chunks have none.
+     */
+    void EnablePhaseTiming(bool bServerTimingHeader = true);
+
+    /**
+     * Starts to keep the last calls that took longer than a threshold, with their phases and the
+     * start of their requests. Enables the metrics and phase timing if they are not yet, without
+     * a Server-Timing header. Must not be called while the server is listening.
+     * @param[in] nThresholdNanoseconds Calls taking at least this long are kept.
+     * @param[in] nCapacity The number of calls kept.
+     * @param[in] bEndpoint Whether requests to the URL path /__slow_calls are answered with the
+     *                      calls as JSON.
+     */
+    void EnableFlightRecorder(uint64_t nThresholdNanoseconds,
+                              size_t nCapacity = 64,
+                              bool bEndpoint = false);
+
+    /**
+     * Returns the calls kept since @ref EnableFlightRecorder.
+     * @return The calls, the oldest first, empty if the recorder is not enabled.
+     */
+    std::vector<tSlowCall> GetSlowCalls() const;
+
+    /**
+     * Starts to accept subscriptions. A request to the URL path /__subscribe/<topic> is answered
+     * with the JSON-RPC notifications published on the topic, one per line, in the chunks of a
+     * response that lasts until the client disconnects or the server stops listening. Must not be
+     * called while the server is listening.
+     * @param[in] nQueueCapacity The number of notifications queued per subscriber.
+     * @param[in] eOverflow What happens to notifications a subscriber does not take in time,
+     *                      @ref eCoalesce replaces notifications of the same method.
+     */
+    void EnableNotifications(size_t nQueueCapacity = 256, eOverflowPolicy eOverflow = eDropOldest);
+
+    /**
+     * Sends a JSON-RPC notification to the subscribers of a topic, serialized once for all of them.
+     * @param[in] strTopic The topic.
+     * @param[in] strMethod The method of the notification.
+     * @param[in] oParams The parameters of the notification.
+     * @return The number of subscribers, 0 if notifications are not enabled.
+     */
+    size_t Publish(const char* strTopic, const char* strMethod, const Json::Value& oParams);
+
+    /**
+     * Returns the number of subscribers of a topic.
+     * @param[in] strTopic The topic.
+     * @return The number of subscribers, 0 if notifications are not enabled.
+     */
+    size_t GetSubscriberCount(const char* strTopic) const;
+
 protected:
     bool HandleRequest(const std::string& strName,
+                       const std::string& strContentType,
                        const std::string& strRequest,
-                       std::string& strResponse,
-                       std::string& strContentType);
+                       IHttpResponse& oResponse);
+
+    void OnResponseWritten();
+
+    /**
+     * Serves WebSocket connections to "/__subscribe/<topic>" with the notifications of the topic,
+     * one per message, all others with calls.
+     */
+    void HandleWebSocket(const std::string& strUrl, IWebSocket& oSocket);
+
+    /**
+     * Accepts an additional content type. Requests sent with it are answered with
+     * the same type, all others with the default one passed to the constructor.
+     * Must not be called while the server is listening.
+     * @param[in] strContentType The MIME type, i.e. "application/cbor".
+     */
+    void AddContentType(const char* strContentType);
+
+private:
+    bool HandleMeasuredCall(cLockedRPCObject& oObject,
+                            const std::string& strName,
+                            const std::string& strRoute,
+                            const std::string& strRequest,
+                            IHttpResponse& oResponse,
+                            uint64_t nStart);
+    void WriteMetrics(IHttpResponse& oResponse) const;
+    void WriteSlowCalls(IHttpResponse& oResponse) const;
+    bool ServeSubscription(const std::string& strTopic, IHttpResponse& oResponse);
+    void ServeSubscription(const std::string& strTopic, IWebSocket& oSocket);
 
 private:
     std::string m_strContentType;
+    std::vector<std::string> m_oContentTypes;
+    a_util::memory::unique_ptr<cRPCMetrics> m_pMetrics;
+    bool m_bMetricsEndpoint;
+    bool m_bPhaseTiming;
+    bool m_bServerTimingHeader;
+    a_util::memory::unique_ptr<cFlightRecorder> m_pFlightRecorder;
+    bool m_bFlightRecorderEndpoint;
+    a_util::memory::unique_ptr<cNotificationHub> m_pNotifications;
 };
 
 } // namespace detail
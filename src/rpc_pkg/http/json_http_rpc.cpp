@@ -18,8 +18,16 @@
    @endverbatim
  */
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include "rpc_pkg/http/json_http_rpc.h"
+#include "rpc_pkg/impl/compression.h"
 #include "rpc_pkg/impl/url.h"
+#include "rpc_pkg/impl/websocket.h"
+#include "rpc_pkg/impl/websocket_calls.h"
 #include "httplib.h"
 
 namespace rpc
@@ -96,6 +104,12 @@ std::string encode_url_path(const std::string& strUrl)
     return strUrl.substr(0, nSlashPosition) + url_encode(strUrl.substr(nSlashPosition));
 }
 
+namespace
+{
+/// the compressor of the calls of a thread, kept for its next calls
+thread_local cCompressor oCallCompressor;
+} // namespace
+
 } // namespace detail
 
 class cJSONClientConnector::cImplementation
@@ -103,12 +117,43 @@ class cJSONClientConnector::cImplementation
 public:
     rpc::cUrl m_oUrl;
     httplib::Client m_oHttpClient;
+    std::string m_strContentType;
+    bool m_bCompression;
+    size_t m_nMinimumRequestSize;
+    /// everything of a request up to the value of Content-Length, the same for all calls
+    std::string m_strRequestHead;
+    /// the same for requests with a compressed body
+    std::string m_strCompressedRequestHead;
 
 public:
     cImplementation(const std::string& strUrl)
         : m_oUrl(detail::encode_url_path(strUrl).c_str()),
-          m_oHttpClient(m_oUrl.GetAuthority().GetHost().c_str(), m_oUrl.GetAuthority().GetPort())
+          m_oHttpClient(m_oUrl.GetAuthority().GetHost().c_str(), m_oUrl.GetAuthority().GetPort()),
+          m_strContentType("application/json"),
+          m_bCompression(false),
+          m_nMinimumRequestSize(0)
+    {
+        BuildRequestHead();
+    }
+
+    /**
+     * Formats the request line and headers the way httplib::Client::post writes them.
+     */
+    void BuildRequestHead()
     {
+        m_strRequestHead = "POST ";
+        m_strRequestHead += httplib::detail::encode_url(m_oUrl.GetPath().insert(0, 1, '/'));
+        m_strRequestHead += " HTTP/1.1\r\nConnection: close\r\nHost: ";
+        m_strRequestHead += m_oUrl.GetAuthority().GetHost();
+        if (m_bCompression)
+        {
+            m_strRequestHead += "\r\nAccept-Encoding: gzip, deflate";
+        }
+        m_strRequestHead += "\r\nContent-Type: ";
+        m_strRequestHead += m_strContentType;
+        m_strCompressedRequestHead = m_strRequestHead + "\r\nContent-Encoding: gzip";
+        m_strRequestHead += "\r\nContent-Length: ";
+        m_strCompressedRequestHead += "\r\nContent-Length: ";
     }
 };
 
@@ -122,36 +167,481 @@ cJSONClientConnector::~cJSONClientConnector()
     delete m_pImplementation;
 }
 
+void cJSONClientConnector::SetContentType(const char* strContentType)
+{
+    m_pImplementation->m_strContentType = strContentType;
+    m_pImplementation->BuildRequestHead();
+}
+
+void cJSONClientConnector::EnableCompression(size_t nMinimumRequestSize)
+{
+    m_pImplementation->m_bCompression = true;
+    m_pImplementation->m_nMinimumRequestSize = nMinimumRequestSize;
+    m_pImplementation->BuildRequestHead();
+}
+
 void cJSONClientConnector::SendRPCMessage(const std::string& message,
                                           std::string& result) throw(jsonrpc::JsonRpcException)
 {
-    const std::string url = m_pImplementation->m_oUrl.GetPath().insert(0, 1, '/');
-    const char* const content_type = "application/json";
+    const bool compress = m_pImplementation->m_bCompression && !message.empty() &&
+                          message.size() >= m_pImplementation->m_nMinimumRequestSize;
+    std::string compressed;
+    if (compress)
+    {
+        detail::oCallCompressor.Compress(
+            detail::eEncodingGzip, message.data(), message.size(), compressed);
+    }
+    const std::string& body = compress ? compressed : message;
 
-    httplib::Client& http_client = m_pImplementation->m_oHttpClient;
-    typedef a_util::memory::unique_ptr<httplib::Response> Response;
-    Response response(http_client.post(url.c_str(), message, content_type));
+    // only the length and the body differ between calls
+    const std::string& head = compress ? m_pImplementation->m_strCompressedRequestHead
+                                       : m_pImplementation->m_strRequestHead;
+    char content_length[24];
+    const int content_length_size =
+        snprintf(content_length, sizeof(content_length), "%zu\r\n\r\n", body.size());
+    std::string request;
+    request.reserve(head.size() + content_length_size + body.size());
+    request.append(head).append(content_length, content_length_size).append(body);
 
-    if (!response.get())
+    httplib::Response response;
+    if (!m_pImplementation->m_oHttpClient.send_raw(request, response))
     {
         throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
                                         "error while performing call, invalid response received");
     }
 
-    if (response->status != 200)
+    if (response.status != 200)
     {
         using a_util::strings::format;
         throw jsonrpc::JsonRpcException(
             jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
-            format("http error while performing call: %d", response->status));
+            format("http error while performing call: %d", response.status));
+    }
+
+    const std::string content_encoding = response.get_header_value("Content-Encoding");
+    if (!content_encoding.empty())
+    {
+        if (!detail::oCallCompressor.Decompress(
+                detail::ParseContentEncoding(content_encoding), response.body, result))
+        {
+            throw jsonrpc::JsonRpcException(
+                jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
+                "error while performing call, invalid response received");
+        }
+        return;
     }
 
 #if A_UTILS_VERSION_MAJOR < 4
-    result = response->body;
+    result = response.body;
 #else
-    result = std::move(response->body);
+    result = std::move(response.body);
 #endif
 }
 
+namespace
+{
+/// how often a connection waiting for its callbacks checks whether the client calls the server
+const uint32_t nCallbackPollMilliseconds = 100;
+
+/**
+ * Collects the response of a callback object.
+ */
+class cCallbackResponse : public IResponse
+{
+public:
+    explicit cCallbackResponse(std::string& strResponse) : m_strResponse(strResponse)
+    {
+    }
+
+    void Set(const char* strResponse, size_t nResponseSize) override
+    {
+        m_strResponse.assign(strResponse, nResponseSize);
+    }
+
+private:
+    std::string& m_strResponse;
+};
+} // namespace
+
+class cJSONWebSocketConnector::cImplementation
+{
+public:
+    cImplementation(const std::string& strUrl)
+        : m_oUrl(detail::encode_url_path(GetHttpUrl(strUrl)).c_str()),
+          m_nSocket(-1),
+          m_bClosed(true),
+          m_pCallbackObject(nullptr)
+    {
+    }
+
+    ~cImplementation()
+    {
+        std::lock_guard<std::mutex> oConnectGuard(m_oConnectLock);
+        if (m_nSocket == -1)
+        {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> oGuard(m_oSendLock);
+            m_pFrames->Close(1000);
+            httplib::detail::shutdown_socket(m_nSocket);
+        }
+        Disconnect();
+    }
+
+    void Call(const std::string& strRequest, std::string& strResult)
+    {
+        {
+            std::lock_guard<std::mutex> oGuard(m_oConnectLock);
+            if (m_bClosed)
+            {
+                Disconnect();
+                Connect();
+            }
+        }
+        if (!m_oCalls.Call(strRequest, strResult, [this](const std::string& strMessage) {
+                return Send(strMessage);
+            }))
+        {
+            throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
+                                            "error while performing call, connection closed");
+        }
+    }
+
+    void SetCallbackObject(IRPCObject* pObject)
+    {
+        m_pCallbackObject = pObject;
+    }
+
+private:
+    /**
+     * cUrl only accepts schemes of at least three characters, the handshake is HTTP anyway.
+     */
+    static std::string GetHttpUrl(const std::string& strUrl)
+    {
+        return strUrl.compare(0, 5, "ws://") == 0 ? "http://" + strUrl.substr(5) : strUrl;
+    }
+
+    void Connect()
+    {
+        const std::string strHost = m_oUrl.GetAuthority().GetHost();
+        const socket_t nSocket =
+            httplib::detail::create_client_socket(strHost.c_str(), m_oUrl.GetAuthority().GetPort());
+        if (nSocket == -1)
+        {
+            throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
+                                            "error while performing call, unable to connect");
+        }
+        httplib::detail::set_nodelay(nSocket);
+
+        const std::string strKey = detail::CreateWebSocketKey();
+        const std::string strHandshake =
+            "GET " + httplib::detail::encode_url(m_oUrl.GetPath().insert(0, 1, '/')) +
+            " HTTP/1.1\r\nHost: " + strHost +
+            "\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: " + strKey +
+            "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+        httplib::Response oResponse;
+        if (httplib::detail::socket_write(nSocket, strHandshake.data(), strHandshake.size()) !=
+                static_cast<int>(strHandshake.size()) ||
+            !httplib::detail::read_response_line(nSocket, oResponse) || oResponse.status != 101 ||
+            !httplib::detail::read_headers(nSocket, oResponse.headers) ||
+            oResponse.get_header_value("Sec-WebSocket-Accept") !=
+                detail::GetWebSocketAccept(strKey))
+        {
+            httplib::detail::close_socket(nSocket);
+            throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
+                                            "error while performing call, websocket refused");
+        }
+
+        m_oCalls.Open();
+        {
+            std::lock_guard<std::mutex> oGuard(m_oSendLock);
+            m_nSocket = nSocket;
+            m_pFrames.reset(new detail::cWebSocketFrames(
+                [nSocket](char* pData, size_t nSize) {
+                    return httplib::detail::socket_read_all(nSocket, pData, nSize);
+                },
+                [nSocket](const char* pData, size_t nSize) {
+                    return httplib::detail::socket_write(nSocket, pData, nSize) ==
+                           static_cast<int>(nSize);
+                },
+                true));
+            m_bClosed = false;
+        }
+        m_oReader = std::thread(&cImplementation::Receive, this);
+    }
+
+    /**
+     * Cleans up a closed connection, the reader does not send anymore once it is closed.
+     */
+    void Disconnect()
+    {
+        if (m_oReader.joinable())
+        {
+            m_oReader.join();
+        }
+        if (m_nSocket != -1)
+        {
+            httplib::detail::close_socket(m_nSocket);
+            m_nSocket = -1;
+        }
+    }
+
+    bool Send(const std::string& strMessage)
+    {
+        std::lock_guard<std::mutex> oGuard(m_oSendLock);
+        if (m_bClosed)
+        {
+            return false;
+        }
+        if (!m_pFrames->Send(detail::eWebSocketText, strMessage.data(), strMessage.size()))
+        {
+            // the reader fails all pending calls
+            httplib::detail::shutdown_socket(m_nSocket);
+            return false;
+        }
+        return true;
+    }
+
+    void Receive()
+    {
+        {
+            // calls of the server are handled in the order they arrive, while responses to the
+            // calls of the client keep coming in, so callbacks can call the server in turn
+            detail::cWebSocketWorkers oCallbacks(
+                [this](const std::string& strRequest, uint64_t) { HandleCallback(strRequest); }, 1);
+            std::string strMessage;
+            for (;;)
+            {
+                // the server is not read while callbacks are behind, unless the client waits
+                // for responses, a callback may be one of the callers
+                while (!m_oCalls.HasPendingCalls() &&
+                       !oCallbacks.WaitForSlot(nCallbackPollMilliseconds))
+                {
+                }
+                if (!m_pFrames->Receive(strMessage))
+                {
+                    break;
+                }
+                if (m_oCalls.Receive(strMessage) == detail::cWebSocketCalls::eRequest)
+                {
+                    oCallbacks.Push(std::move(strMessage), 0);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> oGuard(m_oSendLock);
+                m_bClosed = true;
+            }
+            m_oCalls.Close();
+        }
+    }
+
+    void HandleCallback(const std::string& strRequest)
+    {
+        std::string strResponse;
+        IRPCObject* pObject = m_pCallbackObject;
+        if (pObject)
+        {
+            cCallbackResponse oResponse(strResponse);
+            pObject->HandleCall(strRequest.data(), strRequest.size(), oResponse);
+        }
+        // notifications are not answered, calls nobody handles get an error
+        if (!strResponse.empty() ||
+            detail::CreateErrorResponse(strRequest,
+                                        jsonrpc::Errors::ERROR_RPC_METHOD_NOT_FOUND,
+                                        "No callback object handles the request",
+                                        strResponse))
+        {
+            Send(strResponse);
+        }
+    }
+
+private:
+    rpc::cUrl m_oUrl;
+    /// held while the connection is established again
+    std::mutex m_oConnectLock;
+    /// held while a message is sent, the connection is not replaced meanwhile
+    std::mutex m_oSendLock;
+    socket_t m_nSocket;
+    a_util::memory::unique_ptr<detail::cWebSocketFrames> m_pFrames;
+    detail::cWebSocketCalls m_oCalls;
+    std::atomic<bool> m_bClosed;
+    std::atomic<IRPCObject*> m_pCallbackObject;
+    std::thread m_oReader;
+};
+
+cJSONWebSocketConnector::cJSONWebSocketConnector(const std::string& strUrl)
+    : m_pImplementation(new cImplementation(strUrl))
+{
+}
+
+cJSONWebSocketConnector::~cJSONWebSocketConnector()
+{
+}
+
+void cJSONWebSocketConnector::SendRPCMessage(const std::string& message,
+                                             std::string& result) throw(jsonrpc::JsonRpcException)
+{
+    m_pImplementation->Call(message, result);
+}
+
+void cJSONWebSocketConnector::SetCallbackObject(IRPCObject* pObject)
+{
+    m_pImplementation->SetCallbackObject(pObject);
+}
+
+cJSONWebSocketCallbackConnector::cJSONWebSocketCallbackConnector(const tWebSocketPeer& pPeer)
+    : m_pPeer(pPeer)
+{
+}
+
+void cJSONWebSocketCallbackConnector::SendRPCMessage(
+    const std::string& message, std::string& result) throw(jsonrpc::JsonRpcException)
+{
+    if (!m_pPeer || !m_pPeer->Call(message, result))
+    {
+        throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_CONNECTOR,
+                                        "error while performing call, connection closed");
+    }
+}
+
+class cJSONSubscriber::cImplementation
+{
+public:
+    enum eState
+    {
+        eConnecting,
+        eSubscribed,
+        eClosed
+    };
+
+public:
+    cImplementation(const std::string& strUrl,
+                    const std::string& strTopic,
+                    const tCallback& fnCallback)
+        : m_fnCallback(fnCallback), m_eState(eConnecting), m_bStop(false)
+    {
+        const rpc::cUrl oUrl(strUrl.c_str());
+        m_oThread = std::thread(&cImplementation::Receive,
+                                this,
+                                oUrl.GetAuthority().GetHost(),
+                                oUrl.GetAuthority().GetPort(),
+                                "/__subscribe/" + strTopic);
+    }
+
+    ~cImplementation()
+    {
+        m_bStop = true;
+        m_oThread.join();
+    }
+
+    bool WaitForSubscription(uint32_t nTimeoutMilliseconds)
+    {
+        std::unique_lock<std::mutex> oGuard(m_oStateLock);
+        m_oStateChanged.wait_for(oGuard, std::chrono::milliseconds(nTimeoutMilliseconds), [this]() {
+            return m_eState != eConnecting;
+        });
+        return m_eState == eSubscribed;
+    }
+
+    bool IsConnected() const
+    {
+        std::lock_guard<std::mutex> oGuard(m_oStateLock);
+        return m_eState != eClosed;
+    }
+
+private:
+    void Receive(const std::string& strHost, int nPort, const std::string& strPath)
+    {
+        httplib::Client oClient(strHost.c_str(), nPort);
+        httplib::Response oResponse;
+        oClient.stream(
+            strPath.c_str(),
+            oResponse,
+            [this](const httplib::Response& oResponse) {
+                if (oResponse.status != 200)
+                {
+                    return false;
+                }
+                SetState(eSubscribed);
+                return true;
+            },
+            [this](const char* pData, size_t nSize) {
+                if (pData)
+                {
+                    Dispatch(pData, nSize);
+                }
+                return !m_bStop;
+            });
+        SetState(eClosed);
+    }
+
+    /**
+     * Calls the callback for every complete line, a notification may span chunks.
+     */
+    void Dispatch(const char* pData, size_t nSize)
+    {
+        m_strPending.append(pData, nSize);
+        size_t nLineStart = 0;
+        for (size_t nLineEnd = m_strPending.find('\n'); nLineEnd != std::string::npos;
+             nLineStart = nLineEnd + 1, nLineEnd = m_strPending.find('\n', nLineStart))
+        {
+            Json::Value oNotification;
+            // empty lines keep the connection alive
+            if (nLineEnd > nLineStart &&
+                m_oReader.parse(m_strPending.data() + nLineStart,
+                                m_strPending.data() + nLineEnd,
+                                oNotification,
+                                false) &&
+                oNotification.isObject())
+            {
+                m_fnCallback(oNotification["method"].asString(), oNotification["params"]);
+            }
+        }
+        m_strPending.erase(0, nLineStart);
+    }
+
+    void SetState(eState eNewState)
+    {
+        {
+            std::lock_guard<std::mutex> oGuard(m_oStateLock);
+            m_eState = eNewState;
+        }
+        m_oStateChanged.notify_all();
+    }
+
+private:
+    tCallback m_fnCallback;
+    mutable std::mutex m_oStateLock;
+    std::condition_variable m_oStateChanged;
+    eState m_eState;
+    std::atomic<bool> m_bStop;
+    Json::Reader m_oReader;
+    std::string m_strPending;
+    std::thread m_oThread;
+};
+
+cJSONSubscriber::cJSONSubscriber(const std::string& strUrl,
+                                 const std::string& strTopic,
+                                 const tCallback& fnCallback)
+    : m_pImplementation(new cImplementation(strUrl, strTopic, fnCallback))
+{
+}
+
+cJSONSubscriber::~cJSONSubscriber()
+{
+}
+
+bool cJSONSubscriber::WaitForSubscription(uint32_t nTimeoutMilliseconds)
+{
+    return m_pImplementation->WaitForSubscription(nTimeoutMilliseconds);
+}
+
+bool cJSONSubscriber::IsConnected() const
+{
+    return m_pImplementation->IsConnected();
+}
+
 } // namespace http
 } // namespace rpc
@@ -23,6 +23,9 @@
 
 #include <jsonrpccpp/client/iclientconnector.h>
 #include <jsonrpccpp/server/abstractserverconnector.h>
+#include <jsonrpccpp/common/binarycodec.h>
+#include <cstdint>
+#include <functional>
 #include "http_rpc_server.h"
 
 namespace rpc
@@ -36,6 +39,8 @@ class cJSONRPCServer : public detail::cRPCServer
 public:
     cJSONRPCServer() : cRPCServer("application/json")
     {
+        AddContentType(jsonrpc::GetContentType(jsonrpc::ENCODING_CBOR));
+        AddContentType(jsonrpc::GetContentType(jsonrpc::ENCODING_MSGPACK));
     }
 };
 
@@ -57,11 +62,132 @@ public:
     void SendRPCMessage(const std::string& message,
                         std::string& result) throw(jsonrpc::JsonRpcException);
 
+    /**
+     * Sets the content type of the requests, "application/json" by default.
+     * @param[in] strContentType The MIME type, i.e. "application/cbor".
+     */
+    void SetContentType(const char* strContentType);
+
+    /**
+     * Accepts compressed responses and compresses large requests with gzip. Servers enable the
+     * compression of responses with @ref detail::cThreadedHttpServer::EnableCompression, but
+     * always accept compressed requests.
+     * @param[in] nMinimumRequestSize Smaller requests are sent as they are.
+     */
+    void EnableCompression(size_t nMinimumRequestSize = 1024);
+
 private:
     class cImplementation;
     cImplementation* m_pImplementation;
 };
 
+/**
+ * Connector that sends RPC messages over a single WebSocket connection, which is established with
+ * the first call and again after it has been closed. Calls of several threads share the
+ * connection, their ids are replaced by ids unique on the connection, so the server can answer
+ * them in any order and a slow call does not hold up the others. Notifications are not answered
+ * and result in an empty result right away. The server can call the client over the same
+ * connection, see @ref SetCallbackObject.
+ */
+class cJSONWebSocketConnector : public jsonrpc::IClientConnector
+{
+public:
+    /**
+     * Constructor
+     * @param[in] strUrl The url, i.e. ws://localhost:8000/system or http://localhost:8000/system
+     */
+    cJSONWebSocketConnector(const std::string& strUrl);
+
+    /**
+     * Destructor, closes the connection, calls still waiting for their result fail.
+     */
+    ~cJSONWebSocketConnector();
+
+public:
+    void SendRPCMessage(const std::string& message,
+                        std::string& result) throw(jsonrpc::JsonRpcException);
+
+    /**
+     * Sets the object that handles the calls and notifications the server sends over the
+     * connection, one after the other. Without an object, calls are answered with an error.
+     * @param[in] pObject The object, it has to outlive the connector, nullptr to reset it.
+     */
+    void SetCallbackObject(IRPCObject* pObject);
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
+/**
+ * Connector for the calls of a server object to a client connected with a
+ * @ref cJSONWebSocketConnector, which handles them with its callback object. The calls share the
+ * WebSocket connection with the calls of the client and fail once it has been closed.
+ */
+class cJSONWebSocketCallbackConnector : public jsonrpc::IClientConnector
+{
+public:
+    /**
+     * Constructor
+     * @param[in] pPeer The connection, see @ref GetCurrentWebSocketPeer.
+     */
+    cJSONWebSocketCallbackConnector(const tWebSocketPeer& pPeer);
+
+public:
+    void SendRPCMessage(const std::string& message,
+                        std::string& result) throw(jsonrpc::JsonRpcException);
+
+private:
+    tWebSocketPeer m_pPeer;
+};
+
+/**
+ * Receives the notifications a @ref cJSONRPCServer publishes on a topic, see
+ * @ref detail::cRPCServer::EnableNotifications. They arrive on a thread of the subscriber, over a
+ * single connection that stays open as long as the subscriber exists.
+ */
+class cJSONSubscriber
+{
+public:
+    /// called for every notification with its method and parameters
+    typedef std::function<void(const std::string& strMethod, const Json::Value& oParams)>
+        tCallback;
+
+public:
+    /**
+     * Constructor, subscribes in the background.
+     * @param[in] strUrl The URL of the server, i.e. http://localhost:8000
+     * @param[in] strTopic The topic.
+     * @param[in] fnCallback Called for every notification.
+     */
+    cJSONSubscriber(const std::string& strUrl,
+                    const std::string& strTopic,
+                    const tCallback& fnCallback);
+
+    /**
+     * Destructor, closes the connection within 100 ms.
+     */
+    ~cJSONSubscriber();
+
+    /**
+     * Waits until the server has accepted the subscription, notifications published from then on
+     * reach the callback.
+     * @param[in] nTimeoutMilliseconds The longest time to wait.
+     * @return false if the subscription failed or did not succeed in time.
+     */
+    bool WaitForSubscription(uint32_t nTimeoutMilliseconds);
+
+    /**
+     * Returns whether the connection is still open.
+     * @return false once the server closed it.
+     */
+    bool IsConnected() const;
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
 } // namespace http
 } // namespace rpc
 
@@ -18,15 +18,29 @@
    @endverbatim
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
 #include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
 #include <a_util/result/error_def.h>
 #include <a_util/concurrency/thread.h>
 #include <a_util/concurrency/mutex.h>
+#include <jsonrpccpp/common/errors.h>
 #include "rpc_pkg/http/threaded_http_server.h"
 #include "rpc_pkg/rpc_server.h"
 #include "httplib.h"
 #include "threaded_http_server.h"
+#include "rpc_pkg/impl/compression.h"
 #include "rpc_pkg/impl/url.h"
+#include "rpc_pkg/impl/websocket.h"
+#include "rpc_pkg/impl/websocket_calls.h"
 
 namespace rpc
 {
@@ -39,6 +53,12 @@ struct AcceptFunc
 {
     std::deque<std::pair<httplib::Server*, socket_t>> m_queueRequest;
     a_util::concurrency::mutex m_csQueue;
+    /// the request threads still running, they use the server until they end
+    std::atomic<size_t> m_nActiveRequests;
+
+    AcceptFunc() : m_nActiveRequests(0)
+    {
+    }
 
     void Push(httplib::Server& oServer, socket_t nSocket)
     {
@@ -57,6 +77,7 @@ struct AcceptFunc
     void operator()(httplib::Server& oServer, socket_t nSocket)
     {
         Push(oServer, nSocket);
+        ++m_nActiveRequests;
         a_util::concurrency::thread oRequestThread(&AcceptFunc::ProcessRequest, this);
         oRequestThread.detach();
     }
@@ -65,16 +86,523 @@ struct AcceptFunc
     {
         std::pair<httplib::Server*, socket_t> item = Pop();
         item.first->process_request(item.second);
+        --m_nActiveRequests;
+    }
+
+    void WaitForRequests()
+    {
+        while (m_nActiveRequests > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+};
+
+namespace
+{
+/**
+ * The buffers of the connection a thread serves, kept for the requests that follow.
+ */
+struct tConnectionBuffers
+{
+    cCompressor oCompressor;
+    std::string strRequest;
+    std::string strCompressed;
+};
+
+thread_local tConnectionBuffers oConnectionBuffers;
+} // namespace
+
+/**
+ * Buffers the response body up to a fixed chunk size. Bodies that fit into a single
+ * chunk are sent with Content-Length as before, larger ones are flushed to the socket
+ * as HTTP chunks whenever the buffer is full, so at most one chunk is held in memory.
+ * HTTP/1.0 clients do not support chunked encoding and get the body in one piece.
+ * Bodies are compressed for clients that accept it, streamed ones chunk by chunk.
+ */
+class cHttpResponse : public IHttpResponse, private std::streambuf
+{
+public:
+    static const size_t nChunkSize = 64 * 1024;
+
+public:
+    /**
+     * Constructor.
+     * @param[in] oRequest The request.
+     * @param[in,out] oResponse The response.
+     * @param[in] eEncoding The encoding of bodies of at least nMinimumSize bytes.
+     * @param[in] nMinimumSize Smaller bodies are not compressed.
+     */
+    cHttpResponse(const httplib::Request& oRequest,
+                  httplib::Response& oResponse,
+                  eContentEncoding eEncoding,
+                  size_t nMinimumSize)
+        : m_oRequest(oRequest),
+          m_oResponse(oResponse),
+          m_nChunkedBytes(0),
+          m_eEncoding(eEncoding),
+          m_nMinimumSize(nMinimumSize),
+          m_bCompressing(false),
+          m_oStream(this)
+    {
+    }
+
+    void SetContentType(const char* strContentType) override
+    {
+        m_strContentType = strContentType;
+        m_oResponse.set_header("Content-Type", strContentType);
+    }
+
+    const char* GetContentType() const override
+    {
+        return m_strContentType.c_str();
+    }
+
+    void Set(const char* strResponse, size_t nResponseSize) override
+    {
+        if (pptr() == pbase() && !m_oResponse.chunked)
+        {
+            m_oResponse.body.assign(strResponse, nResponseSize);
+        }
+        else
+        {
+            m_oStream.write(strResponse, nResponseSize);
+        }
+    }
+
+    std::ostream& GetStream() override
+    {
+        return m_oStream;
+    }
+
+    size_t GetBytesWritten() const override
+    {
+        return m_oResponse.body.size() + m_nChunkedBytes + (pptr() - pbase());
+    }
+
+    bool SetHeader(const char* strName, const char* strValue) override
+    {
+        if (m_oResponse.chunked)
+        {
+            return false;
+        }
+        m_oResponse.set_header(strName, strValue);
+        return true;
+    }
+
+    uint64_t GetReceivedTime() const override
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         m_oRequest.received.time_since_epoch())
+                                         .count());
+    }
+
+    bool Flush() override
+    {
+        if (!m_oResponse.is_chunked_allowed())
+        {
+            return false;
+        }
+        if (!m_oResponse.chunked)
+        {
+            // a stream the handler flushes itself is sent as it is, to arrive right away
+            m_eEncoding = eEncodingIdentity;
+            // sends the headers, followed by what has been handed over via Set
+            const std::string strBody = std::move(m_oResponse.body);
+            m_oResponse.body.clear();
+            if (!m_oResponse.write_chunk(strBody.data(), strBody.size()))
+            {
+                return false;
+            }
+            m_nChunkedBytes += strBody.size();
+        }
+        return FlushChunk(eFlushSync);
+    }
+
+    /**
+     * Hands the remaining buffered data over to the response.
+     */
+    void Finish()
+    {
+        if (m_oResponse.chunked)
+        {
+            FlushChunk(eFlushFinish);
+        }
+        else
+        {
+            m_oResponse.body.append(pbase(), pptr());
+            setp(pbase(), epptr());
+            if (m_eEncoding != eEncodingIdentity && !m_oResponse.body.empty() &&
+                m_oResponse.body.size() >= m_nMinimumSize &&
+                !m_oResponse.has_header("Content-Encoding"))
+            {
+                std::string& strCompressed = oConnectionBuffers.strCompressed;
+                oConnectionBuffers.oCompressor.Compress(
+                    m_eEncoding, m_oResponse.body.data(), m_oResponse.body.size(), strCompressed);
+                // the uncompressed body keeps its memory for the next response
+                m_oResponse.body.swap(strCompressed);
+                SetEncodingHeaders();
+            }
+        }
+    }
+
+private:
+    int_type overflow(int_type nChar) override
+    {
+        if (m_oBuffer.empty())
+        {
+            m_oBuffer.resize(nChunkSize);
+            setp(m_oBuffer.data(), m_oBuffer.data() + m_oBuffer.size());
+        }
+        else if (!FlushChunk(eFlushNone))
+        {
+            return traits_type::eof();
+        }
+
+        if (!traits_type::eq_int_type(nChar, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(nChar);
+            pbump(1);
+        }
+        return traits_type::not_eof(nChar);
+    }
+
+    bool FlushChunk(eCompressionFlush eFlush)
+    {
+        bool bResult = true;
+        // a compressed stream may hold back data until it is flushed
+        if (pptr() != pbase() || (m_bCompressing && eFlush != eFlushNone))
+        {
+            if (m_oResponse.is_chunked_allowed())
+            {
+                bResult = WriteChunk(pbase(), pptr() - pbase(), eFlush);
+                m_nChunkedBytes += pptr() - pbase();
+            }
+            else
+            {
+                m_oResponse.body.append(pbase(), pptr());
+            }
+        }
+        setp(m_oBuffer.data(), m_oBuffer.data() + m_oBuffer.size());
+        return bResult;
+    }
+
+    bool WriteChunk(const char* pData, size_t nSize, eCompressionFlush eFlush)
+    {
+        if (!m_oResponse.chunked && m_eEncoding != eEncodingIdentity &&
+            !m_oResponse.has_header("Content-Encoding"))
+        {
+            // a body that needs more than one chunk is worth compressing
+            SetEncodingHeaders();
+            oConnectionBuffers.oCompressor.Begin(m_eEncoding);
+            m_bCompressing = true;
+        }
+        if (!m_bCompressing)
+        {
+            return m_oResponse.write_chunk(pData, nSize);
+        }
+
+        std::string& strCompressed = oConnectionBuffers.strCompressed;
+        strCompressed.clear();
+        oConnectionBuffers.oCompressor.Write(pData, nSize, eFlush, strCompressed);
+        return m_oResponse.write_chunk(strCompressed.data(), strCompressed.size());
+    }
+
+    void SetEncodingHeaders()
+    {
+        m_oResponse.set_header("Content-Encoding", GetContentEncodingName(m_eEncoding));
+        m_oResponse.set_header("Vary", "Accept-Encoding");
+    }
+
+private:
+    const httplib::Request& m_oRequest;
+    httplib::Response& m_oResponse;
+    std::string m_strContentType;
+    size_t m_nChunkedBytes;
+    eContentEncoding m_eEncoding;
+    size_t m_nMinimumSize;
+    bool m_bCompressing;
+    std::vector<char> m_oBuffer;
+    std::ostream m_oStream;
+};
+
+namespace
+{
+/// the longest time a WebSocket waits before it checks whether the server still listens
+const uint32_t nWebSocketPollMilliseconds = 100;
+/// the most messages of a WebSocket connection that are handled at once
+const size_t nMaxWebSocketWorkers = 16;
+
+uint64_t GetSteadyNanoseconds()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                     std::chrono::steady_clock::now().time_since_epoch())
+                                     .count());
+}
+
+/**
+ * Whether a comma separated header value contains a token, ignoring the case.
+ */
+bool HasToken(std::string strValue, const char* strToken)
+{
+    std::transform(strValue.begin(), strValue.end(), strValue.begin(), [](char cChar) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(cChar)));
+    });
+    return strValue.find(strToken) != std::string::npos;
+}
+
+bool IsWebSocketUpgrade(const httplib::Request& oRequest)
+{
+    return oRequest.method == "GET" && HasToken(oRequest.get_header_value("Upgrade"), "websocket") &&
+           HasToken(oRequest.get_header_value("Connection"), "upgrade") &&
+           oRequest.get_header_value("Sec-WebSocket-Version") == "13" &&
+           !oRequest.get_header_value("Sec-WebSocket-Key").empty();
+}
+
+/**
+ * The server side of a WebSocket connection, stops receiving once the server stops listening.
+ */
+class cServerWebSocket : public IWebSocket
+{
+public:
+    cServerWebSocket(socket_t nSocket, const std::function<bool()>& fnIsListening)
+        : m_nSocket(nSocket),
+          m_fnIsListening(fnIsListening),
+          m_oFrames(
+              [nSocket](char* pData, size_t nSize) {
+                  return httplib::detail::socket_read_all(nSocket, pData, nSize);
+              },
+              [nSocket](const char* pData, size_t nSize) {
+                  return httplib::detail::socket_write(nSocket, pData, nSize) ==
+                         static_cast<int>(nSize);
+              },
+              false),
+          m_nReceived(0)
+    {
+    }
+
+    ~cServerWebSocket()
+    {
+        // going away if the server stops
+        m_oFrames.Close(m_fnIsListening() ? 1000 : 1001);
+    }
+
+    eReceiveResult Receive(std::string& strMessage, uint32_t nTimeoutMilliseconds) override
+    {
+        uint32_t nWaited = 0;
+        while (m_fnIsListening())
+        {
+            const uint32_t nSlice =
+                std::min(nTimeoutMilliseconds - nWaited, nWebSocketPollMilliseconds);
+            if (httplib::detail::wait_for_socket_readable(m_nSocket, nSlice * 1000))
+            {
+                m_nReceived = GetSteadyNanoseconds();
+                return m_oFrames.Receive(strMessage) ? eMessage : eClosed;
+            }
+            nWaited += nSlice;
+            if (nWaited >= nTimeoutMilliseconds)
+            {
+                return eTimeout;
+            }
+        }
+        return eClosed;
     }
+
+    bool Send(const char* strMessage, size_t nMessageSize) override
+    {
+        return m_oFrames.Send(eWebSocketText, strMessage, nMessageSize);
+    }
+
+    uint64_t GetReceivedTime() const override
+    {
+        return m_nReceived;
+    }
+
+private:
+    socket_t m_nSocket;
+    std::function<bool()> m_fnIsListening;
+    cWebSocketFrames m_oFrames;
+    uint64_t m_nReceived;
+};
+
+/**
+ * Collects the response to a WebSocket message, which is sent as one message.
+ */
+class cWebSocketResponse : public IHttpResponse, private std::streambuf
+{
+public:
+    cWebSocketResponse() : m_nReceived(0), m_oStream(this)
+    {
+    }
+
+    /**
+     * Prepares the response to the next message, keeping the memory of the last one.
+     */
+    void Reset(uint64_t nReceived)
+    {
+        m_strBody.clear();
+        m_nReceived = nReceived;
+    }
+
+    const std::string& GetBody() const
+    {
+        return m_strBody;
+    }
+
+    void SetContentType(const char* strContentType) override
+    {
+        m_strContentType = strContentType;
+    }
+
+    const char* GetContentType() const override
+    {
+        return m_strContentType.c_str();
+    }
+
+    void Set(const char* strResponse, size_t nResponseSize) override
+    {
+        m_strBody.append(strResponse, nResponseSize);
+    }
+
+    std::ostream& GetStream() override
+    {
+        return m_oStream;
+    }
+
+    size_t GetBytesWritten() const override
+    {
+        return m_strBody.size();
+    }
+
+    bool SetHeader(const char*, const char*) override
+    {
+        return false;
+    }
+
+    uint64_t GetReceivedTime() const override
+    {
+        return m_nReceived;
+    }
+
+    bool Flush() override
+    {
+        return false;
+    }
+
+private:
+    int_type overflow(int_type nChar) override
+    {
+        if (!traits_type::eq_int_type(nChar, traits_type::eof()))
+        {
+            m_strBody.push_back(traits_type::to_char_type(nChar));
+        }
+        return traits_type::not_eof(nChar);
+    }
+
+    std::streamsize xsputn(const char* pData, std::streamsize nSize) override
+    {
+        m_strBody.append(pData, static_cast<size_t>(nSize));
+        return nSize;
+    }
+
+private:
+    std::string m_strBody;
+    std::string m_strContentType;
+    uint64_t m_nReceived;
+    std::ostream m_oStream;
 };
 
+/**
+ * The client of a WebSocket connection served by @ref cThreadedHttpServer::HandleWebSocket.
+ */
+class cWebSocketPeer : public IWebSocketPeer, public std::enable_shared_from_this<cWebSocketPeer>
+{
+public:
+    explicit cWebSocketPeer(IWebSocket& oSocket) : m_pSocket(&oSocket)
+    {
+    }
+
+    bool Call(const std::string& strRequest, std::string& strResponse) override
+    {
+        return m_oCalls.Call(strRequest, strResponse, [this](const std::string& strMessage) {
+            std::lock_guard<std::mutex> oGuard(m_oLock);
+            return m_pSocket && m_pSocket->Send(strMessage.data(), strMessage.size());
+        });
+    }
+
+    /**
+     * Hands a message of the client over to the call of the server waiting for it.
+     * @return false if the message is a request.
+     */
+    bool Receive(const std::string& strMessage)
+    {
+        // without calls of the server every message is a request, which saves looking for ids
+        return m_oCalls.HasPendingCalls() &&
+               m_oCalls.Receive(strMessage) != cWebSocketCalls::eRequest;
+    }
+
+    /**
+     * Whether calls of the server wait for the client, whose responses must be received.
+     */
+    bool HasPendingCalls() const
+    {
+        return m_oCalls.HasPendingCalls();
+    }
+
+    /**
+     * Fails the calls waiting for the client, the connection is closed.
+     */
+    void Close()
+    {
+        m_oCalls.Close();
+        std::lock_guard<std::mutex> oGuard(m_oLock);
+        m_pSocket = nullptr;
+    }
+
+private:
+    cWebSocketCalls m_oCalls;
+    std::mutex m_oLock;
+    IWebSocket* m_pSocket;
+};
+
+thread_local cWebSocketPeer* pCurrentWebSocketPeer = nullptr;
+
+/**
+ * Makes the connection of a call available via GetCurrentWebSocketPeer() while it is handled.
+ */
+class cCurrentWebSocketPeerGuard
+{
+public:
+    explicit cCurrentWebSocketPeerGuard(cWebSocketPeer& oPeer) : m_pPrevious(pCurrentWebSocketPeer)
+    {
+        pCurrentWebSocketPeer = &oPeer;
+    }
+
+    ~cCurrentWebSocketPeerGuard()
+    {
+        pCurrentWebSocketPeer = m_pPrevious;
+    }
+
+private:
+    cWebSocketPeer* m_pPrevious;
+};
+
+} // namespace
+
 class cThreadedHttpServer::cImplementation : private httplib::Server
 {
 public:
-    cImplementation(cThreadedHttpServer& oServer) : m_oServer(oServer)
+    cImplementation(cThreadedHttpServer& oServer)
+        : m_oServer(oServer), m_bCompression(false), m_nCompressionMinimumSize(0)
     {
     }
 
+    void EnableCompression(size_t nMinimumSize)
+    {
+        m_bCompression = true;
+        m_nCompressionMinimumSize = nMinimumSize;
+    }
+
     ~cImplementation()
     {
         StopListening();
@@ -111,26 +639,78 @@ public:
             stop();
             m_pAcceptThread->join();
             m_pAcceptThread.release();
+            // idle connections notice the stop within 100 ms
+            m_oAcceptFunc.WaitForRequests();
         }
 
         return Result();
     }
 
+    bool IsListening() const
+    {
+        return is_running();
+    }
+
 protected:
     bool handle_request(const httplib::Request& oRequest, httplib::Response& oResponse) override
     {
-        std::string strContentType;
-        bool bResult =
-            m_oServer.HandleRequest(oRequest.url, oRequest.body, oResponse.body, strContentType);
-        oResponse.set_header("Content-Type", strContentType.c_str());
+        if (IsWebSocketUpgrade(oRequest))
+        {
+            const std::string strHandshake =
+                "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\n"
+                "Connection: Upgrade\r\nSec-WebSocket-Accept: " +
+                GetWebSocketAccept(oRequest.get_header_value("Sec-WebSocket-Key")) + "\r\n\r\n";
+            oResponse.upgraded = true;
+            httplib::detail::set_nodelay(oResponse.sock);
+            if (httplib::detail::socket_write(oResponse.sock,
+                                              strHandshake.data(),
+                                              strHandshake.size()) ==
+                static_cast<int>(strHandshake.size()))
+            {
+                cServerWebSocket oSocket(oResponse.sock, [this]() { return is_running(); });
+                m_oServer.HandleWebSocket(oRequest.url, oSocket);
+            }
+            return true;
+        }
+
+        const std::string* pBody = &oRequest.body;
+        const std::string strContentEncoding = oRequest.get_header_value("Content-Encoding");
+        if (!strContentEncoding.empty())
+        {
+            const eContentEncoding eEncoding = ParseContentEncoding(strContentEncoding);
+            if (!oConnectionBuffers.oCompressor.Decompress(
+                    eEncoding, oRequest.body, oConnectionBuffers.strRequest))
+            {
+                oResponse.status = eEncoding == eEncodingUnknown ? 415 : 400;
+                return true;
+            }
+            pBody = &oConnectionBuffers.strRequest;
+        }
+
+        cHttpResponse oHttpResponse(
+            oRequest,
+            oResponse,
+            m_bCompression ? SelectContentEncoding(oRequest.get_header_value("Accept-Encoding"))
+                           : eEncodingIdentity,
+            m_nCompressionMinimumSize);
+        bool bResult = m_oServer.HandleRequest(
+            oRequest.url, oRequest.get_header_value("Content-Type"), *pBody, oHttpResponse);
+        oHttpResponse.Finish();
         return bResult;
     }
 
+    void response_written(const httplib::Request&, const httplib::Response&) override
+    {
+        m_oServer.OnResponseWritten();
+    }
+
 protected:
     // std::thread m_oAcceptThread;
     a_util::memory::unique_ptr<a_util::concurrency::thread> m_pAcceptThread;
     AcceptFunc m_oAcceptFunc;
     cThreadedHttpServer& m_oServer;
+    bool m_bCompression;
+    size_t m_nCompressionMinimumSize;
 };
 
 cThreadedHttpServer::cThreadedHttpServer() : m_pImplementation(new cImplementation(*this))
@@ -151,6 +731,89 @@ Result cThreadedHttpServer::StopListening()
     return m_pImplementation->StopListening();
 }
 
+void cThreadedHttpServer::EnableCompression(size_t nMinimumSize)
+{
+    m_pImplementation->EnableCompression(nMinimumSize);
+}
+
+void cThreadedHttpServer::HandleWebSocket(const std::string& strUrl, IWebSocket& oSocket)
+{
+    const std::shared_ptr<cWebSocketPeer> pPeer = std::make_shared<cWebSocketPeer>(oSocket);
+    {
+        cWebSocketWorkers oWorkers(
+            [this, &strUrl, &oSocket, &pPeer](const std::string& strMessage, uint64_t nReceived) {
+                // keeps the memory of the last response of the thread
+                thread_local cWebSocketResponse oResponse;
+                oResponse.Reset(nReceived);
+                bool bHandled = false;
+                {
+                    const cCurrentWebSocketPeerGuard oPeerGuard(*pPeer);
+                    bHandled = HandleRequest(strUrl, "application/json", strMessage, oResponse);
+                }
+
+                std::string strError;
+                const std::string* pBody = &oResponse.GetBody();
+                if (pBody->empty())
+                {
+                    // notifications are not answered, calls no object handles get an error
+                    if (bHandled ||
+                        !CreateErrorResponse(strMessage,
+                                             jsonrpc::Errors::ERROR_RPC_METHOD_NOT_FOUND,
+                                             "No object handles requests to " + strUrl,
+                                             strError))
+                    {
+                        return;
+                    }
+                    pBody = &strError;
+                }
+                if (oSocket.Send(pBody->data(), pBody->size()))
+                {
+                    OnResponseWritten();
+                }
+            },
+            nMaxWebSocketWorkers);
+
+        std::string strMessage;
+        for (;;)
+        {
+            // the client is not read while the workers are behind, unless calls of the workers
+            // wait for its responses
+            if (!pPeer->HasPendingCalls() && !oWorkers.WaitForSlot(nWebSocketPollMilliseconds))
+            {
+                if (!IsListening())
+                {
+                    break;
+                }
+                continue;
+            }
+            const IWebSocket::eReceiveResult eResult =
+                oSocket.Receive(strMessage, nWebSocketPollMilliseconds);
+            if (eResult == IWebSocket::eClosed)
+            {
+                break;
+            }
+            if (eResult == IWebSocket::eMessage && !pPeer->Receive(strMessage))
+            {
+                oWorkers.Push(std::move(strMessage), oSocket.GetReceivedTime());
+            }
+        }
+        // calls waiting for the client would hold up the workers
+        pPeer->Close();
+    }
+}
+
+bool cThreadedHttpServer::IsListening() const
+{
+    return m_pImplementation->IsListening();
+}
+
 } // namespace detail
+
+tWebSocketPeer GetCurrentWebSocketPeer()
+{
+    return detail::pCurrentWebSocketPeer ? detail::pCurrentWebSocketPeer->shared_from_this()
+                                         : tWebSocketPeer();
+}
+
 } // namespace http
 } // namespace rpc
@@ -20,6 +20,10 @@
 
 #include <a_util/result/result_type.h>
 #include <a_util/memory.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "rpc_pkg/rpc_server.h"
 
 #ifndef PKG_RPC_RPC_DETAIL_THREAD_HTTP_SERVER_H_
 #define PKG_RPC_RPC_DETAIL_THREAD_HTTP_SERVER_H_
@@ -28,9 +32,120 @@ namespace rpc
 {
 namespace http
 {
+
+/**
+ * The client of a WebSocket connection, which objects of the server can call back as long as it
+ * is connected, see @ref GetCurrentWebSocketPeer.
+ */
+class IWebSocketPeer
+{
+public:
+    /**
+     * Sends a JSON-RPC request or batch to the client and waits for the response. The calls
+     * share the connection with the calls of the client, so the ids are replaced on the way.
+     * @param[in] strRequest The request.
+     * @param[out] strResponse The response, empty if the request only contains notifications.
+     * @return false if the connection has been closed or the request is no JSON.
+     */
+    virtual bool Call(const std::string& strRequest, std::string& strResponse) = 0;
+};
+
+/// a WebSocket connection to a client, it stays valid after the connection has been closed
+typedef std::shared_ptr<IWebSocketPeer> tWebSocketPeer;
+
+/**
+ * Returns the WebSocket connection the call the current thread handles arrived on.
+ * @return The connection or nullptr if the call did not arrive over a WebSocket.
+ */
+tWebSocketPeer GetCurrentWebSocketPeer();
+
 namespace detail
 {
 
+/**
+ * Response to a request handled by @ref cThreadedHttpServer.
+ * Responses that exceed the chunk size are sent with chunked transfer encoding
+ * while they are written to the stream (if the client speaks HTTP/1.1).
+ */
+class IHttpResponse : public IStreamingResponse, public IEncodedResponse
+{
+public:
+    /**
+     * Sets the content type of the response. Has to be called before any data is written.
+     * @param[in] strContentType The content type.
+     */
+    virtual void SetContentType(const char* strContentType) = 0;
+
+    /**
+     * Returns the size of the response body written so far.
+     * @return The size in bytes.
+     */
+    virtual size_t GetBytesWritten() const = 0;
+
+    /**
+     * Adds a header to the response.
+     * @param[in] strName The name of the header.
+     * @param[in] strValue The value of the header.
+     * @return false if the response is sent in chunks and its headers have already been sent.
+     */
+    virtual bool SetHeader(const char* strName, const char* strValue) = 0;
+
+    /**
+     * Returns when the request started to arrive.
+     * @return Nanoseconds of std::chrono::steady_clock.
+     */
+    virtual uint64_t GetReceivedTime() const = 0;
+
+    /**
+     * Sends the response written so far right away, as a chunk. The first call sends the headers,
+     * further data can be written and flushed as long as the request is handled.
+     * @return false if the client does not accept chunks (HTTP/1.0) or has closed the connection.
+     */
+    virtual bool Flush() = 0;
+};
+
+/**
+ * A WebSocket connection handled by @ref cThreadedHttpServer::HandleWebSocket.
+ */
+class IWebSocket
+{
+public:
+    /**
+     * The outcome of @ref Receive.
+     */
+    enum eReceiveResult
+    {
+        /// a message has been received
+        eMessage,
+        /// no message arrived in time
+        eTimeout,
+        /// the client closed the connection or the server stopped listening
+        eClosed
+    };
+
+    /**
+     * Waits for the next message, pings and close frames are answered meanwhile.
+     * @param[out] strMessage The message.
+     * @param[in] nTimeoutMilliseconds The longest time to wait.
+     * @return Whether a message has been received.
+     */
+    virtual eReceiveResult Receive(std::string& strMessage, uint32_t nTimeoutMilliseconds) = 0;
+
+    /**
+     * Sends a text message.
+     * @param[in] strMessage The message.
+     * @param[in] nMessageSize The size of the message.
+     * @return false if the connection is closed.
+     */
+    virtual bool Send(const char* strMessage, size_t nMessageSize) = 0;
+
+    /**
+     * Returns when the last message started to arrive.
+     * @return Nanoseconds of std::chrono::steady_clock.
+     */
+    virtual uint64_t GetReceivedTime() const = 0;
+};
+
 class cThreadedHttpServer
 {
 public:
@@ -50,11 +165,44 @@ public:
      */
     a_util::result::Result StopListening();
 
+    /**
+     * Compresses responses with gzip or deflate for clients that accept it. Compressed requests
+     * are always accepted. Must not be called while the server is listening.
+     * @param[in] nMinimumSize Smaller responses are sent as they are, compressing them costs more
+     *                         than it saves.
+     */
+    void EnableCompression(size_t nMinimumSize = 1024);
+
 protected:
     virtual bool HandleRequest(const std::string& strUrl,
+                               const std::string& strContentType,
                                const std::string& strRequest,
-                               std::string& strResponse,
-                               std::string& strContentType) = 0;
+                               IHttpResponse& oResponse) = 0;
+
+    /**
+     * Called on the thread that handled a request once its response has been sent.
+     */
+    virtual void OnResponseWritten()
+    {
+    }
+
+    /**
+     * Called for a request that upgrades its connection to a WebSocket, after the handshake. The
+     * connection closes when it returns. The default handles every message like the body of a
+     * request to the URL, on threads of their own so a slow call does not hold up the others,
+     * and sends the response back as a message unless it is empty. While too many messages wait
+     * for a thread, the connection is not read. Requests no object handles are answered with a
+     * JSON-RPC error. Messages that answer calls of @ref IWebSocketPeer are handed over to them.
+     * @param[in] strUrl The URL of the request.
+     * @param[in] oSocket The connection.
+     */
+    virtual void HandleWebSocket(const std::string& strUrl, IWebSocket& oSocket);
+
+    /**
+     * Tells requests that keep their response open when to end.
+     * @return false once @ref StopListening has been called.
+     */
+    bool IsListening() const;
 
 private:
     class cImplementation;
@@ -0,0 +1,336 @@
+/**
+ * @file
+ * gzip and deflate content encodings of HTTP bodies implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <zlib.h>
+#include "rpc_pkg/impl/compression.h"
+
+namespace rpc
+{
+namespace http
+{
+namespace detail
+{
+
+namespace
+{
+/// the window bits of zlib for the gzip format, of the zlib format and to detect either of them
+const int nGzipWindowBits = 15 + 16;
+const int nDeflateWindowBits = 15;
+const int nDetectWindowBits = 15 + 32;
+
+bool IsWhitespace(char cChar)
+{
+    return cChar == ' ' || cChar == '\t';
+}
+
+/**
+ * Compares a token case-insensitively.
+ */
+bool IsToken(const char* pBegin, const char* pEnd, const char* strToken)
+{
+    const size_t nSize = std::strlen(strToken);
+    if (static_cast<size_t>(pEnd - pBegin) != nSize)
+    {
+        return false;
+    }
+    for (size_t nChar = 0; nChar < nSize; ++nChar)
+    {
+        if (std::tolower(static_cast<unsigned char>(pBegin[nChar])) != strToken[nChar])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+eContentEncoding ParseContentEncoding(const std::string& strValue)
+{
+    const char* pBegin = strValue.c_str();
+    const char* pEnd = pBegin + strValue.size();
+    while (pBegin < pEnd && IsWhitespace(*pBegin))
+    {
+        ++pBegin;
+    }
+    while (pEnd > pBegin && IsWhitespace(pEnd[-1]))
+    {
+        --pEnd;
+    }
+    if (pBegin == pEnd || IsToken(pBegin, pEnd, "identity"))
+    {
+        return eEncodingIdentity;
+    }
+    if (IsToken(pBegin, pEnd, "gzip") || IsToken(pBegin, pEnd, "x-gzip"))
+    {
+        return eEncodingGzip;
+    }
+    if (IsToken(pBegin, pEnd, "deflate"))
+    {
+        return eEncodingDeflate;
+    }
+    return eEncodingUnknown;
+}
+
+eContentEncoding SelectContentEncoding(const std::string& strValue)
+{
+    bool bGzip = false;
+    bool bDeflate = false;
+    bool bGzipRefused = false;
+    bool bWildcard = false;
+    const char* pPos = strValue.c_str();
+    while (*pPos)
+    {
+        // one "coding;q=value" per comma
+        while (IsWhitespace(*pPos) || *pPos == ',')
+        {
+            ++pPos;
+        }
+        const char* pCoding = pPos;
+        while (*pPos && *pPos != ',' && *pPos != ';' && !IsWhitespace(*pPos))
+        {
+            ++pPos;
+        }
+        const char* pCodingEnd = pPos;
+        bool bAcceptable = true;
+        while (*pPos && *pPos != ',')
+        {
+            if (*pPos == '=' && (pPos[-1] == 'q' || pPos[-1] == 'Q'))
+            {
+                bAcceptable = std::atof(pPos + 1) > 0.0;
+            }
+            ++pPos;
+        }
+
+        if (IsToken(pCoding, pCodingEnd, "gzip") || IsToken(pCoding, pCodingEnd, "x-gzip"))
+        {
+            bGzip = bAcceptable;
+            bGzipRefused = !bAcceptable;
+        }
+        else if (IsToken(pCoding, pCodingEnd, "deflate"))
+        {
+            bDeflate = bAcceptable;
+        }
+        else if (IsToken(pCoding, pCodingEnd, "*"))
+        {
+            bWildcard = bAcceptable;
+        }
+    }
+
+    if (bGzip || (bWildcard && !bGzipRefused))
+    {
+        return eEncodingGzip;
+    }
+    return bDeflate ? eEncodingDeflate : eEncodingIdentity;
+}
+
+const char* GetContentEncodingName(eContentEncoding eEncoding)
+{
+    switch (eEncoding)
+    {
+        case eEncodingGzip:
+            return "gzip";
+        case eEncodingDeflate:
+            return "deflate";
+        default:
+            return "identity";
+    }
+}
+
+class cCompressor::cImplementation
+{
+public:
+    cImplementation(int nLevel)
+        : m_nLevel(nLevel),
+          m_pDeflate(nullptr),
+          m_bGzipInitialized(false),
+          m_bDeflateInitialized(false),
+          m_bInflateInitialized(false)
+    {
+        std::memset(&m_oGzip, 0, sizeof(m_oGzip));
+        std::memset(&m_oDeflate, 0, sizeof(m_oDeflate));
+        std::memset(&m_oInflate, 0, sizeof(m_oInflate));
+    }
+
+    ~cImplementation()
+    {
+        if (m_bGzipInitialized)
+        {
+            deflateEnd(&m_oGzip);
+        }
+        if (m_bDeflateInitialized)
+        {
+            deflateEnd(&m_oDeflate);
+        }
+        if (m_bInflateInitialized)
+        {
+            inflateEnd(&m_oInflate);
+        }
+    }
+
+    void Begin(eContentEncoding eEncoding)
+    {
+        const bool bGzip = eEncoding == eEncodingGzip;
+        bool& bInitialized = bGzip ? m_bGzipInitialized : m_bDeflateInitialized;
+        m_pDeflate = bGzip ? &m_oGzip : &m_oDeflate;
+        if (bInitialized)
+        {
+            deflateReset(m_pDeflate);
+        }
+        else
+        {
+            deflateInit2(m_pDeflate,
+                         m_nLevel,
+                         Z_DEFLATED,
+                         bGzip ? nGzipWindowBits : nDeflateWindowBits,
+                         8,
+                         Z_DEFAULT_STRATEGY);
+            bInitialized = true;
+        }
+    }
+
+    void Write(const char* pData, size_t nSize, eCompressionFlush eFlush, std::string& strOutput)
+    {
+        z_stream& oStream = *m_pDeflate;
+        oStream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(pData));
+        oStream.avail_in = static_cast<uInt>(nSize);
+        const int nFlush =
+            eFlush == eFlushFinish ? Z_FINISH : (eFlush == eFlushSync ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+        for (;;)
+        {
+            // the bound fits the input, anything the stream holds back needs another round
+            const size_t nOffset = strOutput.size();
+            const size_t nSpace = deflateBound(&oStream, oStream.avail_in) + 16;
+            strOutput.resize(nOffset + nSpace);
+            oStream.next_out = reinterpret_cast<Bytef*>(&strOutput[nOffset]);
+            oStream.avail_out = static_cast<uInt>(nSpace);
+            deflate(&oStream, nFlush);
+            strOutput.resize(nOffset + nSpace - oStream.avail_out);
+            if (oStream.avail_out != 0)
+            {
+                break;
+            }
+        }
+    }
+
+    bool Decompress(const std::string& strData, std::string& strOutput)
+    {
+        if (m_bInflateInitialized)
+        {
+            inflateReset(&m_oInflate);
+        }
+        else
+        {
+            inflateInit2(&m_oInflate, nDetectWindowBits);
+            m_bInflateInitialized = true;
+        }
+
+        strOutput.clear();
+        m_oInflate.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(strData.data()));
+        m_oInflate.avail_in = static_cast<uInt>(strData.size());
+        int nResult = Z_OK;
+        while (nResult != Z_STREAM_END)
+        {
+            const size_t nOffset = strOutput.size();
+            // at least doubles the output each round
+            const size_t nSpace =
+                std::min(std::max<size_t>(std::max(nOffset, strData.size() * 4), 4096),
+                         nMaxDecompressedSize - nOffset);
+            if (nSpace == 0)
+            {
+                return false;
+            }
+            strOutput.resize(nOffset + nSpace);
+            m_oInflate.next_out = reinterpret_cast<Bytef*>(&strOutput[nOffset]);
+            m_oInflate.avail_out = static_cast<uInt>(nSpace);
+            nResult = inflate(&m_oInflate, Z_NO_FLUSH);
+            strOutput.resize(nOffset + nSpace - m_oInflate.avail_out);
+            // a truncated body ends with Z_BUF_ERROR
+            if (nResult != Z_OK && nResult != Z_STREAM_END)
+            {
+                return false;
+            }
+        }
+        return m_oInflate.avail_in == 0;
+    }
+
+private:
+    const int m_nLevel;
+    z_stream m_oGzip;
+    z_stream m_oDeflate;
+    z_stream m_oInflate;
+    z_stream* m_pDeflate;
+    bool m_bGzipInitialized;
+    bool m_bDeflateInitialized;
+    bool m_bInflateInitialized;
+};
+
+const size_t cCompressor::nMaxDecompressedSize;
+
+cCompressor::cCompressor(int nLevel) : m_pImplementation(new cImplementation(nLevel))
+{
+}
+
+cCompressor::~cCompressor()
+{
+}
+
+void cCompressor::Begin(eContentEncoding eEncoding)
+{
+    m_pImplementation->Begin(eEncoding);
+}
+
+void cCompressor::Write(const char* pData,
+                        size_t nSize,
+                        eCompressionFlush eFlush,
+                        std::string& strOutput)
+{
+    m_pImplementation->Write(pData, nSize, eFlush, strOutput);
+}
+
+void cCompressor::Compress(eContentEncoding eEncoding,
+                           const char* pData,
+                           size_t nSize,
+                           std::string& strOutput)
+{
+    strOutput.clear();
+    Begin(eEncoding);
+    Write(pData, nSize, eFlushFinish, strOutput);
+}
+
+bool cCompressor::Decompress(eContentEncoding eEncoding,
+                             const std::string& strData,
+                             std::string& strOutput)
+{
+    if (eEncoding == eEncodingIdentity)
+    {
+        strOutput = strData;
+        return true;
+    }
+    return eEncoding != eEncodingUnknown && m_pImplementation->Decompress(strData, strOutput);
+}
+
+} // namespace detail
+} // namespace http
+} // namespace rpc
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * gzip and deflate content encodings of HTTP bodies declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_COMPRESSION_H_INCLUDED
+#define PKG_RPC_COMPRESSION_H_INCLUDED
+
+#include <a_util/memory.h>
+#include <cstddef>
+#include <string>
+
+namespace rpc
+{
+namespace http
+{
+namespace detail
+{
+
+/**
+ * The content encodings of HTTP bodies.
+ */
+enum eContentEncoding
+{
+    eEncodingIdentity,
+    eEncodingGzip,
+    /// the zlib format, as HTTP defines it
+    eEncodingDeflate,
+    eEncodingUnknown
+};
+
+/**
+ * How much of the data passed to @ref cCompressor::Write is output right away.
+ */
+enum eCompressionFlush
+{
+    /// the compressor may keep data to compress it better
+    eFlushNone,
+    /// everything written so far can be decompressed from the output
+    eFlushSync,
+    /// ends the stream
+    eFlushFinish
+};
+
+/**
+ * Parses a Content-Encoding header.
+ * @param[in] strValue The value of the header.
+ * @return The encoding, @ref eEncodingIdentity if the header is empty.
+ */
+eContentEncoding ParseContentEncoding(const std::string& strValue);
+
+/**
+ * Selects the encoding of a response from an Accept-Encoding header, gzip if acceptable.
+ * @param[in] strValue The value of the header.
+ * @return The encoding, @ref eEncodingIdentity if neither gzip nor deflate is acceptable.
+ */
+eContentEncoding SelectContentEncoding(const std::string& strValue);
+
+/**
+ * Returns the name of an encoding as in Content-Encoding headers.
+ * @param[in] eEncoding The encoding.
+ * @return The name, i.e. "gzip".
+ */
+const char* GetContentEncodingName(eContentEncoding eEncoding);
+
+/**
+ * Compresses and decompresses bodies, keeping the zlib streams and their memory from one body to
+ * the next. Must not be used by several threads at once.
+ */
+class cCompressor
+{
+public:
+    /// decompressed bodies larger than this are rejected
+    static const size_t nMaxDecompressedSize = 256 * 1024 * 1024;
+
+public:
+    /**
+     * Constructor.
+     * @param[in] nLevel The zlib compression level, 1 for the fastest.
+     */
+    explicit cCompressor(int nLevel = 1);
+
+    /**
+     * Destructor.
+     */
+    ~cCompressor();
+
+    /**
+     * Starts to compress a body piece by piece with @ref Write.
+     * @param[in] eEncoding The encoding, gzip or deflate.
+     */
+    void Begin(eContentEncoding eEncoding);
+
+    /**
+     * Compresses the next piece of the body started with @ref Begin.
+     * @param[in] pData The data.
+     * @param[in] nSize The size of the data.
+     * @param[in] eFlush What has to be output.
+     * @param[in,out] strOutput The compressed data is appended.
+     */
+    void Write(const char* pData, size_t nSize, eCompressionFlush eFlush, std::string& strOutput);
+
+    /**
+     * Compresses a whole body.
+     * @param[in] eEncoding The encoding, gzip or deflate.
+     * @param[in] pData The body.
+     * @param[in] nSize The size of the body.
+     * @param[out] strOutput The compressed body.
+     */
+    void Compress(eContentEncoding eEncoding,
+                  const char* pData,
+                  size_t nSize,
+                  std::string& strOutput);
+
+    /**
+     * Decompresses a whole body.
+     * @param[in] eEncoding The encoding, gzip or deflate.
+     * @param[in] strData The compressed body.
+     * @param[out] strOutput The body.
+     * @return false if the body is corrupt, truncated or larger than @ref nMaxDecompressedSize.
+     */
+    bool Decompress(eContentEncoding eEncoding, const std::string& strData, std::string& strOutput);
+
+private:
+    cCompressor(const cCompressor&);
+    cCompressor& operator=(const cCompressor&);
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
+} // namespace detail
+} // namespace http
+} // namespace rpc
+
+#endif // PKG_RPC_COMPRESSION_H_INCLUDED
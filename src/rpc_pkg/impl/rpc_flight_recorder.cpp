@@ -0,0 +1,229 @@
+/**
+ * @file
+ * Recorder of slow RPC calls implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include "rpc_pkg/rpc_flight_recorder.h"
+
+namespace rpc
+{
+
+const size_t cFlightRecorder::nMaxNameSize;
+const size_t cFlightRecorder::nSnippetSize;
+
+tSlowCall::tSlowCall() : nRequestBytes(0), nNanoseconds(0), aPhaseNanoseconds(), nThreadId(0)
+{
+}
+
+namespace
+{
+/**
+ * The fixed size form of a call stored in a slot.
+ */
+struct tRecord
+{
+    uint64_t nRequestBytes;
+    uint64_t nNanoseconds;
+    uint64_t aPhaseNanoseconds[ePhaseCount];
+    uint64_t nThreadId;
+    uint32_t nObjectSize;
+    uint32_t nMethodSize;
+    uint32_t nSnippetSize;
+    char strObject[cFlightRecorder::nMaxNameSize];
+    char strMethod[cFlightRecorder::nMaxNameSize];
+    char strRequest[cFlightRecorder::nSnippetSize];
+};
+
+const size_t nRecordWords = (sizeof(tRecord) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+/**
+ * A seqlock around a record: the sequence is odd while the record is written and 2 * (n + 1)
+ * once the n-th call has been stored. The record is kept in atomic words so a reader may
+ * copy it while a writer overwrites it and detect that afterwards.
+ */
+struct tSlot
+{
+    std::atomic<uint64_t> nSequence;
+    std::atomic<uint64_t> aWords[nRecordWords];
+
+    tSlot() : nSequence(0)
+    {
+        for (std::atomic<uint64_t>& nWord: aWords)
+        {
+            nWord.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+uint32_t CopyTruncated(char* strDestination, const char* strSource, size_t nMaxSize)
+{
+    size_t nSize = 0;
+    while (nSize < nMaxSize && strSource[nSize])
+    {
+        strDestination[nSize] = strSource[nSize];
+        ++nSize;
+    }
+    return static_cast<uint32_t>(nSize);
+}
+
+uint64_t GetThreadId()
+{
+    static thread_local const uint64_t nThreadId =
+        static_cast<uint64_t>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    return nThreadId;
+}
+
+} // namespace
+
+class cFlightRecorder::cImplementation
+{
+public:
+    cImplementation(uint64_t nThresholdNanoseconds, size_t nCapacity)
+        : m_nThreshold(nThresholdNanoseconds),
+          m_oSlots(nCapacity ? nCapacity : 1),
+          m_nNextCall(0)
+    {
+    }
+
+    bool Record(const tRecord& oRecord)
+    {
+        const uint64_t nCall = m_nNextCall.fetch_add(1, std::memory_order_relaxed);
+        tSlot& oSlot = m_oSlots[nCall % m_oSlots.size()];
+
+        // drop the call instead of waiting for a writer lapping us or a slower one before us
+        uint64_t nSequence = oSlot.nSequence.load(std::memory_order_relaxed);
+        if ((nSequence & 1) || nSequence > 2 * nCall ||
+            !oSlot.nSequence.compare_exchange_strong(
+                nSequence, 2 * nCall + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        uint64_t aWords[nRecordWords] = {};
+        std::memcpy(aWords, &oRecord, sizeof(tRecord));
+        for (size_t nWord = 0; nWord < nRecordWords; ++nWord)
+        {
+            oSlot.aWords[nWord].store(aWords[nWord], std::memory_order_relaxed);
+        }
+        oSlot.nSequence.store(2 * nCall + 2, std::memory_order_release);
+        return true;
+    }
+
+    std::vector<tSlowCall> GetCalls() const
+    {
+        std::vector<tSlowCall> oCalls;
+        const uint64_t nEnd = m_nNextCall.load(std::memory_order_acquire);
+        const uint64_t nBegin = nEnd > m_oSlots.size() ? nEnd - m_oSlots.size() : 0;
+        for (uint64_t nCall = nBegin; nCall < nEnd; ++nCall)
+        {
+            const tSlot& oSlot = m_oSlots[nCall % m_oSlots.size()];
+            const uint64_t nSequence = oSlot.nSequence.load(std::memory_order_acquire);
+            if (nSequence != 2 * nCall + 2)
+            {
+                // dropped, overwritten or still being written
+                continue;
+            }
+            uint64_t aWords[nRecordWords];
+            for (size_t nWord = 0; nWord < nRecordWords; ++nWord)
+            {
+                aWords[nWord] = oSlot.aWords[nWord].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (oSlot.nSequence.load(std::memory_order_relaxed) != nSequence)
+            {
+                continue;
+            }
+
+            tRecord oRecord;
+            std::memcpy(&oRecord, aWords, sizeof(tRecord));
+            tSlowCall oCall;
+            oCall.strObject.assign(oRecord.strObject, oRecord.nObjectSize);
+            oCall.strMethod.assign(oRecord.strMethod, oRecord.nMethodSize);
+            oCall.nRequestBytes = oRecord.nRequestBytes;
+            oCall.nNanoseconds = oRecord.nNanoseconds;
+            std::memcpy(oCall.aPhaseNanoseconds,
+                        oRecord.aPhaseNanoseconds,
+                        sizeof(oCall.aPhaseNanoseconds));
+            oCall.nThreadId = oRecord.nThreadId;
+            oCall.strRequest.assign(oRecord.strRequest, oRecord.nSnippetSize);
+            oCalls.push_back(oCall);
+        }
+        return oCalls;
+    }
+
+public:
+    const uint64_t m_nThreshold;
+
+private:
+    std::vector<tSlot> m_oSlots;
+    std::atomic<uint64_t> m_nNextCall;
+};
+
+cFlightRecorder::cFlightRecorder(uint64_t nThresholdNanoseconds, size_t nCapacity)
+    : m_pImplementation(new cImplementation(nThresholdNanoseconds, nCapacity))
+{
+}
+
+cFlightRecorder::~cFlightRecorder()
+{
+}
+
+uint64_t cFlightRecorder::GetThreshold() const
+{
+    return m_pImplementation->m_nThreshold;
+}
+
+bool cFlightRecorder::Record(const char* strObject,
+                             const char* strMethod,
+                             const char* strRequest,
+                             size_t nRequestBytes,
+                             uint64_t nNanoseconds,
+                             const uint64_t* pPhaseNanoseconds)
+{
+    if (nNanoseconds < m_pImplementation->m_nThreshold)
+    {
+        return false;
+    }
+
+    tRecord oRecord = {};
+    oRecord.nRequestBytes = nRequestBytes;
+    oRecord.nNanoseconds = nNanoseconds;
+    for (size_t nPhase = 0; nPhase < ePhaseCount; ++nPhase)
+    {
+        oRecord.aPhaseNanoseconds[nPhase] = pPhaseNanoseconds ? pPhaseNanoseconds[nPhase] : 0;
+    }
+    oRecord.nThreadId = GetThreadId();
+    oRecord.nObjectSize = CopyTruncated(oRecord.strObject, strObject, nMaxNameSize);
+    oRecord.nMethodSize = CopyTruncated(oRecord.strMethod, strMethod, nMaxNameSize);
+    oRecord.nSnippetSize =
+        static_cast<uint32_t>(nRequestBytes < nSnippetSize ? nRequestBytes : nSnippetSize);
+    std::memcpy(oRecord.strRequest, strRequest, oRecord.nSnippetSize);
+    return m_pImplementation->Record(oRecord);
+}
+
+std::vector<tSlowCall> cFlightRecorder::GetCalls() const
+{
+    return m_pImplementation->GetCalls();
+}
+
+} // namespace rpc
@@ -0,0 +1,405 @@
+/**
+ * @file
+ * RPC call metrics implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <a_util/concurrency/mutex.h>
+#include "rpc_pkg/rpc_metrics.h"
+#include "rpc_pkg/impl/rpc_lock_helper.h"
+
+namespace rpc
+{
+
+cLatencyHistogram::cLatencyHistogram() : m_aBuckets()
+{
+}
+
+size_t cLatencyHistogram::GetBucket(uint64_t nNanoseconds)
+{
+    if (nNanoseconds < 16)
+    {
+        return static_cast<size_t>(nNanoseconds);
+    }
+
+    size_t nExponent = 0;
+    for (size_t nShift = 32; nShift > 0; nShift /= 2)
+    {
+        if (nNanoseconds >> (nExponent + nShift))
+        {
+            nExponent += nShift;
+        }
+    }
+    const size_t nBucket =
+        16 + (nExponent - 4) * 8 + static_cast<size_t>((nNanoseconds >> (nExponent - 3)) & 7);
+    return nBucket < nBucketCount ? nBucket : nBucketCount - 1;
+}
+
+uint64_t cLatencyHistogram::GetBucketLimit(size_t nBucket)
+{
+    if (nBucket < 16)
+    {
+        return nBucket;
+    }
+    const size_t nExponent = 4 + (nBucket - 16) / 8;
+    const uint64_t nWidth = uint64_t(1) << (nExponent - 3);
+    return (8 + (nBucket - 16) % 8 + 1) * nWidth - 1;
+}
+
+void cLatencyHistogram::Add(const cLatencyHistogram& oOther)
+{
+    for (size_t nBucket = 0; nBucket < nBucketCount; ++nBucket)
+    {
+        m_aBuckets[nBucket] += oOther.m_aBuckets[nBucket];
+    }
+}
+
+uint64_t cLatencyHistogram::GetCount() const
+{
+    uint64_t nCount = 0;
+    for (size_t nBucket = 0; nBucket < nBucketCount; ++nBucket)
+    {
+        nCount += m_aBuckets[nBucket];
+    }
+    return nCount;
+}
+
+uint64_t cLatencyHistogram::GetPercentile(double fShare) const
+{
+    const uint64_t nCount = GetCount();
+    if (nCount == 0)
+    {
+        return 0;
+    }
+    // the rank of the percentile, at least the first latency
+    uint64_t nRank = static_cast<uint64_t>(fShare * static_cast<double>(nCount) + 0.5);
+    nRank = nRank == 0 ? 1 : (nRank > nCount ? nCount : nRank);
+    uint64_t nSeen = 0;
+    for (size_t nBucket = 0; nBucket < nBucketCount; ++nBucket)
+    {
+        nSeen += m_aBuckets[nBucket];
+        if (nSeen >= nRank)
+        {
+            return GetBucketLimit(nBucket);
+        }
+    }
+    return GetBucketLimit(nBucketCount - 1);
+}
+
+const char* GetPhaseName(ePhase ePhase)
+{
+    static const char* const aNames[ePhaseCount] = {
+        "read", "lock", "parse", "dispatch", "serialize", "write"};
+    return ePhase < ePhaseCount ? aNames[ePhase] : "";
+}
+
+tCallMetrics::tCallMetrics()
+    : nCalls(0), nErrors(0), nBytesIn(0), nBytesOut(0), nTimedCalls(0), aPhaseNanoseconds()
+{
+}
+
+namespace
+{
+/**
+ * Counters of one object or method, only written by the thread owning the shard.
+ */
+struct tEntry
+{
+    std::string strObject;
+    std::string strMethod;
+    uint64_t nHash;
+    std::atomic<uint64_t> nCalls;
+    std::atomic<uint64_t> nErrors;
+    std::atomic<uint64_t> nBytesIn;
+    std::atomic<uint64_t> nBytesOut;
+    std::atomic<uint64_t> aLatency[cLatencyHistogram::nBucketCount];
+    std::atomic<uint64_t> nTimedCalls;
+    std::atomic<uint64_t> aPhases[ePhaseCount];
+
+    tEntry(const std::string& strObject, const std::string& strMethod, uint64_t nHash)
+        : strObject(strObject),
+          strMethod(strMethod),
+          nHash(nHash),
+          nCalls(0),
+          nErrors(0),
+          nBytesIn(0),
+          nBytesOut(0),
+          nTimedCalls(0)
+    {
+        for (std::atomic<uint64_t>& nBucket: aLatency)
+        {
+            nBucket.store(0, std::memory_order_relaxed);
+        }
+        for (std::atomic<uint64_t>& nPhase: aPhases)
+        {
+            nPhase.store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+/// single writer, so there is no need for an atomic read-modify-write
+inline void Increment(std::atomic<uint64_t>& nCounter, uint64_t nValue)
+{
+    nCounter.store(nCounter.load(std::memory_order_relaxed) + nValue, std::memory_order_relaxed);
+}
+
+/**
+ * The counters of one thread at a time, an open addressing table of entries that are published
+ * once and never removed.
+ */
+struct tShard
+{
+    std::atomic<bool> bInUse;
+    std::atomic<tEntry*> aEntries[cRPCMetrics::nMaxEntries];
+
+    tShard() : bInUse(true)
+    {
+        for (std::atomic<tEntry*>& pEntry: aEntries)
+        {
+            pEntry.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~tShard()
+    {
+        for (std::atomic<tEntry*>& pEntry: aEntries)
+        {
+            delete pEntry.load(std::memory_order_relaxed);
+        }
+    }
+
+    tEntry* Find(const std::string& strObject, const std::string& strMethod)
+    {
+        // FNV-1a of both names
+        uint64_t nHash = 14695981039346656037ull;
+        for (const std::string* pName: {&strObject, &strMethod})
+        {
+            for (char cChar: *pName)
+            {
+                nHash = (nHash ^ static_cast<unsigned char>(cChar)) * 1099511628211ull;
+            }
+            nHash = (nHash ^ 0xff) * 1099511628211ull;
+        }
+
+        for (size_t nProbe = 0; nProbe < cRPCMetrics::nMaxEntries; ++nProbe)
+        {
+            std::atomic<tEntry*>& pSlot = aEntries[(nHash + nProbe) % cRPCMetrics::nMaxEntries];
+            tEntry* pEntry = pSlot.load(std::memory_order_relaxed);
+            if (!pEntry)
+            {
+                pEntry = new tEntry(strObject, strMethod, nHash);
+                pSlot.store(pEntry, std::memory_order_release);
+                return pEntry;
+            }
+            if (pEntry->nHash == nHash && pEntry->strObject == strObject &&
+                pEntry->strMethod == strMethod)
+            {
+                return pEntry;
+            }
+        }
+        return nullptr;
+    }
+};
+
+/**
+ * The shard of the current thread, handed back when the thread ends.
+ */
+struct tThreadShard
+{
+    uint64_t nOwner;
+    std::shared_ptr<tShard> pShard;
+
+    tThreadShard() : nOwner(0)
+    {
+    }
+
+    ~tThreadShard()
+    {
+        Release();
+    }
+
+    void Release()
+    {
+        if (pShard)
+        {
+            pShard->bInUse.store(false, std::memory_order_release);
+            pShard.reset();
+        }
+    }
+};
+
+thread_local tThreadShard oThreadShard;
+std::atomic<uint64_t> nNextOwner(1);
+
+} // namespace
+
+class cRPCMetrics::cImplementation
+{
+public:
+    cImplementation() : m_nId(nNextOwner.fetch_add(1, std::memory_order_relaxed))
+    {
+    }
+
+    tEntry* Find(const std::string& strObject, const std::string& strMethod)
+    {
+        if (oThreadShard.nOwner != m_nId)
+        {
+            Acquire();
+        }
+        return oThreadShard.pShard->Find(strObject, strMethod);
+    }
+
+    tMetricsSnapshot GetSnapshot() const
+    {
+        std::map<std::pair<std::string, std::string>, tCallMetrics> oMetrics;
+        detail::lock_guard<a_util::concurrency::mutex> oGuard(m_oShardsLock);
+        for (const std::shared_ptr<tShard>& pShard: m_oShards)
+        {
+            for (const std::atomic<tEntry*>& pSlot: pShard->aEntries)
+            {
+                const tEntry* pEntry = pSlot.load(std::memory_order_acquire);
+                if (!pEntry)
+                {
+                    continue;
+                }
+                tCallMetrics& oEntry = oMetrics[std::make_pair(pEntry->strObject, pEntry->strMethod)];
+                oEntry.nCalls += pEntry->nCalls.load(std::memory_order_relaxed);
+                oEntry.nErrors += pEntry->nErrors.load(std::memory_order_relaxed);
+                oEntry.nBytesIn += pEntry->nBytesIn.load(std::memory_order_relaxed);
+                oEntry.nBytesOut += pEntry->nBytesOut.load(std::memory_order_relaxed);
+                for (size_t nBucket = 0; nBucket < cLatencyHistogram::nBucketCount; ++nBucket)
+                {
+                    oEntry.oLatency.m_aBuckets[nBucket] +=
+                        pEntry->aLatency[nBucket].load(std::memory_order_relaxed);
+                }
+                oEntry.nTimedCalls += pEntry->nTimedCalls.load(std::memory_order_relaxed);
+                for (size_t nPhase = 0; nPhase < ePhaseCount; ++nPhase)
+                {
+                    oEntry.aPhaseNanoseconds[nPhase] +=
+                        pEntry->aPhases[nPhase].load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        tMetricsSnapshot oSnapshot;
+        oSnapshot.reserve(oMetrics.size());
+        for (auto& oEntry: oMetrics)
+        {
+            oEntry.second.strObject = oEntry.first.first;
+            oEntry.second.strMethod = oEntry.first.second;
+            oSnapshot.push_back(oEntry.second);
+        }
+        return oSnapshot;
+    }
+
+private:
+    /**
+     * Takes over a shard of an ended thread or adds a new one.
+     */
+    void Acquire()
+    {
+        oThreadShard.Release();
+        detail::lock_guard<a_util::concurrency::mutex> oGuard(m_oShardsLock);
+        for (const std::shared_ptr<tShard>& pShard: m_oShards)
+        {
+            bool bInUse = false;
+            if (pShard->bInUse.compare_exchange_strong(bInUse, true, std::memory_order_acquire))
+            {
+                oThreadShard.pShard = pShard;
+                oThreadShard.nOwner = m_nId;
+                return;
+            }
+        }
+        m_oShards.push_back(std::make_shared<tShard>());
+        oThreadShard.pShard = m_oShards.back();
+        oThreadShard.nOwner = m_nId;
+    }
+
+private:
+    const uint64_t m_nId;
+    mutable a_util::concurrency::mutex m_oShardsLock;
+    std::vector<std::shared_ptr<tShard>> m_oShards;
+};
+
+cRPCMetrics::cRPCMetrics() : m_pImplementation(new cImplementation)
+{
+}
+
+cRPCMetrics::~cRPCMetrics()
+{
+}
+
+void cRPCMetrics::RecordCall(const std::string& strObject,
+                             const std::string& strMethod,
+                             bool bError,
+                             size_t nBytesIn,
+                             size_t nBytesOut,
+                             uint64_t nNanoseconds,
+                             const uint64_t* pPhaseNanoseconds)
+{
+    tEntry* pEntry = m_pImplementation->Find(strObject, strMethod);
+    if (pEntry)
+    {
+        Increment(pEntry->nCalls, 1);
+        Increment(pEntry->nErrors, bError ? 1 : 0);
+        Increment(pEntry->nBytesIn, nBytesIn);
+        Increment(pEntry->nBytesOut, nBytesOut);
+        Increment(pEntry->aLatency[cLatencyHistogram::GetBucket(nNanoseconds)], 1);
+        if (pPhaseNanoseconds)
+        {
+            Increment(pEntry->nTimedCalls, 1);
+            for (size_t nPhase = 0; nPhase < ePhaseWrite; ++nPhase)
+            {
+                Increment(pEntry->aPhases[nPhase], pPhaseNanoseconds[nPhase]);
+            }
+        }
+    }
+}
+
+void cRPCMetrics::RecordPhase(const std::string& strObject,
+                              const std::string& strMethod,
+                              ePhase ePhase,
+                              uint64_t nNanoseconds)
+{
+    tEntry* pEntry = m_pImplementation->Find(strObject, strMethod);
+    if (pEntry && ePhase < ePhaseCount)
+    {
+        Increment(pEntry->aPhases[ePhase], nNanoseconds);
+    }
+}
+
+void cRPCMetrics::RecordBatchedCall(const std::string& strObject,
+                                    const std::string& strMethod,
+                                    bool bError)
+{
+    tEntry* pEntry = m_pImplementation->Find(strObject, strMethod);
+    if (pEntry)
+    {
+        Increment(pEntry->nCalls, 1);
+        Increment(pEntry->nErrors, bError ? 1 : 0);
+    }
+}
+
+tMetricsSnapshot cRPCMetrics::GetSnapshot() const
+{
+    return m_pImplementation->GetSnapshot();
+}
+
+} // namespace rpc
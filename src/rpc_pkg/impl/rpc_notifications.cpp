@@ -0,0 +1,189 @@
+/**
+ * @file
+ * Fan-out of notifications to the subscribers of topics implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <a_util/concurrency.h>
+#include "rpc_pkg/rpc_notifications.h"
+#include "rpc_pkg/impl/rpc_lock_helper.h"
+
+namespace rpc
+{
+
+struct cNotificationHub::cSubscription::tQueue
+{
+    std::mutex oLock;
+    std::condition_variable oArrived;
+    std::deque<tNotificationPtr> oNotifications;
+    uint64_t nDropped;
+
+    tQueue() : nDropped(0)
+    {
+    }
+
+    void Push(const tNotificationPtr& pNotification, size_t nCapacity, eOverflowPolicy eOverflow)
+    {
+        {
+            std::lock_guard<std::mutex> oGuard(oLock);
+            if (oNotifications.size() >= nCapacity)
+            {
+                ++nDropped;
+                if (eOverflow == eDropNewest)
+                {
+                    return;
+                }
+                if (eOverflow == eCoalesce)
+                {
+                    const std::deque<tNotificationPtr>::iterator itQueued = std::find_if(
+                        oNotifications.begin(),
+                        oNotifications.end(),
+                        [&pNotification](const tNotificationPtr& pQueued) {
+                            return pQueued->strKey == pNotification->strKey;
+                        });
+                    if (itQueued != oNotifications.end())
+                    {
+                        *itQueued = pNotification;
+                        return;
+                    }
+                }
+                oNotifications.pop_front();
+            }
+            oNotifications.push_back(pNotification);
+        }
+        oArrived.notify_one();
+    }
+};
+
+class cNotificationHub::cImplementation
+{
+public:
+    cImplementation(size_t nQueueCapacity, eOverflowPolicy eOverflow)
+        : m_nQueueCapacity(std::max<size_t>(nQueueCapacity, 1)), m_eOverflow(eOverflow)
+    {
+    }
+
+    void Subscribe(const std::string& strTopic, cSubscription::tQueue* pQueue)
+    {
+        detail::lock_guard<a_util::concurrency::shared_mutex> oGuard(m_oSubscribersLock);
+        m_oSubscribers[strTopic].push_back(pQueue);
+    }
+
+    void Unsubscribe(const std::string& strTopic, cSubscription::tQueue* pQueue)
+    {
+        detail::lock_guard<a_util::concurrency::shared_mutex> oGuard(m_oSubscribersLock);
+        tSubscribers::iterator itTopic = m_oSubscribers.find(strTopic);
+        if (itTopic != m_oSubscribers.end())
+        {
+            std::vector<cSubscription::tQueue*>& oQueues = itTopic->second;
+            oQueues.erase(std::remove(oQueues.begin(), oQueues.end(), pQueue), oQueues.end());
+            if (oQueues.empty())
+            {
+                m_oSubscribers.erase(itTopic);
+            }
+        }
+    }
+
+    size_t Publish(const std::string& strTopic, const tNotificationPtr& pNotification)
+    {
+        detail::shared_lock<a_util::concurrency::shared_mutex> oGuard(m_oSubscribersLock);
+        tSubscribers::const_iterator itTopic = m_oSubscribers.find(strTopic);
+        if (itTopic == m_oSubscribers.end())
+        {
+            return 0;
+        }
+        for (cSubscription::tQueue* pQueue: itTopic->second)
+        {
+            pQueue->Push(pNotification, m_nQueueCapacity, m_eOverflow);
+        }
+        return itTopic->second.size();
+    }
+
+    size_t GetSubscriberCount(const std::string& strTopic) const
+    {
+        detail::shared_lock<a_util::concurrency::shared_mutex> oGuard(m_oSubscribersLock);
+        tSubscribers::const_iterator itTopic = m_oSubscribers.find(strTopic);
+        return itTopic == m_oSubscribers.end() ? 0 : itTopic->second.size();
+    }
+
+private:
+    typedef std::map<std::string, std::vector<cSubscription::tQueue*>> tSubscribers;
+    const size_t m_nQueueCapacity;
+    const eOverflowPolicy m_eOverflow;
+    mutable a_util::concurrency::shared_mutex m_oSubscribersLock;
+    tSubscribers m_oSubscribers;
+};
+
+cNotificationHub::cSubscription::cSubscription(cNotificationHub& oHub, const std::string& strTopic)
+    : m_oHub(oHub), m_strTopic(strTopic), m_pQueue(new tQueue)
+{
+    m_oHub.m_pImplementation->Subscribe(m_strTopic, m_pQueue.get());
+}
+
+cNotificationHub::cSubscription::~cSubscription()
+{
+    m_oHub.m_pImplementation->Unsubscribe(m_strTopic, m_pQueue.get());
+}
+
+bool cNotificationHub::cSubscription::Take(std::vector<tNotificationPtr>& oNotifications,
+                                           uint32_t nTimeoutMilliseconds)
+{
+    std::unique_lock<std::mutex> oGuard(m_pQueue->oLock);
+    if (!m_pQueue->oArrived.wait_for(oGuard,
+                                     std::chrono::milliseconds(nTimeoutMilliseconds),
+                                     [this]() { return !m_pQueue->oNotifications.empty(); }))
+    {
+        return false;
+    }
+    oNotifications.assign(m_pQueue->oNotifications.begin(), m_pQueue->oNotifications.end());
+    m_pQueue->oNotifications.clear();
+    return true;
+}
+
+uint64_t cNotificationHub::cSubscription::GetDropped() const
+{
+    std::lock_guard<std::mutex> oGuard(m_pQueue->oLock);
+    return m_pQueue->nDropped;
+}
+
+cNotificationHub::cNotificationHub(size_t nQueueCapacity, eOverflowPolicy eOverflow)
+    : m_pImplementation(new cImplementation(nQueueCapacity, eOverflow))
+{
+}
+
+cNotificationHub::~cNotificationHub()
+{
+}
+
+size_t cNotificationHub::Publish(const std::string& strTopic,
+                                 const tNotificationPtr& pNotification)
+{
+    return m_pImplementation->Publish(strTopic, pNotification);
+}
+
+size_t cNotificationHub::GetSubscriberCount(const std::string& strTopic) const
+{
+    return m_pImplementation->GetSubscriberCount(strTopic);
+}
+
+} // namespace rpc
@@ -34,55 +34,145 @@ cRPCObjectsRegistry::~cRPCObjectsRegistry()
 
 Result cRPCObjectsRegistry::RegisterRPCObject(const char* strName, IRPCObject* pObject)
 {
-    std::string strLocalName(strName);
+    a_util::memory::unique_ptr<a_util::concurrency::shared_mutex> pLock(
+        new a_util::concurrency::shared_mutex);
     detail::lock_guard<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
-    tRPCObjects::iterator itExisting = m_oRPCObjects.find(strLocalName);
+    return InsertRPCObject(strName, pLock, pObject);
+}
 
-    if (itExisting != m_oRPCObjects.end())
+a_util::result::Result cRPCObjectsRegistry::UnregisterRPCObject(const char* strName)
+{
+    return UnregisterRPCObjects(std::vector<std::string>(1, strName));
+}
+
+Result cRPCObjectsRegistry::RegisterRPCObjects(const tRPCObjectList& oObjects)
+{
+    // create the locks of the objects before the registry is locked
+    std::vector<a_util::memory::unique_ptr<a_util::concurrency::shared_mutex>> oLocks(
+        oObjects.size());
+    for (size_t nObject = 0; nObject < oObjects.size(); ++nObject)
     {
-        RETURN_ERROR_DESCRIPTION(
-            AlreadyRegistered, "RPC-Registry: Object '%s' already registered.", strName);
+        oLocks[nObject].reset(new a_util::concurrency::shared_mutex);
     }
 
-    m_oRPCObjects[strLocalName].first.reset(new a_util::concurrency::shared_mutex);
-    m_oRPCObjects[strLocalName].second = pObject;
+    detail::lock_guard<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
+    for (size_t nObject = 0; nObject < oObjects.size(); ++nObject)
+    {
+        const Result nResult =
+            InsertRPCObject(oObjects[nObject].first, oLocks[nObject], oObjects[nObject].second);
+        if (isFailed(nResult))
+        {
+            while (nObject-- > 0)
+            {
+                m_oRouter.Remove(oObjects[nObject].first.c_str());
+                m_oRPCObjects.erase(oObjects[nObject].first);
+            }
+            return nResult;
+        }
+    }
     return Result();
 }
 
-a_util::result::Result cRPCObjectsRegistry::UnregisterRPCObject(const char* strName)
+a_util::result::Result cRPCObjectsRegistry::UnregisterRPCObjects(
+    const std::vector<std::string>& oNames)
 {
-    detail::lock_guard<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
-    tRPCObjects::iterator itExisting = m_oRPCObjects.find(strName);
-
-    if (itExisting == m_oRPCObjects.end())
+    std::vector<a_util::memory::unique_ptr<a_util::concurrency::shared_mutex>> oLocks;
     {
-        RETURN_ERROR_DESCRIPTION(NotFound, "RPC-Registry: Object '%s' not found.", strName);
+        detail::lock_guard<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
+        for (const std::string& strName: oNames)
+        {
+            if (m_oRPCObjects.find(strName) == m_oRPCObjects.end())
+            {
+                RETURN_ERROR_DESCRIPTION(
+                    NotFound, "RPC-Registry: Object '%s' not found.", strName.c_str());
+            }
+        }
+
+        oLocks.reserve(oNames.size());
+        for (const std::string& strName: oNames)
+        {
+            tRPCObjects::iterator itExisting = m_oRPCObjects.find(strName);
+            // a name given twice
+            if (itExisting == m_oRPCObjects.end())
+            {
+                continue;
+            }
+            m_oRouter.Remove(strName.c_str());
+            oLocks.push_back(std::move(itExisting->second.first));
+            m_oRPCObjects.erase(itExisting);
+        }
     }
 
-    // make sure no one is using it anymore.
+    // no lookup finds the objects anymore, so make sure no one is using them by waiting for the
+    // calls in progress on all of them at once, the registry stays available meanwhile.
     // mind that an object cannot be unregistered in its own method call
+    for (const a_util::memory::unique_ptr<a_util::concurrency::shared_mutex>& pLock: oLocks)
     {
-        detail::lock_guard<a_util::concurrency::shared_mutex> oObjectGuard(
-            *itExisting->second.first);
+        detail::lock_guard<a_util::concurrency::shared_mutex> oObjectGuard(*pLock);
     }
 
-    m_oRPCObjects.erase(itExisting);
+    return Result();
+}
+
+Result cRPCObjectsRegistry::InsertRPCObject(
+    const std::string& strName,
+    a_util::memory::unique_ptr<a_util::concurrency::shared_mutex>& pLock,
+    IRPCObject* pObject)
+{
+    tRPCObjects::iterator itExisting = m_oRPCObjects.find(strName);
 
+    if (itExisting != m_oRPCObjects.end())
+    {
+        RETURN_ERROR_DESCRIPTION(
+            AlreadyRegistered, "RPC-Registry: Object '%s' already registered.", strName.c_str());
+    }
+
+    // the routes lead to the entries, so lookups know the route they matched
+    tRPCObjects::value_type& oEntry = *m_oRPCObjects.emplace(strName, tRPCItem()).first;
+    if (!m_oRouter.Insert(strName.c_str(), &oEntry))
+    {
+        m_oRPCObjects.erase(strName);
+        RETURN_ERROR_DESCRIPTION(AlreadyRegistered,
+                                 "RPC-Registry: Route of object '%s' conflicts with another one.",
+                                 strName.c_str());
+    }
+    oEntry.second.first = std::move(pLock);
+    oEntry.second.second = pObject;
     return Result();
 }
 
 cRPCObjectsRegistry::cLockedRPCObject cRPCObjectsRegistry::GetRPCObject(const char* strName) const
 {
-    tRPCObjects::const_iterator itObject;
+    tRouteMatch oMatch;
+    return GetRPCObject(strName, oMatch);
+}
+
+cRPCObjectsRegistry::cLockedRPCObject cRPCObjectsRegistry::GetRPCObject(const char* strPath,
+                                                                        tRouteMatch& oMatch) const
+{
+    detail::shared_lock<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
+    if (!m_oRouter.Find(strPath, oMatch))
     {
-        detail::shared_lock<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
-        itObject = m_oRPCObjects.find(strName);
-        if (itObject == m_oRPCObjects.end())
-        {
-            return cLockedRPCObject();
-        }
-        return cLockedRPCObject(itObject->second);
+        return cLockedRPCObject();
+    }
+    return cLockedRPCObject(static_cast<const tRPCObjects::value_type*>(oMatch.pTarget)->second);
+}
+
+cRPCObjectsRegistry::cLockedRPCObject cRPCObjectsRegistry::GetRPCObject(const char* strPath,
+                                                                        tRouteMatch& oMatch,
+                                                                        std::string& strRoute) const
+{
+    detail::shared_lock<a_util::concurrency::shared_mutex> oGuard(m_oObjectsLock);
+    if (!m_oRouter.Find(strPath, oMatch))
+    {
+        strRoute.clear();
+        return cLockedRPCObject();
     }
+    // copied, the entry is removed before the calls in progress are waited for
+    const tRPCObjects::value_type& oEntry =
+        *static_cast<const tRPCObjects::value_type*>(oMatch.pTarget);
+    strRoute = oEntry.first;
+    return cLockedRPCObject(oEntry.second);
 }
 
 } // namespace rpc
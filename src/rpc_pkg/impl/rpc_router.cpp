@@ -0,0 +1,383 @@
+/**
+ * @file
+ * Prefix tree router for RPC object paths implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <cstring>
+#include <vector>
+#include "rpc_pkg/rpc_router.h"
+
+namespace rpc
+{
+
+const size_t tRouteMatch::nMaxParameters;
+
+tRouteMatch::tRouteMatch() : pTarget(nullptr), nParameterCount(0)
+{
+}
+
+std::string tRouteMatch::GetParameter(const char* strName, const std::string& strDefault) const
+{
+    const size_t nNameSize = std::strlen(strName);
+    for (size_t nParameter = 0; nParameter < nParameterCount; ++nParameter)
+    {
+        const tRouteParameter& oParameter = aParameters[nParameter];
+        if (oParameter.nNameSize == nNameSize &&
+            std::memcmp(oParameter.strName, strName, nNameSize) == 0)
+        {
+            return std::string(oParameter.strValue, oParameter.nValueSize);
+        }
+    }
+    return strDefault;
+}
+
+namespace
+{
+const char* const strMountParameter = "*";
+
+thread_local const tRouteMatch* pCurrentRoute = nullptr;
+
+/**
+ * A node of the tree, reached by the bytes of its prefix from its parent.
+ */
+struct tNode
+{
+    /// the bytes of the edge from the parent
+    std::string strPrefix;
+    /// the first byte of the prefix of each child, in the order of @ref oChildren
+    std::string strIndices;
+    /// the children continuing with exact bytes
+    std::vector<a_util::memory::unique_ptr<tNode>> oChildren;
+    /// the child matching a parameter segment, its children continue after the segment
+    a_util::memory::unique_ptr<tNode> pParameter;
+    /// the name of the parameter if this node is one
+    std::string strParameter;
+    /// the target of the route ending here
+    void* pTarget;
+    /// the target of the route mounted on the subtree below this node
+    void* pMount;
+
+    tNode() : pTarget(nullptr), pMount(nullptr)
+    {
+    }
+
+    bool IsEmpty() const
+    {
+        return !pTarget && !pMount && oChildren.empty() && !pParameter;
+    }
+};
+
+bool IsSegmentStart(const char* strRoute, const char* pPos)
+{
+    return pPos == strRoute || pPos[-1] == '/';
+}
+
+bool IsParameter(const char* strRoute, const char* pPos)
+{
+    return *pPos == ':' && IsSegmentStart(strRoute, pPos);
+}
+
+bool IsMount(const char* strRoute, const char* pPos)
+{
+    return pPos[0] == '*' && pPos[1] == '\0' && IsSegmentStart(strRoute, pPos);
+}
+
+const char* GetSegmentEnd(const char* pPos)
+{
+    while (*pPos && *pPos != '/')
+    {
+        ++pPos;
+    }
+    return pPos;
+}
+
+/**
+ * Returns the end of the exact bytes starting at pPos, up to the next parameter or mount.
+ */
+const char* GetLiteralEnd(const char* strRoute, const char* pPos)
+{
+    do
+    {
+        ++pPos;
+    } while (*pPos && !IsParameter(strRoute, pPos) && !IsMount(strRoute, pPos));
+    return pPos;
+}
+
+/**
+ * Returns the node reached by the bytes, splitting an edge or adding a child where necessary.
+ */
+tNode& InsertLiteral(tNode& oRoot, const char* strBytes, size_t nSize)
+{
+    tNode* pNode = &oRoot;
+    while (nSize > 0)
+    {
+        const size_t nChild = pNode->strIndices.find(*strBytes);
+        if (nChild == std::string::npos)
+        {
+            a_util::memory::unique_ptr<tNode> pChild(new tNode);
+            pChild->strPrefix.assign(strBytes, nSize);
+            pNode->strIndices.push_back(*strBytes);
+            pNode->oChildren.push_back(std::move(pChild));
+            return *pNode->oChildren.back();
+        }
+
+        a_util::memory::unique_ptr<tNode>& pChild = pNode->oChildren[nChild];
+        const std::string& strPrefix = pChild->strPrefix;
+        size_t nCommon = 1;
+        while (nCommon < strPrefix.size() && nCommon < nSize &&
+               strPrefix[nCommon] == strBytes[nCommon])
+        {
+            ++nCommon;
+        }
+        if (nCommon < strPrefix.size())
+        {
+            a_util::memory::unique_ptr<tNode> pSplit(new tNode);
+            pSplit->strPrefix.assign(strPrefix, 0, nCommon);
+            pChild->strPrefix.erase(0, nCommon);
+            pSplit->strIndices.push_back(pChild->strPrefix[0]);
+            pSplit->oChildren.push_back(std::move(pChild));
+            pChild = std::move(pSplit);
+        }
+        pNode = pChild.get();
+        strBytes += nCommon;
+        nSize -= nCommon;
+    }
+    return *pNode;
+}
+
+bool FindAt(const tNode& oNode, const char* pPos, tRouteMatch& oMatch)
+{
+    if (*pPos == '\0')
+    {
+        if (oNode.pTarget)
+        {
+            oMatch.pTarget = oNode.pTarget;
+            return true;
+        }
+    }
+    else
+    {
+        const size_t nChild = oNode.strIndices.find(*pPos);
+        if (nChild != std::string::npos)
+        {
+            const tNode& oChild = *oNode.oChildren[nChild];
+            if (std::strncmp(pPos, oChild.strPrefix.data(), oChild.strPrefix.size()) == 0 &&
+                FindAt(oChild, pPos + oChild.strPrefix.size(), oMatch))
+            {
+                return true;
+            }
+        }
+
+        const char* pSegmentEnd = GetSegmentEnd(pPos);
+        if (oNode.pParameter && pSegmentEnd != pPos)
+        {
+            tRouteParameter& oParameter = oMatch.aParameters[oMatch.nParameterCount++];
+            oParameter.strName = oNode.pParameter->strParameter.c_str();
+            oParameter.nNameSize = oNode.pParameter->strParameter.size();
+            oParameter.strValue = pPos;
+            oParameter.nValueSize = static_cast<size_t>(pSegmentEnd - pPos);
+            if (FindAt(*oNode.pParameter, pSegmentEnd, oMatch))
+            {
+                return true;
+            }
+            --oMatch.nParameterCount;
+        }
+    }
+
+    if (oNode.pMount)
+    {
+        tRouteParameter& oParameter = oMatch.aParameters[oMatch.nParameterCount++];
+        oParameter.strName = strMountParameter;
+        oParameter.nNameSize = 1;
+        oParameter.strValue = pPos;
+        oParameter.nValueSize = std::strlen(pPos);
+        oMatch.pTarget = oNode.pMount;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Removes the rest of a route below a node and the nodes no other route needs.
+ */
+bool RemoveAt(tNode& oNode, const char* strRoute, const char* pPos)
+{
+    if (*pPos == '\0')
+    {
+        const bool bFound = oNode.pTarget != nullptr;
+        oNode.pTarget = nullptr;
+        return bFound;
+    }
+    if (IsMount(strRoute, pPos))
+    {
+        const bool bFound = oNode.pMount != nullptr;
+        oNode.pMount = nullptr;
+        return bFound;
+    }
+    if (IsParameter(strRoute, pPos))
+    {
+        const char* pSegmentEnd = GetSegmentEnd(pPos);
+        if (!oNode.pParameter ||
+            oNode.pParameter->strParameter.compare(
+                0, std::string::npos, pPos + 1, static_cast<size_t>(pSegmentEnd - pPos - 1)) != 0 ||
+            !RemoveAt(*oNode.pParameter, strRoute, pSegmentEnd))
+        {
+            return false;
+        }
+        if (oNode.pParameter->IsEmpty())
+        {
+            oNode.pParameter.reset();
+        }
+        return true;
+    }
+
+    const size_t nChild = oNode.strIndices.find(*pPos);
+    if (nChild == std::string::npos)
+    {
+        return false;
+    }
+    tNode& oChild = *oNode.oChildren[nChild];
+    if (std::strncmp(pPos, oChild.strPrefix.data(), oChild.strPrefix.size()) != 0 ||
+        !RemoveAt(oChild, strRoute, pPos + oChild.strPrefix.size()))
+    {
+        return false;
+    }
+    if (oChild.IsEmpty())
+    {
+        oNode.strIndices.erase(nChild, 1);
+        oNode.oChildren.erase(oNode.oChildren.begin() + static_cast<std::ptrdiff_t>(nChild));
+    }
+    return true;
+}
+
+} // namespace
+
+class cRouter::cImplementation
+{
+public:
+    bool Insert(const char* strRoute, void* pTarget)
+    {
+        // check the number of parameters first, so a failing route adds no nodes
+        size_t nParameters = 0;
+        for (const char* pPos = strRoute; *pPos; ++pPos)
+        {
+            if (IsParameter(strRoute, pPos) || IsMount(strRoute, pPos))
+            {
+                ++nParameters;
+            }
+        }
+        if (!pTarget || nParameters > tRouteMatch::nMaxParameters)
+        {
+            return false;
+        }
+
+        tNode* pNode = &m_oRoot;
+        const char* pPos = strRoute;
+        while (*pPos)
+        {
+            if (IsMount(strRoute, pPos))
+            {
+                if (pNode->pMount)
+                {
+                    return false;
+                }
+                pNode->pMount = pTarget;
+                return true;
+            }
+            if (IsParameter(strRoute, pPos))
+            {
+                const char* pSegmentEnd = GetSegmentEnd(pPos);
+                const std::string strName(pPos + 1, pSegmentEnd);
+                if (!pNode->pParameter)
+                {
+                    pNode->pParameter.reset(new tNode);
+                    pNode->pParameter->strParameter = strName;
+                }
+                else if (pNode->pParameter->strParameter != strName)
+                {
+                    return false;
+                }
+                pNode = pNode->pParameter.get();
+                pPos = pSegmentEnd;
+                continue;
+            }
+            const char* pLiteralEnd = GetLiteralEnd(strRoute, pPos);
+            pNode = &InsertLiteral(*pNode, pPos, static_cast<size_t>(pLiteralEnd - pPos));
+            pPos = pLiteralEnd;
+        }
+
+        if (pNode->pTarget)
+        {
+            return false;
+        }
+        pNode->pTarget = pTarget;
+        return true;
+    }
+
+    bool Remove(const char* strRoute)
+    {
+        return RemoveAt(m_oRoot, strRoute, strRoute);
+    }
+
+    bool Find(const char* strPath, tRouteMatch& oMatch) const
+    {
+        oMatch.pTarget = nullptr;
+        oMatch.nParameterCount = 0;
+        return FindAt(m_oRoot, strPath, oMatch);
+    }
+
+private:
+    tNode m_oRoot;
+};
+
+cRouter::cRouter() : m_pImplementation(new cImplementation)
+{
+}
+
+cRouter::~cRouter()
+{
+}
+
+bool cRouter::Insert(const char* strRoute, void* pTarget)
+{
+    return m_pImplementation->Insert(strRoute, pTarget);
+}
+
+bool cRouter::Remove(const char* strRoute)
+{
+    return m_pImplementation->Remove(strRoute);
+}
+
+bool cRouter::Find(const char* strPath, tRouteMatch& oMatch) const
+{
+    return m_pImplementation->Find(strPath, oMatch);
+}
+
+const tRouteMatch* GetCurrentRoute()
+{
+    return pCurrentRoute;
+}
+
+const tRouteMatch* SetCurrentRoute(const tRouteMatch* pRoute)
+{
+    const tRouteMatch* pPrevious = pCurrentRoute;
+    pCurrentRoute = pRoute;
+    return pPrevious;
+}
+
+} // namespace rpc
@@ -19,13 +19,238 @@
  */
 
 #include "url.h"
-#include <iostream>
 #include <a_util/strings.h>
-#include <a_util/regex.h>
 
 namespace rpc
 {
 
+namespace
+{
+// the character classes of STD-66 in the subset cUrl accepts, independent of the locale
+
+bool IsWordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool IsSchemeChar(char c)
+{
+    // word characters and everything from '+' up to '_'
+    return IsWordChar(c) || (c >= '+' && c <= '_');
+}
+
+bool IsAuthorityChar(char c)
+{
+    return IsWordChar(c) || c == ':' || c == '@' || c == '.' || c == '-';
+}
+
+bool IsPathChar(char c)
+{
+    return IsWordChar(c) || c == '/' || c == '.' || c == '%' || c == '-' || c == '~';
+}
+
+bool IsQueryChar(char c)
+{
+    return c != '#' && c != ' ' && c != '\t' && c != '\n' && c != '\v' && c != '\f' && c != '\r';
+}
+
+bool IsHostChar(char c)
+{
+    return IsWordChar(c) || c == '.' || c == '-';
+}
+
+/**
+ * Returns the end of the run of characters of a class starting at nPos.
+ */
+template <bool (*IsClassChar)(char)>
+size_t SkipChars(const std::string& strText, size_t nPos, size_t nEnd)
+{
+    while (nPos < nEnd && IsClassChar(strText[nPos]))
+    {
+        ++nPos;
+    }
+    return nPos;
+}
+
+/**
+ * A scheme has at least three characters and neither starts with '+', '-' or '.' nor ends with
+ * '+', ',', '-' or '.'.
+ */
+bool IsValidScheme(const std::string& strUrl, size_t nEnd)
+{
+    if (nEnd < 3)
+    {
+        return false;
+    }
+    const char cFirst = strUrl[0];
+    const char cLast = strUrl[nEnd - 1];
+    return cFirst != '+' && cFirst != '-' && cFirst != '.' && (cLast < '+' || cLast > '.') &&
+           SkipChars<IsSchemeChar>(strUrl, 1, nEnd - 1) == nEnd - 1;
+}
+
+/**
+ * Parses "", "#", "#fragment" or "##fragment" up to the end of the URL.
+ */
+bool ParseFragment(const std::string& strUrl, size_t nPos, std::string& strFragment)
+{
+    const size_t nEnd = strUrl.size();
+    strFragment.clear();
+    if (nPos == nEnd || (nPos + 1 == nEnd && strUrl[nPos] == '#'))
+    {
+        return true;
+    }
+    if (strUrl[nPos] != '#')
+    {
+        return false;
+    }
+    const size_t nStart = nPos + (strUrl[nPos + 1] == '#' ? 2 : 1);
+    if (nStart == nEnd || SkipChars<IsWordChar>(strUrl, nStart, nEnd) != nEnd)
+    {
+        return false;
+    }
+    strFragment.assign(strUrl, nStart, nEnd - nStart);
+    return true;
+}
+
+/**
+ * Splits everything behind "scheme://" into its parts in one pass. The parts are the ones the
+ * STD-66 expression of former versions captured, including its handling of duplicated '/', '?'
+ * and '#' separators.
+ */
+bool ParseHierarchy(const std::string& strUrl,
+                    size_t nPos,
+                    std::string& strAuthority,
+                    std::string& strPath,
+                    std::string& strQuery,
+                    std::string& strFragment)
+{
+    const size_t nEnd = strUrl.size();
+    const size_t nAuthorityEnd = SkipChars<IsAuthorityChar>(strUrl, nPos, nEnd);
+    if (nAuthorityEnd == nPos)
+    {
+        return false;
+    }
+
+    // the path has to take all path characters following the authority: "", "/", "/path" or
+    // "//path", where "//" alone is the path "/"
+    const size_t nPathEnd = SkipChars<IsPathChar>(strUrl, nAuthorityEnd, nEnd);
+    const size_t nPathChars = nPathEnd - nAuthorityEnd;
+    size_t nPathStart = nPathEnd;
+    if (nPathChars > 0)
+    {
+        if (strUrl[nAuthorityEnd] != '/')
+        {
+            return false;
+        }
+        nPathStart = nAuthorityEnd + (nPathChars > 2 && strUrl[nAuthorityEnd + 1] == '/' ? 2 : 1);
+    }
+
+    // the query: "", "?", "?query" or "??query"
+    strQuery.clear();
+    size_t nFragmentStart = nPathEnd;
+    if (nPathEnd < nEnd && strUrl[nPathEnd] == '?')
+    {
+        size_t nQueryStart = nPathEnd + 1;
+        if (nQueryStart + 1 < nEnd && strUrl[nQueryStart] == '?' &&
+            IsQueryChar(strUrl[nQueryStart + 1]))
+        {
+            ++nQueryStart;
+        }
+        else if (nQueryStart == nEnd || strUrl[nQueryStart] != '?')
+        {
+            if (ParseFragment(strUrl, nQueryStart, strFragment))
+            {
+                strAuthority.assign(strUrl, nPos, nAuthorityEnd - nPos);
+                strPath.assign(strUrl, nPathStart, nPathEnd - nPathStart);
+                return true;
+            }
+            if (nQueryStart == nEnd || !IsQueryChar(strUrl[nQueryStart]))
+            {
+                return false;
+            }
+        }
+        nFragmentStart = SkipChars<IsQueryChar>(strUrl, nQueryStart, nEnd);
+        strQuery.assign(strUrl, nQueryStart, nFragmentStart - nQueryStart);
+    }
+    if (!ParseFragment(strUrl, nFragmentStart, strFragment))
+    {
+        return false;
+    }
+    strAuthority.assign(strUrl, nPos, nAuthorityEnd - nPos);
+    strPath.assign(strUrl, nPathStart, nPathEnd - nPathStart);
+    return true;
+}
+
+/**
+ * Splits a STD-66 URL. The scheme may contain "://" itself, the longest scheme the rest of the
+ * URL can follow is taken.
+ */
+bool ParseStd66(const std::string& strUrl,
+                std::string& strScheme,
+                std::string& strAuthority,
+                std::string& strPath,
+                std::string& strQuery,
+                std::string& strFragment)
+{
+    for (size_t nSeparator = strUrl.rfind("://"); nSeparator != std::string::npos;
+         nSeparator = nSeparator ? strUrl.rfind("://", nSeparator - 1) : std::string::npos)
+    {
+        if (IsValidScheme(strUrl, nSeparator) &&
+            ParseHierarchy(strUrl, nSeparator + 3, strAuthority, strPath, strQuery, strFragment))
+        {
+            strScheme.assign(strUrl, 0, nSeparator);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Converts the options of a proprietary URL like tcp://127.0.0.1:5001{timeout=1000,size=10} into
+ * the query of a STD-66 URL: tcp://127.0.0.1:5001?timeout=1000&size=10
+ */
+bool ConvertProprietaryUrl(const std::string& strUrl, std::string& strStdUrl)
+{
+    const size_t nOpen = strUrl.find('{');
+    if (nOpen == std::string::npos)
+    {
+        return false;
+    }
+    const size_t nClose = strUrl.find('}', nOpen);
+    if (nClose == std::string::npos)
+    {
+        return false;
+    }
+    strStdUrl.reserve(strUrl.size());
+    strStdUrl.assign(strUrl, 0, nOpen);
+    strStdUrl.push_back('?');
+    for (size_t nPos = nOpen + 1; nPos < nClose; ++nPos)
+    {
+        const char c = strUrl[nPos];
+        if (c == ',')
+        {
+            strStdUrl.push_back('&');
+        }
+        else if (IsWordChar(c) || c == '=')
+        {
+            strStdUrl.push_back(c);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    strStdUrl.append(strUrl, nClose + 1, std::string::npos);
+    return true;
+}
+
+} // namespace
+
 cUrl::cUrl()
 {
     m_bIsValidURL = false;
@@ -48,72 +273,32 @@ bool cUrl::IsValid() const
 
 bool cUrl::Validate(const std::string& strUrl)
 {
-
     m_bIsValidURL = false;
-    // do this in stages - get the uri scheme, the auth data, the location and all the trailing
-    // stuff first do an almost entire matching here to be safe about the urls integrity.. note:
-    // cRegEx does NOT support cStrings....too bad attention: Watch out for trigraph replacements
-    // here (e.g. '??(' substitutes to ']')
-    // http://msdn.microsoft.com/de-de/library/bt0y4awe(v=vs.90).aspx
-    a_util::regex::RegularExpression oUrlExp(
-        "^([^\\+\\-\\.][\\w\\+-_]+[^\\+-\\.])://([\\w:@\\.-]+)/?(/([\\w\\/"
-        "\\.%\\-_\\~]+))?\\?\?(\\?([^\\s#]+))?#?(#(\\w+))?$");
-    std::string strScheme;    // mandatory
     std::string strAuthority; // mandatory
-    std::string strPath;      // optional
     std::string strQuery;     // optional
-    std::string strFragment;  // optional
-    std::string strDummy;
-
-    if (!(oUrlExp.fullMatch(strUrl,
-                            strScheme,
-                            strAuthority,
-                            strDummy,
-                            strPath,
-                            strDummy,
-                            strQuery,
-                            strDummy,
-                            strFragment)))
+    if (!ParseStd66(strUrl,
+                    m_sComponents.strScheme,
+                    strAuthority,
+                    m_sComponents.strPath,
+                    strQuery,
+                    m_sComponents.strFragment))
     {
-        // if we cannot match a valid STD-66 URL convert any proprietary MB query to STD-66 and
+        // if we cannot match a valid STD-66 URL convert any proprietary query to STD-66 and
         // re-run this.
-        a_util::regex::RegularExpression oMBUrlExp("^.*{([\\w=,]*)}.*$");
-        std::string strStdMBQuery;
-        if (!(oMBUrlExp.fullMatch(strUrl, strStdMBQuery)))
+        std::string strStdUrl;
+        if (!ConvertProprietaryUrl(strUrl, strStdUrl) ||
+            !ParseStd66(strStdUrl,
+                        m_sComponents.strScheme,
+                        strAuthority,
+                        m_sComponents.strPath,
+                        strQuery,
+                        m_sComponents.strFragment))
         {
             return false;
         }
-        std::string strMBQuery(strStdMBQuery);
-        a_util::strings::replace(strMBQuery, ",", "&");
-        strMBQuery = "?" + strMBQuery;
-
-        oMBUrlExp = a_util::regex::RegularExpression("{.*}");
-        std::string strQueryPcs(strMBQuery);
-        std::string strStrUrl(strUrl);
-
-        //????????
-        /*  if (!(oMBUrlExp.Replace(strQueryPcs, &strStrUrl)))
-          {
-              RETURN_ERROR(ERR_UNEXPECTED);
-          }   */
-        return Validate(strStrUrl);
-    }
-
-    if (strAuthority.empty())
-    {
-        return false;
-    }
-
-    if (strScheme.empty())
-    {
-        return false;
     }
 
-    m_sComponents.strPath = std::string(strPath);
-    m_sComponents.strScheme = strScheme;
-    m_sComponents.strFragment = std::string(strFragment);
-
-    m_sComponents.oAuthority = cAuthority(std::string(strAuthority));
+    m_sComponents.oAuthority = cAuthority(strAuthority);
     if (!m_sComponents.oAuthority.IsValid())
     {
         return false;
@@ -183,32 +368,54 @@ cUrl::cAuthority::~cAuthority()
 
 bool cUrl::cAuthority::Validate(const std::string& strAuthority)
 {
-    if (strAuthority.empty())
+    // [user[:password]@]host[:port]
+    const size_t nEnd = strAuthority.size();
+    size_t nHostStart = 0;
+    const size_t nAt = strAuthority.find('@');
+    if (nAt != std::string::npos)
     {
-        return false;
+        const size_t nUserEnd = SkipChars<IsWordChar>(strAuthority, 0, nAt);
+        if (nUserEnd == 0)
+        {
+            return false;
+        }
+        size_t nPasswordStart = nUserEnd;
+        if (nUserEnd < nAt)
+        {
+            nPasswordStart = nUserEnd + 1;
+            if (strAuthority[nUserEnd] != ':' || nPasswordStart == nAt ||
+                SkipChars<IsWordChar>(strAuthority, nPasswordStart, nAt) != nAt)
+            {
+                return false;
+            }
+        }
+        m_sAuthority.strUser.assign(strAuthority, 0, nUserEnd);
+        m_sAuthority.strPassword.assign(strAuthority, nPasswordStart, nAt - nPasswordStart);
+        nHostStart = nAt + 1;
     }
-
-    a_util::regex::RegularExpression oUrlExp("^((\\w+)(:(\\w+))?@)?([\\w\\.-]+)(:([\\d]+))?$");
-    std::string strUser;     // optional
-    std::string strPassword; // optional
-    std::string strHost;     // mandatory
-    std::string strPort;     // mandatory
-    std::string strDummy;
-
-    if (!(oUrlExp.fullMatch(
-            strAuthority, strDummy, strUser, strDummy, strPassword, strHost, strDummy, strPort)))
+    else
     {
-        return false;
+        m_sAuthority.strUser.clear();
+        m_sAuthority.strPassword.clear();
     }
 
-    if (strHost.empty() || strHost == " ")
+    const size_t nHostEnd = SkipChars<IsHostChar>(strAuthority, nHostStart, nEnd);
+    if (nHostEnd == nHostStart)
     {
         return false;
     }
+    std::string strPort;
+    if (nHostEnd < nEnd)
+    {
+        if (strAuthority[nHostEnd] != ':' || nHostEnd + 1 == nEnd ||
+            SkipChars<IsDigit>(strAuthority, nHostEnd + 1, nEnd) != nEnd)
+        {
+            return false;
+        }
+        strPort.assign(strAuthority, nHostEnd + 1, std::string::npos);
+    }
 
-    m_sAuthority.strLocation = strHost;
-    m_sAuthority.strUser = strUser;
-    m_sAuthority.strPassword = strPassword;
+    m_sAuthority.strLocation.assign(strAuthority, nHostStart, nHostEnd - nHostStart);
     m_sAuthority.nPort = a_util::strings::toUInt16(strPort);
 
     return true;
@@ -246,11 +453,35 @@ std::string cUrl::cAuthority::AsString() const
 
 bool cUrl::cAuthority::IsValidIPv4() const
 {
-    a_util::regex::RegularExpression oReg(
-        "\\b(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.(25["
-        "0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\b");
-    bool bIsIp4 = oReg.fullMatch(m_sAuthority.strLocation);
-    return bIsIp4;
+    // four decimal octets of one to three digits each
+    const std::string& strHost = m_sAuthority.strLocation;
+    size_t nPos = 0;
+    for (int nOctet = 0; nOctet < 4; ++nOctet)
+    {
+        if (nOctet > 0)
+        {
+            if (nPos == strHost.size() || strHost[nPos] != '.')
+            {
+                return false;
+            }
+            ++nPos;
+        }
+        const size_t nDigitsEnd = SkipChars<IsDigit>(strHost, nPos, strHost.size());
+        if (nDigitsEnd == nPos || nDigitsEnd - nPos > 3)
+        {
+            return false;
+        }
+        unsigned int nValue = 0;
+        for (; nPos < nDigitsEnd; ++nPos)
+        {
+            nValue = nValue * 10 + static_cast<unsigned int>(strHost[nPos] - '0');
+        }
+        if (nValue > 255)
+        {
+            return false;
+        }
+    }
+    return nPos == strHost.size();
 }
 
 // cUrl::cQuery
@@ -269,28 +500,35 @@ cUrl::cQuery::~cQuery()
 
 bool cUrl::cQuery::Validate(const std::string& strQuery)
 {
-    if (strQuery.empty())
-    {
-        return true;
-    }
-
-    std::string strParam; // Option storage
-    std::string strValue; // Value storage
-    std::string strDummy; // Dummy
-
-    a_util::regex::RegularExpression oQueryExp("([\\w\\d]+)(=([\\w\\d]+))?&?");
-    std::string strQueryPieces(strQuery);
-    int nCount = 0;
-    while (oQueryExp.fullMatch(strQueryPieces, strParam, strDummy, strValue))
+    // parameter[=value][&parameter[=value]...][&]
+    const size_t nEnd = strQuery.size();
+    size_t nPos = 0;
+    while (nPos < nEnd)
     {
+        const size_t nParamEnd = SkipChars<IsWordChar>(strQuery, nPos, nEnd);
+        if (nParamEnd == nPos)
+        {
+            return false;
+        }
+        size_t nValueStart = nParamEnd;
+        size_t nValueEnd = nParamEnd;
+        if (nParamEnd < nEnd && strQuery[nParamEnd] == '=')
+        {
+            nValueStart = nParamEnd + 1;
+            nValueEnd = SkipChars<IsWordChar>(strQuery, nValueStart, nEnd);
+            if (nValueEnd == nValueStart)
+            {
+                return false;
+            }
+        }
+        if (nValueEnd < nEnd && strQuery[nValueEnd] != '&')
+        {
+            return false;
+        }
         m_mapQuery.insert(
-            std::make_pair<std::string, std::string>(std::string(strParam), std::string(strValue)));
-        nCount++;
-    }
-
-    if (0 == nCount) // && !strQuery.IsEmpty()
-    {
-        return false;
+            std::make_pair(strQuery.substr(nPos, nParamEnd - nPos),
+                           strQuery.substr(nValueStart, nValueEnd - nValueStart)));
+        nPos = nValueEnd + 1;
     }
 
     return true;
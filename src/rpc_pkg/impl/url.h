@@ -52,6 +52,7 @@ namespace rpc
  * In contrast to STD-66 URLs, proprietary URLs with following scheme are supported
  * @li tcp://127.0.0.1:5001{timeout=1000,max_pkg_size=65000}
  * @li udp://127.0.0.1:5002{timeout=1000,max_pkg_size=65000}
+ * Their options are read as the query ?timeout=1000&max_pkg_size=65000.
  *
  * Usage:
  * After construction you should call function @ref cUrl::IsValid() to determine
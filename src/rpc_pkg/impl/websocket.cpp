@@ -0,0 +1,331 @@
+/**
+ * @file
+ * Framing of WebSocket connections (RFC 6455) implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <cstring>
+#include <jsonrpccpp/common/binarycodec.h>
+#include "rpc_pkg/impl/websocket.h"
+
+namespace rpc
+{
+namespace http
+{
+namespace detail
+{
+
+namespace
+{
+const char* const strWebSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+/// status codes of close frames
+const uint16_t nCloseNormal = 1000;
+const uint16_t nCloseProtocolError = 1002;
+const uint16_t nCloseTooLarge = 1009;
+
+uint32_t RotateLeft(uint32_t nValue, int nBits)
+{
+    return (nValue << nBits) | (nValue >> (32 - nBits));
+}
+
+/**
+ * SHA-1 (RFC 3174), only used for the handshake.
+ */
+std::string Sha1(const std::string& strData)
+{
+    uint32_t aHash[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string strPadded = strData;
+    strPadded.push_back(static_cast<char>(0x80));
+    while (strPadded.size() % 64 != 56)
+    {
+        strPadded.push_back('\0');
+    }
+    const uint64_t nBits = static_cast<uint64_t>(strData.size()) * 8;
+    for (int nByte = 7; nByte >= 0; --nByte)
+    {
+        strPadded.push_back(static_cast<char>((nBits >> (nByte * 8)) & 0xFF));
+    }
+
+    for (size_t nBlock = 0; nBlock < strPadded.size(); nBlock += 64)
+    {
+        uint32_t aWords[80];
+        for (int nWord = 0; nWord < 16; ++nWord)
+        {
+            const unsigned char* pWord =
+                reinterpret_cast<const unsigned char*>(strPadded.data() + nBlock + nWord * 4);
+            aWords[nWord] = (static_cast<uint32_t>(pWord[0]) << 24) |
+                            (static_cast<uint32_t>(pWord[1]) << 16) |
+                            (static_cast<uint32_t>(pWord[2]) << 8) | pWord[3];
+        }
+        for (int nWord = 16; nWord < 80; ++nWord)
+        {
+            aWords[nWord] = RotateLeft(aWords[nWord - 3] ^ aWords[nWord - 8] ^
+                                           aWords[nWord - 14] ^ aWords[nWord - 16],
+                                       1);
+        }
+
+        uint32_t a = aHash[0], b = aHash[1], c = aHash[2], d = aHash[3], e = aHash[4];
+        for (int nRound = 0; nRound < 80; ++nRound)
+        {
+            uint32_t f, k;
+            if (nRound < 20)
+            {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            }
+            else if (nRound < 40)
+            {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            }
+            else if (nRound < 60)
+            {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            }
+            else
+            {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            const uint32_t nTemp = RotateLeft(a, 5) + f + e + k + aWords[nRound];
+            e = d;
+            d = c;
+            c = RotateLeft(b, 30);
+            b = a;
+            a = nTemp;
+        }
+        aHash[0] += a;
+        aHash[1] += b;
+        aHash[2] += c;
+        aHash[3] += d;
+        aHash[4] += e;
+    }
+
+    std::string strHash;
+    for (uint32_t nWord: aHash)
+    {
+        for (int nByte = 3; nByte >= 0; --nByte)
+        {
+            strHash.push_back(static_cast<char>((nWord >> (nByte * 8)) & 0xFF));
+        }
+    }
+    return strHash;
+}
+
+/**
+ * XORs the data with the repeated mask, eight bytes at a time.
+ */
+void ApplyMask(char* pData, size_t nSize, const unsigned char aMask[4])
+{
+    uint64_t nMask = 0;
+    std::memcpy(&nMask, aMask, 4);
+    std::memcpy(reinterpret_cast<char*>(&nMask) + 4, aMask, 4);
+    size_t nByte = 0;
+    for (; nByte + 8 <= nSize; nByte += 8)
+    {
+        uint64_t nWord;
+        std::memcpy(&nWord, pData + nByte, 8);
+        nWord ^= nMask;
+        std::memcpy(pData + nByte, &nWord, 8);
+    }
+    for (; nByte < nSize; ++nByte)
+    {
+        pData[nByte] ^= static_cast<char>(aMask[nByte & 3]);
+    }
+}
+
+} // namespace
+
+std::string GetWebSocketAccept(const std::string& strKey)
+{
+    return jsonrpc::EncodeBase64(Sha1(strKey + strWebSocketGuid));
+}
+
+std::string CreateWebSocketKey()
+{
+    std::random_device oRandom;
+    std::string strKey;
+    for (int nByte = 0; nByte < 16; ++nByte)
+    {
+        strKey.push_back(static_cast<char>(oRandom() & 0xFF));
+    }
+    return jsonrpc::EncodeBase64(strKey);
+}
+
+const uint64_t cWebSocketFrames::nMaxMessageSize;
+
+cWebSocketFrames::cWebSocketFrames(const tRead& fnRead, const tWrite& fnWrite, bool bClient)
+    : m_fnRead(fnRead),
+      m_fnWrite(fnWrite),
+      m_bClient(bClient),
+      m_oMaskGenerator(std::random_device()()),
+      m_bCloseSent(false)
+{
+}
+
+bool cWebSocketFrames::Receive(std::string& strMessage)
+{
+    strMessage.clear();
+    bool bFragmented = false;
+    std::string strControl;
+    for (;;)
+    {
+        unsigned char aHeader[2];
+        if (!m_fnRead(reinterpret_cast<char*>(aHeader), sizeof(aHeader)))
+        {
+            return false;
+        }
+        const bool bFinal = (aHeader[0] & 0x80) != 0;
+        const unsigned char nOpcode = aHeader[0] & 0x0F;
+        const bool bControl = (nOpcode & 0x08) != 0;
+        const bool bMasked = (aHeader[1] & 0x80) != 0;
+        uint64_t nSize = aHeader[1] & 0x7F;
+
+        // no extensions are negotiated and only clients mask their frames
+        if ((aHeader[0] & 0x70) != 0 || bMasked == m_bClient ||
+            (!bControl && nOpcode > eWebSocketBinary) ||
+            (!bControl && (nOpcode == eWebSocketContinuation) != bFragmented) ||
+            (bControl && (!bFinal || nSize > 125)))
+        {
+            Close(nCloseProtocolError);
+            return false;
+        }
+
+        if (nSize >= 126)
+        {
+            unsigned char aSize[8];
+            const size_t nSizeBytes = nSize == 126 ? 2 : 8;
+            if (!m_fnRead(reinterpret_cast<char*>(aSize), nSizeBytes))
+            {
+                return false;
+            }
+            nSize = 0;
+            for (size_t nByte = 0; nByte < nSizeBytes; ++nByte)
+            {
+                nSize = (nSize << 8) | aSize[nByte];
+            }
+        }
+        unsigned char aMask[4] = {};
+        if (bMasked && !m_fnRead(reinterpret_cast<char*>(aMask), sizeof(aMask)))
+        {
+            return false;
+        }
+        if (nSize > nMaxMessageSize - strMessage.size())
+        {
+            Close(nCloseTooLarge);
+            return false;
+        }
+
+        std::string& strTarget = bControl ? strControl : strMessage;
+        const size_t nOffset = bControl ? 0 : strMessage.size();
+        strTarget.resize(nOffset + static_cast<size_t>(nSize));
+        if (nSize > 0 && !m_fnRead(&strTarget[nOffset], static_cast<size_t>(nSize)))
+        {
+            return false;
+        }
+        if (bMasked)
+        {
+            ApplyMask(&strTarget[0] + nOffset, static_cast<size_t>(nSize), aMask);
+        }
+
+        switch (nOpcode)
+        {
+            case eWebSocketPing:
+                Send(eWebSocketPong, strControl.data(), strControl.size());
+                break;
+            case eWebSocketPong:
+                break;
+            case eWebSocketClose:
+                Close(strControl.size() >= 2
+                          ? static_cast<uint16_t>(
+                                (static_cast<unsigned char>(strControl[0]) << 8) |
+                                static_cast<unsigned char>(strControl[1]))
+                          : nCloseNormal);
+                return false;
+            default:
+                if (bFinal)
+                {
+                    return true;
+                }
+                bFragmented = true;
+                break;
+        }
+    }
+}
+
+bool cWebSocketFrames::Send(eWebSocketOpcode eOpcode, const char* pData, size_t nSize)
+{
+    std::lock_guard<std::mutex> oGuard(m_oSendLock);
+    if (m_bCloseSent)
+    {
+        return false;
+    }
+    if (eOpcode == eWebSocketClose)
+    {
+        m_bCloseSent = true;
+    }
+
+    m_strSendBuffer.clear();
+    m_strSendBuffer.push_back(static_cast<char>(0x80 | eOpcode));
+    const unsigned char nMaskBit = m_bClient ? 0x80 : 0x00;
+    if (nSize < 126)
+    {
+        m_strSendBuffer.push_back(static_cast<char>(nMaskBit | nSize));
+    }
+    else
+    {
+        const size_t nSizeBytes = nSize <= 0xFFFF ? 2 : 8;
+        m_strSendBuffer.push_back(static_cast<char>(nMaskBit | (nSizeBytes == 2 ? 126 : 127)));
+        for (size_t nByte = nSizeBytes; nByte-- > 0;)
+        {
+            m_strSendBuffer.push_back(
+                static_cast<char>((static_cast<uint64_t>(nSize) >> (nByte * 8)) & 0xFF));
+        }
+    }
+
+    if (m_bClient)
+    {
+        const uint32_t nMask = m_oMaskGenerator();
+        const unsigned char aMask[4] = {static_cast<unsigned char>(nMask >> 24),
+                                        static_cast<unsigned char>(nMask >> 16),
+                                        static_cast<unsigned char>(nMask >> 8),
+                                        static_cast<unsigned char>(nMask)};
+        m_strSendBuffer.append(reinterpret_cast<const char*>(aMask), sizeof(aMask));
+        const size_t nOffset = m_strSendBuffer.size();
+        m_strSendBuffer.append(pData, nSize);
+        ApplyMask(&m_strSendBuffer[0] + nOffset, nSize, aMask);
+    }
+    else
+    {
+        m_strSendBuffer.append(pData, nSize);
+    }
+    return m_fnWrite(m_strSendBuffer.data(), m_strSendBuffer.size());
+}
+
+void cWebSocketFrames::Close(uint16_t nStatusCode)
+{
+    const char aStatusCode[2] = {static_cast<char>(nStatusCode >> 8),
+                                 static_cast<char>(nStatusCode & 0xFF)};
+    Send(eWebSocketClose, aStatusCode, sizeof(aStatusCode));
+}
+
+} // namespace detail
+} // namespace http
+} // namespace rpc
@@ -0,0 +1,126 @@
+/**
+ * @file
+ * Framing of WebSocket connections (RFC 6455) declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_WEBSOCKET_H_INCLUDED
+#define PKG_RPC_WEBSOCKET_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+
+namespace rpc
+{
+namespace http
+{
+namespace detail
+{
+
+/**
+ * The opcodes of the frames.
+ */
+enum eWebSocketOpcode
+{
+    eWebSocketContinuation = 0x0,
+    eWebSocketText = 0x1,
+    eWebSocketBinary = 0x2,
+    eWebSocketClose = 0x8,
+    eWebSocketPing = 0x9,
+    eWebSocketPong = 0xA
+};
+
+/**
+ * Computes the Sec-WebSocket-Accept header of the handshake.
+ * @param[in] strKey The Sec-WebSocket-Key header of the request.
+ * @return The base64 encoded SHA-1 hash of the key and the GUID of RFC 6455.
+ */
+std::string GetWebSocketAccept(const std::string& strKey);
+
+/**
+ * Creates a random Sec-WebSocket-Key for the handshake of a client.
+ * @return 16 random bytes, base64 encoded.
+ */
+std::string CreateWebSocketKey();
+
+/**
+ * Reads and writes the frames of a WebSocket connection after the handshake. The socket is
+ * accessed via functions, so the same framing serves the server and the client.
+ */
+class cWebSocketFrames
+{
+public:
+    /// reads exactly nSize bytes, false if the connection is closed
+    typedef std::function<bool(char* pData, size_t nSize)> tRead;
+    /// writes all nSize bytes, false if the connection is closed
+    typedef std::function<bool(const char* pData, size_t nSize)> tWrite;
+
+    /// messages larger than this close the connection
+    static const uint64_t nMaxMessageSize = 256 * 1024 * 1024;
+
+public:
+    /**
+     * Constructor.
+     * @param[in] fnRead Reads from the socket.
+     * @param[in] fnWrite Writes to the socket.
+     * @param[in] bClient Whether this is the client side, which masks the frames it sends and
+     *                    expects unmasked frames, the server the other way round.
+     */
+    cWebSocketFrames(const tRead& fnRead, const tWrite& fnWrite, bool bClient);
+
+    /**
+     * Reads the next message, joins fragmented messages and answers pings and close frames.
+     * Must not be called by several threads at once.
+     * @param[out] strMessage The payload of the message.
+     * @return false if the connection has been closed or violates the protocol.
+     */
+    bool Receive(std::string& strMessage);
+
+    /**
+     * Sends a message or control frame with a single write. Thread safe.
+     * @param[in] eOpcode The opcode.
+     * @param[in] pData The payload.
+     * @param[in] nSize The size of the payload.
+     * @return false if the connection is closed.
+     */
+    bool Send(eWebSocketOpcode eOpcode, const char* pData, size_t nSize);
+
+    /**
+     * Sends a close frame unless one has been sent already.
+     * @param[in] nStatusCode The status code, i.e. 1000 for a normal closure.
+     */
+    void Close(uint16_t nStatusCode);
+
+private:
+    tRead m_fnRead;
+    tWrite m_fnWrite;
+    bool m_bClient;
+    std::mutex m_oSendLock;
+    std::string m_strSendBuffer;
+    std::mt19937 m_oMaskGenerator;
+    bool m_bCloseSent;
+};
+
+} // namespace detail
+} // namespace http
+} // namespace rpc
+
+#endif // PKG_RPC_WEBSOCKET_H_INCLUDED
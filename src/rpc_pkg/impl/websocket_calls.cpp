@@ -0,0 +1,568 @@
+/**
+ * @file
+ * JSON-RPC calls over WebSocket connections implementation.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <chrono>
+#include <cstring>
+#include <json/json.h>
+#include <jsonrpccpp/common/errors.h>
+#include "rpc_pkg/impl/websocket_calls.h"
+
+namespace rpc
+{
+namespace http
+{
+namespace detail
+{
+
+namespace
+{
+/// the most messages that wait per thread of @ref cWebSocketWorkers
+const size_t nMaxWaitingMessagesPerThread = 4;
+
+/**
+ * The position of a value in a message.
+ */
+struct tSpan
+{
+    size_t nBegin;
+    size_t nEnd;
+};
+
+size_t SkipWhitespace(const std::string& strJson, size_t nPos)
+{
+    const size_t nNext = strJson.find_first_not_of(" \t\r\n", nPos);
+    return nNext == std::string::npos ? strJson.size() : nNext;
+}
+
+/**
+ * Skips a JSON string.
+ * @return The position after the closing quote, npos if it is incomplete.
+ */
+size_t SkipString(const std::string& strJson, size_t nPos)
+{
+    const char* pBegin = strJson.data();
+    const char* pEnd = pBegin + strJson.size();
+    for (const char* pQuote = pBegin + nPos + 1; pQuote < pEnd; ++pQuote)
+    {
+        pQuote = static_cast<const char*>(std::memchr(pQuote, '"', pEnd - pQuote));
+        if (!pQuote)
+        {
+            break;
+        }
+        // a quote is escaped by an odd number of backslashes, the opening quote stops the search
+        const char* pEscapes = pQuote;
+        while (*(pEscapes - 1) == '\\')
+        {
+            --pEscapes;
+        }
+        if ((pQuote - pEscapes) % 2 == 0)
+        {
+            return static_cast<size_t>(pQuote - pBegin) + 1;
+        }
+    }
+    return std::string::npos;
+}
+
+/**
+ * Skips a JSON value without validating it, the handler of the message does that.
+ * @return The position after the value, npos if it is incomplete.
+ */
+size_t SkipValue(const std::string& strJson, size_t nPos)
+{
+    if (nPos >= strJson.size())
+    {
+        return std::string::npos;
+    }
+    if (strJson[nPos] == '"')
+    {
+        return SkipString(strJson, nPos);
+    }
+    if (strJson[nPos] != '{' && strJson[nPos] != '[')
+    {
+        const size_t nEnd = strJson.find_first_of(",}] \t\r\n", nPos);
+        return nEnd == std::string::npos ? strJson.size() : nEnd;
+    }
+
+    size_t nDepth = 0;
+    for (; nPos < strJson.size(); ++nPos)
+    {
+        switch (strJson[nPos])
+        {
+            case '"':
+                nPos = SkipString(strJson, nPos);
+                if (nPos == std::string::npos)
+                {
+                    return nPos;
+                }
+                // at the closing quote
+                --nPos;
+                break;
+            case '{':
+            case '[':
+                ++nDepth;
+                break;
+            case '}':
+            case ']':
+                if (--nDepth == 0)
+                {
+                    return nPos + 1;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return std::string::npos;
+}
+
+/**
+ * Finds the ids of a call or of the calls of a batch, skipping notifications, which have no id
+ * or, in JSON-RPC 1.0, the id null. Only the top level members are looked at, so large
+ * parameters cost no more than a search for quotes and brackets.
+ * @param[in] strMessage The message.
+ * @param[out] oIds The ids in the order of the calls.
+ * @param[out] bRequest Whether the message is a request, the first call of a batch decides.
+ * @return false if the message is no object or array of objects.
+ */
+bool FindIds(const std::string& strMessage, std::vector<tSpan>& oIds, bool& bRequest)
+{
+    oIds.clear();
+    bRequest = true;
+    size_t nPos = SkipWhitespace(strMessage, 0);
+    const bool bBatch = nPos < strMessage.size() && strMessage[nPos] == '[';
+    if (bBatch)
+    {
+        nPos = SkipWhitespace(strMessage, nPos + 1);
+        if (nPos < strMessage.size() && strMessage[nPos] == ']')
+        {
+            return true;
+        }
+    }
+
+    for (bool bFirst = true;; bFirst = false)
+    {
+        if (nPos >= strMessage.size() || strMessage[nPos] != '{')
+        {
+            return false;
+        }
+        if (bFirst)
+        {
+            bRequest = false;
+        }
+        nPos = SkipWhitespace(strMessage, nPos + 1);
+        while (nPos < strMessage.size() && strMessage[nPos] != '}')
+        {
+            const size_t nName = nPos;
+            nPos = SkipValue(strMessage, nPos);
+            if (nPos == std::string::npos || strMessage[nName] != '"')
+            {
+                return false;
+            }
+            const size_t nNameSize = nPos - nName;
+            nPos = SkipWhitespace(strMessage, nPos);
+            if (nPos >= strMessage.size() || strMessage[nPos] != ':')
+            {
+                return false;
+            }
+            const tSpan oValue = {SkipWhitespace(strMessage, nPos + 1), 0};
+            nPos = SkipValue(strMessage, oValue.nBegin);
+            if (nPos == std::string::npos)
+            {
+                return false;
+            }
+            if (strMessage.compare(nName, nNameSize, "\"id\"") == 0 &&
+                strMessage.compare(oValue.nBegin, 4, "null") != 0)
+            {
+                oIds.push_back({oValue.nBegin, nPos});
+            }
+            else if (bFirst && strMessage.compare(nName, nNameSize, "\"method\"") == 0)
+            {
+                bRequest = true;
+            }
+            nPos = SkipWhitespace(strMessage, nPos);
+            if (nPos < strMessage.size() && strMessage[nPos] == ',')
+            {
+                nPos = SkipWhitespace(strMessage, nPos + 1);
+            }
+        }
+        if (nPos >= strMessage.size())
+        {
+            return false;
+        }
+        nPos = SkipWhitespace(strMessage, nPos + 1);
+        if (!bBatch)
+        {
+            return true;
+        }
+        if (nPos < strMessage.size() && strMessage[nPos] == ']')
+        {
+            return true;
+        }
+        if (nPos >= strMessage.size() || strMessage[nPos] != ',')
+        {
+            return false;
+        }
+        nPos = SkipWhitespace(strMessage, nPos + 1);
+    }
+}
+
+/**
+ * Reads an id the calls got on the way.
+ * @return false if the id is no such id.
+ */
+bool ParseId(const std::string& strMessage, const tSpan& oId, uint64_t& nId)
+{
+    nId = 0;
+    if (oId.nBegin == oId.nEnd || oId.nEnd - oId.nBegin > 19)
+    {
+        return false;
+    }
+    for (size_t nPos = oId.nBegin; nPos < oId.nEnd; ++nPos)
+    {
+        if (strMessage[nPos] < '0' || strMessage[nPos] > '9')
+        {
+            return false;
+        }
+        nId = nId * 10 + static_cast<uint64_t>(strMessage[nPos] - '0');
+    }
+    return true;
+}
+
+/**
+ * Replaces the ids of a message.
+ */
+std::string ReplaceIds(const std::string& strMessage,
+                       const std::vector<tSpan>& oIds,
+                       const std::vector<std::string>& oValues)
+{
+    std::string strResult;
+    strResult.reserve(strMessage.size() + oIds.size() * 8);
+    size_t nPos = 0;
+    for (size_t nId = 0; nId < oIds.size(); ++nId)
+    {
+        strResult.append(strMessage, nPos, oIds[nId].nBegin - nPos);
+        strResult.append(oValues[nId]);
+        nPos = oIds[nId].nEnd;
+    }
+    strResult.append(strMessage, nPos, std::string::npos);
+    return strResult;
+}
+
+/**
+ * Whether the id of a call asks for a response, notifications have none or, in JSON-RPC 1.0,
+ * the id null.
+ */
+bool HasId(const Json::Value& oCall)
+{
+    return oCall.isObject() && oCall.isMember("id") && !oCall["id"].isNull();
+}
+
+std::string Write(const Json::Value& oMessage)
+{
+    Json::FastWriter oWriter;
+    oWriter.omitEndingLineFeed();
+    return oWriter.write(oMessage);
+}
+
+Json::Value CreateError(const Json::Value& oId, int nCode, const std::string& strMessage)
+{
+    Json::Value oError;
+    oError["jsonrpc"] = "2.0";
+    oError["id"] = oId;
+    oError["error"]["code"] = nCode;
+    oError["error"]["message"] = strMessage;
+    return oError;
+}
+} // namespace
+
+struct cWebSocketCalls::tCall
+{
+    /// the ids of the request in the order they have been replaced
+    std::vector<std::string> oIds;
+    uint64_t nFirstId;
+    std::string strResponse;
+    std::condition_variable oDone;
+    bool bDone;
+    bool bAnswered;
+};
+
+cWebSocketCalls::cWebSocketCalls() : m_nNextId(1), m_bClosed(false)
+{
+}
+
+cWebSocketCalls::~cWebSocketCalls()
+{
+    Close();
+}
+
+bool cWebSocketCalls::Call(const std::string& strRequest,
+                           std::string& strResponse,
+                           const tSend& fnSend)
+{
+    std::vector<tSpan> oIdSpans;
+    bool bRequest = false;
+    if (!FindIds(strRequest, oIdSpans, bRequest))
+    {
+        return false;
+    }
+
+    tCall oCall;
+    oCall.bDone = false;
+    oCall.bAnswered = false;
+    std::vector<std::string> oReplacedIds;
+    {
+        std::lock_guard<std::mutex> oGuard(m_oLock);
+        if (m_bClosed)
+        {
+            return false;
+        }
+        oCall.nFirstId = m_nNextId;
+        for (const tSpan& oId: oIdSpans)
+        {
+            oCall.oIds.emplace_back(strRequest, oId.nBegin, oId.nEnd - oId.nBegin);
+            oReplacedIds.push_back(std::to_string(m_nNextId));
+            m_oPending[m_nNextId++] = &oCall;
+        }
+    }
+
+    const bool bSent = fnSend(ReplaceIds(strRequest, oIdSpans, oReplacedIds));
+    std::unique_lock<std::mutex> oLock(m_oLock);
+    if (oCall.oIds.empty())
+    {
+        strResponse.clear();
+        return bSent;
+    }
+    if (!bSent)
+    {
+        // unless the connection has been closed meanwhile, which failed the call already
+        const std::map<uint64_t, tCall*>::iterator itCall = m_oPending.find(oCall.nFirstId);
+        if (itCall != m_oPending.end() && itCall->second == &oCall)
+        {
+            for (uint64_t nId = 0; nId < oCall.oIds.size(); ++nId)
+            {
+                m_oPending.erase(oCall.nFirstId + nId);
+            }
+            return false;
+        }
+    }
+    oCall.oDone.wait(oLock, [&oCall]() { return oCall.bDone; });
+    strResponse.swap(oCall.strResponse);
+    return oCall.bAnswered;
+}
+
+cWebSocketCalls::eMessage cWebSocketCalls::Receive(const std::string& strMessage)
+{
+    std::vector<tSpan> oIdSpans;
+    bool bRequest = false;
+    if (!FindIds(strMessage, oIdSpans, bRequest) || bRequest)
+    {
+        return eRequest;
+    }
+
+    tCall* pCall = nullptr;
+    {
+        std::lock_guard<std::mutex> oGuard(m_oLock);
+        uint64_t nId = 0;
+        // errors for calls the other side could not parse have the id null, the others decide
+        for (const tSpan& oId: oIdSpans)
+        {
+            if (ParseId(strMessage, oId, nId))
+            {
+                const std::map<uint64_t, tCall*>::iterator itCall = m_oPending.find(nId);
+                if (itCall != m_oPending.end())
+                {
+                    pCall = itCall->second;
+                }
+                break;
+            }
+        }
+        if (!pCall)
+        {
+            return eUnexpected;
+        }
+        for (uint64_t nId = 0; nId < pCall->oIds.size(); ++nId)
+        {
+            m_oPending.erase(pCall->nFirstId + nId);
+        }
+    }
+
+    // the call is not pending anymore, nobody else touches it until it is done
+    std::vector<std::string> oOriginalIds;
+    for (const tSpan& oId: oIdSpans)
+    {
+        uint64_t nId = 0;
+        const uint64_t nIndex =
+            ParseId(strMessage, oId, nId) ? nId - pCall->nFirstId : pCall->oIds.size();
+        oOriginalIds.push_back(nIndex < pCall->oIds.size()
+                                   ? pCall->oIds[nIndex]
+                                   : strMessage.substr(oId.nBegin, oId.nEnd - oId.nBegin));
+    }
+    pCall->strResponse = ReplaceIds(strMessage, oIdSpans, oOriginalIds);
+
+    std::lock_guard<std::mutex> oGuard(m_oLock);
+    pCall->bAnswered = true;
+    pCall->bDone = true;
+    pCall->oDone.notify_one();
+    return eResponse;
+}
+
+bool cWebSocketCalls::HasPendingCalls() const
+{
+    std::lock_guard<std::mutex> oGuard(m_oLock);
+    return !m_oPending.empty();
+}
+
+void cWebSocketCalls::Close()
+{
+    std::lock_guard<std::mutex> oGuard(m_oLock);
+    m_bClosed = true;
+    for (const std::pair<const uint64_t, tCall*>& oPending: m_oPending)
+    {
+        oPending.second->bDone = true;
+        oPending.second->oDone.notify_one();
+    }
+    m_oPending.clear();
+}
+
+void cWebSocketCalls::Open()
+{
+    std::lock_guard<std::mutex> oGuard(m_oLock);
+    m_bClosed = false;
+}
+
+cWebSocketWorkers::cWebSocketWorkers(const tHandle& fnHandle, size_t nMaxThreads)
+    : m_fnHandle(fnHandle),
+      m_nMaxThreads(nMaxThreads),
+      m_nMaxMessages(nMaxThreads * nMaxWaitingMessagesPerThread),
+      m_nIdle(0),
+      m_bStopping(false)
+{
+}
+
+cWebSocketWorkers::~cWebSocketWorkers()
+{
+    {
+        std::lock_guard<std::mutex> oGuard(m_oLock);
+        m_bStopping = true;
+        m_oMessages.clear();
+    }
+    m_oWaiting.notify_all();
+    for (std::thread& oThread: m_oThreads)
+    {
+        oThread.join();
+    }
+}
+
+void cWebSocketWorkers::Push(std::string&& strMessage, uint64_t nReceived)
+{
+    std::lock_guard<std::mutex> oGuard(m_oLock);
+    m_oMessages.emplace_back(std::move(strMessage), nReceived);
+    if (m_oMessages.size() > m_nIdle && m_oThreads.size() < m_nMaxThreads)
+    {
+        m_oThreads.emplace_back(&cWebSocketWorkers::Work, this);
+    }
+    else
+    {
+        m_oWaiting.notify_one();
+    }
+}
+
+bool cWebSocketWorkers::WaitForSlot(uint32_t nTimeoutMilliseconds)
+{
+    std::unique_lock<std::mutex> oLock(m_oLock);
+    return m_oSlotFree.wait_for(oLock, std::chrono::milliseconds(nTimeoutMilliseconds), [this]() {
+        return m_bStopping || m_oMessages.size() < m_nMaxMessages;
+    });
+}
+
+void cWebSocketWorkers::Work()
+{
+    std::string strMessage;
+    std::unique_lock<std::mutex> oLock(m_oLock);
+    for (;;)
+    {
+        ++m_nIdle;
+        m_oWaiting.wait(oLock, [this]() { return m_bStopping || !m_oMessages.empty(); });
+        --m_nIdle;
+        if (m_bStopping)
+        {
+            return;
+        }
+        strMessage.swap(m_oMessages.front().first);
+        const uint64_t nReceived = m_oMessages.front().second;
+        m_oMessages.pop_front();
+        m_oSlotFree.notify_one();
+
+        oLock.unlock();
+        m_fnHandle(strMessage, nReceived);
+        oLock.lock();
+    }
+}
+
+bool CreateErrorResponse(const std::string& strRequest,
+                         int nCode,
+                         const std::string& strMessage,
+                         std::string& strResponse)
+{
+    Json::Value oRequest;
+    if (!Json::Reader().parse(strRequest, oRequest, false))
+    {
+        strResponse = Write(CreateError(Json::Value(),
+                                        jsonrpc::Errors::ERROR_RPC_JSON_PARSE_ERROR,
+                                        jsonrpc::Errors::GetErrorMessage(
+                                            jsonrpc::Errors::ERROR_RPC_JSON_PARSE_ERROR)));
+        return true;
+    }
+    if (oRequest.isObject() && oRequest.isMember("method"))
+    {
+        if (!HasId(oRequest))
+        {
+            return false;
+        }
+        strResponse = Write(CreateError(oRequest["id"], nCode, strMessage));
+        return true;
+    }
+    if (oRequest.isArray() && !oRequest.empty())
+    {
+        Json::Value oResponse(Json::arrayValue);
+        for (const Json::Value& oElement: oRequest)
+        {
+            if (HasId(oElement))
+            {
+                oResponse.append(CreateError(oElement["id"], nCode, strMessage));
+            }
+        }
+        if (oResponse.empty())
+        {
+            return false;
+        }
+        strResponse = Write(oResponse);
+        return true;
+    }
+    strResponse = Write(CreateError(Json::Value(),
+                                    jsonrpc::Errors::ERROR_RPC_INVALID_REQUEST,
+                                    jsonrpc::Errors::GetErrorMessage(
+                                        jsonrpc::Errors::ERROR_RPC_INVALID_REQUEST)));
+    return true;
+}
+
+} // namespace detail
+} // namespace http
+} // namespace rpc
@@ -0,0 +1,189 @@
+/**
+ * @file
+ * JSON-RPC calls over WebSocket connections declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_WEBSOCKET_CALLS_H_INCLUDED
+#define PKG_RPC_WEBSOCKET_CALLS_H_INCLUDED
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace rpc
+{
+namespace http
+{
+namespace detail
+{
+
+/**
+ * Matches the JSON-RPC calls one side of a WebSocket connection sends to the responses of the
+ * other side by their ids, whatever order the responses arrive in. The ids are replaced by ids
+ * unique on the connection while the calls are on the way, so calls of several threads share the
+ * connection and a slow call does not hold up the others.
+ */
+class cWebSocketCalls
+{
+public:
+    /// sends a message, false if the connection is closed
+    typedef std::function<bool(const std::string& strMessage)> tSend;
+
+    /**
+     * What a received message is, see @ref Receive.
+     */
+    enum eMessage
+    {
+        /// a response to a pending call, which has been handed over to it
+        eResponse,
+        /// a request, notification or batch of the other side, or no JSON at all
+        eRequest,
+        /// a response to no pending call
+        eUnexpected
+    };
+
+public:
+    cWebSocketCalls();
+    ~cWebSocketCalls();
+
+    /**
+     * Sends a request and waits for its response. Thread safe.
+     * @param[in] strRequest A JSON-RPC request or batch.
+     * @param[out] strResponse The response with the ids of the request, empty if the request
+     *                         only contains notifications.
+     * @param[in] fnSend Sends the request with the replaced ids, it is called without any lock.
+     * @return false if the request is no JSON or the connection closed before the response.
+     */
+    bool Call(const std::string& strRequest, std::string& strResponse, const tSend& fnSend);
+
+    /**
+     * Hands a message of the other side to the call waiting for it, if it is a response.
+     * @param[in] strMessage The message.
+     * @return What the message is.
+     */
+    eMessage Receive(const std::string& strMessage);
+
+    /**
+     * Whether calls wait for their response, if not, received messages cannot be responses.
+     * @return true if calls wait.
+     */
+    bool HasPendingCalls() const;
+
+    /**
+     * Fails the waiting calls and the ones that follow, once the connection has been closed.
+     */
+    void Close();
+
+    /**
+     * Accepts calls again, once the connection has been established again.
+     */
+    void Open();
+
+private:
+    struct tCall;
+
+    mutable std::mutex m_oLock;
+    /// the waiting calls by their replaced ids, batches occur once per id
+    std::map<uint64_t, tCall*> m_oPending;
+    uint64_t m_nNextId;
+    bool m_bClosed;
+};
+
+/**
+ * Handles the messages a WebSocket connection receives on threads of their own, so the
+ * connection keeps receiving while they are handled. A thread is started whenever more messages
+ * wait than threads are idle, up to a limit, and waits for the next message when it is done.
+ * Only a few messages per thread may wait, the connection stops receiving then (see
+ * @ref WaitForSlot) and TCP flow control slows down the other side.
+ */
+class cWebSocketWorkers
+{
+public:
+    /// handles a message that started to arrive at nReceived
+    typedef std::function<void(const std::string& strMessage, uint64_t nReceived)> tHandle;
+
+public:
+    /**
+     * Constructor.
+     * @param[in] fnHandle Handles a message.
+     * @param[in] nMaxThreads The most threads, 1 handles the messages in the order they arrived.
+     */
+    cWebSocketWorkers(const tHandle& fnHandle, size_t nMaxThreads);
+
+    /**
+     * Drops the messages that still wait and waits for the ones being handled.
+     */
+    ~cWebSocketWorkers();
+
+    /**
+     * Hands over a message to the next idle thread.
+     * @param[in] strMessage The message.
+     * @param[in] nReceived When the message started to arrive.
+     */
+    void Push(std::string&& strMessage, uint64_t nReceived);
+
+    /**
+     * Waits until fewer messages wait than the limit, before the next message is received.
+     * @param[in] nTimeoutMilliseconds The longest time to wait.
+     * @return false if the limit is still reached after the timeout.
+     */
+    bool WaitForSlot(uint32_t nTimeoutMilliseconds);
+
+private:
+    void Work();
+
+private:
+    tHandle m_fnHandle;
+    size_t m_nMaxThreads;
+    size_t m_nMaxMessages;
+    std::mutex m_oLock;
+    std::condition_variable m_oWaiting;
+    std::condition_variable m_oSlotFree;
+    std::deque<std::pair<std::string, uint64_t>> m_oMessages;
+    std::vector<std::thread> m_oThreads;
+    size_t m_nIdle;
+    bool m_bStopping;
+};
+
+/**
+ * Creates the error response to a JSON-RPC request that no object handles.
+ * @param[in] strRequest The request or batch.
+ * @param[in] nCode The error code, i.e. jsonrpc::Errors::ERROR_RPC_METHOD_NOT_FOUND.
+ * @param[in] strMessage The error message.
+ * @param[out] strResponse An error for every call of the request, with its id. Requests that are
+ *                         no JSON or no requests get a single error with the id null.
+ * @return false if the request only contains notifications, which are not answered.
+ */
+bool CreateErrorResponse(const std::string& strRequest,
+                         int nCode,
+                         const std::string& strMessage,
+                         std::string& strResponse);
+
+} // namespace detail
+} // namespace http
+} // namespace rpc
+
+#endif // PKG_RPC_WEBSOCKET_CALLS_H_INCLUDED
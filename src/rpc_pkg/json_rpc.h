@@ -23,6 +23,7 @@
 
 #include <jsonrpccpp/client/iclientconnector.h>
 #include <jsonrpccpp/server/abstractserverconnector.h>
+#include <jsonrpccpp/server/abstractprotocolhandler.h>
 
 #if defined(__QNX__) && defined(__GNUC__) && (__GNUC__ == 5)
 #include <string>
@@ -90,6 +91,36 @@ public:
                                       oValue["Function"].asString().c_str());
     }
 
+    /**
+     * Fills a struct generated with --cpp-structs from a result, like result_to_json.
+     * @tparam ResultStruct struct with the members ErrorCode, Description, Line, File and Function
+     */
+    template <typename ResultStruct>
+    static inline ResultStruct result_to_struct(a_util::result::Result nResult)
+    {
+        ResultStruct oResult;
+        oResult.ErrorCode = nResult.getErrorCode();
+        oResult.Description = nResult.getDescription();
+        oResult.Line = nResult.getLine();
+        oResult.File = nResult.getFile();
+        oResult.Function = nResult.getFunction();
+        return oResult;
+    }
+
+    /**
+     * Creates a result from a struct generated with --cpp-structs, like json_to_result.
+     * @tparam ResultStruct struct with the members ErrorCode, Description, Line, File and Function
+     */
+    template <typename ResultStruct>
+    static inline a_util::result::Result struct_to_result(const ResultStruct& oValue)
+    {
+        return a_util::result::Result(oValue.ErrorCode,
+                                      oValue.Description.c_str(),
+                                      oValue.Line,
+                                      oValue.File.c_str(),
+                                      oValue.Function.c_str());
+    }
+
     static inline int64_t stoll(const std::string& strValue)
     {
 #ifdef HAVE_STD_STOLL
@@ -129,6 +160,37 @@ public:
     {
     }
 
+    /**
+     * Selects the wire encoding of the calls, the connector has to provide SetContentType().
+     * @param[in] eEncoding jsonrpc::ENCODING_JSON (default), jsonrpc::ENCODING_CBOR or
+     *                      jsonrpc::ENCODING_MSGPACK.
+     */
+    void SetEncoding(jsonrpc::encoding_t eEncoding)
+    {
+        Connector::SetContentType(jsonrpc::GetContentType(eEncoding));
+        Stub::SetEncoding(eEncoding);
+    }
+
+    /**
+     * Compresses large calls and accepts compressed results, the connector has to provide
+     * EnableCompression().
+     * @param[in] nMinimumRequestSize Smaller requests are sent as they are.
+     */
+    void EnableCompression(size_t nMinimumRequestSize = 1024)
+    {
+        Connector::EnableCompression(nMinimumRequestSize);
+    }
+
+    /**
+     * Sets the object that handles the calls of the server, the connector has to provide
+     * SetCallbackObject().
+     * @param[in] pObject The object, it has to outlive this one, nullptr to reset it.
+     */
+    void SetCallbackObject(IRPCObject* pObject)
+    {
+        Connector::SetCallbackObject(pObject);
+    }
+
 protected:
     /**
      * Access the rpc stub.
@@ -233,6 +295,34 @@ public:
 
     bool OnRequest(const std::string& request, IResponse* response)
     {
+        jsonrpc::encoding_t eEncoding = jsonrpc::ENCODING_JSON;
+        IEncodedResponse* pEncodedResponse = dynamic_cast<IEncodedResponse*>(response);
+        if (pEncodedResponse)
+        {
+            jsonrpc::GetEncoding(pEncodedResponse->GetContentType(), eEncoding);
+        }
+
+        if (eEncoding != jsonrpc::ENCODING_JSON)
+        {
+            jsonrpc::AbstractProtocolHandler* pHandler =
+                dynamic_cast<jsonrpc::AbstractProtocolHandler*>(GetHandler());
+            if (!pHandler)
+            {
+                return false;
+            }
+            std::string response_value;
+            pHandler->HandleRequest(request, response_value, eEncoding);
+            response->Set(response_value.data(), response_value.size());
+            return true;
+        }
+
+        IStreamingResponse* pStreamingResponse = dynamic_cast<IStreamingResponse*>(response);
+        if (pStreamingResponse)
+        {
+            ProcessRequest(request, pStreamingResponse->GetStream());
+            return true;
+        }
+
         std::string response_value;
         ProcessRequest(request, response_value);
         response->Set(response_value.c_str(), response_value.size());
@@ -249,6 +339,9 @@ class jsonrpc_object_server : protected Connector,
                               public IRPCObject,
                               protected cJSONConversions
 {
+    // stubs generated with --cpp-static-dispatch cast themselves to the implementing class
+    friend ServerStub;
+
 public:
     jsonrpc_object_server() : ServerStub(*static_cast<jsonrpc::AbstractServerConnector*>(this))
     {
@@ -273,6 +366,50 @@ public:
 
         return Result();
     }
+
+protected:
+    /**
+     * Selects the JSON reader used to parse incoming requests.
+     * @param[in] eReader jsonrpc::JSONREADER_FAST for the strict, vectorized reader,
+     *                    jsonrpc::JSONREADER_CLASSIC (default) for the lenient one.
+     */
+    void SetJsonReader(jsonrpc::jsonreader_t eReader)
+    {
+        jsonrpc::AbstractProtocolHandler* pHandler =
+            dynamic_cast<jsonrpc::AbstractProtocolHandler*>(Connector::GetHandler());
+        if (pHandler)
+        {
+            pHandler->SetJsonReader(eReader);
+        }
+    }
+
+    /**
+     * Drops the cached responses of the methods marked "cacheable" in the interface
+     * definition, call it whenever the values they return change.
+     */
+    void InvalidateResponseCache()
+    {
+        jsonrpc::AbstractProtocolHandler* pHandler =
+            dynamic_cast<jsonrpc::AbstractProtocolHandler*>(Connector::GetHandler());
+        if (pHandler)
+        {
+            pHandler->InvalidateCache();
+        }
+    }
+
+    /**
+     * Drops the cached responses of one method marked "cacheable" in the interface definition.
+     * @param[in] strMethod The name of the method.
+     */
+    void InvalidateResponseCache(const std::string& strMethod)
+    {
+        jsonrpc::AbstractProtocolHandler* pHandler =
+            dynamic_cast<jsonrpc::AbstractProtocolHandler*>(Connector::GetHandler());
+        if (pHandler)
+        {
+            pHandler->InvalidateCache(strMethod);
+        }
+    }
 };
 
 } // namespace rpc
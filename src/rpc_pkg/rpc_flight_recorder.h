@@ -0,0 +1,113 @@
+/**
+ * @file
+ * Recorder of slow RPC calls declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_RPC_FLIGHT_RECORDER_H_INCLUDED
+#define PKG_RPC_RPC_FLIGHT_RECORDER_H_INCLUDED
+
+#include <a_util/memory.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "rpc_pkg/rpc_metrics.h"
+
+namespace rpc
+{
+
+/**
+ * A call recorded by the @ref cFlightRecorder.
+ */
+struct tSlowCall
+{
+    /// name of the RPC object, truncated to @ref cFlightRecorder::nMaxNameSize characters
+    std::string strObject;
+    /// name of the method, empty for batches, truncated like @ref strObject
+    std::string strMethod;
+    /// size of the request
+    uint64_t nRequestBytes;
+    /// latency of the call
+    uint64_t nNanoseconds;
+    /// nanoseconds spent in each phase, @ref ePhaseWrite is unknown when the call is recorded
+    uint64_t aPhaseNanoseconds[ePhaseCount];
+    /// the thread that handled the call
+    uint64_t nThreadId;
+    /// the start of the request, at most @ref cFlightRecorder::nSnippetSize bytes
+    std::string strRequest;
+
+    tSlowCall();
+};
+
+/**
+ * Keeps the last calls that took longer than a threshold in a ring buffer of fixed size.
+ * Recording neither allocates nor blocks, a call is dropped if its slot is being written or read
+ * at the same time.
+ */
+class cFlightRecorder
+{
+public:
+    /// the maximum number of characters of the object and method name
+    static const size_t nMaxNameSize = 63;
+    /// the maximum number of bytes of the request kept
+    static const size_t nSnippetSize = 256;
+
+    /**
+     * Constructor.
+     * @param[in] nThresholdNanoseconds Calls taking at least this long are recorded.
+     * @param[in] nCapacity The number of calls kept.
+     */
+    cFlightRecorder(uint64_t nThresholdNanoseconds, size_t nCapacity);
+    ~cFlightRecorder();
+
+    /**
+     * @return The threshold passed to the constructor.
+     */
+    uint64_t GetThreshold() const;
+
+    /**
+     * Records a call if it exceeded the threshold.
+     * @param[in] strObject The name of the object.
+     * @param[in] strMethod The name of the method, empty for batches.
+     * @param[in] strRequest The request.
+     * @param[in] nRequestBytes The size of the request.
+     * @param[in] nNanoseconds The latency of the call.
+     * @param[in] pPhaseNanoseconds The time spent in the phases, nullptr if they are not known.
+     * @return Whether the call has been recorded.
+     */
+    bool Record(const char* strObject,
+                const char* strMethod,
+                const char* strRequest,
+                size_t nRequestBytes,
+                uint64_t nNanoseconds,
+                const uint64_t* pPhaseNanoseconds);
+
+    /**
+     * Returns the recorded calls, calls recorded concurrently may be missing.
+     * @return The calls, the oldest first.
+     */
+    std::vector<tSlowCall> GetCalls() const;
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
+} // namespace rpc
+
+#endif // PKG_RPC_RPC_FLIGHT_RECORDER_H_INCLUDED
@@ -0,0 +1,206 @@
+/**
+ * @file
+ * RPC call metrics declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_RPC_METRICS_H_INCLUDED
+#define PKG_RPC_RPC_METRICS_H_INCLUDED
+
+#include <a_util/memory.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rpc
+{
+
+/**
+ * Distribution of call latencies in nanoseconds. Below 16 ns every nanosecond has its own bucket,
+ * above every power of two is split into 8 buckets, so percentiles are accurate to 12.5%.
+ */
+class cLatencyHistogram
+{
+public:
+    /// up to 2^40 ns, about 18 minutes, longer calls are counted in the last bucket
+    static const size_t nBucketCount = 16 + 36 * 8;
+
+    cLatencyHistogram();
+
+    /**
+     * Returns the bucket of a latency.
+     * @param[in] nNanoseconds The latency.
+     * @return The index into @ref m_aBuckets.
+     */
+    static size_t GetBucket(uint64_t nNanoseconds);
+
+    /**
+     * Returns the largest latency counted in a bucket.
+     * @param[in] nBucket The index into @ref m_aBuckets.
+     * @return The latency in nanoseconds.
+     */
+    static uint64_t GetBucketLimit(size_t nBucket);
+
+    /**
+     * Adds the counts of another histogram.
+     * @param[in] oOther The histogram.
+     */
+    void Add(const cLatencyHistogram& oOther);
+
+    /**
+     * @return The number of latencies counted.
+     */
+    uint64_t GetCount() const;
+
+    /**
+     * Returns the latency a share of the calls did not exceed.
+     * @param[in] fShare The share, i.e. 0.99 for the 99th percentile.
+     * @return The limit of the bucket of the percentile in nanoseconds, 0 if the histogram is empty.
+     */
+    uint64_t GetPercentile(double fShare) const;
+
+public:
+    /// the number of latencies per bucket
+    uint64_t m_aBuckets[nBucketCount];
+};
+
+/**
+ * The steps of handling a request over HTTP.
+ */
+enum ePhase
+{
+    /// receiving the HTTP request
+    ePhaseRead,
+    /// waiting for the RPC object, which is locked while it is unregistered
+    ePhaseLock,
+    /// parsing the request
+    ePhaseParse,
+    /// calling the method
+    ePhaseDispatch,
+    /// serializing the response
+    ePhaseSerialize,
+    /// sending the HTTP response
+    ePhaseWrite,
+    /// the number of phases
+    ePhaseCount
+};
+
+/**
+ * Returns the name of a phase as used in the Server-Timing header.
+ * @param[in] ePhase The phase.
+ * @return The name, i.e. "dispatch".
+ */
+const char* GetPhaseName(ePhase ePhase);
+
+/**
+ * The metrics of the calls of one method, or of all calls of an object if @ref strMethod is empty.
+ */
+struct tCallMetrics
+{
+    /// name of the RPC object
+    std::string strObject;
+    /// name of the method, empty for the totals of the object
+    std::string strMethod;
+    /// number of calls
+    uint64_t nCalls;
+    /// number of calls answered with an error
+    uint64_t nErrors;
+    /// size of the requests
+    uint64_t nBytesIn;
+    /// size of the responses
+    uint64_t nBytesOut;
+    /// latencies from handing a request to the server until its response is complete, not sent
+    cLatencyHistogram oLatency;
+    /// number of calls with phase timing, see cRPCServer::EnablePhaseTiming
+    uint64_t nTimedCalls;
+    /// nanoseconds spent in each phase by the timed calls, divide by @ref nTimedCalls for the mean
+    uint64_t aPhaseNanoseconds[ePhaseCount];
+
+    tCallMetrics();
+};
+
+/// Metrics of all objects and methods, sorted by object and method.
+typedef std::vector<tCallMetrics> tMetricsSnapshot;
+
+/**
+ * Collects call metrics. Every thread records into counters of its own, which are only summed
+ * up by @ref GetSnapshot, so recording neither blocks nor allocates once a thread has seen a
+ * method.
+ */
+class cRPCMetrics
+{
+public:
+    /// the number of distinct objects and methods each thread records, further ones are dropped
+    static const size_t nMaxEntries = 1024;
+
+    cRPCMetrics();
+    ~cRPCMetrics();
+
+    /**
+     * Records a call.
+     * @param[in] strObject The name of the object.
+     * @param[in] strMethod The name of the method, empty for the totals of the object.
+     * @param[in] bError Whether the call was answered with an error.
+     * @param[in] nBytesIn The size of the request.
+     * @param[in] nBytesOut The size of the response.
+     * @param[in] nNanoseconds The latency of the call.
+     * @param[in] pPhaseNanoseconds The time spent in the phases up to @ref ePhaseSerialize, nullptr
+     *                              if they are not known.
+     */
+    void RecordCall(const std::string& strObject,
+                    const std::string& strMethod,
+                    bool bError,
+                    size_t nBytesIn,
+                    size_t nBytesOut,
+                    uint64_t nNanoseconds,
+                    const uint64_t* pPhaseNanoseconds = nullptr);
+
+    /**
+     * Adds the time of a phase that ended after @ref RecordCall, i.e. @ref ePhaseWrite.
+     * @param[in] strObject The name of the object.
+     * @param[in] strMethod The name of the method, empty for the totals of the object.
+     * @param[in] ePhase The phase.
+     * @param[in] nNanoseconds The time spent in it.
+     */
+    void RecordPhase(const std::string& strObject,
+                     const std::string& strMethod,
+                     ePhase ePhase,
+                     uint64_t nNanoseconds);
+
+    /**
+     * Records a call that was part of a batch, its size and latency are only known for the batch.
+     * @param[in] strObject The name of the object.
+     * @param[in] strMethod The name of the method.
+     * @param[in] bError Whether the call was answered with an error.
+     */
+    void RecordBatchedCall(const std::string& strObject, const std::string& strMethod, bool bError);
+
+    /**
+     * Sums up the counters of all threads. Calls recorded concurrently may be partially included.
+     * @return The metrics.
+     */
+    tMetricsSnapshot GetSnapshot() const;
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
+} // namespace rpc
+
+#endif // PKG_RPC_RPC_METRICS_H_INCLUDED
@@ -0,0 +1,148 @@
+/**
+ * @file
+ * Fan-out of notifications to the subscribers of topics declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_RPC_NOTIFICATIONS_H_INCLUDED
+#define PKG_RPC_RPC_NOTIFICATIONS_H_INCLUDED
+
+#include <a_util/memory.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rpc
+{
+
+/**
+ * What happens to a notification published while the queue of a subscriber is full.
+ */
+enum eOverflowPolicy
+{
+    /// the oldest queued notification is dropped
+    eDropOldest,
+    /// the new notification is dropped
+    eDropNewest,
+    /// the new notification replaces a queued one with the same key, otherwise the oldest is
+    /// dropped
+    eCoalesce
+};
+
+/**
+ * A notification as it is sent to the subscribers, serialized once and shared by their queues.
+ */
+struct tNotification
+{
+    /// notifications with the same key replace each other with @ref eCoalesce
+    std::string strKey;
+    /// the serialized notification
+    std::string strData;
+};
+
+/// a notification shared by the queues of all subscribers
+typedef std::shared_ptr<const tNotification> tNotificationPtr;
+
+/**
+ * Distributes notifications to the subscribers of topics. Every subscriber has a queue of its own
+ * with a fixed capacity, so a slow subscriber neither blocks the publisher nor the others.
+ */
+class cNotificationHub
+{
+public:
+    /**
+     * The queue of a subscriber, subscribed to its topic as long as it exists.
+     */
+    class cSubscription
+    {
+    public:
+        /**
+         * Constructor, subscribes to a topic.
+         * @param[in] oHub The hub, has to outlive the subscription.
+         * @param[in] strTopic The topic.
+         */
+        cSubscription(cNotificationHub& oHub, const std::string& strTopic);
+
+        /**
+         * Destructor, unsubscribes.
+         */
+        ~cSubscription();
+
+        /**
+         * Waits for notifications and takes all queued ones.
+         * @param[out] oNotifications The notifications, the oldest first.
+         * @param[in] nTimeoutMilliseconds The longest time to wait.
+         * @return false if there was none within the timeout.
+         */
+        bool Take(std::vector<tNotificationPtr>& oNotifications, uint32_t nTimeoutMilliseconds);
+
+        /**
+         * Returns the number of notifications dropped or replaced because the queue was full.
+         * @return The number of notifications.
+         */
+        uint64_t GetDropped() const;
+
+    private:
+        cSubscription(const cSubscription&);
+        cSubscription& operator=(const cSubscription&);
+
+    private:
+        friend class cNotificationHub;
+        struct tQueue;
+        cNotificationHub& m_oHub;
+        std::string m_strTopic;
+        a_util::memory::unique_ptr<tQueue> m_pQueue;
+    };
+
+public:
+    /**
+     * Constructor.
+     * @param[in] nQueueCapacity The number of notifications queued per subscriber.
+     * @param[in] eOverflow What happens to notifications that do not fit into a queue.
+     */
+    cNotificationHub(size_t nQueueCapacity, eOverflowPolicy eOverflow);
+
+    /**
+     * Destructor, all subscriptions have to be gone.
+     */
+    ~cNotificationHub();
+
+    /**
+     * Queues a notification for all subscribers of a topic.
+     * @param[in] strTopic The topic.
+     * @param[in] pNotification The notification.
+     * @return The number of subscribers.
+     */
+    size_t Publish(const std::string& strTopic, const tNotificationPtr& pNotification);
+
+    /**
+     * Returns the number of subscribers of a topic.
+     * @param[in] strTopic The topic.
+     * @return The number of subscribers.
+     */
+    size_t GetSubscriberCount(const std::string& strTopic) const;
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
+} // namespace rpc
+
+#endif // PKG_RPC_RPC_NOTIFICATIONS_H_INCLUDED
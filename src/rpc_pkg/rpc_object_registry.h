@@ -25,7 +25,11 @@
 #include <a_util/concurrency.h>
 #include <a_util/memory.h>
 #include <map>
+#include <string>
+#include <utility>
+#include <vector>
 #include "rpc_pkg/rpc_server.h"
+#include "rpc_pkg/rpc_router.h"
 
 namespace rpc
 {
@@ -57,6 +61,24 @@ public:
      */
     virtual Result UnregisterRPCObject(const char* strName);
 
+    /// the names and objects of @ref RegisterRPCObjects
+    typedef std::vector<std::pair<std::string, IRPCObject*>> tRPCObjectList;
+
+    /**
+     * Registers a set of objects at once. Lookups either find none or all of them.
+     * @param[in] oObjects The names and objects.
+     * @return Standard result, no object is registered if one of them fails.
+     */
+    Result RegisterRPCObjects(const tRPCObjectList& oObjects);
+
+    /**
+     * Unregisters a set of objects at once and waits for the calls in progress on all of them.
+     * The registry is not locked while waiting, lookups of other objects continue.
+     * @param[in] oNames The names of the objects.
+     * @return Standard result, no object is unregistered if one of them is not found.
+     */
+    Result UnregisterRPCObjects(const std::vector<std::string>& oNames);
+
     typedef std::pair<a_util::memory::unique_ptr<a_util::concurrency::shared_mutex>, IRPCObject*>
         tRPCItem;
     typedef std::pair<a_util::concurrency::shared_mutex*, IRPCObject*> tRPCRawItem;
@@ -113,10 +135,37 @@ public:
 
     virtual cLockedRPCObject GetRPCObject(const char* strName) const;
 
+    /**
+     * Looks up the object whose route matches a path, see @ref cRouter for the routes objects
+     * may be registered with.
+     * @param[in] strPath The path.
+     * @param[out] oMatch The parameters of the route, they point into strPath.
+     * @return The locked object, empty if no route matches.
+     */
+    cLockedRPCObject GetRPCObject(const char* strPath, tRouteMatch& oMatch) const;
+
+    /**
+     * Looks up the object whose route matches a path and returns the route as well.
+     * @param[in] strPath The path.
+     * @param[out] oMatch The parameters of the route, they point into strPath.
+     * @param[out] strRoute The route the object is registered with, empty if no route matches.
+     * @return The locked object, empty if no route matches.
+     */
+    cLockedRPCObject GetRPCObject(const char* strPath,
+                                  tRouteMatch& oMatch,
+                                  std::string& strRoute) const;
+
+private:
+    Result InsertRPCObject(const std::string& strName,
+                           a_util::memory::unique_ptr<a_util::concurrency::shared_mutex>& pLock,
+                           IRPCObject* pObject);
+
 private:
     mutable a_util::concurrency::shared_mutex m_oObjectsLock;
     typedef std::map<std::string, tRPCItem> tRPCObjects;
     tRPCObjects m_oRPCObjects;
+    /// routes to the items of m_oRPCObjects
+    cRouter m_oRouter;
 };
 
 } // namespace rpc
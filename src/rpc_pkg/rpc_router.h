@@ -0,0 +1,144 @@
+/**
+ * @file
+ * Prefix tree router for RPC object paths declaration.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_RPC_ROUTER_H_INCLUDED
+#define PKG_RPC_RPC_ROUTER_H_INCLUDED
+
+#include <a_util/memory.h>
+#include <cstddef>
+#include <string>
+
+namespace rpc
+{
+
+/**
+ * A path parameter of a matched route. Name and value point into the route and the path.
+ */
+struct tRouteParameter
+{
+    /// the name of the parameter, "*" for the rest of the path below a mount
+    const char* strName;
+    /// the size of the name
+    size_t nNameSize;
+    /// the segment of the path
+    const char* strValue;
+    /// the size of the segment
+    size_t nValueSize;
+};
+
+/**
+ * The outcome of @ref cRouter::Find.
+ */
+struct tRouteMatch
+{
+    /// the most parameters a route may have
+    static const size_t nMaxParameters = 8;
+
+    /// the target of the route
+    void* pTarget;
+    /// the number of valid entries in @ref aParameters
+    size_t nParameterCount;
+    /// the values of the parameters in the order of the route
+    tRouteParameter aParameters[nMaxParameters];
+
+    tRouteMatch();
+
+    /**
+     * Returns the value of a parameter.
+     * @param[in] strName The name of the parameter without ':', "*" for the rest below a mount.
+     * @param[in] strDefault Returned if the route has no such parameter.
+     * @return The value.
+     */
+    std::string GetParameter(const char* strName, const std::string& strDefault = "") const;
+};
+
+/**
+ * Maps paths to targets with a radix tree of their bytes. Routes are split into segments at '/'.
+ * A segment ":name" matches any non-empty segment and a final segment "*" mounts the target on
+ * the subtree below the preceding '/'. Exact segments take precedence over parameters, parameters
+ * over mounts.
+ * @code
+ * /graph/streaming/filter_1/properties   only this path
+ * /graph/streaming/:filter/properties    one object for the properties of all filters
+ * @endcode
+ * and a final segment "*" after /graph/streaming/ serves everything below /graph/streaming/.
+ * Lookups take time linear in the length of the path and do not allocate, as long as no
+ * parameter competes with an exact segment that fails further down. The router is not
+ * synchronized.
+ */
+class cRouter
+{
+public:
+    /**
+     * Constructor.
+     */
+    cRouter();
+
+    /**
+     * Destructor.
+     */
+    ~cRouter();
+
+    /**
+     * Adds a route.
+     * @param[in] strRoute The route.
+     * @param[in] pTarget The target returned for matching paths, must not be nullptr.
+     * @return false if the route exists, a parameter at the same position is named differently
+     *         or the route has more than @ref tRouteMatch::nMaxParameters parameters.
+     */
+    bool Insert(const char* strRoute, void* pTarget);
+
+    /**
+     * Removes a route.
+     * @param[in] strRoute The route as it was inserted.
+     * @return false if there is no such route.
+     */
+    bool Remove(const char* strRoute);
+
+    /**
+     * Looks up the route matching a path.
+     * @param[in] strPath The path, the parameters point into it.
+     * @param[out] oMatch The target and parameters of the route.
+     * @return false if no route matches.
+     */
+    bool Find(const char* strPath, tRouteMatch& oMatch) const;
+
+private:
+    class cImplementation;
+    a_util::memory::unique_ptr<cImplementation> m_pImplementation;
+};
+
+/**
+ * Returns the route of the call the current thread handles, set by the server while an object
+ * handles a call.
+ * @return The route or nullptr outside of calls.
+ */
+const tRouteMatch* GetCurrentRoute();
+
+/**
+ * Sets the route returned by @ref GetCurrentRoute for the current thread.
+ * @param[in] pRoute The route, nullptr to reset it.
+ * @return The route set before.
+ */
+const tRouteMatch* SetCurrentRoute(const tRouteMatch* pRoute);
+
+} // namespace rpc
+
+#endif // PKG_RPC_RPC_ROUTER_H_INCLUDED
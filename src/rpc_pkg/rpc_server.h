@@ -22,6 +22,7 @@
 #define PKG_RPC_RPC_SERVER_H_INCLUDED
 
 #include <a_util/result.h>
+#include <ostream>
 
 namespace rpc
 {
@@ -52,6 +53,36 @@ public:
     virtual void Set(const char* strResponse, size_t nResponseSize) = 0;
 };
 
+/**
+ * Interface for responses that can be serialized piecewise instead of being
+ * handed over in one piece via @ref IResponse::Set.
+ */
+class IStreamingResponse : public IResponse
+{
+public:
+    /**
+     * Returns the stream the response is serialized into. Buffered data is sent
+     * whenever the underlying buffer is full, so the response does not need to be
+     * held in memory as a whole.
+     * @return The response stream.
+     */
+    virtual std::ostream& GetStream() = 0;
+};
+
+/**
+ * Optionally implemented by @ref IResponse objects of transports that negotiate
+ * the message encoding, i.e. via the HTTP content type.
+ */
+class IEncodedResponse
+{
+public:
+    /**
+     * Returns the content type of the request, the response has to use the same one.
+     * @return The MIME type, i.e. "application/cbor".
+     */
+    virtual const char* GetContentType() const = 0;
+};
+
 /**
  * Interface of an object that support remote calls
  */
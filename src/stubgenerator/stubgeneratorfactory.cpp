@@ -29,9 +29,16 @@
 #include "stubgeneratorfactory.h"
 #include <jsonrpccpp/common/specificationparser.h>
 #include <jsonrpccpp/version.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <thread>
 #include "commandline.h"
 #include "helper/cpphelper.h"
+#include "helper/cppstructs.h"
 #include "client/cppclientstubgenerator.h"
 #include "client/jsclientstubgenerator.h"
 #include "server/cppserverstubgenerator.h"
@@ -39,6 +46,100 @@
 using namespace jsonrpc;
 using namespace std;
 
+namespace
+{
+bool generateStubsOf(int argc, char** argv, FILE* my_stdout, FILE* my_stderr)
+{
+    vector<StubGenerator*> stubgenerators;
+    vector<Procedure> procedures;
+    bool result = StubGeneratorFactory::createStubGenerators(
+        argc, argv, procedures, stubgenerators, my_stdout, my_stderr);
+    for (unsigned int i = 0; i < stubgenerators.size(); ++i)
+    {
+        stubgenerators[i]->generateStub();
+        if (!stubgenerators[i]->writeFile())
+        {
+            fprintf(my_stderr, "Cannot write %s.\n", stubgenerators[i]->getFilename().c_str());
+            result = false;
+        }
+    }
+    StubGeneratorFactory::deleteStubGenerators(stubgenerators);
+    return result;
+}
+
+bool generateBatch(const string& program,
+                   const string& batch_file,
+                   unsigned int jobs,
+                   FILE* my_stdout,
+                   FILE* my_stderr)
+{
+    ifstream batch(batch_file.c_str());
+    if (!batch)
+    {
+        fprintf(my_stderr, "Cannot read batch file %s.\n", batch_file.c_str());
+        return false;
+    }
+
+    // one invocation per line, empty lines and lines starting with # are skipped
+    vector<string> invocations;
+    string line;
+    while (getline(batch, line))
+    {
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start != string::npos && line[start] != '#')
+        {
+            invocations.push_back("\"" + program + "\" " + line.substr(start));
+        }
+    }
+
+    if (jobs == 0)
+    {
+        jobs = std::max(thread::hardware_concurrency(), 1u);
+    }
+    jobs = std::min(jobs, static_cast<unsigned int>(invocations.size()));
+
+    atomic<size_t> next(0);
+    atomic<bool> result(true);
+    vector<thread> workers;
+    for (unsigned int i = 0; i < jobs; ++i)
+    {
+        workers.push_back(thread([&]() {
+            for (size_t index = next++; index < invocations.size(); index = next++)
+            {
+                rpc::cCommandLine oCmd(invocations[index]);
+                if (!generateStubsOf(oCmd.GetArgc(),
+                                     const_cast<char**>(oCmd.GetArgv()),
+                                     my_stdout,
+                                     my_stderr))
+                {
+                    result = false;
+                }
+            }
+        }));
+    }
+    for (unsigned int i = 0; i < workers.size(); ++i)
+    {
+        workers[i].join();
+    }
+    return result;
+}
+} // namespace
+
+bool StubGeneratorFactory::generateStubs(int argc, char** argv, FILE* my_stdout, FILE* my_stderr)
+{
+    rpc::cCommandLine oCmd(argc, const_cast<const char**>(argv));
+    string batch_file = oCmd.GetProperty("batch");
+    if (batch_file.empty())
+    {
+        return generateStubsOf(argc, argv, my_stdout, my_stderr);
+    }
+    return generateBatch(argv[0],
+                         batch_file,
+                         static_cast<unsigned int>(atoi(oCmd.GetProperty("jobs", "0").c_str())),
+                         my_stdout,
+                         my_stderr);
+}
+
 bool StubGeneratorFactory::createStubGenerators(int argc,
                                                 char** argv,
                                                 vector<Procedure>& procedures,
@@ -72,12 +173,39 @@ bool StubGeneratorFactory::createStubGenerators(int argc,
     }
 
     bool verbose = oCmd.GetFlag("verbose") || oCmd.GetFlag("v");
+    bool direct = oCmd.GetFlag("cpp-direct");
+    bool static_dispatch = oCmd.GetFlag("cpp-static-dispatch");
+    CPPStructs structs;
 
     try
     {
         string interface_definition;
         SpecificationParser::GetFileContent(oCmd.GetValue(1).c_str(), interface_definition);
         procedures = SpecificationParser::GetProceduresFromString(interface_definition);
+
+        // stubs dispatch by method id, so the ids of one interface have to be unique
+        map<int, string> method_ids;
+        for (unsigned int i = 0; i < procedures.size(); ++i)
+        {
+            const string& name = procedures.at(i).GetProcedureName();
+            map<int, string>::const_iterator it = method_ids.find(procedures.at(i).GetMethodId());
+            if (it != method_ids.end() && it->second != name)
+            {
+                fprintf(my_stderr,
+                        "The procedures %s and %s share the method id %d, rename one of them.\n",
+                        it->second.c_str(),
+                        name.c_str(),
+                        procedures.at(i).GetMethodId());
+                return false;
+            }
+            method_ids[procedures.at(i).GetMethodId()] = name;
+        }
+
+        if (oCmd.GetFlag("cpp-structs"))
+        {
+            structs.parse(interface_definition);
+        }
+
         if (verbose)
         {
             fprintf(my_stdout,
@@ -112,7 +240,10 @@ bool StubGeneratorFactory::createStubGenerators(int argc,
                 new CPPServerStubGenerator(oCmd.GetProperty("cpp-server").c_str(),
                                            procedures,
                                            filename,
-                                           interface_definition));
+                                           interface_definition,
+                                           direct,
+                                           static_dispatch,
+                                           structs));
         }
 
         if (!oCmd.GetProperty("cpp-client").empty())
@@ -125,7 +256,7 @@ bool StubGeneratorFactory::createStubGenerators(int argc,
             if (verbose)
                 fprintf(my_stdout, "Generating C++ Clientstub to: %s\n", filename.c_str());
             stubgenerators.push_back(new CPPClientStubGenerator(
-                oCmd.GetProperty("cpp-client").c_str(), procedures, filename));
+                oCmd.GetProperty("cpp-client").c_str(), procedures, filename, direct, structs));
         }
 
         if (!oCmd.GetProperty("js-client").empty())
@@ -0,0 +1,108 @@
+/**
+ * @file
+ * Encoded size and encode/decode time of CBOR and MessagePack compared to JSON.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <jsonrpccpp/common/binarycodec.h>
+#include "benchmark_payloads.h"
+
+namespace
+{
+enum ePayload
+{
+    eGetInteger,
+    eSignalList,
+    eFloatArray,
+    eBinaryBlob
+};
+
+Json::Value MakePayload(int64_t nPayload, int64_t nSize)
+{
+    using namespace rpc::benchmark_payloads;
+    switch (nPayload)
+    {
+    case eSignalList:
+        return MakeSignalListResponse(static_cast<size_t>(nSize));
+    case eFloatArray:
+        return MakeFloatArrayResponse(static_cast<size_t>(nSize));
+    case eBinaryBlob:
+    {
+        // raw bytes, JSON has to escape everything above 0x7f
+        std::string strBlob(static_cast<size_t>(nSize), '\0');
+        for (size_t nByte = 0; nByte < strBlob.size(); ++nByte)
+        {
+            strBlob[nByte] = static_cast<char>((nByte * 131) & 0xff);
+        }
+        return MakeResponse(Json::Value(strBlob));
+    }
+    default:
+        return MakeGetIntegerRequest();
+    }
+}
+
+void BM_Encode(benchmark::State& oState, jsonrpc::encoding_t eEncoding)
+{
+    const Json::Value oPayload = MakePayload(oState.range(0), oState.range(1));
+    std::string strEncoded;
+    for (auto _ : oState)
+    {
+        jsonrpc::EncodeValue(eEncoding, oPayload, strEncoded);
+        benchmark::DoNotOptimize(strEncoded.data());
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(strEncoded.size()));
+    oState.counters["encoded_bytes"] = static_cast<double>(strEncoded.size());
+}
+
+void BM_Decode(benchmark::State& oState, jsonrpc::encoding_t eEncoding)
+{
+    std::string strEncoded;
+    jsonrpc::EncodeValue(eEncoding, MakePayload(oState.range(0), oState.range(1)), strEncoded);
+    for (auto _ : oState)
+    {
+        Json::Value oValue;
+        if (!jsonrpc::DecodeValue(eEncoding, strEncoded, oValue, jsonrpc::JSONREADER_FAST))
+        {
+            oState.SkipWithError("decode failed");
+            break;
+        }
+        benchmark::DoNotOptimize(oValue);
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(strEncoded.size()));
+    oState.counters["encoded_bytes"] = static_cast<double>(strEncoded.size());
+}
+
+void PayloadArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    pBenchmark->ArgNames({"payload", "size"});
+    pBenchmark->Args({eGetInteger, 1});
+    pBenchmark->Args({eSignalList, 1000});
+    pBenchmark->Args({eFloatArray, 10000});
+    pBenchmark->Args({eBinaryBlob, 65536});
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Encode, json, jsonrpc::ENCODING_JSON)->Apply(PayloadArguments);
+BENCHMARK_CAPTURE(BM_Encode, cbor, jsonrpc::ENCODING_CBOR)->Apply(PayloadArguments);
+BENCHMARK_CAPTURE(BM_Encode, msgpack, jsonrpc::ENCODING_MSGPACK)->Apply(PayloadArguments);
+BENCHMARK_CAPTURE(BM_Decode, json, jsonrpc::ENCODING_JSON)->Apply(PayloadArguments);
+BENCHMARK_CAPTURE(BM_Decode, cbor, jsonrpc::ENCODING_CBOR)->Apply(PayloadArguments);
+BENCHMARK_CAPTURE(BM_Decode, msgpack, jsonrpc::ENCODING_MSGPACK)->Apply(PayloadArguments);
@@ -0,0 +1,78 @@
+/**
+ * @file
+ * Concurrent calls of a getter, each sent on its own against coalesced into shared requests.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <jsonrpccpp/client.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+/**
+ * Answers every request after the round trip time of a server on the local network.
+ */
+class cRemoteConnector : public jsonrpc::IClientConnector
+{
+public:
+    cRemoteConnector() : m_nSent(0)
+    {
+    }
+
+    void SendRPCMessage(const std::string&, std::string& strResult)
+    {
+        ++m_nSent;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        strResult = "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":42}";
+    }
+
+    std::atomic<int64_t> m_nSent;
+};
+
+/**
+ * All threads share a client, with the getter coalesced or not.
+ */
+template <bool bCoalesce>
+void BM_ConcurrentGetter(benchmark::State& oState)
+{
+    static cRemoteConnector oConnector;
+    static jsonrpc::Client oClient(oConnector);
+    if (oState.thread_index() == 0)
+    {
+        oClient.SetCoalescing("GetCounter", bCoalesce);
+        oConnector.m_nSent = 0;
+    }
+    const Json::Value oParams;
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oClient.CallMethod("GetCounter", oParams));
+    }
+    if (oState.thread_index() == 0)
+    {
+        oState.counters["requests_per_call"] =
+            static_cast<double>(oConnector.m_nSent) /
+            static_cast<double>(oState.iterations() * oState.threads());
+    }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ConcurrentGetter, false)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentGetter, true)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,107 @@
+/**
+ * @file
+ * Bytes on the wire against the CPU time of compressing bodies with gzip.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg/impl/compression.h>
+#include "benchmark_payloads.h"
+
+namespace
+{
+enum ePayload
+{
+    eGetInteger,
+    eSignalList,
+    eGraph,
+    eFloatArray
+};
+
+std::string MakeBody(int64_t nPayload, int64_t nSize)
+{
+    using namespace rpc::benchmark_payloads;
+    switch (nPayload)
+    {
+        case eSignalList:
+            return Json::FastWriter().write(MakeSignalListResponse(static_cast<size_t>(nSize)));
+        case eGraph:
+            return Json::FastWriter().write(MakeGraphRequest(static_cast<size_t>(nSize)));
+        case eFloatArray:
+            return Json::FastWriter().write(MakeFloatArrayResponse(static_cast<size_t>(nSize)));
+        default:
+            return Json::FastWriter().write(MakeGetIntegerRequest());
+    }
+}
+
+/**
+ * Compresses a body with a level, the compressor reused like the one of a connection.
+ */
+void BM_Compress(benchmark::State& oState, int nLevel)
+{
+    const std::string strBody = MakeBody(oState.range(0), oState.range(1));
+    rpc::http::detail::cCompressor oCompressor(nLevel);
+    std::string strCompressed;
+    for (auto _ : oState)
+    {
+        oCompressor.Compress(
+            rpc::http::detail::eEncodingGzip, strBody.data(), strBody.size(), strCompressed);
+        benchmark::DoNotOptimize(strCompressed.data());
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(strBody.size()));
+    oState.counters["body_bytes"] = static_cast<double>(strBody.size());
+    oState.counters["wire_bytes"] = static_cast<double>(strCompressed.size());
+}
+
+void BM_Decompress(benchmark::State& oState)
+{
+    const std::string strBody = MakeBody(oState.range(0), oState.range(1));
+    rpc::http::detail::cCompressor oCompressor;
+    std::string strCompressed;
+    oCompressor.Compress(
+        rpc::http::detail::eEncodingGzip, strBody.data(), strBody.size(), strCompressed);
+    std::string strDecompressed;
+    for (auto _ : oState)
+    {
+        if (!oCompressor.Decompress(
+                rpc::http::detail::eEncodingGzip, strCompressed, strDecompressed))
+        {
+            oState.SkipWithError("decompression failed");
+            break;
+        }
+        benchmark::DoNotOptimize(strDecompressed.data());
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(strBody.size()));
+    oState.counters["wire_bytes"] = static_cast<double>(strCompressed.size());
+}
+
+void PayloadArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    pBenchmark->ArgNames({"payload", "size"});
+    pBenchmark->Args({eGetInteger, 1});
+    pBenchmark->Args({eSignalList, 1000});
+    pBenchmark->Args({eGraph, 1000});
+    pBenchmark->Args({eFloatArray, 10000});
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_Compress, fastest, 1)->Apply(PayloadArguments);
+BENCHMARK_CAPTURE(BM_Compress, default, 6)->Apply(PayloadArguments);
+BENCHMARK(BM_Decompress)->Apply(PayloadArguments);
@@ -0,0 +1,167 @@
+/**
+ * @file
+ * Per-call CPU time of stubs generated with --cpp-direct compared to the Json::Value based ones,
+ * of calls by method id compared to calls by name and of stubs generated with
+ * --cpp-static-dispatch.
+ * Client and server run in-process, so only serialization and dispatch are measured.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg.h>
+#include <benchmarkclientstub.h>
+#include <benchmarkserverstub.h>
+#include <benchmarkdirectclientstub.h>
+#include <benchmarkdirectserverstub.h>
+#include <benchmarkstaticserverstub.h>
+#include "benchmark_server.h"
+
+namespace
+{
+using rpc::benchmark_server::cBenchmarkServer;
+
+/**
+ * Hands requests straight to the server object.
+ */
+class cLoopbackConnector : public jsonrpc::IClientConnector, private rpc::IResponse
+{
+public:
+    cLoopbackConnector(rpc::IRPCObject& oServer) : m_oServer(oServer), m_pResult(nullptr)
+    {
+    }
+
+    void SendRPCMessage(const std::string& message, std::string& result)
+    {
+        m_pResult = &result;
+        m_oServer.HandleCall(message.data(), message.size(), *this);
+    }
+
+private:
+    void Set(const char* strResponse, size_t nResponseSize)
+    {
+        m_pResult->assign(strResponse, nResponseSize);
+    }
+
+    rpc::IRPCObject& m_oServer;
+    std::string* m_pResult;
+};
+
+struct tDom
+{
+    typedef rpc_stubs::cBenchmarkClientStub Client;
+    typedef cBenchmarkServer<rpc_stubs::cBenchmarkServerStub> Server;
+};
+
+struct tDirect
+{
+    typedef rpc_stubs::cBenchmarkDirectClientStub Client;
+    typedef cBenchmarkServer<rpc_stubs::cBenchmarkDirectServerStub> Server;
+};
+
+/**
+ * final lets the compiler resolve the calls of the stub to the implementation.
+ */
+class cStaticBenchmarkServer final
+    : public cBenchmarkServer<rpc_stubs::cBenchmarkStaticServerStub<cStaticBenchmarkServer>>
+{
+};
+
+struct tStatic
+{
+    typedef rpc_stubs::cBenchmarkClientStub Client;
+    typedef cStaticBenchmarkServer Server;
+};
+
+template <typename Stubs>
+void BM_CallGetInteger(benchmark::State& oState)
+{
+    typename Stubs::Server oServer;
+    cLoopbackConnector oConnector(oServer);
+    typename Stubs::Client oClient(oConnector);
+    int nValue = 0;
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oClient.GetInteger(++nValue));
+    }
+}
+
+template <typename Stubs>
+void BM_CallConcat(benchmark::State& oState)
+{
+    typename Stubs::Server oServer;
+    cLoopbackConnector oConnector(oServer);
+    typename Stubs::Client oClient(oConnector);
+    const std::string strValue(static_cast<size_t>(oState.range(0)), 'x');
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oClient.Concat(strValue, strValue));
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) * oState.range(0) * 4);
+}
+
+/**
+ * Dispatch alone: arg 0 looks the method up by its name as AbstractServer does, arg 1
+ * switches on its id.
+ */
+template <typename Stubs>
+void BM_DispatchGetInteger(benchmark::State& oState)
+{
+    typename Stubs::Server oServer;
+    jsonrpc::Procedure oProcedure("GetInteger", jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_INTEGER,
+                                  "nValue", jsonrpc::JSON_INTEGER, NULL);
+    Json::Value oParams;
+    oParams["nValue"] = 1;
+    Json::Value oResult;
+    const bool bById = oState.range(0) != 0;
+    for (auto _ : oState)
+    {
+        oServer.Dispatch(oProcedure, oParams, oResult, bById);
+        benchmark::DoNotOptimize(oResult);
+    }
+}
+
+/**
+ * Whole requests with arg 0 naming the method and arg 1 carrying its id.
+ */
+template <typename Stubs>
+void BM_HandleGetInteger(benchmark::State& oState)
+{
+    typename Stubs::Server oServer;
+    cLoopbackConnector oConnector(oServer);
+    const std::string strRequest =
+        oState.range(0) == 0
+            ? "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"GetInteger\",\"params\":{\"nValue\":1}}\n"
+            : "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":1381751287,\"params\":{\"nValue\":1}}\n";
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        oConnector.SendRPCMessage(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse);
+    }
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_DispatchGetInteger, tDom)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_DispatchGetInteger, tStatic)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_HandleGetInteger, tDom)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_HandleGetInteger, tStatic)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_HandleGetInteger, tDirect)->Arg(0)->Arg(1);
+BENCHMARK_TEMPLATE(BM_CallGetInteger, tDom);
+BENCHMARK_TEMPLATE(BM_CallGetInteger, tDirect);
+BENCHMARK_TEMPLATE(BM_CallConcat, tDom)->Arg(16)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_CallConcat, tDirect)->Arg(16)->Arg(4096);
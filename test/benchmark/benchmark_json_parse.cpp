@@ -0,0 +1,99 @@
+/**
+ * @file
+ * JSON parse throughput benchmarks: classic Json::Reader vs. Json::FastReader.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include "benchmark_payloads.h"
+
+namespace
+{
+enum ePayload
+{
+    eGetInteger,
+    eSignalList,
+    eGraph,
+    eFloatArray
+};
+
+std::string MakePayload(int64_t nPayload, int64_t nSize)
+{
+    using namespace rpc::benchmark_payloads;
+    Json::Value oPayload;
+    switch (nPayload)
+    {
+    case eSignalList:
+        oPayload = MakeSignalListResponse(static_cast<size_t>(nSize));
+        break;
+    case eGraph:
+        oPayload = MakeGraphRequest(static_cast<size_t>(nSize));
+        break;
+    case eFloatArray:
+        oPayload = MakeFloatArrayResponse(static_cast<size_t>(nSize));
+        break;
+    default:
+        oPayload = MakeGetIntegerRequest();
+        break;
+    }
+    Json::FastWriter oWriter;
+    return oWriter.write(oPayload);
+}
+
+void ParseWith(benchmark::State& oState, jsonrpc::jsonreader_t eReader)
+{
+    const std::string strDocument = MakePayload(oState.range(0), oState.range(1));
+    for (auto _ : oState)
+    {
+        Json::Value oRoot;
+        if (!jsonrpc::ParseJson(eReader, strDocument, oRoot))
+        {
+            oState.SkipWithError("parse failed");
+            break;
+        }
+        benchmark::DoNotOptimize(oRoot);
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(strDocument.size()));
+    oState.counters["document_bytes"] = static_cast<double>(strDocument.size());
+}
+
+void BM_JsonParseClassic(benchmark::State& oState)
+{
+    ParseWith(oState, jsonrpc::JSONREADER_CLASSIC);
+}
+
+void BM_JsonParseFast(benchmark::State& oState)
+{
+    ParseWith(oState, jsonrpc::JSONREADER_FAST);
+}
+
+void PayloadArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    pBenchmark->ArgNames({"payload", "size"});
+    pBenchmark->Args({eGetInteger, 1});
+    pBenchmark->Args({eSignalList, 100});
+    pBenchmark->Args({eSignalList, 10000});
+    pBenchmark->Args({eGraph, 100});
+    pBenchmark->Args({eGraph, 10000});
+    pBenchmark->Args({eFloatArray, 10000});
+}
+
+} // namespace
+
+BENCHMARK(BM_JsonParseClassic)->Apply(PayloadArguments);
+BENCHMARK(BM_JsonParseFast)->Apply(PayloadArguments);
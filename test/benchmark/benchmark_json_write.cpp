@@ -0,0 +1,154 @@
+/**
+ * @file
+ * JSON serialization benchmarks for Json::FastWriter and Json::StreamWriter.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include "benchmark_payloads.h"
+#include <memory>
+#include <sstream>
+#include <streambuf>
+
+namespace
+{
+enum ePayload
+{
+    eFloatArray,
+    eSignalList,
+    eIntegerArray
+};
+
+Json::Value MakePayload(int64_t nPayload, int64_t nSize)
+{
+    using namespace rpc::benchmark_payloads;
+    switch (nPayload)
+    {
+    case eSignalList:
+        return MakeSignalListResponse(static_cast<size_t>(nSize));
+    case eIntegerArray:
+    {
+        Json::Value oValues(Json::arrayValue);
+        for (int64_t nValue = 0; nValue < nSize; ++nValue)
+        {
+            oValues.append(Json::Value::Int64(nValue * 7919 - 1000000));
+        }
+        return MakeResponse(oValues);
+    }
+    default:
+        return MakeFloatArrayResponse(static_cast<size_t>(nSize));
+    }
+}
+
+void BM_JsonWriteFast(benchmark::State& oState)
+{
+    const Json::Value oPayload = MakePayload(oState.range(0), oState.range(1));
+    Json::FastWriter oWriter;
+    size_t nBytes = 0;
+    for (auto _ : oState)
+    {
+        const std::string strDocument = oWriter.write(oPayload);
+        nBytes = strDocument.size();
+        benchmark::DoNotOptimize(strDocument.data());
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(nBytes));
+}
+
+void BM_JsonWriteStream(benchmark::State& oState)
+{
+    const Json::Value oPayload = MakePayload(oState.range(0), oState.range(1));
+    Json::StreamWriterBuilder oBuilder;
+    oBuilder["indentation"] = "";
+    const std::unique_ptr<Json::StreamWriter> pWriter(oBuilder.newStreamWriter());
+    size_t nBytes = 0;
+    for (auto _ : oState)
+    {
+        std::ostringstream oStream;
+        pWriter->write(oPayload, &oStream);
+        nBytes = static_cast<size_t>(oStream.tellp());
+        benchmark::DoNotOptimize(nBytes);
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(nBytes));
+}
+
+/**
+ * Stream that counts and discards the written data, standing in for the socket.
+ */
+class cDiscardBuffer : public std::streambuf
+{
+public:
+    size_t m_nBytes = 0;
+
+protected:
+    std::streamsize xsputn(const char*, std::streamsize nCount) override
+    {
+        m_nBytes += static_cast<size_t>(nCount);
+        return nCount;
+    }
+
+    int_type overflow(int_type nChar) override
+    {
+        ++m_nBytes;
+        return traits_type::not_eof(nChar);
+    }
+};
+
+void BM_JsonWriteFastChunked(benchmark::State& oState)
+{
+    const Json::Value oPayload = MakePayload(oState.range(0), oState.range(1));
+    Json::FastWriter oWriter;
+    size_t nBytes = 0;
+    for (auto _ : oState)
+    {
+        cDiscardBuffer oBuffer;
+        std::ostream oStream(&oBuffer);
+        oWriter.write(oPayload, oStream);
+        nBytes = oBuffer.m_nBytes;
+        benchmark::DoNotOptimize(nBytes);
+    }
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) *
+                             static_cast<int64_t>(nBytes));
+}
+
+void BM_JsonDoubleToString(benchmark::State& oState)
+{
+    const Json::Value oValues = rpc::benchmark_payloads::MakeFloatArrayResponse(1024)["result"];
+    Json::ArrayIndex nIndex = 0;
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(Json::valueToString(oValues[nIndex].asDouble()));
+        nIndex = (nIndex + 1) % 1024;
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+void PayloadArguments(benchmark::internal::Benchmark* pBenchmark)
+{
+    pBenchmark->ArgNames({"payload", "size"});
+    pBenchmark->Args({eFloatArray, 10000});
+    pBenchmark->Args({eSignalList, 1000});
+    pBenchmark->Args({eIntegerArray, 10000});
+}
+
+} // namespace
+
+BENCHMARK(BM_JsonWriteFast)->Apply(PayloadArguments);
+BENCHMARK(BM_JsonWriteStream)->Apply(PayloadArguments);
+BENCHMARK(BM_JsonWriteFastChunked)->Apply(PayloadArguments);
+BENCHMARK(BM_JsonDoubleToString);
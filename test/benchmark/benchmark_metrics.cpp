@@ -0,0 +1,76 @@
+/**
+ * @file
+ * Cost of recording call metrics, see rpc::cRPCMetrics.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg/rpc_metrics.h>
+#include <rpc_pkg/rpc_flight_recorder.h>
+
+namespace
+{
+/**
+ * Records the totals of an object and one of its methods, as the server does per request.
+ */
+void BM_RecordCall(benchmark::State& oState)
+{
+    static rpc::cRPCMetrics oMetrics;
+    const std::string strObject = "/calculator";
+    const std::string strMethod = "Add";
+    uint64_t nLatency = 1000;
+    for (auto _ : oState)
+    {
+        oMetrics.RecordCall(strObject, std::string(), false, 90, 40, nLatency);
+        oMetrics.RecordCall(strObject, strMethod, false, 90, 40, nLatency);
+        nLatency = (nLatency * 7) % 100000;
+    }
+}
+
+void BM_MetricsSnapshot(benchmark::State& oState)
+{
+    rpc::cRPCMetrics oMetrics;
+    for (int64_t nMethod = 0; nMethod < oState.range(0); ++nMethod)
+    {
+        oMetrics.RecordCall("/calculator", std::to_string(nMethod), false, 90, 40, 1000);
+    }
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oMetrics.GetSnapshot());
+    }
+}
+
+/**
+ * Keeps every call, the worst case of a threshold below all latencies.
+ */
+void BM_RecordSlowCall(benchmark::State& oState)
+{
+    static rpc::cFlightRecorder oRecorder(0, 64);
+    const std::string strRequest(300, 'r');
+    const uint64_t aPhases[rpc::ePhaseCount] = {100, 10, 200, 500, 150, 0};
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oRecorder.Record(
+            "/calculator", "Add", strRequest.data(), strRequest.size(), 960, aPhases));
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_RecordCall)->ThreadRange(1, 8);
+BENCHMARK(BM_RecordSlowCall)->ThreadRange(1, 8);
+BENCHMARK(BM_MetricsSnapshot)->Arg(10)->Arg(100);
@@ -0,0 +1,84 @@
+/**
+ * @file
+ * Fan-out of notifications to the subscribers of a topic.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg/rpc_notifications.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+/**
+ * Publishes a notification of range(1) bytes to range(0) subscribers whose queues are full, so
+ * every publish replaces the oldest notification of each queue.
+ */
+void BM_NotificationPublish(benchmark::State& oState)
+{
+    rpc::cNotificationHub oHub(64, rpc::eDropOldest);
+    std::vector<std::unique_ptr<rpc::cNotificationHub::cSubscription>> oSubscriptions;
+    for (int64_t nSubscriber = 0; nSubscriber < oState.range(0); ++nSubscriber)
+    {
+        oSubscriptions.emplace_back(new rpc::cNotificationHub::cSubscription(oHub, "graph"));
+    }
+    std::shared_ptr<rpc::tNotification> pNotification(new rpc::tNotification);
+    pNotification->strKey = "Changed";
+    pNotification->strData.assign(static_cast<size_t>(oState.range(1)), 'x');
+
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oHub.Publish("graph", pNotification));
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations() * oState.range(0)));
+}
+
+/**
+ * The same with @ref rpc::eCoalesce and alternating methods, searching the queue for a match.
+ */
+void BM_NotificationPublishCoalesce(benchmark::State& oState)
+{
+    rpc::cNotificationHub oHub(64, rpc::eCoalesce);
+    std::vector<std::unique_ptr<rpc::cNotificationHub::cSubscription>> oSubscriptions;
+    for (int64_t nSubscriber = 0; nSubscriber < oState.range(0); ++nSubscriber)
+    {
+        oSubscriptions.emplace_back(new rpc::cNotificationHub::cSubscription(oHub, "graph"));
+    }
+    std::vector<rpc::tNotificationPtr> oNotifications;
+    for (int nMethod = 0; nMethod < 8; ++nMethod)
+    {
+        std::shared_ptr<rpc::tNotification> pNotification(new rpc::tNotification);
+        pNotification->strKey = "Changed" + std::to_string(nMethod);
+        pNotification->strData.assign(static_cast<size_t>(oState.range(1)), 'x');
+        oNotifications.push_back(pNotification);
+    }
+
+    size_t nNotification = 0;
+    for (auto _ : oState)
+    {
+        benchmark::DoNotOptimize(oHub.Publish("graph", oNotifications[nNotification]));
+        nNotification = (nNotification + 1) % oNotifications.size();
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations() * oState.range(0)));
+}
+
+} // namespace
+
+BENCHMARK(BM_NotificationPublish)->Args({1, 256})->Args({16, 256})->Args({256, 256})->Args({256, 65536});
+BENCHMARK(BM_NotificationPublishCoalesce)->Args({16, 256});
@@ -0,0 +1,101 @@
+/**
+ * @file
+ * Validation and extraction of named parameters, one lookup per parameter compared to the single
+ * pass of jsonrpc::Procedure::ValidateParameters.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <jsonrpccpp/common/procedure.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+/**
+ * A method with nCount integer parameters and a matching parameter object.
+ */
+struct tParameters
+{
+    jsonrpc::Procedure oProcedure;
+    std::vector<std::string> oNames;
+    Json::Value oParams;
+
+    explicit tParameters(int64_t nCount)
+        : oProcedure("Parameters", jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_INTEGER, NULL)
+    {
+        for (int64_t nParam = 0; nParam < nCount; ++nParam)
+        {
+            char strName[16];
+            std::snprintf(strName, sizeof(strName), "nValue%02d", static_cast<int>(nParam));
+            oNames.push_back(strName);
+            oProcedure.AddParameter(strName, jsonrpc::JSON_INTEGER);
+            oParams[strName] = static_cast<int>(nParam);
+        }
+    }
+};
+
+/**
+ * The former path: isMember and operator[] per parameter to validate, the stub looks every
+ * parameter up by its name once more.
+ */
+void BM_ParametersLookup(benchmark::State& oState)
+{
+    const tParameters oParameters(oState.range(0));
+    const Json::Value& oParams = oParameters.oParams;
+    for (auto _ : oState)
+    {
+        bool bValid = true;
+        for (const std::string& strName: oParameters.oNames)
+        {
+            bValid = bValid && oParams.isMember(strName) && oParams[strName].isIntegral();
+        }
+        int nSum = 0;
+        for (const std::string& strName: oParameters.oNames)
+        {
+            nSum += oParams[strName].asInt();
+        }
+        benchmark::DoNotOptimize(bValid);
+        benchmark::DoNotOptimize(nSum);
+    }
+}
+
+/**
+ * One pass over the parameter object, the stub reads the collected values by position.
+ */
+void BM_ParametersCollect(benchmark::State& oState)
+{
+    const tParameters oParameters(oState.range(0));
+    jsonrpc::ParameterValues oValues;
+    for (auto _ : oState)
+    {
+        const bool bValid = oParameters.oProcedure.ValidateParameters(oParameters.oParams, oValues);
+        int nSum = 0;
+        for (unsigned int nParam = 0; nParam < oValues.size(); ++nParam)
+        {
+            nSum += oValues[nParam].asInt();
+        }
+        benchmark::DoNotOptimize(bValid);
+        benchmark::DoNotOptimize(nSum);
+    }
+}
+
+} // namespace
+
+BENCHMARK(BM_ParametersLookup)->Arg(1)->Arg(8)->Arg(32);
+BENCHMARK(BM_ParametersCollect)->Arg(1)->Arg(8)->Arg(32);
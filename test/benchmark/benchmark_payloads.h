@@ -0,0 +1,138 @@
+/**
+ * @file
+ * Representative RPC payloads shared by the pkg_rpc benchmarks.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_BENCHMARK_PAYLOADS_H_INCLUDED
+#define PKG_RPC_BENCHMARK_PAYLOADS_H_INCLUDED
+
+#include <jsonrpccpp/common/jsonparser.h>
+#include <cstdint>
+#include <string>
+
+namespace rpc
+{
+namespace benchmark_payloads
+{
+/**
+ * Wraps @p oParams into a JSON-RPC 2.0 request object.
+ * @param[in] strMethod Name of the called method.
+ * @param[in] oParams The named parameters.
+ * @return The request.
+ */
+inline Json::Value MakeRequest(const std::string& strMethod, const Json::Value& oParams)
+{
+    Json::Value oRequest;
+    oRequest["jsonrpc"] = "2.0";
+    oRequest["id"] = 1;
+    oRequest["method"] = strMethod;
+    oRequest["params"] = oParams;
+    return oRequest;
+}
+
+/**
+ * Wraps @p oResult into a JSON-RPC 2.0 response object.
+ * @param[in] oResult The result value.
+ * @return The response.
+ */
+inline Json::Value MakeResponse(const Json::Value& oResult)
+{
+    Json::Value oResponse;
+    oResponse["jsonrpc"] = "2.0";
+    oResponse["id"] = 1;
+    oResponse["result"] = oResult;
+    return oResponse;
+}
+
+/**
+ * A signal listing as returned by the participant info RPCs: one object with names,
+ * types, units, a double value, an int64 timestamp and a flag per signal.
+ * @param[in] nSignals Number of signals.
+ * @return The response.
+ */
+inline Json::Value MakeSignalListResponse(size_t nSignals)
+{
+    static const char* const astrUnits[] = {"m/s", "rad", "1/min", "Nm", ""};
+    Json::Value oSignals(Json::arrayValue);
+    for (size_t nSignal = 0; nSignal < nSignals; ++nSignal)
+    {
+        Json::Value& oSignal = oSignals.append(Json::Value(Json::objectValue));
+        oSignal["name"] = "vehicle/chassis/signal_" + std::to_string(nSignal);
+        oSignal["type"] = (nSignal % 3 == 0) ? "tFloat64" : "tInt32";
+        oSignal["unit"] = astrUnits[nSignal % 5];
+        oSignal["value"] = 0.1 * static_cast<double>(nSignal) - 12.75;
+        oSignal["timestamp"] =
+            Json::Value::Int64(1600000000000000LL + static_cast<int64_t>(nSignal) * 10000);
+        oSignal["valid"] = (nSignal % 7) != 0;
+    }
+    return MakeResponse(oSignals);
+}
+
+/**
+ * A LoadGraphFromString request: a single large string parameter containing a
+ * pretty printed graph description, i.e. lots of quotes and newlines to escape.
+ * @param[in] nNodes Number of graph nodes in the description.
+ * @return The request.
+ */
+inline Json::Value MakeGraphRequest(size_t nNodes)
+{
+    std::string strGraph = "<graph name=\"main\">\n";
+    for (size_t nNode = 0; nNode < nNodes; ++nNode)
+    {
+        const std::string strNode = std::to_string(nNode);
+        strGraph += "\t<node id=\"" + strNode + "\" type=\"filter\" name=\"Filter " + strNode +
+                    "\">\n\t\t<pin name=\"in\"/>\n\t\t<pin name=\"out\"/>\n\t</node>\n";
+    }
+    strGraph += "</graph>\n";
+    Json::Value oParams;
+    oParams["strGraph"] = strGraph;
+    return MakeRequest("LoadGraphFromString", oParams);
+}
+
+/**
+ * A telemetry style response: a flat array of doubles.
+ * @param[in] nValues Number of array elements.
+ * @return The response.
+ */
+inline Json::Value MakeFloatArrayResponse(size_t nValues)
+{
+    Json::Value oValues(Json::arrayValue);
+    double fValue = 0.0;
+    for (size_t nValue = 0; nValue < nValues; ++nValue)
+    {
+        fValue += 0.37 + static_cast<double>(nValue % 11) / 7.0;
+        oValues.append(fValue);
+    }
+    return MakeResponse(oValues);
+}
+
+/**
+ * The smallest typical call: GetInteger with a single integer parameter.
+ * @return The request.
+ */
+inline Json::Value MakeGetIntegerRequest()
+{
+    Json::Value oParams;
+    oParams["nValue"] = 1234;
+    return MakeRequest("GetInteger", oParams);
+}
+
+} // namespace benchmark_payloads
+} // namespace rpc
+
+#endif // PKG_RPC_BENCHMARK_PAYLOADS_H_INCLUDED
@@ -0,0 +1,235 @@
+/**
+ * @file
+ * Lookups of RPC objects by name, the shared lock of the registry contended by all threads.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg/rpc_object_registry.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class cNullObject : public rpc::IRPCObject
+{
+public:
+    rpc::Result HandleCall(const char*, size_t, rpc::IResponse&)
+    {
+        return rpc::Result();
+    }
+};
+
+/**
+ * A registry with nObjects objects named like the URL paths the HTTP server looks up.
+ */
+struct tRegistry
+{
+    rpc::cRPCObjectsRegistry oRegistry;
+    cNullObject oObject;
+    std::vector<std::string> oNames;
+
+    explicit tRegistry(int nObjects)
+    {
+        for (int nObject = 0; nObject < nObjects; ++nObject)
+        {
+            oNames.push_back("/object_" + std::to_string(nObject));
+            oRegistry.RegisterRPCObject(oNames.back().c_str(), &oObject);
+        }
+    }
+};
+
+/**
+ * nObjects objects named like the properties of filters in a graph, sharing long prefixes.
+ */
+struct tFilterRegistry
+{
+    rpc::cRPCObjectsRegistry oRegistry;
+    std::map<std::string, cNullObject*> oMap;
+    cNullObject oObject;
+    std::vector<std::string> oNames;
+
+    explicit tFilterRegistry(int nObjects)
+    {
+        for (int nObject = 0; nObject < nObjects; ++nObject)
+        {
+            oNames.push_back("/graph/streaming/filter_" + std::to_string(nObject) + "/properties");
+            oRegistry.RegisterRPCObject(oNames.back().c_str(), &oObject);
+            oMap[oNames.back()] = &oObject;
+        }
+        // the order the paths are looked up in, so the benchmark does not walk the tree in order
+        for (size_t nName = 0; nName < oNames.size(); ++nName)
+        {
+            std::swap(oNames[nName], oNames[(nName * 7919) % oNames.size()]);
+        }
+    }
+};
+
+const tFilterRegistry& GetFilterRegistry()
+{
+    static const tFilterRegistry oRegistry(10000);
+    return oRegistry;
+}
+
+/**
+ * The lookup of the flat std::map the registry used before, as reference.
+ */
+void BM_FilterLookupMap(benchmark::State& oState)
+{
+    const tFilterRegistry& oRegistry = GetFilterRegistry();
+    size_t nName = 0;
+    for (auto _ : oState)
+    {
+        const std::map<std::string, cNullObject*>::const_iterator itObject =
+            oRegistry.oMap.find(oRegistry.oNames[nName].c_str());
+        benchmark::DoNotOptimize(itObject->second);
+        nName = (nName + 1) % oRegistry.oNames.size();
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+/**
+ * A lookup in the registry with its radix tree, including locking the object.
+ */
+void BM_FilterLookupRegistry(benchmark::State& oState)
+{
+    const tFilterRegistry& oRegistry = GetFilterRegistry();
+    size_t nName = 0;
+    for (auto _ : oState)
+    {
+        rpc::tRouteMatch oMatch;
+        rpc::cRPCObjectsRegistry::cLockedRPCObject oObject =
+            oRegistry.oRegistry.GetRPCObject(oRegistry.oNames[nName].c_str(), oMatch);
+        benchmark::DoNotOptimize(static_cast<bool>(oObject));
+        nName = (nName + 1) % oRegistry.oNames.size();
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+/**
+ * The same paths served by a single route with a parameter.
+ */
+void BM_FilterLookupParameter(benchmark::State& oState)
+{
+    const tFilterRegistry& oRegistry = GetFilterRegistry();
+    int nTarget = 0;
+    rpc::cRouter oRouter;
+    oRouter.Insert("/graph/streaming/:filter/properties", &nTarget);
+    size_t nName = 0;
+    for (auto _ : oState)
+    {
+        rpc::tRouteMatch oMatch;
+        benchmark::DoNotOptimize(oRouter.Find(oRegistry.oNames[nName].c_str(), oMatch));
+        nName = (nName + 1) % oRegistry.oNames.size();
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+/**
+ * Registers and unregisters the objects of a graph with range(0) filters, one by one or with a
+ * single call each, while range(1) threads look up another object. Reports the lookups these
+ * threads manage meanwhile.
+ */
+template <bool bBulk>
+void BM_GraphLoad(benchmark::State& oState)
+{
+    const size_t nObjects = static_cast<size_t>(oState.range(0));
+    rpc::cRPCObjectsRegistry oRegistry;
+    cNullObject oObject;
+    rpc::cRPCObjectsRegistry::tRPCObjectList oObjects;
+    std::vector<std::string> oNames;
+    for (size_t nObject = 0; nObject < nObjects; ++nObject)
+    {
+        oNames.push_back("/graph/streaming/filter_" + std::to_string(nObject) + "/properties");
+        oObjects.push_back(std::make_pair(oNames.back(), &oObject));
+    }
+
+    oRegistry.RegisterRPCObject("/graph", &oObject);
+    std::atomic<bool> bStop(false);
+    std::atomic<uint64_t> nLookups(0);
+    std::vector<std::thread> oReaders;
+    for (int64_t nReader = 0; nReader < oState.range(1); ++nReader)
+    {
+        oReaders.push_back(std::thread([&]() {
+            uint64_t nOwnLookups = 0;
+            while (!bStop)
+            {
+                benchmark::DoNotOptimize(static_cast<bool>(oRegistry.GetRPCObject("/graph")));
+                ++nOwnLookups;
+            }
+            nLookups += nOwnLookups;
+        }));
+    }
+
+    for (auto _ : oState)
+    {
+        if (bBulk)
+        {
+            oRegistry.RegisterRPCObjects(oObjects);
+            oRegistry.UnregisterRPCObjects(oNames);
+        }
+        else
+        {
+            for (const std::string& strName: oNames)
+            {
+                oRegistry.RegisterRPCObject(strName.c_str(), &oObject);
+            }
+            for (const std::string& strName: oNames)
+            {
+                oRegistry.UnregisterRPCObject(strName.c_str());
+            }
+        }
+    }
+
+    bStop = true;
+    for (std::thread& oReader: oReaders)
+    {
+        oReader.join();
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations() * nObjects));
+    oState.counters["lookups"] = benchmark::Counter(static_cast<double>(nLookups.load()),
+                                                    benchmark::Counter::kIsRate);
+}
+
+template <int nObjects>
+void BM_RegistryLookup(benchmark::State& oState)
+{
+    static const tRegistry oRegistry(nObjects);
+    size_t nName = 0;
+    for (auto _ : oState)
+    {
+        rpc::cRPCObjectsRegistry::cLockedRPCObject oObject =
+            oRegistry.oRegistry.GetRPCObject(oRegistry.oNames[nName].c_str());
+        benchmark::DoNotOptimize(static_cast<bool>(oObject));
+        nName = (nName + 1) % oRegistry.oNames.size();
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_RegistryLookup, 10)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RegistryLookup, 1000)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_FilterLookupMap);
+BENCHMARK(BM_FilterLookupRegistry)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_FilterLookupParameter);
+BENCHMARK_TEMPLATE(BM_GraphLoad, false)->Args({1000, 0})->Args({1000, 4})->UseRealTime();
+BENCHMARK_TEMPLATE(BM_GraphLoad, true)->Args({1000, 0})->Args({1000, 4})->UseRealTime();
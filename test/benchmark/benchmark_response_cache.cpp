@@ -0,0 +1,87 @@
+/**
+ * @file
+ * Per-call CPU time of getters answered from the response cache compared to calling the method
+ * and serializing its result every time.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <jsonrpccpp/server/rpcprotocolserverv2.h>
+#include "benchmark_payloads.h"
+
+namespace
+{
+/**
+ * A getter of a signal listing, the method copies the listing like one building it from a
+ * member would.
+ */
+class cSignalListHandler : public jsonrpc::IProcedureInvokationHandler
+{
+public:
+    cSignalListHandler(size_t nSignals)
+        : m_oSignals(rpc::benchmark_payloads::MakeSignalListResponse(nSignals)["result"])
+    {
+    }
+
+    void HandleMethodCall(jsonrpc::Procedure&, const Json::Value&, Json::Value& oOutput)
+    {
+        oOutput = m_oSignals;
+    }
+
+    void HandleNotificationCall(jsonrpc::Procedure&, const Json::Value&)
+    {
+    }
+
+private:
+    Json::Value m_oSignals;
+};
+
+/**
+ * Whole requests with arg 0 the number of signals and arg 1 whether the getter is cached.
+ */
+void BM_HandleCachedGetter(benchmark::State& oState)
+{
+    cSignalListHandler oHandler(static_cast<size_t>(oState.range(0)));
+    jsonrpc::RpcProtocolServerV2 oProtocol(oHandler);
+    jsonrpc::Procedure oProcedure("GetSignals", jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_ARRAY, NULL);
+    if (oState.range(1) != 0)
+    {
+        oProcedure.Cached(jsonrpc::Procedure::CACHE_UNTIL_INVALIDATED);
+    }
+    oProtocol.AddProcedure(oProcedure);
+
+    const std::string strRequest = "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"GetSignals\"}\n";
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        strResponse.clear();
+        oProtocol.HandleRequest(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse.data());
+    }
+    oState.counters["response_bytes"] = static_cast<double>(strResponse.size());
+}
+
+} // namespace
+
+BENCHMARK(BM_HandleCachedGetter)
+    ->ArgNames({"signals", "cached"})
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({100, 0})
+    ->Args({100, 1})
+    ->Args({1000, 0})
+    ->Args({1000, 1});
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * The implementation of the test interface shared by the pkg_rpc benchmarks.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#ifndef PKG_RPC_BENCHMARK_SERVER_H_INCLUDED
+#define PKG_RPC_BENCHMARK_SERVER_H_INCLUDED
+
+#include <rpc_pkg.h>
+#include <string>
+
+namespace rpc
+{
+namespace benchmark_server
+{
+/**
+ * Implements the methods of test.json for any of its generated server stubs.
+ */
+template <typename ServerStub>
+class cBenchmarkServer : public rpc::jsonrpc_object_server<ServerStub>
+{
+public:
+    virtual int GetInteger(int nValue)
+    {
+        return nValue;
+    }
+
+    virtual std::string Concat(const std::string& strString1, const std::string& strString2)
+    {
+        return strString1 + strString2;
+    }
+
+    virtual std::string GetIntegerAsString(const std::string& nValue)
+    {
+        return nValue;
+    }
+
+    virtual Json::Value GetResult()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    virtual Json::Value RegisterObject()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    virtual Json::Value UnregisterObject()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    virtual Json::Value UnregisterSelf()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    void Dispatch(jsonrpc::Procedure& oProcedure, const Json::Value& oParams, Json::Value& oResult, bool bById)
+    {
+        jsonrpc::ParameterValues oValues;
+        if (!bById || !oProcedure.ValidateParameters(oParams, oValues) ||
+            !ServerStub::HandleMethodCallById(oProcedure.GetMethodId(), oValues, oResult))
+        {
+            ServerStub::HandleMethodCall(oProcedure, oParams, oResult);
+        }
+    }
+};
+
+} // namespace benchmark_server
+} // namespace rpc
+
+#endif // PKG_RPC_BENCHMARK_SERVER_H_INCLUDED
@@ -0,0 +1,236 @@
+/**
+ * @file
+ * Round trips over TCP loopback to rpc::http::cJSONRPCServer, with a new connection per call as
+ * rpc::http::cJSONClientConnector makes them and with one kept alive.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg.h>
+#include <httplib.h>
+#include <benchmarkdirectserverstub.h>
+#include "benchmark_payloads.h"
+#include "benchmark_server.h"
+
+namespace
+{
+const char* const strServerUrl = "http://127.0.0.1:1235";
+const char* const strObjectUrl = "http://127.0.0.1:1235/benchmark";
+const char* const strWebSocketUrl = "ws://127.0.0.1:1235/benchmark";
+
+/**
+ * The server all transport benchmarks talk to, started on first use.
+ */
+class cTransportServer
+{
+public:
+    static void Start()
+    {
+        static cTransportServer oServer;
+    }
+
+private:
+    cTransportServer()
+    {
+        m_oServer.RegisterRPCObject("benchmark", &m_oObject);
+        // only clients that accept it get compressed responses
+        m_oServer.EnableCompression();
+        m_oServer.StartListening(strServerUrl);
+    }
+
+    ~cTransportServer()
+    {
+        m_oServer.StopListening();
+        m_oServer.UnregisterRPCObject("benchmark");
+    }
+
+    rpc::http::cJSONRPCServer m_oServer;
+    rpc::benchmark_server::cBenchmarkServer<rpc_stubs::cBenchmarkDirectServerStub> m_oObject;
+};
+
+std::string MakeRequest(int64_t nSize)
+{
+    return "{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"Concat\",\"params\":{\"strString1\":\"" +
+           std::string(static_cast<size_t>(nSize), 'x') + "\",\"strString2\":\"\"}}";
+}
+
+/**
+ * A connection and request per call, every thread with a connector of its own.
+ */
+void BM_RoundTripClose(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    rpc::http::cJSONClientConnector oConnector(strObjectUrl);
+    const std::string strRequest = MakeRequest(oState.range(0));
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        oConnector.SendRPCMessage(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse);
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) * oState.range(0) * 2);
+}
+
+/**
+ * All calls of a thread on one connection, the server reads requests until the client closes it.
+ */
+void BM_RoundTripKeepAlive(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    httplib::Request oRequest;
+    oRequest.method = "POST";
+    oRequest.url = "/benchmark";
+    oRequest.set_header("Host", "127.0.0.1");
+    oRequest.set_header("Content-Type", "application/json");
+    oRequest.body = MakeRequest(oState.range(0));
+
+    const socket_t nSocket = httplib::detail::create_client_socket("127.0.0.1", 1235);
+    if (nSocket == -1)
+    {
+        oState.SkipWithError("could not connect");
+        return;
+    }
+    for (auto _ : oState)
+    {
+        httplib::Response oResponse;
+        httplib::detail::write_request(nSocket, oRequest);
+        if (!httplib::detail::read_response_line(nSocket, oResponse) ||
+            !httplib::detail::read_headers(nSocket, oResponse.headers) ||
+            !httplib::detail::read_content(nSocket, oResponse))
+        {
+            oState.SkipWithError("connection lost");
+            break;
+        }
+        benchmark::DoNotOptimize(oResponse.body);
+    }
+    httplib::detail::close_socket(nSocket);
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) * oState.range(0) * 2);
+}
+
+/**
+ * All calls of a thread as messages on one WebSocket connection, without any HTTP per call.
+ */
+void BM_RoundTripWebSocket(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    rpc::http::cJSONWebSocketConnector oConnector(strWebSocketUrl);
+    const std::string strRequest = MakeRequest(oState.range(0));
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        oConnector.SendRPCMessage(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse);
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+    oState.SetBytesProcessed(static_cast<int64_t>(oState.iterations()) * oState.range(0) * 2);
+}
+
+/**
+ * Echoes a signal listing of range(0) signals, compressed both ways if range(1) is set.
+ */
+void BM_RoundTripCompression(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    rpc::http::cJSONClientConnector oConnector(strObjectUrl);
+    if (oState.range(1))
+    {
+        oConnector.EnableCompression();
+    }
+    Json::Value oRequest;
+    oRequest["id"] = 1;
+    oRequest["jsonrpc"] = "2.0";
+    oRequest["method"] = "Concat";
+    oRequest["params"]["strString1"] = Json::FastWriter().write(
+        rpc::benchmark_payloads::MakeSignalListResponse(static_cast<size_t>(oState.range(0))));
+    oRequest["params"]["strString2"] = "";
+    const std::string strRequest = Json::FastWriter().write(oRequest);
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        oConnector.SendRPCMessage(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse);
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+    oState.counters["body_bytes"] = static_cast<double>(strRequest.size());
+}
+
+/**
+ * The CPU time a client spends per call, formatting the request head with every call the way
+ * httplib::Client::post does.
+ */
+void BM_ClientCpuPost(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    httplib::Client oClient("127.0.0.1", 1235);
+    const std::string strRequest = MakeRequest(oState.range(0));
+    for (auto _ : oState)
+    {
+        const a_util::memory::unique_ptr<httplib::Response> pResponse(
+            oClient.post("/benchmark", strRequest, "application/json"));
+        benchmark::DoNotOptimize(pResponse->body);
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+/**
+ * The CPU time a client spends per call with the request head the connector prepared.
+ */
+void BM_ClientCpuConnector(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    rpc::http::cJSONClientConnector oConnector(strObjectUrl);
+    const std::string strRequest = MakeRequest(oState.range(0));
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        oConnector.SendRPCMessage(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse);
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+/**
+ * The CPU time a client spends per call on a WebSocket connection, the reader thread not counted.
+ */
+void BM_ClientCpuWebSocket(benchmark::State& oState)
+{
+    cTransportServer::Start();
+    rpc::http::cJSONWebSocketConnector oConnector(strWebSocketUrl);
+    const std::string strRequest = MakeRequest(oState.range(0));
+    std::string strResponse;
+    for (auto _ : oState)
+    {
+        oConnector.SendRPCMessage(strRequest, strResponse);
+        benchmark::DoNotOptimize(strResponse);
+    }
+    oState.SetItemsProcessed(static_cast<int64_t>(oState.iterations()));
+}
+
+} // namespace
+
+BENCHMARK(BM_ClientCpuPost)->Arg(16)->Arg(64 * 1024);
+BENCHMARK(BM_ClientCpuConnector)->Arg(16)->Arg(64 * 1024);
+BENCHMARK(BM_ClientCpuWebSocket)->Arg(16)->Arg(64 * 1024);
+BENCHMARK(BM_RoundTripClose)->Arg(16)->Arg(64 * 1024)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_RoundTripKeepAlive)->Arg(16)->Arg(64 * 1024)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_RoundTripWebSocket)->Arg(16)->Arg(64 * 1024)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_RoundTripCompression)
+    ->ArgNames({"signals", "compressed"})
+    ->ArgsProduct({{100, 1000, 10000}, {0, 1}})
+    ->UseRealTime();
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * Parsing of the URLs the client connector and the server are created with.
+ *
+ * @copyright
+ * @verbatim
+   Copyright @ 2020 AUDI AG. All rights reserved.
+
+       This Source Code Form is subject to the terms of the Mozilla
+       Public License, v. 2.0. If a copy of the MPL was not distributed
+       with this file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+   If it is not possible or desirable to put the notice in a particular file, then
+   You may include the notice in a location (such as a LICENSE file in a
+   relevant directory) where a recipient would be likely to look for such a notice.
+
+   You may add additional accurate notices of copyright ownership.
+   @endverbatim
+ */
+
+
+#include <benchmark/benchmark.h>
+#include <rpc_pkg/impl/url.h>
+#include <string>
+
+namespace
+{
+void BM_UrlParse(benchmark::State& oState, const char* strUrl)
+{
+    const std::string strInput = strUrl;
+    for (auto _ : oState)
+    {
+        const rpc::cUrl oUrl(strInput);
+        benchmark::DoNotOptimize(oUrl.IsValid());
+    }
+}
+
+/**
+ * Everything the client connector takes from its URL.
+ */
+void BM_UrlComponents(benchmark::State& oState, const char* strUrl)
+{
+    const std::string strInput = strUrl;
+    for (auto _ : oState)
+    {
+        const rpc::cUrl oUrl(strInput);
+        const rpc::cUrl::cAuthority oAuthority = oUrl.GetAuthority();
+        benchmark::DoNotOptimize(oAuthority.GetHost());
+        benchmark::DoNotOptimize(oAuthority.GetPort());
+        benchmark::DoNotOptimize(oUrl.GetPath());
+    }
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_UrlParse, server, "http://0.0.0.0:1234");
+BENCHMARK_CAPTURE(BM_UrlParse, object, "http://localhost:1234/calculator");
+BENCHMARK_CAPTURE(BM_UrlParse, query, "ssh+tcp://user:pw@1.2.3.4:22/a/b?keepalive=true&x#top");
+BENCHMARK_CAPTURE(BM_UrlParse, legacy, "tcp://127.0.0.1:5001{timeout=1000,max_pkg_size=65000}");
+BENCHMARK_CAPTURE(BM_UrlComponents, object, "http://localhost:1234/calculator");
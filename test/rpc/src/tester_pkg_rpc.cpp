@@ -22,6 +22,37 @@
 #include <rpc_pkg.h>
 #include <testclientstub.h>
 #include <testserverstub.h>
+#include <testdirectclientstub.h>
+#include <testdirectserverstub.h>
+#include <teststaticserverstub.h>
+#include <teststructclientstub.h>
+#include <teststructserverstub.h>
+#include <teststructdirectclientstub.h>
+#include <teststructdirectserverstub.h>
+#include <testtypesclientstub.h>
+#include <testtypesserverstub.h>
+#include <testtypesdirectclientstub.h>
+#include <testtypesdirectserverstub.h>
+#include <testcacheclientstub.h>
+#include <testcacheserverstub.h>
+#include <jsonrpccpp/client/rpcprotocolclient.h>
+#include <rpc_pkg/impl/compression.h>
+#include <rpc_pkg/impl/url.h>
+#include <rpc_pkg/impl/websocket.h>
+#include <rpc_pkg/impl/websocket_calls.h>
+#include <load_generator.h>
+#include <a_util/regex.h>
+#include <httplib.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <type_traits>
 
 typedef rpc::
     jsonrpc_remote_object<rpc_stubs::cTestClientStub, rpc::http::cJSONClientConnector, std::string>
@@ -134,3 +165,2552 @@ TEST(cTesterPkgRpc, TestObjectNameWithSpaces)
     cTestClient oClient("http://127.0.0.1:1234/" TEST_OBJ_STRING);
     ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
 }
+
+class cFastReaderTestServer : public cTestServer
+{
+public:
+    cFastReaderTestServer(rpc::http::cJSONRPCServer& oServer) : cTestServer(oServer)
+    {
+        SetJsonReader(jsonrpc::JSONREADER_FAST);
+    }
+};
+
+/**
+ * The fast reader has to produce the same values as the classic one.
+ */
+TEST(cTesterPkgRpc, TestFastJsonReader)
+{
+    const char* astrDocuments[] = {
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1234}}",
+        "  [ 0, -0, 1, -1, 2147483647, 2147483648, -2147483649, 9223372036854775807,"
+        " -9223372036854775808, 18446744073709551615, 18446744073709551616,"
+        " 0.5, -1.25e-3, 1E22, 1e23, 123456789012345678901234567890, 3.141592653589793238 ]\n",
+        "{\"escaped\":\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\\u00e4\\u20AC\\ud83d\\ude00 tail of a long "
+        "plain string that spans more than one vector register\",\"nested\":[[[{}]],[]],"
+        "\"literals\":[true,false,null]}",
+        "\t\n\r {  \"a\"  :  [ 1 ,  2 ]  ,\n\n\n                                   \"b\" : {} }"};
+    for (const char* strDocument: astrDocuments)
+    {
+        Json::Value oClassic;
+        Json::Value oFast;
+        ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, strDocument, oClassic));
+        Json::FastReader oReader;
+        ASSERT_TRUE(oReader.parse(strDocument, oFast)) << oReader.getFormattedErrorMessages();
+        ASSERT_EQ(oClassic, oFast) << strDocument;
+        ASSERT_EQ(Json::FastWriter().write(oClassic), Json::FastWriter().write(oFast));
+    }
+
+    const char* astrInvalid[] = {"", "{", "[1,]", "{\"a\" 1}", "01", "1.", "-", "\"unterminated",
+                                 "\"tab\tinside\"", "\"\\x\"", "\"\\ud800\"", "tru", "[1] 2",
+                                 "// comment\n{}"};
+    for (const char* strDocument: astrInvalid)
+    {
+        Json::Value oFast;
+        Json::FastReader oReader;
+        ASSERT_FALSE(oReader.parse(strDocument, oFast)) << strDocument;
+        ASSERT_FALSE(oReader.getFormattedErrorMessages().empty());
+    }
+
+    rpc::http::cJSONRPCServer rpc_server;
+    cFastReaderTestServer oTestServer(rpc_server);
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oTestServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    cTestClient oClient("http://127.0.0.1:1234/test");
+    oClient.SetJsonReader(jsonrpc::JSONREADER_FAST);
+    ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+    ASSERT_TRUE(oClient.Concat("f\"oo\n", "b\\ar") == "f\"oo\nb\\ar");
+}
+
+/**
+ * Doubles are written with the shortest representation that reads back to the same value.
+ */
+TEST(cTesterPkgRpc, TestShortestDoubleFormatting)
+{
+    ASSERT_EQ(Json::valueToString(0.1), "0.1");
+    ASSERT_EQ(Json::valueToString(-1.5), "-1.5");
+    ASSERT_EQ(Json::valueToString(100.0), "100.0");
+    ASSERT_EQ(Json::valueToString(-0.0), "-0.0");
+    ASSERT_EQ(Json::valueToString(1e16), "10000000000000000.0");
+    ASSERT_EQ(Json::valueToString(1e17), "1e+17");
+    ASSERT_EQ(Json::valueToString(0.0001), "0.0001");
+    ASSERT_EQ(Json::valueToString(0.00001), "1e-05");
+    ASSERT_EQ(Json::valueToString(5e-324), "5e-324");
+    ASSERT_EQ(Json::valueToString(1.7976931348623157e308), "1.7976931348623157e+308");
+    // values which need all 17 digits are written exactly as snprintf("%.17g") did
+    ASSERT_EQ(Json::valueToString(0.1 + 0.2), "0.30000000000000004");
+    ASSERT_EQ(Json::valueToString(18193588526611460.0), "18193588526611460.0");
+    ASSERT_EQ(Json::valueToString(std::numeric_limits<int64_t>::min()), "-9223372036854775808");
+
+    Json::Value oValues(Json::arrayValue);
+    double fValue = 1.0;
+    for (int nValue = 0; nValue < 2000; ++nValue)
+    {
+        fValue = fValue * -1.37 + 1.0 / (nValue + 3);
+        oValues.append(fValue);
+        oValues.append(fValue * 1e-200);
+    }
+    Json::Value oReadBack;
+    ASSERT_TRUE(Json::FastReader().parse(Json::FastWriter().write(oValues), oReadBack));
+    for (Json::ArrayIndex nIndex = 0; nIndex < oValues.size(); ++nIndex)
+    {
+        ASSERT_EQ(oValues[nIndex].asDouble(), oReadBack[nIndex].asDouble());
+    }
+}
+
+/**
+ * Responses larger than the chunk size are streamed with chunked transfer encoding.
+ */
+TEST(cTesterPkgRpc, TestChunkedResponse)
+{
+    Json::Value oValues(Json::arrayValue);
+    for (int nValue = 0; nValue < 20000; ++nValue)
+    {
+        oValues.append(nValue * 0.25);
+        oValues.append("value " + std::to_string(nValue));
+    }
+    std::ostringstream oStream;
+    Json::FastWriter().write(oValues, oStream, 100);
+    ASSERT_EQ(oStream.str(), Json::FastWriter().write(oValues));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    cTestServer oTestServer(rpc_server);
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oTestServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    cTestClient oClient("http://127.0.0.1:1234/test");
+    const std::string strFirst(300 * 1024, 'a');
+    const std::string strSecond(200 * 1024 + 17, 'b');
+    ASSERT_TRUE(oClient.Concat(strFirst, strSecond) == strFirst + strSecond);
+    ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+}
+
+/**
+ * CBOR and MessagePack map to the same Json::Value model as JSON, keeping the
+ * integer types and raw bytes, and are negotiated via the content type.
+ */
+TEST(cTesterPkgRpc, TestBinaryEncodings)
+{
+    Json::Value oValue;
+    oValue["int"] = -1234;
+    oValue["int64_min"] = std::numeric_limits<Json::Value::Int64>::min();
+    oValue["uint64_max"] = std::numeric_limits<Json::Value::UInt64>::max();
+    oValue["double"] = 0.1;
+    oValue["single"] = 0.5;
+    oValue["whole_double"] = 100.0;
+    oValue["text"] = "\xc3\xa4 text";
+    oValue["bytes"] = std::string("\x00\xff\xfe binary", 10);
+    oValue["list"].append(Json::Value());
+    oValue["list"].append(true);
+    oValue["list"].append(Json::Value(Json::objectValue));
+    for (jsonrpc::encoding_t eEncoding: {jsonrpc::ENCODING_CBOR, jsonrpc::ENCODING_MSGPACK})
+    {
+        std::string strEncoded;
+        jsonrpc::EncodeValue(eEncoding, oValue, strEncoded);
+        Json::Value oDecoded;
+        ASSERT_TRUE(jsonrpc::DecodeValue(eEncoding, strEncoded, oDecoded));
+        ASSERT_EQ(oValue, oDecoded);
+        ASSERT_EQ(Json::intValue, oDecoded["int64_min"].type());
+        ASSERT_EQ(Json::uintValue, oDecoded["uint64_max"].type());
+        ASSERT_EQ(Json::realValue, oDecoded["whole_double"].type());
+        ASSERT_EQ(oValue["bytes"].asString(), oDecoded["bytes"].asString());
+
+        strEncoded.pop_back();
+        ASSERT_FALSE(jsonrpc::DecodeValue(eEncoding, strEncoded, oDecoded));
+    }
+
+    // indefinite length items and half precision floats from other CBOR encoders
+    const char strIndefinite[] = "\xbf\x61" "a\x9f\xf9\x3c\x00\x7f\x61x\x61y\xff\xff\xff";
+    Json::Value oDecoded;
+    ASSERT_TRUE(jsonrpc::DecodeValue(jsonrpc::ENCODING_CBOR,
+                                     std::string(strIndefinite, sizeof(strIndefinite) - 1),
+                                     oDecoded));
+    ASSERT_EQ(1.0, oDecoded["a"][0].asDouble());
+    ASSERT_EQ("xy", oDecoded["a"][1].asString());
+
+    rpc::http::cJSONRPCServer rpc_server;
+    cTestServer oTestServer(rpc_server);
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oTestServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    for (jsonrpc::encoding_t eEncoding: {jsonrpc::ENCODING_CBOR, jsonrpc::ENCODING_MSGPACK})
+    {
+        cTestClient oClient("http://127.0.0.1:1234/test");
+        oClient.SetEncoding(eEncoding);
+        ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+        ASSERT_TRUE(oClient.Concat("foo", std::string("\0bar", 4)) == std::string("foo\0bar", 7));
+        std::string strValue = rpc::cJSONConversions::to_string(std::numeric_limits<int64_t>::max());
+        ASSERT_TRUE(oClient.GetIntegerAsString(strValue) == strValue);
+    }
+
+    cTestClient oJsonClient("http://127.0.0.1:1234/test");
+    ASSERT_TRUE(oJsonClient.GetInteger(1234) == 1234);
+}
+
+typedef rpc::jsonrpc_remote_object<rpc_stubs::cTestDirectClientStub,
+                                   rpc::http::cJSONClientConnector,
+                                   std::string>
+    cTestDirectClient;
+
+template <typename ServerStub>
+class cCodecTestServer : public rpc::jsonrpc_object_server<ServerStub>
+{
+public:
+    virtual int GetInteger(int nValue)
+    {
+        if (nValue < 0)
+        {
+            throw jsonrpc::JsonRpcException(-32099, "negative value", Json::Value(nValue));
+        }
+        return nValue;
+    }
+
+    virtual std::string Concat(const std::string& strString1, const std::string& strString2)
+    {
+        return strString1 + strString2;
+    }
+
+    virtual std::string GetIntegerAsString(const std::string& nValue)
+    {
+        return rpc::cJSONConversions::to_string(rpc::cJSONConversions::stoll(nValue));
+    }
+
+    virtual Json::Value GetResult()
+    {
+        Json::Value oResult;
+        oResult["ErrorCode"] = 0;
+        oResult["Description"] = "\xc3\xa4";
+        oResult["List"].append(0.1);
+        return oResult;
+    }
+
+    virtual Json::Value RegisterObject()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    virtual Json::Value UnregisterObject()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    virtual Json::Value UnregisterSelf()
+    {
+        return Json::Value(Json::objectValue);
+    }
+
+    bool IsDirect(const std::string& strRequest)
+    {
+        jsonrpc::DirectCall oCall(strRequest);
+        std::string strResponse;
+        return oCall.ReadEnvelope() && this->HandleDirectCall(oCall, strResponse);
+    }
+};
+
+class cStringResponse : public rpc::IResponse
+{
+public:
+    void Set(const char* strResponse, size_t nResponseSize)
+    {
+        m_strResponse.assign(strResponse, nResponseSize);
+    }
+
+    std::string m_strResponse;
+};
+
+/**
+ * Stubs generated with --cpp-direct read and write the JSON text without a Json::Value
+ * and fall back to it for everything else, with byte identical requests and responses.
+ */
+TEST(cTesterPkgRpc, TestDirectCodecs)
+{
+    struct tCase
+    {
+        const char* strRequest;
+        bool bDirect;
+    };
+    const tCase asCases[] = {
+        {"{\"id\":1,\"jsonrpc\":\"2.0\",\"method\":\"GetInteger\",\"params\":{\"nValue\":1234}}\n",
+         true},
+        {" { \"params\" : { \"nValue\" : -2147483648 } , \"method\" : \"GetInteger\" ,"
+         " \"jsonrpc\" : \"2.0\", \"id\" : \"a b\" } ",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":null,\"method\":\"GetInteger\",\"params\":{\"nValue\":-5}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":-123456789012345678,\"method\":\"Concat\",\"params\":"
+         "{\"strString2\":\"\\u00e4\\ud83d\\ude00\\n\\\"\",\"strString1\":\"\xc3\xa4/\"}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"GetResult\"}", true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":7,\"method\":\"GetResult\",\"params\":{}}", true},
+        // everything below takes the Json::Value path
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":2147483648}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1.0}}", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":\"1\"}}", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{}}", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1,\"x\":2}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1,\"nValue\":2}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":[1]}", false},
+        {"{\"jsonrpc\":\"2.0\",\"method\":\"GetInteger\",\"params\":{\"nValue\":1}}", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":-0,\"method\":\"GetInteger\",\"params\":{\"nValue\":1}}", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":\"\\u00e4\",\"method\":\"GetInteger\",\"params\":{\"nValue\":1}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Unknown\",\"params\":{}}", false},
+        {"{\"jsonrpc\":\"1.0\",\"id\":1,\"method\":\"GetResult\"}", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetResult\"} // comment", false},
+        {"[{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetResult\"}]", false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Concat\",\"params\":"
+         "{\"strString1\":\"\\ud800\",\"strString2\":\"\"}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Concat\",\"params\":"
+         "{\"strString1\":\"a\tb\",\"strString2\":\"\"}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,", false}};
+
+    cCodecTestServer<rpc_stubs::cTestServerStub> oDomServer;
+    cCodecTestServer<rpc_stubs::cTestDirectServerStub> oDirectServer;
+    for (const tCase& sCase: asCases)
+    {
+        ASSERT_FALSE(oDomServer.IsDirect(sCase.strRequest));
+        ASSERT_EQ(sCase.bDirect, oDirectServer.IsDirect(sCase.strRequest)) << sCase.strRequest;
+        cStringResponse oExpected;
+        cStringResponse oResponse;
+        // out of range values make the Json::Value path throw
+        const bool bExpectedOk =
+            isOk(oDomServer.HandleCall(sCase.strRequest, strlen(sCase.strRequest), oExpected));
+        ASSERT_EQ(bExpectedOk,
+                  isOk(oDirectServer.HandleCall(sCase.strRequest, strlen(sCase.strRequest), oResponse)))
+            << sCase.strRequest;
+        ASSERT_EQ(oExpected.m_strResponse, oResponse.m_strResponse) << sCase.strRequest;
+    }
+
+    for (const char* strNumber: {"0.1", "-0", "-0.0", "6.02214076e23", "12345678901234567890", "-7"})
+    {
+        const std::string strDocument(strNumber);
+        jsonrpc::DirectScanner oScanner(strDocument.data(), strDocument.data() + strDocument.size());
+        double fValue = 1.0;
+        Json::Value oValue;
+        ASSERT_TRUE(oScanner.Read(fValue));
+        ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, strDocument, oValue));
+        ASSERT_EQ(Json::valueToString(oValue.asDouble()), Json::valueToString(fValue));
+    }
+
+    Json::Value oParams;
+    oParams["strString2"] = "\xc3\xa4\"\x01";
+    oParams["strString1"] = "foo";
+    jsonrpc::DirectRequest oRequest("Concat");
+    oRequest.Param("strString1", std::string("foo"));
+    oRequest.Param("strString2", std::string("\xc3\xa4\"\x01"));
+    std::string strExpected;
+    jsonrpc::RpcProtocolClient().BuildRequest("Concat", oParams, strExpected, false);
+    ASSERT_EQ(strExpected, oRequest.Finish());
+    jsonrpc::RpcProtocolClient().BuildRequest("GetResult", Json::nullValue, strExpected, false);
+    ASSERT_EQ(strExpected, jsonrpc::DirectRequest("GetResult").Finish());
+
+    int nResult = 0;
+    ASSERT_TRUE(jsonrpc::DirectResponse("{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":42}\n")
+                    .ReadResult(nResult));
+    ASSERT_EQ(42, nResult);
+    ASSERT_FALSE(jsonrpc::DirectResponse("{\"id\":1,\"jsonrpc\":\"2.0\",\"error\":{\"code\":1}}")
+                     .ReadResult(nResult));
+    ASSERT_FALSE(jsonrpc::DirectResponse("{\"id\":1,\"result\":42}").ReadResult(nResult));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oDirectServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    cTestDirectClient oClient("http://127.0.0.1:1234/test");
+    ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+    ASSERT_TRUE(oClient.Concat("f\"oo\n", "\xc3\xa4") == "f\"oo\n\xc3\xa4");
+    ASSERT_EQ("\xc3\xa4", oClient.GetResult()["Description"].asString());
+    try
+    {
+        oClient.GetInteger(-1);
+        FAIL();
+    }
+    catch (const jsonrpc::JsonRpcException& oException)
+    {
+        ASSERT_EQ(-32099, oException.GetCode());
+        ASSERT_EQ(-1, oException.GetData().asInt());
+    }
+
+    oClient.SetEncoding(jsonrpc::ENCODING_CBOR);
+    ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+    cTestClient oDomClient("http://127.0.0.1:1234/test");
+    ASSERT_TRUE(oDomClient.Concat("foo", "bar") == "foobar");
+}
+
+/**
+ * Generated stubs share one method id per name, requests may carry it instead of the name.
+ */
+TEST(cTesterPkgRpc, TestMethodIds)
+{
+    static_assert(rpc_stubs::cTestClientStub::method_ids::GetInteger ==
+                      rpc_stubs::cTestServerStub::method_ids::GetInteger,
+                  "client and server ids differ");
+    static_assert(rpc_stubs::cTestDirectServerStub::method_ids::Concat ==
+                      rpc_stubs::cTestServerStub::method_ids::Concat,
+                  "ids depend on the generator options");
+    // ids are part of the wire format and must never change
+    ASSERT_EQ(1381751287, jsonrpc::Procedure::CalculateMethodId("GetInteger"));
+    ASSERT_EQ(1046310813, jsonrpc::Procedure::CalculateMethodId("Concat"));
+    ASSERT_EQ(+rpc_stubs::cTestServerStub::method_ids::GetInteger,
+              jsonrpc::Procedure::CalculateMethodId("GetInteger"));
+
+    const char* strByName =
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":5}}";
+    const char* strById = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":1381751287,\"params\":{\"nValue\":5}}";
+    const char* strUnknownId = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":17,\"params\":{\"nValue\":5}}";
+    const char* strNegativeId = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":-1,\"params\":{}}";
+
+    cCodecTestServer<rpc_stubs::cTestServerStub> oDomServer;
+    cCodecTestServer<rpc_stubs::cTestDirectServerStub> oDirectServer;
+    ASSERT_TRUE(oDirectServer.IsDirect(strById));
+    ASSERT_FALSE(oDirectServer.IsDirect(strUnknownId));
+    for (rpc::IRPCObject* pServer:
+         std::initializer_list<rpc::IRPCObject*>{&oDomServer, &oDirectServer})
+    {
+        cStringResponse oByName;
+        cStringResponse oById;
+        ASSERT_TRUE(isOk(pServer->HandleCall(strByName, strlen(strByName), oByName)));
+        ASSERT_TRUE(isOk(pServer->HandleCall(strById, strlen(strById), oById)));
+        ASSERT_EQ(oByName.m_strResponse, oById.m_strResponse);
+
+        for (const char* strRequest: {strUnknownId, strNegativeId})
+        {
+            cStringResponse oError;
+            pServer->HandleCall(strRequest, strlen(strRequest), oError);
+            Json::Value oResponse;
+            ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, oError.m_strResponse, oResponse));
+            ASSERT_EQ(jsonrpc::Errors::ERROR_RPC_METHOD_NOT_FOUND, oResponse["error"]["code"].asInt());
+        }
+    }
+
+    std::string strRequest;
+    jsonrpc::RpcProtocolClient().BuildCompactRequest(
+        rpc_stubs::cTestServerStub::method_ids::GetInteger, "GetInteger", Json::Value(), strRequest, false);
+    ASSERT_EQ(strRequest, jsonrpc::DirectRequest("GetInteger", 1381751287).Finish());
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("dom", &oDomServer)));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("direct", &oDirectServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    cTestClient oClient("http://127.0.0.1:1234/dom");
+    oClient.SetCompactRequests(true);
+    ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+    ASSERT_TRUE(oClient.Concat("foo", "bar") == "foobar");
+
+    cTestDirectClient oDirectClient("http://127.0.0.1:1234/direct");
+    oDirectClient.SetCompactRequests(true);
+    ASSERT_TRUE(oDirectClient.GetInteger(1234) == 1234);
+    try
+    {
+        oDirectClient.GetInteger(-1);
+        FAIL();
+    }
+    catch (const jsonrpc::JsonRpcException& oException)
+    {
+        ASSERT_EQ(-32099, oException.GetCode());
+    }
+}
+
+/**
+ * Stubs generated with --cpp-static-dispatch call the implementation without virtual dispatch.
+ */
+class cStaticTestServer final
+    : public cCodecTestServer<rpc_stubs::cTestStaticServerStub<cStaticTestServer>>
+{
+};
+
+TEST(cTesterPkgRpc, TestStaticDispatch)
+{
+    cCodecTestServer<rpc_stubs::cTestDirectServerStub> oDirectServer;
+    cStaticTestServer oStaticServer;
+    for (const char* strRequest:
+         {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":5}}",
+          "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":1381751287,\"params\":{\"nValue\":-5}}",
+          "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1.0}}",
+          "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"GetResult\"}",
+          "[{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"Concat\",\"params\":"
+          "{\"strString1\":\"a\",\"strString2\":\"b\"}}]"})
+    {
+        cStringResponse oExpected;
+        cStringResponse oResponse;
+        ASSERT_TRUE(isOk(oDirectServer.HandleCall(strRequest, strlen(strRequest), oExpected)));
+        ASSERT_TRUE(isOk(oStaticServer.HandleCall(strRequest, strlen(strRequest), oResponse)));
+        ASSERT_EQ(oExpected.m_strResponse, oResponse.m_strResponse) << strRequest;
+    }
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oStaticServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    cTestClient oClient("http://127.0.0.1:1234/test");
+    ASSERT_TRUE(oClient.GetInteger(1234) == 1234);
+    ASSERT_TRUE(oClient.Concat("foo", "bar") == "foobar");
+}
+
+template <typename ServerStub>
+class cStructTestServer : public rpc::jsonrpc_object_server<ServerStub>
+{
+public:
+    typename ServerStub::GetResult_result GetResult() override
+    {
+        return rpc::cJSONConversions::result_to_struct<typename ServerStub::GetResult_result>(
+            a_util::result::Result(-2, "\xc3\xa4\"", 12, "file.cpp", "GetResult"));
+    }
+
+    bool SetResult(const typename ServerStub::SetResult_oResult& oResult) override
+    {
+        m_strDescription = oResult.Description;
+        return oResult.ErrorCode == 0;
+    }
+
+    typename ServerStub::Move_result Move(int nSteps,
+                                          const typename ServerStub::Move_oPosition& oPosition) override
+    {
+        typename ServerStub::Move_result oResult;
+        oResult.fX = oPosition.fX + nSteps;
+        oResult.fY = oPosition.fY;
+        oResult.oFrame = oPosition.oFrame;
+        oResult.aHistory.append(oPosition.fX);
+        return oResult;
+    }
+
+    typename ServerStub::Scale_result Scale(const typename ServerStub::Scale_param01& oPoint,
+                                            double fFactor) override
+    {
+        typename ServerStub::Scale_result oResult;
+        oResult.fX = oPoint.fX * fFactor;
+        oResult.fY = oPoint.fY * fFactor;
+        return oResult;
+    }
+
+    bool IsDirect(const std::string& strRequest)
+    {
+        jsonrpc::DirectCall oCall(strRequest);
+        std::string strResponse;
+        return oCall.ReadEnvelope() && this->HandleDirectCall(oCall, strResponse);
+    }
+
+    std::string m_strDescription;
+};
+
+/**
+ * Stubs generated with --cpp-structs pass object shaped parameters and results as structs.
+ */
+TEST(cTesterPkgRpc, TestStructs)
+{
+    static_assert(std::is_same<rpc_stubs::cTestStructServerStub::GetResult_result,
+                               rpc_stubs::cTestStructServerStub::SetResult_oResult>::value,
+                  "objects of the same shape share one struct");
+
+    struct tCase
+    {
+        const char* strRequest;
+        bool bDirect;
+    };
+    const tCase asCases[] = {
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetResult\"}", true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"SetResult\",\"params\":{\"oResult\":"
+         "{\"Description\":\"a\",\"ErrorCode\":0,\"File\":\"f\",\"Function\":\"g\",\"Line\":3}}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"SetResult\",\"params\":{\"oResult\":"
+         "{ \"Line\" : 3, \"Function\":\"g\",\"File\":\"f\",\"ErrorCode\":-1,\"Description\":\"\\u00e4\"}}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Move\",\"params\":{\"nSteps\":2,\"oPosition\":"
+         "{\"fX\":0.5,\"fY\":-1,\"oFrame\":{\"nLevel\":1,\"strName\":\"world\"}}}}",
+         true},
+        // everything below takes the Json::Value path
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"SetResult\",\"params\":{\"oResult\":"
+         "{\"Description\":\"a\",\"ErrorCode\":0,\"File\":\"f\",\"Function\":\"g\",\"Line\":3,\"x\":1}}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"SetResult\",\"params\":{\"oResult\":"
+         "{\"Description\":\"a\",\"ErrorCode\":0,\"File\":\"f\",\"Function\":\"g\"}}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"SetResult\",\"params\":{\"oResult\":"
+         "{\"Description\":\"a\",\"ErrorCode\":\"0\",\"File\":\"f\",\"Function\":\"g\",\"Line\":3}}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Move\",\"params\":{\"nSteps\":2,\"oPosition\":"
+         "{\"fX\":0.5,\"fY\":-1,\"oFrame\":{\"nLevel\":1}}}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Scale\",\"params\":[{\"fX\":1,\"fY\":2},2.5]}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Scale\",\"params\":[{\"fX\":1},2.5]}", false}};
+
+    cStructTestServer<rpc_stubs::cTestStructServerStub> oDomServer;
+    cStructTestServer<rpc_stubs::cTestStructDirectServerStub> oDirectServer;
+    for (const tCase& sCase: asCases)
+    {
+        ASSERT_FALSE(oDomServer.IsDirect(sCase.strRequest));
+        ASSERT_EQ(sCase.bDirect, oDirectServer.IsDirect(sCase.strRequest)) << sCase.strRequest;
+        cStringResponse oExpected;
+        cStringResponse oResponse;
+        ASSERT_TRUE(isOk(oDomServer.HandleCall(sCase.strRequest, strlen(sCase.strRequest), oExpected)));
+        ASSERT_TRUE(
+            isOk(oDirectServer.HandleCall(sCase.strRequest, strlen(sCase.strRequest), oResponse)));
+        ASSERT_EQ(oExpected.m_strResponse, oResponse.m_strResponse) << sCase.strRequest;
+    }
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("dom", &oDomServer)));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("direct", &oDirectServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    rpc::jsonrpc_remote_object<rpc_stubs::cTestStructClientStub,
+                               rpc::http::cJSONClientConnector,
+                               std::string>
+        oClient("http://127.0.0.1:1234/direct");
+    rpc::jsonrpc_remote_object<rpc_stubs::cTestStructDirectClientStub,
+                               rpc::http::cJSONClientConnector,
+                               std::string>
+        oDirectClient("http://127.0.0.1:1234/dom");
+
+    const a_util::result::Result oResult =
+        rpc::cJSONConversions::struct_to_result(oClient.GetResult());
+    ASSERT_EQ(-2, oResult.getErrorCode());
+    ASSERT_STREQ("\xc3\xa4\"", oResult.getDescription());
+    ASSERT_EQ(12, oResult.getLine());
+    ASSERT_EQ(oDirectClient.GetResult().Description, oClient.GetResult().Description);
+
+    rpc_stubs::cTestStructDirectClientStub::SetResult_oResult oSetResult;
+    oSetResult.Description = "set";
+    ASSERT_TRUE(oDirectClient.SetResult(oSetResult));
+    ASSERT_EQ("set", oDomServer.m_strDescription);
+    oSetResult.ErrorCode = 1;
+    ASSERT_FALSE(oClient.SetResult(
+        rpc::cJSONConversions::result_to_struct<rpc_stubs::cTestStructClientStub::SetResult_oResult>(
+            a_util::result::Result(1, "dom", 0, "", ""))));
+    ASSERT_EQ("dom", oDirectServer.m_strDescription);
+
+    rpc_stubs::cTestStructDirectClientStub::Move_oPosition oPosition;
+    oPosition.fX = 1.5;
+    oPosition.oFrame.strName = "world";
+    oPosition.oFrame.nLevel = 3;
+    const rpc_stubs::cTestStructDirectClientStub::Move_result oMoved = oDirectClient.Move(2, oPosition);
+    ASSERT_EQ(3.5, oMoved.fX);
+    ASSERT_EQ("world", oMoved.oFrame.strName);
+    ASSERT_EQ(3, oMoved.oFrame.nLevel);
+    ASSERT_EQ(1.5, oMoved.aHistory[0].asDouble());
+
+    rpc_stubs::cTestStructClientStub::Scale_param01 oPoint;
+    oPoint.fX = 1.0;
+    oPoint.fY = -2.0;
+    ASSERT_EQ(-5.0, oClient.Scale(oPoint, 2.5).fY);
+}
+
+template <typename ServerStub>
+class cTypesTestServer : public rpc::jsonrpc_object_server<ServerStub>
+{
+public:
+    int64_t Add64(int64_t nOffset, int64_t nValue) override
+    {
+        return nValue + nOffset;
+    }
+
+    uint64_t Half(uint64_t nValue) override
+    {
+        return nValue / 2;
+    }
+
+    std::vector<uint8_t> Reverse(const std::vector<uint8_t>& aData) override
+    {
+        return std::vector<uint8_t>(aData.rbegin(), aData.rend());
+    }
+
+    uint64_t Size(const std::vector<uint8_t>& aFirst, const std::vector<uint8_t>& aSecond) override
+    {
+        return aFirst.size() + aSecond.size();
+    }
+
+    typename ServerStub::Stamp_result Stamp(const typename ServerStub::Stamp_oStamp& oStamp) override
+    {
+        typename ServerStub::Stamp_result oResult = oStamp;
+        oResult.nTime += 1;
+        return oResult;
+    }
+
+    bool IsDirect(const std::string& strRequest)
+    {
+        jsonrpc::DirectCall oCall(strRequest);
+        std::string strResponse;
+        return oCall.ReadEnvelope() && this->HandleDirectCall(oCall, strResponse);
+    }
+};
+
+class cEncodedStringResponse : public cStringResponse, public rpc::IEncodedResponse
+{
+public:
+    cEncodedStringResponse(jsonrpc::encoding_t eEncoding) : m_eEncoding(eEncoding)
+    {
+    }
+
+    const char* GetContentType() const
+    {
+        return jsonrpc::GetContentType(m_eEncoding);
+    }
+
+private:
+    jsonrpc::encoding_t m_eEncoding;
+};
+
+/**
+ * int64, uint64 and binary parameters travel as integers and base64 strings in JSON
+ * and as integers and byte strings in CBOR and MessagePack.
+ */
+TEST(cTesterPkgRpc, TestSpecificationTypes)
+{
+    std::string strBytes;
+    ASSERT_EQ("", jsonrpc::EncodeBase64(std::vector<uint8_t>()));
+    ASSERT_EQ("AP8=", jsonrpc::EncodeBase64(std::vector<uint8_t>{0x00, 0xff}));
+    ASSERT_EQ("Zm9vYg==", jsonrpc::EncodeBase64(std::string("foob")));
+    ASSERT_TRUE(jsonrpc::DecodeBase64("Zm9vYmFy", strBytes));
+    ASSERT_EQ("foobar", strBytes);
+    ASSERT_FALSE(jsonrpc::DecodeBase64("Zm9vY", strBytes));
+    ASSERT_FALSE(jsonrpc::DecodeBase64("Zm=vYg==", strBytes));
+    ASSERT_FALSE(jsonrpc::DecodeBase64("Zm9v\n==", strBytes));
+
+    struct tCase
+    {
+        const char* strRequest;
+        bool bDirect;
+    };
+    const tCase asCases[] = {
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Add64\",\"params\":"
+         "{\"nOffset\":4294967296,\"nValue\":-9223372036854775807}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Add64\",\"params\":"
+         "{\"nOffset\":-1,\"nValue\":-9223372036854775807}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Half\",\"params\":"
+         "{\"nValue\":18446744073709551615}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Half\",\"params\":{\"nValue\":-0}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Reverse\",\"params\":{\"aData\":\"AAEC/w==\"}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Reverse\",\"params\":{\"aData\":\"\"}}",
+         true},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Stamp\",\"params\":{\"oStamp\":"
+         "{\"nDelta\":-1,\"nTime\":18446744073709551614,\"strName\":\"a\"}}}",
+         true},
+        // everything below takes the Json::Value path
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Add64\",\"params\":"
+         "{\"nOffset\":1,\"nValue\":9223372036854775808}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Half\",\"params\":{\"nValue\":-1}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Half\",\"params\":{\"nValue\":1.5}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Reverse\",\"params\":{\"aData\":\"AAE\"}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Reverse\",\"params\":{\"aData\":[0,1]}}",
+         false},
+        {"{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Size\",\"params\":[\"AAE=\",\"\"]}", false}};
+
+    cTypesTestServer<rpc_stubs::cTestTypesServerStub> oDomServer;
+    cTypesTestServer<rpc_stubs::cTestTypesDirectServerStub> oDirectServer;
+    for (const tCase& sCase: asCases)
+    {
+        ASSERT_EQ(sCase.bDirect, oDirectServer.IsDirect(sCase.strRequest)) << sCase.strRequest;
+        cStringResponse oExpected;
+        cStringResponse oResponse;
+        ASSERT_TRUE(isOk(oDomServer.HandleCall(sCase.strRequest, strlen(sCase.strRequest), oExpected)));
+        ASSERT_TRUE(
+            isOk(oDirectServer.HandleCall(sCase.strRequest, strlen(sCase.strRequest), oResponse)));
+        ASSERT_EQ(oExpected.m_strResponse, oResponse.m_strResponse) << sCase.strRequest;
+    }
+
+    // binary encodings carry the raw bytes, in batches as well
+    const std::string strRaw("\x00\xff\x01 text", 8);
+    Json::Value oBatch(Json::arrayValue);
+    oBatch[0]["jsonrpc"] = "2.0";
+    oBatch[0]["id"] = 1;
+    oBatch[0]["method"] = "Reverse";
+    oBatch[0]["params"]["aData"] = strRaw;
+    oBatch[1] = oBatch[0];
+    oBatch[1]["id"] = 2;
+    oBatch[1]["method"] = "Size";
+    oBatch[1]["params"] = Json::arrayValue;
+    oBatch[1]["params"].append(strRaw);
+    oBatch[1]["params"].append("abc");
+    for (jsonrpc::encoding_t eEncoding: {jsonrpc::ENCODING_CBOR, jsonrpc::ENCODING_MSGPACK})
+    {
+        std::string strRequest;
+        jsonrpc::EncodeValue(eEncoding, oBatch, strRequest);
+        cEncodedStringResponse oResponse(eEncoding);
+        ASSERT_TRUE(isOk(oDirectServer.HandleCall(strRequest.data(), strRequest.size(), oResponse)));
+        Json::Value oResult;
+        ASSERT_TRUE(jsonrpc::DecodeValue(eEncoding, oResponse.m_strResponse, oResult));
+        ASSERT_EQ(std::string(strRaw.rbegin(), strRaw.rend()), oResult[0]["result"].asString());
+        ASSERT_EQ(11u, oResult[1]["result"].asUInt64());
+    }
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("dom", &oDomServer)));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("direct", &oDirectServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    rpc::jsonrpc_remote_object<rpc_stubs::cTestTypesClientStub,
+                               rpc::http::cJSONClientConnector,
+                               std::string>
+        oClient("http://127.0.0.1:1234/direct");
+    rpc::jsonrpc_remote_object<rpc_stubs::cTestTypesDirectClientStub,
+                               rpc::http::cJSONClientConnector,
+                               std::string>
+        oDirectClient("http://127.0.0.1:1234/dom");
+
+    const std::vector<uint8_t> oData{0x00, 0xff, 0x80, 'a', 0x00};
+    const std::vector<uint8_t> oReversed(oData.rbegin(), oData.rend());
+    for (jsonrpc::encoding_t eEncoding:
+         {jsonrpc::ENCODING_JSON, jsonrpc::ENCODING_CBOR, jsonrpc::ENCODING_MSGPACK})
+    {
+        oClient.SetEncoding(eEncoding);
+        oDirectClient.SetEncoding(eEncoding);
+        ASSERT_EQ(std::numeric_limits<int64_t>::min(),
+                  oClient.Add64(-1, std::numeric_limits<int64_t>::min() + 1));
+        ASSERT_EQ(std::numeric_limits<int64_t>::max(),
+                  oDirectClient.Add64(std::numeric_limits<int64_t>::max(), 0));
+        ASSERT_EQ(std::numeric_limits<uint64_t>::max() / 2,
+                  oDirectClient.Half(std::numeric_limits<uint64_t>::max()));
+        ASSERT_EQ(oReversed, oClient.Reverse(oData));
+        ASSERT_EQ(oReversed, oDirectClient.Reverse(oData));
+        ASSERT_EQ(std::vector<uint8_t>(), oDirectClient.Reverse(std::vector<uint8_t>()));
+        ASSERT_EQ(8u, oClient.Size(oData, std::vector<uint8_t>{'a', 'b', 'c'}));
+
+        // batches are sent in the encoding of the client as well
+        jsonrpc::BatchCall oCalls;
+        Json::Value oReverseParams;
+        oReverseParams["aData"] = oClient.EncodeBinary(oData);
+        const int nReverse = oCalls.addCall("Reverse", oReverseParams);
+        Json::Value oSizeParams(Json::arrayValue);
+        oSizeParams.append(oClient.EncodeBinary(oData));
+        oSizeParams.append(oClient.EncodeBinary(std::vector<uint8_t>{'a', 'b', 'c'}));
+        const int nSize = oCalls.addCall("Size", oSizeParams);
+        jsonrpc::BatchResponse oResponses = oClient.CallProcedures(oCalls);
+        ASSERT_FALSE(oResponses.hasErrors());
+        std::vector<uint8_t> oBatchReversed;
+        ASSERT_TRUE(oClient.DecodeBinary(oResponses.getResult(nReverse), oBatchReversed));
+        ASSERT_EQ(oReversed, oBatchReversed);
+        ASSERT_EQ(8u, oResponses.getResult(nSize).asUInt64());
+
+        rpc_stubs::cTestTypesDirectClientStub::Stamp_oStamp oStamp;
+        oStamp.nTime = std::numeric_limits<uint64_t>::max() - 1;
+        oStamp.nDelta = std::numeric_limits<int64_t>::min();
+        const rpc_stubs::cTestTypesDirectClientStub::Stamp_result oStamped =
+            oDirectClient.Stamp(oStamp);
+        ASSERT_EQ(std::numeric_limits<uint64_t>::max(), oStamped.nTime);
+        ASSERT_EQ(std::numeric_limits<int64_t>::min(), oStamped.nDelta);
+    }
+}
+
+/**
+ * Validation collects the parameters in the order of jsonrpc::Procedure::GetParameters(),
+ * whatever order the request uses.
+ */
+TEST(cTesterPkgRpc, TestParameterValues)
+{
+    jsonrpc::Procedure oProcedure("Names", jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_INTEGER,
+                                  "b", jsonrpc::JSON_INTEGER, "a", jsonrpc::JSON_STRING,
+                                  "ab", jsonrpc::JSON_INTEGER, NULL);
+    Json::Value oParams;
+    oParams["b"] = 2;
+    oParams["aa"] = "extra";
+    oParams["ab"] = 3;
+    oParams["a"] = "1";
+    oParams[""] = 0;
+    jsonrpc::ParameterValues oValues;
+    ASSERT_TRUE(oProcedure.ValidateParameters(oParams, oValues));
+    ASSERT_EQ(3u, oValues.size());
+    ASSERT_EQ("1", oValues[0].asString());
+    ASSERT_EQ(3, oValues[1].asInt());
+    ASSERT_EQ(2, oValues[2].asInt());
+    ASSERT_TRUE(oProcedure.ValdiateParameters(oParams));
+
+    Json::Value oWrongType = oParams;
+    oWrongType["ab"] = "3";
+    ASSERT_FALSE(oProcedure.ValidateParameters(oWrongType, oValues));
+    Json::Value oMissing = oParams;
+    oMissing.removeMember("b");
+    ASSERT_FALSE(oProcedure.ValidateParameters(oMissing, oValues));
+    oMissing = oParams;
+    oMissing.removeMember("a");
+    ASSERT_FALSE(oProcedure.ValidateParameters(oMissing, oValues));
+    ASSERT_FALSE(oProcedure.ValidateParameters(Json::Value(), oValues));
+    ASSERT_FALSE(oProcedure.ValidateParameters(Json::Value(Json::arrayValue), oValues));
+
+    // more parameters than fit inline
+    jsonrpc::Procedure oMany("Many", jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_INTEGER, NULL);
+    jsonrpc::Procedure oPositional("Many", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_INTEGER, NULL);
+    Json::Value oManyParams;
+    Json::Value oPositionalParams;
+    for (int nParam = 0; nParam < 40; ++nParam)
+    {
+        const std::string strName = "nValue" + std::to_string(10 + nParam);
+        oMany.AddParameter(strName, jsonrpc::JSON_INTEGER);
+        oPositional.AddParameter(strName, jsonrpc::JSON_INTEGER);
+        oManyParams[strName] = nParam;
+        oPositionalParams.append(nParam);
+    }
+    for (const jsonrpc::Procedure* pProcedure: {&oMany, &oPositional})
+    {
+        const Json::Value& oRequestParams =
+            pProcedure == &oMany ? oManyParams : oPositionalParams;
+        ASSERT_TRUE(pProcedure->ValidateParameters(oRequestParams, oValues));
+        ASSERT_EQ(40u, oValues.size());
+        for (unsigned int nParam = 0; nParam < oValues.size(); ++nParam)
+        {
+            ASSERT_EQ(static_cast<int>(nParam), oValues[nParam].asInt());
+        }
+    }
+
+    const char* strRequest = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Concat\","
+                             "\"params\":{\"strString2\":\"bar\",\"strString1\":\"foo\"}}";
+    cCodecTestServer<rpc_stubs::cTestServerStub> oServer;
+    cStringResponse oResponse;
+    ASSERT_TRUE(isOk(oServer.HandleCall(strRequest, strlen(strRequest), oResponse)));
+    ASSERT_NE(std::string::npos, oResponse.m_strResponse.find("\"foobar\""));
+}
+
+/**
+ * Call metrics per object and method, via the snapshot API and the /__metrics endpoint.
+ */
+TEST(cTesterPkgRpc, TestMetrics)
+{
+    ASSERT_EQ(0u, rpc::cLatencyHistogram::GetBucket(0));
+    ASSERT_EQ(15u, rpc::cLatencyHistogram::GetBucket(15));
+    ASSERT_EQ(rpc::cLatencyHistogram::nBucketCount - 1,
+              rpc::cLatencyHistogram::GetBucket(std::numeric_limits<uint64_t>::max()));
+    for (uint64_t nLatency: {16ull, 17ull, 999ull, 1000ull, 123456789ull, 1ull << 39})
+    {
+        const size_t nBucket = rpc::cLatencyHistogram::GetBucket(nLatency);
+        ASSERT_GE(rpc::cLatencyHistogram::GetBucketLimit(nBucket), nLatency);
+        ASSERT_LT(rpc::cLatencyHistogram::GetBucketLimit(nBucket - 1), nLatency);
+        ASSERT_LE(rpc::cLatencyHistogram::GetBucketLimit(nBucket), nLatency + nLatency / 8);
+    }
+    rpc::cLatencyHistogram oHistogram;
+    ASSERT_EQ(0u, oHistogram.GetPercentile(0.5));
+    oHistogram.m_aBuckets[rpc::cLatencyHistogram::GetBucket(100)] = 99;
+    oHistogram.m_aBuckets[rpc::cLatencyHistogram::GetBucket(100000)] = 1;
+    ASSERT_EQ(103u, oHistogram.GetPercentile(0.5));
+    ASSERT_EQ(103u, oHistogram.GetPercentile(0.99));
+    ASSERT_EQ(106495u, oHistogram.GetPercentile(0.999));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(rpc_server.GetMetrics().empty());
+    rpc_server.EnableMetrics(true);
+    cCodecTestServer<rpc_stubs::cTestServerStub> oDomServer;
+    cCodecTestServer<rpc_stubs::cTestDirectServerStub> oDirectServer;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("dom", &oDomServer)));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("direct", &oDirectServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    const std::string strInvalid =
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":\"1\"}}";
+    const std::string strBatch =
+        "[{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1}},"
+        "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"Concat\",\"params\":{\"strString1\":\"a\","
+        "\"strString2\":\"b\"}}]";
+    rpc::http::cJSONClientConnector oDomConnector("http://127.0.0.1:1234/dom");
+    std::string strResponse;
+    oDomConnector.SendRPCMessage(strInvalid, strResponse);
+    oDomConnector.SendRPCMessage(strBatch, strResponse);
+    rpc::http::cJSONClientConnector oUnknownConnector("http://127.0.0.1:1234/unknown");
+    ASSERT_THROW(oUnknownConnector.SendRPCMessage(strBatch, strResponse),
+                 jsonrpc::JsonRpcException);
+
+    cTestClient oClient("http://127.0.0.1:1234/dom");
+    cTestDirectClient oDirectClient("http://127.0.0.1:1234/direct");
+    for (int nCall = 0; nCall < 3; ++nCall)
+    {
+        ASSERT_EQ(nCall, oClient.GetInteger(nCall));
+        ASSERT_EQ(nCall, oDirectClient.GetInteger(nCall));
+    }
+    ASSERT_THROW(oDirectClient.GetInteger(-1), jsonrpc::JsonRpcException);
+
+    std::map<std::string, rpc::tCallMetrics> oMetrics;
+    for (const rpc::tCallMetrics& oEntry: rpc_server.GetMetrics())
+    {
+        oMetrics[oEntry.strObject + "." + oEntry.strMethod] = oEntry;
+    }
+    ASSERT_EQ(5u, oMetrics.size());
+    ASSERT_EQ(5u, oMetrics["dom."].nCalls);
+    ASSERT_EQ(1u, oMetrics["dom."].nErrors);
+    ASSERT_EQ(5u, oMetrics["dom."].oLatency.GetCount());
+    ASSERT_GT(oMetrics["dom."].oLatency.GetPercentile(0.5), 0u);
+    ASSERT_EQ(5u, oMetrics["dom.GetInteger"].nCalls);
+    ASSERT_EQ(1u, oMetrics["dom.GetInteger"].nErrors);
+    // the call in the batch has no latency and size of its own
+    ASSERT_EQ(4u, oMetrics["dom.GetInteger"].oLatency.GetCount());
+    ASSERT_EQ(oMetrics["dom."].nBytesIn - strBatch.size(), oMetrics["dom.GetInteger"].nBytesIn);
+    ASSERT_EQ(1u, oMetrics["dom.Concat"].nCalls);
+    ASSERT_EQ(0u, oMetrics["dom.Concat"].nErrors);
+    ASSERT_EQ(4u, oMetrics["direct.GetInteger"].nCalls);
+    ASSERT_EQ(1u, oMetrics["direct.GetInteger"].nErrors);
+    ASSERT_EQ(oMetrics["direct."].nBytesOut, oMetrics["direct.GetInteger"].nBytesOut);
+    ASSERT_GT(oMetrics["direct.GetInteger"].nBytesOut, 0u);
+
+    rpc::http::cJSONClientConnector oMetricsConnector("http://127.0.0.1:1234/__metrics");
+    oMetricsConnector.SendRPCMessage("", strResponse);
+    Json::Value oEndpoint;
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, strResponse, oEndpoint));
+    ASSERT_EQ(5u, oEndpoint.size());
+    ASSERT_EQ("direct", oEndpoint[0]["object"].asString());
+    ASSERT_FALSE(oEndpoint[0].isMember("method"));
+    ASSERT_EQ("GetInteger", oEndpoint[1]["method"].asString());
+    ASSERT_EQ(4u, oEndpoint[1]["calls"].asUInt64());
+    ASSERT_TRUE(oEndpoint[1]["latency_ns"]["p99"].isUInt64());
+}
+
+/**
+ * The load generator synthesizes its requests from the example parameters of a specification.
+ */
+TEST(cTesterPkgRpc, TestLoadRequests)
+{
+    const std::string strSpecification =
+        "[{\"name\":\"Add\",\"params\":{\"nA\":\"$int64\",\"nB\":2},\"returns\":\"$int64\"},"
+        " {\"name\":\"Notify\",\"params\":[\"$binary\"]},"
+        " {\"name\":\"Echo\",\"params\":{\"nValue\":\"$uint64\"},\"returns\":1}]";
+
+    std::vector<std::string> oRequests =
+        rpc::load::CreateRequests(strSpecification, std::vector<std::string>(), 1);
+    ASSERT_EQ(3u, oRequests.size());
+    Json::Value oCall;
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, oRequests[0], oCall));
+    ASSERT_EQ("Add", oCall["method"].asString());
+    ASSERT_TRUE(oCall["params"]["nA"].isIntegral());
+    ASSERT_EQ(1, oCall["params"]["nA"].asInt64());
+    ASSERT_EQ(2, oCall["params"]["nB"].asInt());
+    ASSERT_EQ(1, oCall["id"].asInt());
+    // procedures without return value are notifications
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, oRequests[1], oCall));
+    ASSERT_FALSE(oCall.isMember("id"));
+    ASSERT_EQ("", oCall["params"][0].asString());
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, oRequests[2], oCall));
+    ASSERT_EQ(1u, oCall["params"]["nValue"].asUInt64());
+
+    oRequests = rpc::load::CreateRequests(strSpecification, std::vector<std::string>{"Echo"}, 1);
+    ASSERT_EQ(1u, oRequests.size());
+    ASSERT_NE(std::string::npos, oRequests[0].find("\"Echo\""));
+
+    // batches start at every call in turn and number the calls that are not notifications
+    oRequests = rpc::load::CreateRequests(strSpecification, std::vector<std::string>(), 2);
+    ASSERT_EQ(3u, oRequests.size());
+    Json::Value oBatch;
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, oRequests[1], oBatch));
+    ASSERT_EQ(2u, oBatch.size());
+    ASSERT_EQ("Notify", oBatch[0]["method"].asString());
+    ASSERT_FALSE(oBatch[0].isMember("id"));
+    ASSERT_EQ("Echo", oBatch[1]["method"].asString());
+    ASSERT_EQ(2, oBatch[1]["id"].asInt());
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, oRequests[2], oBatch));
+    ASSERT_EQ("Echo", oBatch[0]["method"].asString());
+    ASSERT_EQ(1, oBatch[0]["id"].asInt());
+    ASSERT_EQ("Add", oBatch[1]["method"].asString());
+    ASSERT_EQ(2, oBatch[1]["id"].asInt());
+
+    ASSERT_THROW(rpc::load::CreateRequests("{}", std::vector<std::string>(), 1),
+                 jsonrpc::JsonRpcException);
+    ASSERT_THROW(
+        rpc::load::CreateRequests(strSpecification, std::vector<std::string>{"Missing"}, 1),
+        jsonrpc::JsonRpcException);
+}
+
+/**
+ * Only calls answered with a non-null error count as errors, whatever the results contain.
+ */
+TEST(cTesterPkgRpc, TestLoadErrors)
+{
+    ASSERT_EQ(0u, rpc::load::CountErrors(""));
+    ASSERT_EQ(0u, rpc::load::CountErrors("{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":1}\n"));
+    ASSERT_EQ(0u, rpc::load::CountErrors("{\"id\":1,\"result\":\"\\\"error\\\":\"}"));
+    ASSERT_EQ(0u, rpc::load::CountErrors("{\"error\":null,\"id\":1,\"result\":1}"));
+    ASSERT_EQ(1u,
+              rpc::load::CountErrors(
+                  "{\"error\":{\"code\":-32601,\"message\":\"METHOD_NOT_FOUND\"},\"id\":1}"));
+    ASSERT_EQ(2u,
+              rpc::load::CountErrors("[{\"error\":null,\"id\":1,\"result\":{\"error\":1}},"
+                                     "{\"error\":{\"code\":-32602},\"id\":2},"
+                                     "{\"error\":{\"code\":-32602},\"id\":3},"
+                                     "{\"id\":4,\"jsonrpc\":\"2.0\",\"result\":\"error\"}]"));
+    ASSERT_EQ(1u, rpc::load::CountErrors("<html>"));
+}
+
+/**
+ * A stalled client in a closed loop is accounted for the requests it did not send meanwhile.
+ */
+TEST(cTesterPkgRpc, TestCoordinatedOmission)
+{
+    const uint64_t nInterval = 1000000;
+    const size_t nFast = rpc::cLatencyHistogram::GetBucket(100000);
+    const size_t nSlow = rpc::cLatencyHistogram::GetBucket(10000000);
+    const uint64_t nSlowLatency = rpc::cLatencyHistogram::GetBucketLimit(nSlow);
+    rpc::cLatencyHistogram oHistogram;
+    oHistogram.m_aBuckets[nFast] = 5;
+    oHistogram.m_aBuckets[nSlow] = 1;
+
+    rpc::cLatencyHistogram oCorrected = rpc::load::CorrectCoordinatedOmission(oHistogram, 0);
+    ASSERT_EQ(6u, oCorrected.GetCount());
+    oCorrected = rpc::load::CorrectCoordinatedOmission(oHistogram, nInterval);
+    // one request per interval while waiting, each one interval less late than the one before
+    ASSERT_EQ(6u + nSlowLatency / nInterval - 1, oCorrected.GetCount());
+    ASSERT_EQ(5u, oCorrected.m_aBuckets[nFast]);
+    ASSERT_LE(1u,
+              oCorrected.m_aBuckets[rpc::cLatencyHistogram::GetBucket(nSlowLatency - nInterval)]);
+    ASSERT_LE(1u,
+              oCorrected.m_aBuckets[rpc::cLatencyHistogram::GetBucket(
+                  nSlowLatency % nInterval + nInterval)]);
+    // latencies within the interval are not corrected
+    oCorrected = rpc::load::CorrectCoordinatedOmission(oHistogram, nSlowLatency);
+    ASSERT_EQ(6u, oCorrected.GetCount());
+}
+
+TEST(cTesterPkgRpc, TestPhaseTiming)
+{
+    ASSERT_STREQ("dispatch", rpc::GetPhaseName(rpc::ePhaseDispatch));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    rpc_server.EnablePhaseTiming();
+    cCodecTestServer<rpc_stubs::cTestServerStub> oDomServer;
+    cCodecTestServer<rpc_stubs::cTestDirectServerStub> oDirectServer;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("dom", &oDomServer)));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("direct", &oDirectServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    const std::string strRequest =
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetInteger\",\"params\":{\"nValue\":1}}";
+    httplib::Client oHttpClient("127.0.0.1", 1234);
+    for (const char* strUrl: {"/dom", "/direct"})
+    {
+        std::unique_ptr<httplib::Response> pResponse(
+            oHttpClient.post(strUrl, strRequest, "application/json"));
+        ASSERT_TRUE(pResponse);
+        const std::string strServerTiming = pResponse->get_header_value("Server-Timing");
+        ASSERT_EQ(0u, strServerTiming.find("read;dur="));
+        ASSERT_NE(std::string::npos, strServerTiming.find(", dispatch;dur="));
+        ASSERT_NE(std::string::npos, strServerTiming.find(", serialize;dur="));
+        ASSERT_EQ(std::string::npos, strServerTiming.find("write"));
+    }
+
+    cTestClient oClient("http://127.0.0.1:1234/dom");
+    ASSERT_EQ(2, oClient.GetInteger(2));
+
+    // the write phase is recorded once the response has been sent
+    std::map<std::string, rpc::tCallMetrics> oMetrics;
+    for (int nTry = 0; nTry < 100; ++nTry)
+    {
+        for (const rpc::tCallMetrics& oEntry: rpc_server.GetMetrics())
+        {
+            oMetrics[oEntry.strObject + "." + oEntry.strMethod] = oEntry;
+        }
+        if (oMetrics["dom.GetInteger"].aPhaseNanoseconds[rpc::ePhaseWrite] > 0 &&
+            oMetrics["direct.GetInteger"].aPhaseNanoseconds[rpc::ePhaseWrite] > 0)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const rpc::tCallMetrics& oDom = oMetrics["dom.GetInteger"];
+    ASSERT_EQ(2u, oDom.nTimedCalls);
+    ASSERT_GT(oDom.aPhaseNanoseconds[rpc::ePhaseParse], 0u);
+    ASSERT_GT(oDom.aPhaseNanoseconds[rpc::ePhaseDispatch], 0u);
+    ASSERT_GT(oDom.aPhaseNanoseconds[rpc::ePhaseSerialize], 0u);
+    ASSERT_GT(oDom.aPhaseNanoseconds[rpc::ePhaseWrite], 0u);
+    // requests handled by direct stubs are parsed while they are dispatched
+    const rpc::tCallMetrics& oDirect = oMetrics["direct.GetInteger"];
+    ASSERT_EQ(1u, oDirect.nTimedCalls);
+    ASSERT_EQ(0u, oDirect.aPhaseNanoseconds[rpc::ePhaseParse]);
+    ASSERT_GT(oDirect.aPhaseNanoseconds[rpc::ePhaseDispatch], 0u);
+    ASSERT_EQ(oMetrics["dom."].aPhaseNanoseconds[rpc::ePhaseDispatch],
+              oDom.aPhaseNanoseconds[rpc::ePhaseDispatch]);
+}
+
+TEST(cTesterPkgRpc, TestFlightRecorder)
+{
+    rpc::cFlightRecorder oRecorder(1000, 2);
+    const std::string strLongName(100, 'x');
+    const std::string strLongRequest(1000, 'r');
+    const uint64_t aPhases[rpc::ePhaseCount] = {1, 2, 3, 4, 5, 0};
+    ASSERT_FALSE(oRecorder.Record("/fast", "Add", "{}", 2, 999, nullptr));
+    ASSERT_TRUE(oRecorder.Record("/first", "Add", "{}", 2, 1000, nullptr));
+    ASSERT_TRUE(oRecorder.Record("/second", "Add", "{}", 2, 2000, aPhases));
+    ASSERT_TRUE(oRecorder.Record(strLongName.c_str(),
+                                 "",
+                                 strLongRequest.c_str(),
+                                 strLongRequest.size(),
+                                 3000,
+                                 aPhases));
+    std::vector<rpc::tSlowCall> oCalls = oRecorder.GetCalls();
+    ASSERT_EQ(2u, oCalls.size());
+    ASSERT_EQ("/second", oCalls[0].strObject);
+    ASSERT_EQ("Add", oCalls[0].strMethod);
+    ASSERT_EQ("{}", oCalls[0].strRequest);
+    ASSERT_EQ(2000u, oCalls[0].nNanoseconds);
+    ASSERT_EQ(4u, oCalls[0].aPhaseNanoseconds[rpc::ePhaseDispatch]);
+    ASSERT_NE(0u, oCalls[0].nThreadId);
+    ASSERT_EQ(rpc::cFlightRecorder::nMaxNameSize, oCalls[1].strObject.size());
+    ASSERT_TRUE(oCalls[1].strMethod.empty());
+    ASSERT_EQ(1000u, oCalls[1].nRequestBytes);
+    ASSERT_EQ(strLongRequest.substr(0, rpc::cFlightRecorder::nSnippetSize), oCalls[1].strRequest);
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(rpc_server.GetSlowCalls().empty());
+    rpc_server.EnableFlightRecorder(0, 4, true);
+    cCodecTestServer<rpc_stubs::cTestServerStub> oDomServer;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("dom", &oDomServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    cTestClient oClient("http://127.0.0.1:1234/dom");
+    for (int nCall = 0; nCall < 5; ++nCall)
+    {
+        ASSERT_EQ(nCall, oClient.GetInteger(nCall));
+    }
+    oCalls = rpc_server.GetSlowCalls();
+    ASSERT_EQ(4u, oCalls.size());
+    ASSERT_EQ("dom", oCalls[0].strObject);
+    ASSERT_EQ("GetInteger", oCalls[0].strMethod);
+    ASSERT_NE(std::string::npos, oCalls[3].strRequest.find("\"nValue\":4"));
+    ASSERT_EQ(oCalls[3].strRequest.size(), oCalls[3].nRequestBytes);
+    ASSERT_GT(oCalls[3].aPhaseNanoseconds[rpc::ePhaseDispatch], 0u);
+
+    rpc::http::cJSONClientConnector oSlowCallsConnector("http://127.0.0.1:1234/__slow_calls");
+    std::string strResponse;
+    oSlowCallsConnector.SendRPCMessage("", strResponse);
+    Json::Value oEndpoint;
+    ASSERT_TRUE(jsonrpc::ParseJson(jsonrpc::JSONREADER_CLASSIC, strResponse, oEndpoint));
+    ASSERT_EQ(4u, oEndpoint.size());
+    ASSERT_EQ("GetInteger", oEndpoint[3]["method"].asString());
+    ASSERT_EQ(oCalls[3].strRequest, oEndpoint[3]["request"].asString());
+    ASSERT_TRUE(oEndpoint[3]["phases_ns"]["dispatch"].isUInt64());
+}
+
+/**
+ * The parts of a URL as cUrl and the regular expressions it was implemented with before see them.
+ */
+struct tUrlParts
+{
+    bool bValid;
+    std::string strScheme;
+    std::string strUser;
+    std::string strPassword;
+    std::string strHost;
+    uint16_t nPort;
+    bool bIPv4;
+    std::string strPath;
+    std::string strQuery;
+    std::map<std::string, std::string> oQuery;
+    std::string strFragment;
+
+    tUrlParts() : bValid(false), nPort(0), bIPv4(false)
+    {
+    }
+};
+
+tUrlParts ParseUrl(const std::string& strUrl)
+{
+    tUrlParts oParts;
+    const rpc::cUrl oUrl(strUrl);
+    oParts.bValid = oUrl.IsValid();
+    if (oParts.bValid)
+    {
+        const rpc::cUrl::cAuthority oAuthority = oUrl.GetAuthority();
+        oParts.strScheme = oUrl.GetScheme();
+        oParts.strUser = oAuthority.GetUser();
+        oParts.strPassword = oAuthority.GetPassword();
+        oParts.strHost = oAuthority.GetHost();
+        oParts.nPort = oAuthority.GetPort();
+        oParts.bIPv4 = oAuthority.IsValidIPv4();
+        oParts.strPath = oUrl.GetPath();
+        oParts.strQuery = oUrl.GetQuery().AsString();
+        oParts.strFragment = oUrl.GetFragment();
+    }
+    return oParts;
+}
+
+/**
+ * The reference: the expressions of the former cUrl. Its query loop never advanced, here every
+ * parameter is matched on its own.
+ */
+tUrlParts ParseUrlWithRegex(const std::string& strUrl)
+{
+    tUrlParts oParts;
+    std::string strAuthority;
+    std::string strDummy;
+    a_util::regex::RegularExpression oUrlExp(
+        "^([^\\+\\-\\.][\\w\\+-_]+[^\\+-\\.])://([\\w:@\\.-]+)/?(/([\\w\\/"
+        "\\.%\\-_\\~]+))?\\?\?(\\?([^\\s#]+))?#?(#(\\w+))?$");
+    if (!oUrlExp.fullMatch(strUrl,
+                           oParts.strScheme,
+                           strAuthority,
+                           strDummy,
+                           oParts.strPath,
+                           strDummy,
+                           oParts.strQuery,
+                           strDummy,
+                           oParts.strFragment))
+    {
+        return tUrlParts();
+    }
+
+    a_util::regex::RegularExpression oAuthorityExp(
+        "^((\\w+)(:(\\w+))?@)?([\\w\\.-]+)(:([\\d]+))?$");
+    std::string strPort;
+    if (!oAuthorityExp.fullMatch(strAuthority,
+                                 strDummy,
+                                 oParts.strUser,
+                                 strDummy,
+                                 oParts.strPassword,
+                                 oParts.strHost,
+                                 strDummy,
+                                 strPort))
+    {
+        return tUrlParts();
+    }
+    oParts.nPort = a_util::strings::toUInt16(strPort);
+    a_util::regex::RegularExpression oIPv4Exp(
+        "\\b(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.(25["
+        "0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\.(25[0-5]|2[0-4][0-9]|[01]?[0-9][0-9]?)\\b");
+    oParts.bIPv4 = oIPv4Exp.fullMatch(oParts.strHost);
+
+    a_util::regex::RegularExpression oParameterExp("([\\w\\d]+)(=([\\w\\d]+))?");
+    const std::string strQuery =
+        !oParts.strQuery.empty() && oParts.strQuery.back() == '&' ?
+            oParts.strQuery.substr(0, oParts.strQuery.size() - 1) :
+            oParts.strQuery;
+    for (size_t nPos = 0; !strQuery.empty() && nPos <= strQuery.size();)
+    {
+        size_t nEnd = strQuery.find('&', nPos);
+        if (nEnd == std::string::npos)
+        {
+            nEnd = strQuery.size();
+        }
+        std::string strParameter;
+        std::string strValue;
+        if (!oParameterExp.fullMatch(
+                strQuery.substr(nPos, nEnd - nPos), strParameter, strDummy, strValue))
+        {
+            return tUrlParts();
+        }
+        oParts.oQuery.insert(std::make_pair(strParameter, strValue));
+        nPos = nEnd + 1;
+    }
+    oParts.bValid = true;
+    return oParts;
+}
+
+TEST(cTesterPkgRpc, TestUrl)
+{
+    tUrlParts oParts = ParseUrl("ssh+tcp://user:pw@1.2.3.4:22/a/b?keepalive=true&x#top");
+    ASSERT_TRUE(oParts.bValid);
+    ASSERT_EQ("ssh+tcp", oParts.strScheme);
+    ASSERT_EQ("user", oParts.strUser);
+    ASSERT_EQ("pw", oParts.strPassword);
+    ASSERT_EQ("1.2.3.4", oParts.strHost);
+    ASSERT_EQ(22, oParts.nPort);
+    ASSERT_TRUE(oParts.bIPv4);
+    ASSERT_EQ("a/b", oParts.strPath);
+    ASSERT_EQ("keepalive=true&x", oParts.strQuery);
+    ASSERT_EQ("top", oParts.strFragment);
+
+    const rpc::cUrl oLegacyUrl("tcp://127.0.0.1:5001{timeout=1000,max_pkg_size=65000}");
+    ASSERT_TRUE(oLegacyUrl.IsValid());
+    ASSERT_EQ("tcp", oLegacyUrl.GetScheme());
+    ASSERT_EQ("127.0.0.1", oLegacyUrl.GetAuthority().GetHost());
+    ASSERT_EQ(5001, oLegacyUrl.GetAuthority().GetPort());
+    ASSERT_EQ("1000", oLegacyUrl.GetQuery().GetValue("timeout"));
+    ASSERT_EQ("65000", oLegacyUrl.GetQuery().GetValue("max_pkg_size"));
+    ASSERT_EQ("none", oLegacyUrl.GetQuery().GetValue("size", "none"));
+    ASSERT_TRUE(rpc::cUrl("udp://127.0.0.1:5002{}").IsValid());
+    ASSERT_FALSE(rpc::cUrl("udp://127.0.0.1:5002{timeout=1 000}").IsValid());
+
+    // URLs assembled from valid and invalid parts, some of them mutated, have to be split the
+    // same way the expressions did
+    // the valid parts come first and are taken three times out of four
+    const std::vector<std::string> aSchemes = {"http", "tcp", "ssh+tcp", "h_t", "a", "+ab", "ab."};
+    const std::vector<std::string> aUsers = {"", "user@", "user:pw@", ":pw@", "u:@", "@"};
+    const std::vector<std::string> aHosts = {
+        "127.0.0.1", "localhost", "256.1.1.1", "1.2.3", "my-host.de", "01.002.3.255", ""};
+    const std::vector<std::string> aPorts = {"", ":80", ":65535", ":", ":x"};
+    const std::vector<std::string> aPaths = {
+        "", "/", "//", "/calculator", "//a/b", "/a.b/c%20~_-", "/a b", "/a?b c"};
+    const std::vector<std::string> aQueries = {
+        "", "?", "?a", "?a=b", "?a=b&c", "?a=b&c=d&", "??a=1", "?a&&b", "?=b", "?a=", "?a/b"};
+    const std::vector<std::string> aFragments = {"", "#", "#f", "##f", "#f#", "#a-b"};
+    const std::string strMutations = ":/?#@.-_~%+=& a1";
+
+    std::mt19937 oRandom(66);
+    auto fnPick = [&oRandom](const std::vector<std::string>& aParts, size_t nValid) {
+        return aParts[oRandom() % 4 ? oRandom() % nValid : oRandom() % aParts.size()];
+    };
+    for (int nUrl = 0; nUrl < 2000; ++nUrl)
+    {
+        std::string strUrl = fnPick(aSchemes, 4) + "://" + fnPick(aUsers, 3) + fnPick(aHosts, 6) +
+                             fnPick(aPorts, 3) + fnPick(aPaths, 6) + fnPick(aQueries, 6) +
+                             fnPick(aFragments, 4);
+        if (oRandom() % 2)
+        {
+            const size_t nPos = oRandom() % strUrl.size();
+            const char c = strMutations[oRandom() % strMutations.size()];
+            switch (oRandom() % 3)
+            {
+            case 0:
+                strUrl[nPos] = c;
+                break;
+            case 1:
+                strUrl.insert(nPos, 1, c);
+                break;
+            default:
+                strUrl.erase(nPos, 1);
+                break;
+            }
+        }
+
+        const tUrlParts oExpected = ParseUrlWithRegex(strUrl);
+        oParts = ParseUrl(strUrl);
+        ASSERT_EQ(oExpected.bValid, oParts.bValid) << strUrl;
+        if (!oExpected.bValid)
+        {
+            continue;
+        }
+        ASSERT_EQ(oExpected.strScheme, oParts.strScheme) << strUrl;
+        ASSERT_EQ(oExpected.strUser, oParts.strUser) << strUrl;
+        ASSERT_EQ(oExpected.strPassword, oParts.strPassword) << strUrl;
+        ASSERT_EQ(oExpected.strHost, oParts.strHost) << strUrl;
+        ASSERT_EQ(oExpected.nPort, oParts.nPort) << strUrl;
+        ASSERT_EQ(oExpected.bIPv4, oParts.bIPv4) << strUrl;
+        ASSERT_EQ(oExpected.strPath, oParts.strPath) << strUrl;
+        ASSERT_EQ(oExpected.strQuery, oParts.strQuery) << strUrl;
+        ASSERT_EQ(oExpected.strFragment, oParts.strFragment) << strUrl;
+        const rpc::cUrl oUrl(strUrl);
+        for (const auto& oParameter: oExpected.oQuery)
+        {
+            ASSERT_EQ(oParameter.second, oUrl.GetQuery().GetValue(oParameter.first, "-")) << strUrl;
+        }
+    }
+}
+
+/**
+ * Answers every call with the "id" parameter of its route.
+ */
+class cRouteEchoObject : public rpc::IRPCObject
+{
+public:
+    rpc::Result HandleCall(const char*, size_t, rpc::IResponse& oResponse) override
+    {
+        const std::string strId = rpc::GetCurrentRoute()->GetParameter("id", "none");
+        oResponse.Set(strId.data(), strId.size());
+        return rpc::Result();
+    }
+};
+
+TEST(cTesterPkgRpc, TestRouter)
+{
+    int aTargets[5] = {};
+    rpc::cRouter oRouter;
+    ASSERT_TRUE(oRouter.Insert("/graph/streaming/filter_1/properties", &aTargets[0]));
+    ASSERT_TRUE(oRouter.Insert("/graph/streaming/:filter/properties", &aTargets[1]));
+    ASSERT_TRUE(oRouter.Insert("/graph/streaming/*", &aTargets[2]));
+    ASSERT_TRUE(oRouter.Insert("/graph/:graph/filters/:filter", &aTargets[3]));
+    ASSERT_TRUE(oRouter.Insert("/graph", &aTargets[4]));
+    ASSERT_FALSE(oRouter.Insert("/graph", &aTargets[0]));
+    ASSERT_FALSE(oRouter.Insert("/graph/streaming/*", &aTargets[0]));
+    ASSERT_FALSE(oRouter.Insert("/graph/streaming/:name/state", &aTargets[0]));
+    ASSERT_FALSE(oRouter.Insert("/:a/:b/:c/:d/:e/:f/:g/:h/:i", &aTargets[0]));
+
+    rpc::tRouteMatch oMatch;
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/filter_1/properties", oMatch));
+    ASSERT_EQ(&aTargets[0], oMatch.pTarget);
+    ASSERT_EQ(0u, oMatch.nParameterCount);
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/filter_2/properties", oMatch));
+    ASSERT_EQ(&aTargets[1], oMatch.pTarget);
+    ASSERT_EQ("filter_2", oMatch.GetParameter("filter"));
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/filter_2/state", oMatch));
+    ASSERT_EQ(&aTargets[2], oMatch.pTarget);
+    ASSERT_EQ("filter_2/state", oMatch.GetParameter("*"));
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/", oMatch));
+    ASSERT_EQ(&aTargets[2], oMatch.pTarget);
+    ASSERT_EQ("", oMatch.GetParameter("*", "none"));
+    ASSERT_TRUE(oRouter.Find("/graph/main/filters/f", oMatch));
+    ASSERT_EQ(&aTargets[3], oMatch.pTarget);
+    ASSERT_EQ("main", oMatch.GetParameter("graph"));
+    ASSERT_EQ("f", oMatch.GetParameter("filter"));
+    ASSERT_TRUE(oRouter.Find("/graph", oMatch));
+    ASSERT_EQ(&aTargets[4], oMatch.pTarget);
+    ASSERT_FALSE(oRouter.Find("/graph/", oMatch));
+    ASSERT_FALSE(oRouter.Find("/grap", oMatch));
+    ASSERT_FALSE(oRouter.Find("/graph/main//f", oMatch));
+
+    // the exact segment wins as long as the rest of the path matches below it
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/filters/f", oMatch));
+    ASSERT_EQ(&aTargets[2], oMatch.pTarget);
+    ASSERT_TRUE(oRouter.Remove("/graph/streaming/*"));
+    ASSERT_FALSE(oRouter.Remove("/graph/streaming/*"));
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/filters/f", oMatch));
+    ASSERT_EQ(&aTargets[3], oMatch.pTarget);
+    ASSERT_EQ("streaming", oMatch.GetParameter("graph"));
+
+    ASSERT_FALSE(oRouter.Remove("/graph/streaming/:name/properties"));
+    ASSERT_TRUE(oRouter.Remove("/graph/streaming/:filter/properties"));
+    ASSERT_TRUE(oRouter.Remove("/graph/:graph/filters/:filter"));
+    ASSERT_TRUE(oRouter.Remove("/graph"));
+    ASSERT_FALSE(oRouter.Find("/graph/streaming/filter_2/properties", oMatch));
+    ASSERT_TRUE(oRouter.Find("/graph/streaming/filter_1/properties", oMatch));
+    ASSERT_TRUE(oRouter.Remove("/graph/streaming/filter_1/properties"));
+    ASSERT_FALSE(oRouter.Find("/graph/streaming/filter_1/properties", oMatch));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    rpc_server.EnableMetrics();
+    cRouteEchoObject oObject;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("filters/:id", &oObject)));
+    ASSERT_FALSE(isOk(rpc_server.RegisterRPCObject("filters/:name", &oObject)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+    rpc::http::cJSONClientConnector oConnector("http://127.0.0.1:1234/filters/7");
+    std::string strResponse;
+    oConnector.SendRPCMessage("{}", strResponse);
+    ASSERT_EQ("7", strResponse);
+    ASSERT_EQ(nullptr, rpc::GetCurrentRoute());
+    rpc::http::cJSONClientConnector oOtherConnector("http://127.0.0.1:1234/filters/8");
+    oOtherConnector.SendRPCMessage("{}", strResponse);
+    ASSERT_EQ("8", strResponse);
+    // the calls of all paths of a route are measured together
+    const rpc::tMetricsSnapshot oMetrics = rpc_server.GetMetrics();
+    ASSERT_EQ(1u, oMetrics.size());
+    ASSERT_EQ("filters/:id", oMetrics[0].strObject);
+    ASSERT_EQ(2u, oMetrics[0].nCalls);
+    ASSERT_TRUE(isOk(rpc_server.UnregisterRPCObject("filters/:id")));
+}
+
+/**
+ * Takes 100 ms for every call.
+ */
+class cSlowObject : public rpc::IRPCObject
+{
+public:
+    std::atomic<int> nStarted;
+    std::atomic<int> nFinished;
+
+    cSlowObject() : nStarted(0), nFinished(0)
+    {
+    }
+
+    rpc::Result HandleCall(const char*, size_t, rpc::IResponse& oResponse) override
+    {
+        ++nStarted;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        oResponse.Set("{}", 2);
+        ++nFinished;
+        return rpc::Result();
+    }
+};
+
+TEST(cTesterPkgRpc, TestBulkRegistration)
+{
+    rpc::http::cJSONRPCServer rpc_server;
+    cRouteEchoObject oEcho;
+    cSlowObject oSlow1;
+    cSlowObject oSlow2;
+
+    rpc::http::cJSONRPCServer::tRPCObjectList oObjects;
+    oObjects.push_back(std::make_pair("a", &oEcho));
+    oObjects.push_back(std::make_pair("b", &oEcho));
+    oObjects.push_back(std::make_pair("a", &oEcho));
+    ASSERT_FALSE(isOk(rpc_server.RegisterRPCObjects(oObjects)));
+    ASSERT_FALSE(isOk(rpc_server.UnregisterRPCObject("b")));
+
+    oObjects.pop_back();
+    oObjects.push_back(std::make_pair("slow/1", &oSlow1));
+    oObjects.push_back(std::make_pair("slow/2", &oSlow2));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObjects(oObjects)));
+    ASSERT_FALSE(isOk(rpc_server.RegisterRPCObjects(oObjects)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    std::string strResponse;
+    rpc::http::cJSONClientConnector oConnector("http://127.0.0.1:1234/b");
+    oConnector.SendRPCMessage("{}", strResponse);
+    ASSERT_EQ("none", strResponse);
+
+    std::vector<std::string> oNames = {"a", "missing"};
+    ASSERT_FALSE(isOk(rpc_server.UnregisterRPCObjects(oNames)));
+    ASSERT_TRUE(isOk(rpc_server.UnregisterRPCObject("a")));
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("a", &oEcho)));
+
+    // unregistering waits for the calls in progress on all objects
+    std::vector<std::thread> oClients;
+    for (const char* strUrl: {"http://127.0.0.1:1234/slow/1", "http://127.0.0.1:1234/slow/2"})
+    {
+        oClients.push_back(std::thread([strUrl]() {
+            std::string strResponse;
+            rpc::http::cJSONClientConnector oConnector(strUrl);
+            oConnector.SendRPCMessage("{}", strResponse);
+        }));
+    }
+    while (oSlow1.nStarted == 0 || oSlow2.nStarted == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    oNames = {"a", "b", "slow/1", "slow/2"};
+    ASSERT_TRUE(isOk(rpc_server.UnregisterRPCObjects(oNames)));
+    ASSERT_EQ(1, oSlow1.nFinished);
+    ASSERT_EQ(1, oSlow2.nFinished);
+    for (std::thread& oClient: oClients)
+    {
+        oClient.join();
+    }
+    ASSERT_FALSE(isOk(rpc_server.UnregisterRPCObject("b")));
+}
+
+namespace
+{
+rpc::tNotificationPtr MakeNotification(const char* strKey, const char* strData)
+{
+    std::shared_ptr<rpc::tNotification> pNotification(new rpc::tNotification);
+    pNotification->strKey = strKey;
+    pNotification->strData = strData;
+    return pNotification;
+}
+
+std::string TakeAll(rpc::cNotificationHub::cSubscription& oSubscription)
+{
+    std::vector<rpc::tNotificationPtr> oNotifications;
+    std::string strData;
+    if (oSubscription.Take(oNotifications, 0))
+    {
+        for (const rpc::tNotificationPtr& pNotification: oNotifications)
+        {
+            strData += pNotification->strData;
+        }
+    }
+    return strData;
+}
+} // namespace
+
+TEST(cTesterPkgRpc, TestNotificationHub)
+{
+    const rpc::eOverflowPolicy aPolicies[] = {rpc::eDropOldest, rpc::eDropNewest, rpc::eCoalesce};
+    const char* const aExpected[] = {"234", "123", "a4c"};
+    for (size_t nPolicy = 0; nPolicy < 3; ++nPolicy)
+    {
+        rpc::cNotificationHub oHub(3, aPolicies[nPolicy]);
+        ASSERT_EQ(0u, oHub.Publish("topic", MakeNotification("x", "0")));
+        rpc::cNotificationHub::cSubscription oSubscription(oHub, "topic");
+        {
+            rpc::cNotificationHub::cSubscription oOther(oHub, "other");
+            ASSERT_EQ(1u, oHub.GetSubscriberCount("topic"));
+            ASSERT_EQ(1u, oHub.GetSubscriberCount("other"));
+        }
+        ASSERT_EQ(0u, oHub.GetSubscriberCount("other"));
+
+        ASSERT_EQ("", TakeAll(oSubscription));
+        ASSERT_EQ(1u, oHub.Publish("topic", MakeNotification("a", "1")));
+        oHub.Publish("topic", MakeNotification("b", "2"));
+        oHub.Publish("topic", MakeNotification("c", "3"));
+        oHub.Publish("topic", MakeNotification("b", "4"));
+        ASSERT_EQ(1u, oSubscription.GetDropped());
+        if (aPolicies[nPolicy] == rpc::eCoalesce)
+        {
+            // coalescing only applies to full queues, a key not queued drops the oldest
+            ASSERT_EQ("143", TakeAll(oSubscription));
+            oHub.Publish("topic", MakeNotification("a", "a"));
+            oHub.Publish("topic", MakeNotification("b", "b"));
+            oHub.Publish("topic", MakeNotification("c", "c"));
+            oHub.Publish("topic", MakeNotification("b", "4"));
+        }
+        ASSERT_EQ(aExpected[nPolicy], TakeAll(oSubscription));
+    }
+}
+
+TEST(cTesterPkgRpc, TestNotifications)
+{
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_EQ(0u, rpc_server.Publish("graph", "Started", Json::Value()));
+    rpc_server.EnableNotifications(16, rpc::eDropOldest);
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    std::mutex oLock;
+    std::vector<std::string> oReceived;
+    std::unique_ptr<rpc::http::cJSONSubscriber> pSubscriber(new rpc::http::cJSONSubscriber(
+        "http://127.0.0.1:1234",
+        "graph/main",
+        [&](const std::string& strMethod, const Json::Value& oParams) {
+            std::lock_guard<std::mutex> oGuard(oLock);
+            oReceived.push_back(strMethod + ":" + oParams["filter"].asString());
+        }));
+    rpc::http::cJSONSubscriber oOther(
+        "http://127.0.0.1:1234", "graph/other", [&](const std::string&, const Json::Value&) {
+            std::lock_guard<std::mutex> oGuard(oLock);
+            oReceived.push_back("other");
+        });
+    ASSERT_TRUE(pSubscriber->WaitForSubscription(5000));
+    ASSERT_TRUE(oOther.WaitForSubscription(5000));
+    ASSERT_EQ(1u, rpc_server.GetSubscriberCount("graph/main"));
+
+    Json::Value oParams;
+    for (const char* strFilter: {"a", "b", "c"})
+    {
+        oParams["filter"] = strFilter;
+        ASSERT_EQ(1u, rpc_server.Publish("graph/main", "Started", oParams));
+    }
+    // larger than a chunk of the response stream
+    oParams["filter"] = std::string(100000, 'x');
+    rpc_server.Publish("graph/main", "Large", oParams);
+
+    for (int nWait = 0; nWait < 500; ++nWait)
+    {
+        {
+            std::lock_guard<std::mutex> oGuard(oLock);
+            if (oReceived.size() == 4)
+            {
+                break;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> oGuard(oLock);
+        ASSERT_EQ(4u, oReceived.size());
+        ASSERT_EQ("Started:a", oReceived[0]);
+        ASSERT_EQ("Started:b", oReceived[1]);
+        ASSERT_EQ("Started:c", oReceived[2]);
+        ASSERT_EQ("Large:" + std::string(100000, 'x'), oReceived[3]);
+    }
+
+    // the server notices the closed connection when it writes the next time
+    pSubscriber.reset();
+    for (int nWait = 0; nWait < 500 && rpc_server.GetSubscriberCount("graph/main") > 0; ++nWait)
+    {
+        rpc_server.Publish("graph/main", "Stopped", Json::Value());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(0u, rpc_server.GetSubscriberCount("graph/main"));
+
+    // stopping the server ends the remaining subscriptions
+    ASSERT_TRUE(oOther.IsConnected());
+    ASSERT_TRUE(isOk(rpc_server.StopListening()));
+    for (int nWait = 0; nWait < 500 && oOther.IsConnected(); ++nWait)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_FALSE(oOther.IsConnected());
+}
+
+/**
+ * Object for WebSocket connections, calls its client back and has a slow call.
+ */
+class cWebSocketTestServer : public rpc::jsonrpc_object_server<rpc_stubs::cTestServerStub>
+{
+public:
+    cWebSocketTestServer() : m_bSlowCallStarted(false), m_bSlowCallReleased(false)
+    {
+    }
+
+    /**
+     * Asks the client for the value and doubles it.
+     */
+    virtual int GetInteger(int nValue)
+    {
+        rpc::jsonrpc_remote_object<rpc_stubs::cTestClientStub,
+                                   rpc::http::cJSONWebSocketCallbackConnector,
+                                   rpc::http::tWebSocketPeer>
+            oClient(rpc::http::GetCurrentWebSocketPeer());
+        return oClient.GetInteger(nValue) * 2;
+    }
+
+    /**
+     * Waits until the call is released if the first string is "slow".
+     */
+    virtual std::string Concat(const std::string& strString1, const std::string& strString2)
+    {
+        if (strString1 == "slow")
+        {
+            m_bSlowCallStarted = true;
+            for (int nWait = 0; nWait < 500 && !m_bSlowCallReleased; ++nWait)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+        return strString1 + strString2;
+    }
+
+    virtual std::string GetIntegerAsString(const std::string& nValue)
+    {
+        return nValue;
+    }
+
+    virtual Json::Value GetResult()
+    {
+        return Json::Value();
+    }
+
+    virtual Json::Value RegisterObject()
+    {
+        return Json::Value();
+    }
+
+    virtual Json::Value UnregisterObject()
+    {
+        return Json::Value();
+    }
+
+    virtual Json::Value UnregisterSelf()
+    {
+        return Json::Value();
+    }
+
+public:
+    std::atomic<bool> m_bSlowCallStarted;
+    std::atomic<bool> m_bSlowCallReleased;
+};
+
+/**
+ * Answers calls with their id and notifications with nothing, like objects of generated stubs.
+ */
+class cEchoObject : public rpc::IRPCObject
+{
+public:
+    rpc::Result HandleCall(const char* strRequest,
+                           size_t nRequestSize,
+                           rpc::IResponse& oResponse) override
+    {
+        Json::Value oRequest;
+        if (Json::Reader().parse(strRequest, strRequest + nRequestSize, oRequest) &&
+            oRequest.isMember("id"))
+        {
+            Json::Value oResult;
+            oResult["jsonrpc"] = "2.0";
+            oResult["id"] = oRequest["id"];
+            oResult["result"] = oRequest["id"];
+            const std::string strResponse = Json::FastWriter().write(oResult);
+            oResponse.Set(strResponse.data(), strResponse.size());
+        }
+        return rpc::Result();
+    }
+};
+
+/**
+ * A WebSocket connection to the test server without a connector, to look at the messages.
+ */
+class cRawWebSocket
+{
+public:
+    explicit cRawWebSocket(const std::string& strPath)
+        : m_nSocket(httplib::detail::create_client_socket("127.0.0.1", 1234)),
+          m_oFrames(
+              [this](char* pData, size_t nSize) {
+                  return httplib::detail::socket_read_all(m_nSocket, pData, nSize);
+              },
+              [this](const char* pData, size_t nSize) {
+                  return httplib::detail::socket_write(m_nSocket, pData, nSize) ==
+                         static_cast<int>(nSize);
+              },
+              true),
+          m_bConnected(false)
+    {
+        if (m_nSocket == -1)
+        {
+            return;
+        }
+        const std::string strKey = rpc::http::detail::CreateWebSocketKey();
+        const std::string strHandshake =
+            "GET " + strPath +
+            " HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\n"
+            "Connection: keep-alive, Upgrade\r\nSec-WebSocket-Key: " +
+            strKey + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+        httplib::detail::socket_write(m_nSocket, strHandshake.data(), strHandshake.size());
+        httplib::Response oResponse;
+        m_bConnected = httplib::detail::read_response_line(m_nSocket, oResponse) &&
+                       oResponse.status == 101 &&
+                       httplib::detail::read_headers(m_nSocket, oResponse.headers) &&
+                       oResponse.get_header_value("Sec-WebSocket-Accept") ==
+                           rpc::http::detail::GetWebSocketAccept(strKey);
+    }
+
+    ~cRawWebSocket()
+    {
+        if (m_nSocket != -1)
+        {
+            httplib::detail::close_socket(m_nSocket);
+        }
+    }
+
+    bool IsConnected() const
+    {
+        return m_bConnected;
+    }
+
+    rpc::http::detail::cWebSocketFrames& GetFrames()
+    {
+        return m_oFrames;
+    }
+
+    bool Send(const std::string& strMessage)
+    {
+        return m_oFrames.Send(
+            rpc::http::detail::eWebSocketText, strMessage.data(), strMessage.size());
+    }
+
+    bool Receive(Json::Value& oMessage)
+    {
+        std::string strMessage;
+        return m_oFrames.Receive(strMessage) && Json::Reader().parse(strMessage, oMessage);
+    }
+
+private:
+    socket_t m_nSocket;
+    rpc::http::detail::cWebSocketFrames m_oFrames;
+    bool m_bConnected;
+};
+
+TEST(cTesterPkgRpc, TestWebSocket)
+{
+    // the example of RFC 6455
+    ASSERT_EQ("s3pPLMBiTxaQ9kYGzzhZRbK+xOo=",
+              rpc::http::detail::GetWebSocketAccept("dGhlIHNhbXBsZSBub25jZQ=="));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    cTestServer oTestServer(rpc_server);
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oTestServer)));
+    cWebSocketTestServer oWebSocketServer;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("websocket", &oWebSocketServer)));
+    cEchoObject oEcho;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("echo", &oEcho)));
+    rpc_server.EnableNotifications(16, rpc::eDropOldest);
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    {
+        rpc::jsonrpc_remote_object<rpc_stubs::cTestClientStub,
+                                   rpc::http::cJSONWebSocketConnector,
+                                   std::string>
+            oClient("ws://127.0.0.1:1234/test");
+        ASSERT_EQ(1234, oClient.GetInteger(1234));
+        // larger than a frame with a 16 bit size
+        ASSERT_EQ(std::string(100000, 'x') + "y", oClient.Concat(std::string(100000, 'x'), "y"));
+
+        // the calls of all threads share the connection and get their own results
+        std::atomic<int> nMismatches(0);
+        std::vector<std::thread> oThreads;
+        for (int nThread = 0; nThread < 4; ++nThread)
+        {
+            oThreads.emplace_back([&oClient, &nMismatches, nThread]() {
+                for (int nCall = 0; nCall < 100; ++nCall)
+                {
+                    const int nValue = nThread * 1000 + nCall;
+                    if (oClient.GetInteger(nValue) != nValue)
+                    {
+                        ++nMismatches;
+                    }
+                }
+            });
+        }
+        for (std::thread& oThread: oThreads)
+        {
+            oThread.join();
+        }
+        ASSERT_EQ(0, nMismatches);
+
+        // the ids of batches are restored
+        jsonrpc::BatchCall oCalls;
+        Json::Value oParams;
+        oParams["nValue"] = 7;
+        const int nFirst = oCalls.addCall("GetInteger", oParams);
+        oParams["nValue"] = 8;
+        const int nSecond = oCalls.addCall("GetInteger", oParams);
+        jsonrpc::BatchResponse oResponses = oClient.CallProcedures(oCalls);
+        ASSERT_FALSE(oResponses.hasErrors());
+        ASSERT_EQ(7, oResponses.getResult(nFirst).asInt());
+        ASSERT_EQ(8, oResponses.getResult(nSecond).asInt());
+    }
+
+    {
+        // a slow call does not hold up the other calls on the connection
+        rpc::jsonrpc_remote_object<rpc_stubs::cTestClientStub,
+                                   rpc::http::cJSONWebSocketConnector,
+                                   std::string>
+            oClient("ws://127.0.0.1:1234/websocket");
+        std::atomic<bool> bSlowCallDone(false);
+        std::thread oSlowCall([&oClient, &bSlowCallDone]() {
+            oClient.Concat("slow", "call");
+            bSlowCallDone = true;
+        });
+        for (int nWait = 0; nWait < 500 && !oWebSocketServer.m_bSlowCallStarted; ++nWait)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        ASSERT_TRUE(oWebSocketServer.m_bSlowCallStarted);
+        ASSERT_EQ("1234", oClient.GetIntegerAsString("1234"));
+        ASSERT_FALSE(bSlowCallDone);
+        oWebSocketServer.m_bSlowCallReleased = true;
+        oSlowCall.join();
+        ASSERT_TRUE(bSlowCallDone);
+
+        // the server calls back the client, without a callback object that is an error
+        ASSERT_THROW(oClient.GetInteger(21), jsonrpc::JsonRpcException);
+        cTestServer oCallbacks(rpc_server);
+        oClient.SetCallbackObject(&oCallbacks);
+        ASSERT_EQ(42, oClient.GetInteger(21));
+        oClient.SetCallbackObject(nullptr);
+    }
+
+    {
+        // calls to unknown objects are answered with an error
+        rpc::jsonrpc_remote_object<rpc_stubs::cTestClientStub,
+                                   rpc::http::cJSONWebSocketConnector,
+                                   std::string>
+            oClient("ws://127.0.0.1:1234/unknown");
+        try
+        {
+            oClient.GetInteger(1);
+            FAIL();
+        }
+        catch (const jsonrpc::JsonRpcException& oException)
+        {
+            ASSERT_EQ(jsonrpc::Errors::ERROR_RPC_METHOD_NOT_FOUND, oException.GetCode());
+        }
+    }
+
+    {
+        // notifications are not answered, not even for unknown objects
+        for (const char* strPath: {"/echo", "/unknown"})
+        {
+            cRawWebSocket oSocket(strPath);
+            ASSERT_TRUE(oSocket.IsConnected());
+            ASSERT_TRUE(oSocket.Send(
+                "{\"jsonrpc\":\"2.0\",\"method\":\"GetInteger\",\"params\":{\"nValue\":1}}"));
+            ASSERT_TRUE(oSocket.Send("{\"jsonrpc\":\"2.0\",\"method\":\"GetInteger\","
+                                     "\"params\":{\"nValue\":2},\"id\":\"call\"}"));
+            Json::Value oResponse;
+            ASSERT_TRUE(oSocket.Receive(oResponse));
+            ASSERT_EQ("call", oResponse["id"].asString());
+        }
+    }
+
+    {
+        // a subscription receives a message per notification
+        cRawWebSocket oSocket("/__subscribe/graph");
+        ASSERT_TRUE(oSocket.IsConnected());
+        for (int nWait = 0; nWait < 500 && rpc_server.GetSubscriberCount("graph") == 0; ++nWait)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        Json::Value oParams;
+        oParams["filter"] = "a";
+        ASSERT_EQ(1u, rpc_server.Publish("graph", "Started", oParams));
+        oParams["filter"] = "b";
+        ASSERT_EQ(1u, rpc_server.Publish("graph", "Started", oParams));
+
+        for (const char* strFilter: {"a", "b"})
+        {
+            Json::Value oNotification;
+            ASSERT_TRUE(oSocket.Receive(oNotification));
+            ASSERT_EQ("Started", oNotification["method"].asString());
+            ASSERT_EQ(strFilter, oNotification["params"]["filter"].asString());
+        }
+
+        // the server answers the close and unsubscribes
+        oSocket.GetFrames().Close(1000);
+        std::string strMessage;
+        ASSERT_FALSE(oSocket.GetFrames().Receive(strMessage));
+    }
+    for (int nWait = 0; nWait < 500 && rpc_server.GetSubscriberCount("graph") > 0; ++nWait)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_EQ(0u, rpc_server.GetSubscriberCount("graph"));
+
+    ASSERT_TRUE(isOk(rpc_server.StopListening()));
+}
+
+TEST(cTesterPkgRpc, TestWebSocketCalls)
+{
+    using rpc::http::detail::cWebSocketCalls;
+    cWebSocketCalls oCalls;
+    std::promise<std::string> oSent;
+    std::string strResponse;
+    bool bAnswered = false;
+    std::thread oCaller([&oCalls, &oSent, &strResponse, &bAnswered]() {
+        // only the ids of the calls are replaced, not the ones in the parameters
+        bAnswered = oCalls.Call("[{\"jsonrpc\":\"2.0\",\"method\":\"a\","
+                                "\"params\":{\"id\":\"}\\\"]\"},\"id\":\"x\"},"
+                                " {\"method\":\"b\"}, {\"method\":\"c\",\"id\" : 7}]",
+                                strResponse,
+                                [&oSent](const std::string& strMessage) {
+                                    oSent.set_value(strMessage);
+                                    return true;
+                                });
+    });
+    Json::Value oSentRequest;
+    ASSERT_TRUE(Json::Reader().parse(oSent.get_future().get(), oSentRequest));
+    ASSERT_EQ(1u, oSentRequest[0]["id"].asUInt64());
+    ASSERT_EQ("}\"]", oSentRequest[0]["params"]["id"].asString());
+    ASSERT_FALSE(oSentRequest[1].isMember("id"));
+    ASSERT_EQ(2u, oSentRequest[2]["id"].asUInt64());
+
+    ASSERT_EQ(cWebSocketCalls::eRequest, oCalls.Receive("{\"method\":\"m\",\"id\":1}"));
+    ASSERT_EQ(cWebSocketCalls::eRequest, oCalls.Receive("no json"));
+    ASSERT_EQ(cWebSocketCalls::eUnexpected, oCalls.Receive("{\"id\":3,\"result\":0}"));
+    // the response may come in any order
+    ASSERT_EQ(cWebSocketCalls::eResponse,
+              oCalls.Receive("[{\"id\":2,\"result\":{\"id\":5}},{\"id\":1,\"result\":\"a\"}]"));
+    oCaller.join();
+    ASSERT_TRUE(bAnswered);
+    Json::Value oResponse;
+    ASSERT_TRUE(Json::Reader().parse(strResponse, oResponse));
+    ASSERT_EQ(7, oResponse[0]["id"].asInt());
+    ASSERT_EQ(5, oResponse[0]["result"]["id"].asInt());
+    ASSERT_EQ("x", oResponse[1]["id"].asString());
+    ASSERT_FALSE(oCalls.HasPendingCalls());
+
+    // notifications do not wait
+    const cWebSocketCalls::tSend fnSend = [](const std::string&) { return true; };
+    ASSERT_TRUE(oCalls.Call("{\"method\":\"n\",\"id\":null}", strResponse, fnSend));
+    ASSERT_TRUE(strResponse.empty());
+
+    // closing the connection fails the calls
+    std::thread oClosed([&oCalls, &bAnswered, &fnSend]() {
+        std::string strClosedResponse;
+        bAnswered = oCalls.Call("{\"method\":\"m\",\"id\":1}", strClosedResponse, fnSend);
+    });
+    for (int nWait = 0; nWait < 500 && !oCalls.HasPendingCalls(); ++nWait)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    oCalls.Close();
+    oClosed.join();
+    ASSERT_FALSE(bAnswered);
+    ASSERT_FALSE(oCalls.Call("{\"method\":\"m\",\"id\":1}", strResponse, fnSend));
+
+    std::string strError;
+    ASSERT_TRUE(rpc::http::detail::CreateErrorResponse(
+        "[{\"method\":\"m\",\"id\":4},{\"method\":\"n\"}]", -32601, "not found", strError));
+    ASSERT_TRUE(Json::Reader().parse(strError, oResponse));
+    ASSERT_EQ(1u, oResponse.size());
+    ASSERT_EQ(4, oResponse[0]["id"].asInt());
+    ASSERT_EQ(-32601, oResponse[0]["error"]["code"].asInt());
+    ASSERT_FALSE(rpc::http::detail::CreateErrorResponse(
+        "{\"method\":\"n\"}", -32601, "not found", strError));
+}
+
+TEST(cTesterPkgRpc, TestWebSocketBackpressure)
+{
+    // a worker that is behind stops the connection from receiving
+    using rpc::http::detail::cWebSocketWorkers;
+    std::atomic<bool> bReleased(false);
+    {
+        cWebSocketWorkers oWorkers(
+            [&bReleased](const std::string&, uint64_t) {
+                for (int nWait = 0; nWait < 500 && !bReleased; ++nWait)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            },
+            1);
+        ASSERT_TRUE(oWorkers.WaitForSlot(0));
+        for (int nMessage = 0; nMessage < 5; ++nMessage)
+        {
+            oWorkers.Push("message", 0);
+        }
+        ASSERT_FALSE(oWorkers.WaitForSlot(10));
+        bReleased = true;
+        ASSERT_TRUE(oWorkers.WaitForSlot(5000));
+    }
+
+    rpc::http::cJSONRPCServer rpc_server;
+    cWebSocketTestServer oWebSocketServer;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("websocket", &oWebSocketServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    // one connection floods the server with slow calls, far more than the socket buffers hold
+    cRawWebSocket oSocket("/websocket");
+    ASSERT_TRUE(oSocket.IsConnected());
+    const int nCalls = 1000;
+    const std::string strPayload(64 * 1024, 'x');
+    std::atomic<int> nSent(0);
+    std::thread oSender([&oSocket, &nSent, &strPayload]() {
+        for (int nCall = 0; nCall < nCalls; ++nCall)
+        {
+            if (!oSocket.Send("{\"jsonrpc\":\"2.0\",\"method\":\"Concat\",\"id\":" +
+                              std::to_string(nCall) +
+                              ",\"params\":{\"strString1\":\"slow\",\"strString2\":\"" +
+                              strPayload + "\"}}"))
+            {
+                return;
+            }
+            ++nSent;
+        }
+    });
+    for (int nWait = 0; nWait < 500 && !oWebSocketServer.m_bSlowCallStarted; ++nWait)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(oWebSocketServer.m_bSlowCallStarted);
+
+    // the sender is held up once the workers and the socket buffers are full
+    int nLastSent = -1;
+    for (int nWait = 0; nWait < 30 && nSent != nLastSent; ++nWait)
+    {
+        nLastSent = nSent;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    EXPECT_LT(nSent, nCalls);
+
+    // all calls are answered once the slow call is released
+    oWebSocketServer.m_bSlowCallReleased = true;
+    std::vector<bool> oAnswered(nCalls, false);
+    for (int nResponse = 0; nResponse < nCalls; ++nResponse)
+    {
+        Json::Value oResponse;
+        ASSERT_TRUE(oSocket.Receive(oResponse));
+        ASSERT_EQ(strPayload.size() + 4, oResponse["result"].asString().size());
+        oAnswered[oResponse["id"].asUInt()] = true;
+    }
+    oSender.join();
+    ASSERT_EQ(nCalls, nSent);
+    ASSERT_EQ(std::vector<bool>(nCalls, true), oAnswered);
+
+    ASSERT_TRUE(isOk(rpc_server.StopListening()));
+}
+
+TEST(cTesterPkgRpc, TestCompression)
+{
+    using namespace rpc::http::detail;
+    ASSERT_EQ(eEncodingGzip, SelectContentEncoding("deflate, gzip;q=0.5"));
+    ASSERT_EQ(eEncodingDeflate, SelectContentEncoding("gzip;q=0, deflate"));
+    ASSERT_EQ(eEncodingGzip, SelectContentEncoding("*"));
+    ASSERT_EQ(eEncodingIdentity, SelectContentEncoding("br, identity"));
+    ASSERT_EQ(eEncodingIdentity, SelectContentEncoding(""));
+    ASSERT_EQ(eEncodingGzip, ParseContentEncoding(" GZIP "));
+    ASSERT_EQ(eEncodingUnknown, ParseContentEncoding("br"));
+
+    // the streams are reused for the next body
+    cCompressor oCompressor;
+    std::string strBody;
+    for (int nValue = 0; nValue < 10000; ++nValue)
+    {
+        strBody += "{\"name\":\"filter_" + std::to_string(nValue) + "\"},";
+    }
+    for (eContentEncoding eEncoding: {eEncodingGzip, eEncodingDeflate, eEncodingGzip})
+    {
+        std::string strCompressed;
+        std::string strDecompressed;
+        oCompressor.Compress(eEncoding, strBody.data(), strBody.size(), strCompressed);
+        ASSERT_LT(strCompressed.size(), strBody.size() / 4);
+        ASSERT_TRUE(oCompressor.Decompress(eEncoding, strCompressed, strDecompressed));
+        ASSERT_EQ(strBody, strDecompressed);
+        ASSERT_FALSE(oCompressor.Decompress(
+            eEncoding, strCompressed.substr(0, strCompressed.size() / 2), strDecompressed));
+    }
+    std::string strDecompressed;
+    ASSERT_FALSE(oCompressor.Decompress(eEncodingGzip, "not compressed", strDecompressed));
+
+    rpc::http::cJSONRPCServer rpc_server;
+    cTestServer oTestServer(rpc_server);
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("test", &oTestServer)));
+    rpc_server.EnableCompression(256);
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+
+    // compressed requests and responses, the large one streamed in compressed chunks
+    cTestClient oClient("http://127.0.0.1:1234/test");
+    oClient.EnableCompression(256);
+    ASSERT_EQ(1234, oClient.GetInteger(1234));
+    ASSERT_EQ(strBody + "x", oClient.Concat(strBody, "x"));
+    const std::string strSmall(1000, 'a');
+    ASSERT_EQ(strSmall + strSmall, oClient.Concat(strSmall, strSmall));
+
+    // clients that do not accept compression get the plain response
+    cTestClient oPlainClient("http://127.0.0.1:1234/test");
+    ASSERT_EQ(strBody + "x", oPlainClient.Concat(strBody, "x"));
+
+    const std::string strRequest =
+        "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Concat\",\"params\":{\"strString1\":\"" +
+        strSmall + "\",\"strString2\":\"\"}}";
+    httplib::Client oHttpClient("127.0.0.1", 1234);
+    for (const char* strEncoding: {"gzip", "deflate"})
+    {
+        httplib::Response oResponse;
+        ASSERT_TRUE(oHttpClient.send_raw(
+            "POST /test HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept-Encoding: " +
+                std::string(strEncoding) +
+                "\r\nContent-Type: application/json\r\nContent-Length: " +
+                std::to_string(strRequest.size()) + "\r\n\r\n" + strRequest,
+            oResponse));
+        ASSERT_EQ(200, oResponse.status);
+        ASSERT_EQ(strEncoding, oResponse.get_header_value("Content-Encoding"));
+        ASSERT_EQ("Accept-Encoding", oResponse.get_header_value("Vary"));
+        ASSERT_TRUE(oCompressor.Decompress(
+            ParseContentEncoding(strEncoding), oResponse.body, strDecompressed));
+        ASSERT_NE(std::string::npos, strDecompressed.find(strSmall));
+    }
+
+    // a response larger than a chunk is compressed as a stream
+    Json::Value oLargeRequest;
+    oLargeRequest["jsonrpc"] = "2.0";
+    oLargeRequest["id"] = 1;
+    oLargeRequest["method"] = "Concat";
+    oLargeRequest["params"]["strString1"] = strBody;
+    oLargeRequest["params"]["strString2"] = "";
+    const std::string strLargeRequest = Json::FastWriter().write(oLargeRequest);
+    httplib::Response oResponse;
+    ASSERT_TRUE(oHttpClient.send_raw(
+        "POST /test HTTP/1.1\r\nHost: 127.0.0.1\r\nAccept-Encoding: gzip\r\n"
+        "Content-Type: application/json\r\nContent-Length: " +
+            std::to_string(strLargeRequest.size()) + "\r\n\r\n" + strLargeRequest,
+        oResponse));
+    ASSERT_EQ(200, oResponse.status);
+    ASSERT_EQ("chunked", oResponse.get_header_value("Transfer-Encoding"));
+    ASSERT_EQ("gzip", oResponse.get_header_value("Content-Encoding"));
+    ASSERT_LT(oResponse.body.size(), strBody.size() / 4);
+    ASSERT_TRUE(oCompressor.Decompress(eEncodingGzip, oResponse.body, strDecompressed));
+    Json::Value oLargeResponse;
+    ASSERT_TRUE(Json::Reader().parse(strDecompressed, oLargeResponse));
+    ASSERT_EQ(strBody, oLargeResponse["result"].asString());
+
+    oResponse = httplib::Response();
+    ASSERT_TRUE(oHttpClient.send_raw(
+        "POST /test HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Encoding: br\r\n"
+        "Content-Type: application/json\r\nContent-Length: 2\r\n\r\n{}",
+        oResponse));
+    ASSERT_EQ(415, oResponse.status);
+
+    ASSERT_TRUE(isOk(rpc_server.StopListening()));
+}
+
+class cCacheTestServer : public rpc::jsonrpc_object_server<rpc_stubs::cTestCacheServerStub>
+{
+public:
+    cCacheTestServer() : m_nCounter(0), m_nCalls(0)
+    {
+    }
+
+    virtual int GetCounter()
+    {
+        ++m_nCalls;
+        return m_nCounter;
+    }
+
+    virtual int GetSquare(int nValue)
+    {
+        ++m_nCalls;
+        return nValue * nValue;
+    }
+
+    virtual int Increment()
+    {
+        ++m_nCounter;
+        InvalidateResponseCache("GetCounter");
+        return m_nCounter;
+    }
+
+    using rpc::jsonrpc_object_server<rpc_stubs::cTestCacheServerStub>::InvalidateResponseCache;
+
+    std::string Call(const std::string& strRequest)
+    {
+        cStringResponse oResponse;
+        HandleCall(strRequest.data(), strRequest.size(), oResponse);
+        return oResponse.m_strResponse;
+    }
+
+    int m_nCounter;
+    std::atomic<int> m_nCalls;
+};
+
+typedef rpc::jsonrpc_remote_object<rpc_stubs::cTestCacheClientStub,
+                                   rpc::http::cJSONClientConnector,
+                                   std::string>
+    cCacheTestClient;
+
+/**
+ * The responses of methods marked "cacheable" are reused with the id of the call, until they
+ * expire or the object invalidates them.
+ */
+TEST(cTesterPkgRpc, TestResponseCache)
+{
+    cCacheTestServer oServer;
+    ASSERT_EQ("{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":0}\n",
+              oServer.Call("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetCounter\"}"));
+    ASSERT_EQ(1, oServer.m_nCalls);
+    ASSERT_EQ("{\"id\":\"a\\\"b\",\"jsonrpc\":\"2.0\",\"result\":0}\n",
+              oServer.Call("{\"jsonrpc\":\"2.0\",\"id\":\"a\\\"b\",\"method\":\"GetCounter\"}"));
+    ASSERT_EQ("{\"id\":null,\"jsonrpc\":\"2.0\",\"result\":0}\n",
+              oServer.Call("{\"jsonrpc\":\"2.0\",\"id\":null,\"method\":" +
+                           std::to_string(rpc_stubs::cTestCacheServerStub::method_ids::GetCounter) +
+                           ",\"params\":null}"));
+    ASSERT_EQ(1, oServer.m_nCalls);
+
+    // invalidated by the object
+    oServer.Call("{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"Increment\"}");
+    ASSERT_EQ("{\"id\":2,\"jsonrpc\":\"2.0\",\"result\":1}\n",
+              oServer.Call("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"GetCounter\"}"));
+    ASSERT_EQ(2, oServer.m_nCalls);
+    oServer.InvalidateResponseCache();
+    oServer.Call("{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"GetCounter\"}");
+    ASSERT_EQ(3, oServer.m_nCalls);
+
+    // by parameters, whitespace and the order of members do not matter
+    const std::string strSquare = "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"GetSquare\",";
+    ASSERT_EQ("{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":9}\n",
+              oServer.Call(strSquare + "\"params\":{\"nValue\":3}}"));
+    ASSERT_EQ("{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":9}\n",
+              oServer.Call("{ \"params\" : { \"nValue\" : 3 }, \"method\" : \"GetSquare\","
+                           " \"id\" : 1, \"jsonrpc\" : \"2.0\" }"));
+    ASSERT_EQ(4, oServer.m_nCalls);
+    ASSERT_EQ("{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":16}\n",
+              oServer.Call(strSquare + "\"params\":{\"nValue\":4}}"));
+    ASSERT_EQ(5, oServer.m_nCalls);
+
+    // errors, batches and notifications are not cached
+    const std::string strInvalid = oServer.Call(strSquare + "\"params\":{\"nValue\":\"3\"}}");
+    ASSERT_NE(std::string::npos, strInvalid.find("\"error\""));
+    ASSERT_EQ(strInvalid, oServer.Call(strSquare + "\"params\":{\"nValue\":\"3\"}}"));
+    ASSERT_EQ("[{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":9}]\n",
+              oServer.Call("[" + strSquare + "\"params\":{\"nValue\":3}}]"));
+    ASSERT_EQ(6, oServer.m_nCalls);
+    ASSERT_NE(std::string::npos,
+              oServer.Call("{\"jsonrpc\":\"2.0\",\"method\":\"GetCounter\"}").find("\"error\""));
+    ASSERT_EQ(6, oServer.m_nCalls);
+
+    // the time to live
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    oServer.Call(strSquare + "\"params\":{\"nValue\":3}}");
+    ASSERT_EQ(7, oServer.m_nCalls);
+
+    rpc::http::cJSONRPCServer rpc_server;
+    ASSERT_TRUE(isOk(rpc_server.RegisterRPCObject("cache", &oServer)));
+    ASSERT_TRUE(isOk(rpc_server.StartListening("http://127.0.0.1:1234")));
+    cCacheTestClient oClient("http://127.0.0.1:1234/cache");
+    ASSERT_EQ(1, oClient.GetCounter());
+    ASSERT_EQ(1, oClient.GetCounter());
+    ASSERT_EQ(2, oClient.Increment());
+    ASSERT_EQ(2, oClient.GetCounter());
+    ASSERT_EQ(8, oServer.m_nCalls);
+    ASSERT_TRUE(isOk(rpc_server.StopListening()));
+}
+
+/**
+ * Answers calls once released, failing if asked to.
+ */
+class cBlockingConnector : public jsonrpc::IClientConnector
+{
+public:
+    cBlockingConnector() : m_nSent(0), m_bReleased(false), m_bFail(false)
+    {
+    }
+
+    void SendRPCMessage(const std::string& strMessage, std::string& strResult)
+    {
+        std::unique_lock<std::mutex> oGuard(m_oLock);
+        ++m_nSent;
+        m_oReleased.wait(oGuard, [this] { return m_bReleased; });
+        if (m_bFail)
+        {
+            throw jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_CLIENT_CONNECTOR, "failed");
+        }
+        strResult = "{\"id\":1,\"jsonrpc\":\"2.0\",\"result\":" +
+                    std::to_string(strMessage.size()) + "}";
+    }
+
+    void Release()
+    {
+        std::lock_guard<std::mutex> oGuard(m_oLock);
+        m_bReleased = true;
+        m_oReleased.notify_all();
+    }
+
+    /// waits until the first call is sent and gives the others the time to join it
+    void WaitForFirstCall()
+    {
+        while (m_nSent == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    std::atomic<int> m_nSent;
+    std::mutex m_oLock;
+    std::condition_variable m_oReleased;
+    bool m_bReleased;
+    bool m_bFail;
+};
+
+/**
+ * Concurrent calls of coalesced methods with equal parameters share one request, its result or
+ * its exception.
+ */
+TEST(cTesterPkgRpc, TestRequestCoalescing)
+{
+    const int nThreads = 8;
+    cBlockingConnector oConnector;
+    rpc_stubs::cTestCacheClientStub oClient(oConnector);
+    ASSERT_FALSE(oClient.IsCoalescing("GetCounter"));
+    oClient.CoalesceCacheableMethods();
+    ASSERT_TRUE(oClient.IsCoalescing("GetCounter"));
+    ASSERT_TRUE(oClient.IsCoalescing("GetSquare"));
+    ASSERT_FALSE(oClient.IsCoalescing("Increment"));
+
+    std::vector<std::thread> oThreads;
+    std::vector<int> oResults(nThreads * 2);
+    for (int nThread = 0; nThread < nThreads; ++nThread)
+    {
+        oThreads.emplace_back([&, nThread] { oResults[nThread] = oClient.GetSquare(3); });
+    }
+    oConnector.WaitForFirstCall();
+    // other parameters and methods are sent on their own
+    for (int nThread = nThreads; nThread < nThreads * 2; ++nThread)
+    {
+        oThreads.emplace_back([&, nThread] {
+            oResults[nThread] = nThread % 2 ? oClient.GetSquare(4) : oClient.Increment();
+        });
+    }
+    while (oConnector.m_nSent < 2 + nThreads / 2)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    oConnector.Release();
+    for (std::thread& oThread: oThreads)
+    {
+        oThread.join();
+    }
+    ASSERT_EQ(2 + nThreads / 2, oConnector.m_nSent);
+    for (int nThread = 1; nThread < nThreads; ++nThread)
+    {
+        ASSERT_EQ(oResults[0], oResults[nThread]);
+    }
+
+    // calls after the result has arrived are sent again
+    oClient.GetSquare(3);
+    ASSERT_EQ(3 + nThreads / 2, oConnector.m_nSent);
+
+    cBlockingConnector oFailingConnector;
+    oFailingConnector.m_bFail = true;
+    rpc_stubs::cTestCacheClientStub oFailingClient(oFailingConnector);
+    oFailingClient.SetCoalescing("GetCounter", true);
+    std::atomic<int> nFailed(0);
+    oThreads.clear();
+    for (int nThread = 0; nThread < nThreads; ++nThread)
+    {
+        oThreads.emplace_back([&] {
+            try
+            {
+                oFailingClient.GetCounter();
+            }
+            catch (const jsonrpc::JsonRpcException& oException)
+            {
+                if (oException.GetCode() == jsonrpc::Errors::ERROR_CLIENT_CONNECTOR)
+                {
+                    ++nFailed;
+                }
+            }
+        });
+    }
+    oFailingConnector.WaitForFirstCall();
+    oFailingConnector.Release();
+    for (std::thread& oThread: oThreads)
+    {
+        oThread.join();
+    }
+    ASSERT_EQ(1, oFailingConnector.m_nSent);
+    ASSERT_EQ(nThreads, nFailed);
+}